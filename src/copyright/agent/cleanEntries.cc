@@ -23,69 +23,171 @@
  * \todo skip "dnl "
 */
 #include "cleanEntries.hpp"
-#include <sstream>
-#include <iterator>
-using std::stringstream;
-using std::ostream_iterator;
+
+/**
+ * \brief Check if a byte is collapsed by cleanGeneral()
+ *
+ * Same bytes as the regex class `[[:space:]\x0-\x1f]` in the C locale
+ */
+static inline bool isCollapsedSpace(unsigned char c)
+{
+  return c <= ' ';
+}
+
+/**
+ * \brief Check if a byte is skipped after a new line by cleanStatement()
+ *
+ * Same bytes as the regex class `[[:space:][:punct:]]` in the C locale
+ */
+static inline bool isSpaceOrPunct(unsigned char c)
+{
+  return (c >= '\t' && c <= '\r') || (c >= ' ' && c <= '/') ||
+    (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+}
+
+/**
+ * \class spaceCollapser
+ * \brief Replaces every sequence of two or more spaces or control characters
+ * by a single space while appending to a buffer
+ *
+ * Does the same as replacing the regex `[[:space:]\x0-\x1f]{2,}` by " ".
+ */
+class spaceCollapser
+{
+public:
+  explicit spaceCollapser(string& out) : out(out), pending(0), first(0) { }
+
+  void put(char c)
+  {
+    if (isCollapsedSpace((unsigned char) c))
+    {
+      if (pending++ == 0)
+        first = c;
+      return;
+    }
+    flush();
+    out.push_back(c);
+  }
+
+  void flush()
+  {
+    if (pending == 1)
+      out.push_back(first);
+    else if (pending > 1)
+      out.push_back(' ');
+    pending = 0;
+  }
+
+private:
+  string& out;
+  size_t pending;     ///< Number of spaces read but not yet written
+  char first;         ///< First of the pending spaces
+} ;
 
 /**
  * \brief Trim space at beginning and end
  *
  * Since we already collapsed a sequence of spaces into one space, there can only be one space
- * \param sBegin String begin
- * \param sEnd   String end
- * \return string Trimmed string
+ * \param[in,out] s Collapsed string, trimmed in place
  */
-string cleanGeneral(string::const_iterator sBegin, string::const_iterator sEnd)
+static void trimCollapsed(string& s)
 {
-  stringstream ss;
-  rx::regex_replace(ostream_iterator<char>(ss), sBegin, sEnd, rx::regex("[[:space:]\\x0-\\x1f]{2,}"), " ");
-  string s = ss.str();
   string::size_type len = s.length();
   if (len > 1)
   {
-    char cBegin = s[0];
-    char cEnd = s[len - 1];
-    if (cBegin == ' ' && cEnd == ' ')
-      return s.substr(1, len - 2);
-    else if (cBegin == ' ')
-      return s.substr(1);
-    else if (cEnd == ' ')
-      return s.substr(0, len - 1);
+    if (s[len - 1] == ' ')
+      s.erase(len - 1);
+    if (s[0] == ' ')
+      s.erase(0, 1);
   }
   // Only one character/space??? Should not be possible
-  return s == " " ? "" : s;
+  else if (s == " ")
+    s.clear();
+}
+
+/**
+ * \brief Collapse the spaces of a text and trim it
+ * \param sBegin      String begin
+ * \param sEnd        String end
+ * \param[out] buffer Cleaned text, the previous content is replaced
+ */
+static void cleanGeneral(const char* sBegin, const char* sEnd, string& buffer)
+{
+  buffer.clear();
+  spaceCollapser collapser(buffer);
+  for (const char* it = sBegin; it != sEnd; ++it)
+    collapser.put(*it);
+  collapser.flush();
+  trimCollapsed(buffer);
 }
 
 /**
  * \brief Clean copyright statements from special characters
  * (comment characters in programming languages, multiple spaces etc.)
- * \param sBegin String begin
- * \param sEnd   String end
- * \return string Clean statements
+ *
+ * A new line with the spaces and punctuation following it (regex
+ * `\n[[:space:][:punct:]]*`) is replaced by a space, then the text is
+ * cleaned as by cleanGeneral(), in the same pass.
+ * \param sBegin      String begin
+ * \param sEnd        String end
+ * \param[out] buffer Cleaned statement, the previous content is replaced
  */
-string cleanStatement(string::const_iterator sBegin, string::const_iterator sEnd)
+static void cleanStatement(const char* sBegin, const char* sEnd, string& buffer)
 {
-  stringstream ss;
-  rx::regex_replace(ostream_iterator<char>(ss), sBegin, sEnd, rx::regex("\n[[:space:][:punct:]]*"), " ");
-  string s = ss.str();
-  return cleanGeneral(s.begin(), s.end());
+  buffer.clear();
+  spaceCollapser collapser(buffer);
+  const char* it = sBegin;
+  while (it != sEnd)
+  {
+    if (*it == '\n')
+    {
+      for (++it; it != sEnd && isSpaceOrPunct((unsigned char) *it); ++it)
+        ;
+      collapser.put(' ');
+    }
+    else
+      collapser.put(*it++);
+  }
+  collapser.flush();
+  trimCollapsed(buffer);
 }
 
 /**
  * \brief Clean the text based on type
  *
  * If match type is statement, clean as statement. Else clean as general text.
+ * The buffer keeps its capacity, so reusing it for all the matches of a file
+ * avoids allocating for each of them.
+ * \param text        Text for cleaning, the positions of the match are counted from it
+ * \param m           Matches to be cleaned
+ * \param[out] buffer Cleaned text, the previous content is replaced
+ */
+void cleanMatch(const char* text, const match& m, string& buffer)
+{
+  if (m.type == "statement")
+    cleanStatement(text + m.start, text + m.end, buffer);
+  else
+    cleanGeneral(text + m.start, text + m.end, buffer);
+}
+
+/**
+ * \overload void cleanMatch(const string& sText, const match& m, string& buffer)
+ */
+void cleanMatch(const string& sText, const match& m, string& buffer)
+{
+  cleanMatch(sText.data(), m, buffer);
+}
+
+/**
+ * \brief Clean the text based on type
  * \param sText Text for cleaning
  * \param m     Matches to be cleaned
  * \return string Cleaned text
+ * \see cleanMatch(const char*, const match&, string&)
  */
 string cleanMatch(const string& sText, const match& m)
 {
-  string::const_iterator it = sText.begin();
-  if (m.type == "statement")
-    return cleanStatement(it + m.start, it + m.end);
-  else
-    return cleanGeneral(it + m.start, it + m.end);
+  string result;
+  cleanMatch(sText.data(), m, result);
+  return result;
 }
-
@@ -24,6 +24,8 @@
 #include "scanners.hpp"
 
 string cleanMatch(const string& sText, const match& m);
+void cleanMatch(const string& sText, const match& m, string& buffer);
+void cleanMatch(const char* text, const match& m, string& buffer);
 
 
 #endif /* CLEANENTRIES_HPP_ */
@@ -51,6 +51,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 #include <stdio.h>
 #include <iostream>
 #include <sstream>
+#include <omp.h>
 
 #include "copyright.hpp"
 
@@ -81,41 +82,7 @@ int main(int argc, char** argv)
 
   if (!fileNames.empty())
   {
-    const unsigned long fileNamesCount = fileNames.size();
-    bool fileError = false;
-    bool printComma = false;
-
-    if (json)
-    {
-      cout << "[" << endl;
-    }
-
-#pragma omp parallel
-    {
-#pragma omp for
-      for (unsigned int argn = 0; argn < fileNamesCount; ++argn)
-      {
-        const string fileName = fileNames[argn];
-        pair<string, list<match>> scanResult = processSingleFile(state, fileName);
-        if (json)
-        {
-          appendToJson(fileName, scanResult, printComma);
-        }
-        else
-        {
-          printResultToStdout(fileName, scanResult);
-        }
-        if (scanResult.first.empty())
-        {
-          fileError = true;
-        }
-      }
-    }
-    if (json)
-    {
-      cout << endl << "]" << endl;
-    }
-    return fileError ? 1 : 0;
+    return scanFiles(state, json, fileNames) ? 0 : 1;
   }
   else if (directoryToScan.length() > 0)
   {
@@ -124,6 +91,8 @@ int main(int argc, char** argv)
   else
   {
     DbManager dbManager(&argc, argv);
+    // keep the connection of every thread for the next uploads
+    dbManager.setPoolSize(omp_get_max_threads());
     int agentId = queryAgentId(dbManager.getConnection());
 
     CopyrightDatabaseHandler copyrightDatabaseHandler(dbManager);
@@ -133,6 +102,11 @@ int main(int argc, char** argv)
       return_sched(9);
     }
 
+    // results of other versions of the agent are copied instead of scanning again
+    string fingerprint = getFingerprint(state);
+    bool reuseResults = fo_ResultReuseEnabled() &&
+      fo_SetAgentFingerprint(dbManager.getStruct_dbManager(), agentId, fingerprint.c_str());
+
     while (fo_scheduler_next() != NULL)
     {
       int uploadId = atoi(fo_scheduler_current());
@@ -144,6 +118,13 @@ int main(int argc, char** argv)
       if (arsId <= 0)
         return_sched(5);
 
+      if (reuseResults)
+      {
+        long copied = copyrightDatabaseHandler.copyResults(uploadId, agentId, fingerprint);
+        if (copied > 0)
+          fo_scheduler_heart(copied);
+      }
+
       if (!processUploadId(state, agentId, uploadId, copyrightDatabaseHandler))
         return_sched(2);
 
@@ -25,7 +25,8 @@
  */
 CopyrightState::CopyrightState(CliOptions&& cliOptions) :
   cliOptions(cliOptions),
-  scanners(cliOptions.extractScanners())
+  scanners(cliOptions.extractScanners()),
+  allScanners(new multiScanner(scanners))
 {
 }
 
@@ -36,7 +37,10 @@ CopyrightState::CopyrightState(CliOptions&& cliOptions) :
 void CopyrightState::addScanner(scanner* sc)
 {
   if (sc)
+  {
     scanners.push_back(unptr::shared_ptr<scanner>(sc));
+    allScanners.reset(new multiScanner(scanners));
+  }
 }
 
 /**
@@ -81,6 +85,15 @@ unsigned int CliOptions::getOptType() const
   return optType;
 }
 
+/**
+ * \brief Get the scanners combined in a multiScanner
+ * \return Scanner running all the scanners of the state in a single pass
+ */
+const scanner& CopyrightState::getMultiScanner() const
+{
+  return *allScanners;
+}
+
 /**
  * \brief Get the CliOptions set by user
  * \return The CliOptions
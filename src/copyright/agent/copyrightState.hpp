@@ -21,6 +21,7 @@
 
 #include "regscan.hpp"
 #include "copyscan.hpp"
+#include "multiscan.hpp"
 
 #include "libfossdbmanagerclass.hpp"
 #include "database.hpp"
@@ -69,11 +70,15 @@ public:
 
   const std::list<unptr::shared_ptr<scanner>>& getScanners() const;
 
+  /* all the scanners, run in a single pass */
+  const scanner& getMultiScanner() const;
+
   const CliOptions& getCliOptions() const;
 
 private:
   const CliOptions cliOptions;          /**< CliOptions passed */
   std::list<unptr::shared_ptr<scanner>> scanners; /**< List of available scanners */
+  unptr::shared_ptr<multiScanner> allScanners; /**< scanners, rebuilt when one is added */
 };
 
 #endif
@@ -21,6 +21,7 @@
  */
 
 #include "copyrightUtils.hpp"
+#include "regexConfProvider.hpp"
 #include <boost/program_options.hpp>
 
 #include <iostream>
@@ -285,29 +286,47 @@ CopyrightState getState(CliOptions&& cliOptions)
   return state;
 }
 
+/**
+ * \brief Get the fingerprint of the configuration of the agent
+ *
+ * The fingerprint covers the types of statements to find and the regexes of
+ * the scanners: the results of the agent versions with the same fingerprint
+ * are reused.
+ * \param state State of the agent, after its scanners were created
+ * \return SHA1 of the configuration
+ */
+string getFingerprint(const CopyrightState& state)
+{
+  ostringstream configuration;
+  configuration << IDENTITY << " " << AGENT_FINGERPRINT_REVISION << " "
+    << state.getCliOptions().getOptType() << "\n"
+    << RegexConfProvider::getLoadedRegexes();
+
+  gchar* checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA1,
+    configuration.str().c_str(), -1);
+  string fingerprint(checksum);
+  g_free(checksum);
+  return fingerprint;
+}
+
 /**
  * \brief Save findings to the database if agent was called by scheduler
- * \param s                        Statement found
- * \param matches                  List of regex matches for highlight
- * \param pFileId                  Id of pfile on which the statement was found
- * \param agentId                  Id of agent who discovered the statements
- * \param copyrightDatabaseHandler Database handler object
+ *
+ * The findings are buffered and committed later with the ones of other pfiles.
+ * \param content      Content of the file
+ * \param matches      List of regex matches for highlight
+ * \param pFileId      Id of pfile on which the statement was found
+ * \param agentId      Id of agent who discovered the statements
+ * \param resultBuffer Buffer of the findings to write to the database
  * \return True of successful insertion, false otherwise
  */
-bool saveToDatabase(const string& s, const list<match>& matches, unsigned long pFileId, int agentId, const CopyrightDatabaseHandler& copyrightDatabaseHandler)
+bool saveToDatabase(const fo::FileView& content, const list<match>& matches, unsigned long pFileId, int agentId, CopyrightResultBuffer& resultBuffer)
 {
-  if (!copyrightDatabaseHandler.begin())
-  {
-    return false;
-  }
-
-  size_t count = 0;
+  DatabaseEntry entry;
   for (auto m = matches.begin(); m != matches.end(); ++m)
   {
-
-    DatabaseEntry entry;
     entry.agent_fk = agentId;
-    entry.content = cleanMatch(s, *m);
+    cleanMatch(content.data(), *m, entry.content);
     entry.copy_endbyte = m->end;
     entry.copy_startbyte = m->start;
     entry.pfile_fk = pFileId;
@@ -315,41 +334,32 @@ bool saveToDatabase(const string& s, const list<match>& matches, unsigned long p
 
     if (entry.content.length() != 0)
     {
-      ++count;
-      if (!copyrightDatabaseHandler.insertInDatabase(entry))
-      {
-        copyrightDatabaseHandler.rollback();
-        return false;
-      };
+      resultBuffer.addEntry(entry);
     }
   }
 
-  return copyrightDatabaseHandler.commit();
+  return resultBuffer.endFile();
 }
 
 /**
  * \brief Scan a given file with all available scanners and save findings to database
- * \param sContent        Content of file
+ * \param content         Content of file
  * \param pFileId         id of the pfile sent for scan
  * \param state           State of the agent
  * \param agentId         Agent id
- * \param databaseHandler Database handler used by agent
+ * \param resultBuffer    Buffer of the findings to write to the database
  */
-void matchFileWithLicenses(const string& sContent, unsigned long pFileId, CopyrightState const& state, int agentId, CopyrightDatabaseHandler& databaseHandler)
+void matchFileWithLicenses(const fo::FileView& content, unsigned long pFileId, CopyrightState const& state, int agentId, CopyrightResultBuffer& resultBuffer)
 {
   list<match> l;
-  const list<unptr::shared_ptr<scanner>>& scanners = state.getScanners();
-  for (auto sc = scanners.begin(); sc != scanners.end(); ++sc)
-  {
-    (*sc)->ScanString(sContent, l);
-  }
-  saveToDatabase(sContent, l, pFileId, agentId, databaseHandler);
+  state.getMultiScanner().ScanString(content.begin(), content.end(), l);
+  saveToDatabase(content, l, pFileId, agentId, resultBuffer);
 }
 
 /**
  * \brief Get the file contents, scan for statements and save findings to database
  *
- * Reads the file contents of the pFileId and send it for scanning to matchFileWithLicenses().
+ * Maps the file contents of the pFileId and send it for scanning to matchFileWithLicenses().
  *
  * If the pfile is not found for pFileId, bails with error code 8.
  *
@@ -358,8 +368,9 @@ void matchFileWithLicenses(const string& sContent, unsigned long pFileId, Copyri
  * \param agentId         Agent id
  * \param pFileId         pFile to be scanned
  * \param databaseHandler Database handler used by agent
+ * \param resultBuffer    Buffer of the findings to write to the database
  */
-void matchPFileWithLicenses(CopyrightState const& state, int agentId, unsigned long pFileId, CopyrightDatabaseHandler& databaseHandler)
+void matchPFileWithLicenses(CopyrightState const& state, int agentId, unsigned long pFileId, CopyrightDatabaseHandler& databaseHandler, CopyrightResultBuffer& resultBuffer)
 {
   char* pFile = databaseHandler.getPFileNameForFileId(pFileId);
 
@@ -369,17 +380,12 @@ void matchPFileWithLicenses(CopyrightState const& state, int agentId, unsigned l
     bail(8);
   }
 
-  char* fileName = NULL;
-  {
-#pragma omp critical (repo_mk_path)
-    fileName = fo_RepMkPath("files", pFile);
-  }
+  char* fileName = fo_RepMkPath("files", pFile);
   if (fileName)
   {
-    string s;
-    ReadFileToString(fileName, s);
+    fo::FileView content(fileName);
 
-    matchFileWithLicenses(s, pFileId, state, agentId, databaseHandler);
+    matchFileWithLicenses(content, pFileId, state, agentId, resultBuffer);
 
     free(fileName);
     free(pFile);
@@ -395,7 +401,9 @@ void matchPFileWithLicenses(CopyrightState const& state, int agentId, unsigned l
  * \brief Process a given upload id, scan from statements and add to database
  *
  * The agent runs in parallel with the help of omp.
- * A new thread is created for every pfile.
+ * The pfile ids are shared between the threads while they are returned by
+ * the database. Each thread buffers its findings
+ * in a CopyrightResultBuffer.
  * \param state           State of the agent
  * \param agentId         Agent id
  * \param uploadId        Upload id to be processed
@@ -404,59 +412,54 @@ void matchPFileWithLicenses(CopyrightState const& state, int agentId, unsigned l
  */
 bool processUploadId(const CopyrightState& state, int agentId, int uploadId, CopyrightDatabaseHandler& databaseHandler)
 {
-  vector<unsigned long> fileIds = databaseHandler.queryFileIdsForUpload(agentId, uploadId);
+  fo::StreamedQueryResult fileIds = databaseHandler.streamFileIdsForUpload(agentId, uploadId);
 
 #pragma omp parallel
   {
     CopyrightDatabaseHandler threadLocalDatabaseHandler(databaseHandler.spawn());
+    CopyrightResultBuffer resultBuffer(threadLocalDatabaseHandler);
 
-    size_t pFileCount = fileIds.size();
-#pragma omp for
-    for (size_t it = 0; it < pFileCount; ++it)
+    vector<unsigned long> batch;
+    while (fileIds.getNextUnsignedLongs(0, FILE_ID_BATCH_SIZE, batch) > 0)
     {
-      unsigned long pFileId = fileIds[it];
-
-      if (pFileId == 0)
+      for (size_t it = 0; it < batch.size(); ++it)
       {
-        continue;
-      }
+        unsigned long pFileId = batch[it];
 
-      matchPFileWithLicenses(state, agentId, pFileId, threadLocalDatabaseHandler);
+        if (pFileId == 0)
+        {
+          continue;
+        }
 
-      fo_scheduler_heart(1);
+        matchPFileWithLicenses(state, agentId, pFileId, threadLocalDatabaseHandler, resultBuffer);
+
+        fo_scheduler_heart(1);
+      }
+      batch.clear();
     }
+
+    resultBuffer.flush();
   }
 
-  return true;
+  return !fileIds.isFailed();
 }
 
 /**
  * Read a single file and run all scanners on it based of CopyrightState.
  * @param state    Copyright state
  * @param fileName Location of the file to be scanned
- * @return A pair of file scanned and list of matches found.
+ * @return A pair of file scanned and list of matches found. The content of
+ *         the file is empty if it could not be read.
  */
-pair<string, list<match>> processSingleFile(const CopyrightState& state,
+pair<fo::FileView, list<match>> processSingleFile(const CopyrightState& state,
   const string fileName)
 {
-  const list<unptr::shared_ptr<scanner>>& scanners = state.getScanners();
   list<match> matchList;
 
-  // Read file into one string
-  string s;
-  if (!ReadFileToString(fileName, s))
-  {
-    // File error
-    s = "";
-  }
-  else
-  {
-    for (auto sc = scanners.begin(); sc != scanners.end(); ++sc)
-    {
-      (*sc)->ScanString(s, matchList);
-    }
-  }
-  return make_pair(s, matchList);
+  // Map the file, an unreadable file is left empty
+  fo::FileView content(fileName);
+  state.getMultiScanner().ScanString(content.begin(), content.end(), matchList);
+  return make_pair(std::move(content), std::move(matchList));
 }
 
 /**
@@ -467,7 +470,7 @@ pair<string, list<match>> processSingleFile(const CopyrightState& state,
  *                   data is printed
  */
 void appendToJson(const std::string fileName,
-    const std::pair<string, list<match>> resultPair, bool &printComma)
+    const std::pair<fo::FileView, list<match>>& resultPair, bool &printComma)
 {
   Json::Value result;
 #if JSONCPP_VERSION_HEXA < ((1 << 24) | (4 << 16))
@@ -488,15 +491,17 @@ void appendToJson(const std::string fileName,
   }
   else
   {
-    list<match> resultList = resultPair.second;
+    const list<match>& resultList = resultPair.second;
     Json::Value results;
-    for (auto m : resultList)
+    string content;
+    for (const auto& m : resultList)
     {
       Json::Value j;
       j["start"] = m.start;
       j["end"] = m.end;
       j["type"] = m.type;
-      j["content"] = cleanMatch(resultPair.first, m);
+      cleanMatch(resultPair.first.data(), m, content);
+      j["content"] = content;
       results.append(j);
     }
     result["file"] = fileName;
@@ -533,7 +538,7 @@ void appendToJson(const std::string fileName,
  * @param resultPair Result pair from scanSingleFile()
  */
 void printResultToStdout(const std::string fileName,
-    const std::pair<string, list<match>> resultPair)
+    const std::pair<fo::FileView, list<match>>& resultPair)
 {
   if (resultPair.first.empty())
   {
@@ -543,11 +548,13 @@ void printResultToStdout(const std::string fileName,
   stringstream ss;
   ss << fileName << " ::" << endl;
   // Output matches
-  list<match> resultList = resultPair.second;
+  const list<match>& resultList = resultPair.second;
+  string content;
   for (auto m = resultList.begin();  m != resultList.end(); ++m)
   {
+    cleanMatch(resultPair.first.data(), *m, content);
     ss << "\t[" << m->start << ':' << m->end << ':' << m->type << "] '"
-       << cleanMatch(resultPair.first, *m)
+       << content
        << "'" << endl;
   }
   // Thread-Safety: output all matches (collected in ss) at once to cout
@@ -24,6 +24,11 @@
 #define AGENT_NAME IDENTITY ///< the name of the agent, used to get agent key
 #define AGENT_DESC IDENTITY " agent" ///< what program this is
 #define AGENT_ARS  IDENTITY "_ars"
+/**
+ * The results of the agent versions with the same fingerprint are reused,
+ * change it when the findings of the same regexes change
+ */
+#define AGENT_FINGERPRINT_REVISION 1
 
 #include <string>
 #include <vector>
@@ -53,6 +58,8 @@ bool parseCliOptions(int argc, char** argv, CliOptions& dest,
 
 CopyrightState getState(CliOptions&& cliOptions);
 
+std::string getFingerprint(const CopyrightState& state);
+
 scanner* makeRegexScanner(const std::string& regexDesc, const std::string& defaultType);
 /*
 std::vector<CopyrightMatch> matchStringToRegexes(const std::string& content, std::vector<RegexMatcher> matchers);
@@ -61,14 +68,14 @@ void normalizeContent(std::string& content);
 
 bool processUploadId(const CopyrightState& state, int agentId, int uploadId, CopyrightDatabaseHandler& handler);
 
-std::pair<std::string, std::list<match>> processSingleFile(const CopyrightState& state,
+std::pair<fo::FileView, std::list<match>> processSingleFile(const CopyrightState& state,
   const std::string fileName);
 
 void appendToJson(const std::string fileName,
-    const std::pair<string, list<match>> resultPair, bool &printComma);
+    const std::pair<fo::FileView, list<match>>& resultPair, bool &printComma);
 
 void printResultToStdout(const std::string fileName,
-    const std::pair<string, list<match>> resultPair);
+    const std::pair<fo::FileView, list<match>>& resultPair);
 
 #endif /* COPYRIGHTUTILS_HPP_ */
 
@@ -33,8 +33,10 @@ hCopyrightScanner::hCopyrightScanner()
   RegexConfProvider rcp;
   rcp.maybeLoad("copyright");
 
-  regCopyright = rx::regex(rcp.getRegexValue("copyright","REG_COPYRIGHT"),
+  const char* copyrightRegex = rcp.getRegexValue("copyright","REG_COPYRIGHT");
+  regCopyright = rx::regex(copyrightRegex,
                         rx::regex_constants::icase);
+  literals = extractRegexLiterals(copyrightRegex);
 
   regException = rx::regex(rcp.getRegexValue("copyright","REG_EXCEPTION"),
                rx::regex_constants::icase);
@@ -47,25 +49,51 @@ hCopyrightScanner::hCopyrightScanner()
 /**
  * \brief Scan a given string for copyright statements
  *
- * Given a string s, scans for copyright statements using regCopyrights.
+ * Given a text, scans for copyright statements using regCopyrights.
  * Then checks for an regException match.
- * \param[in]  s   String to work on
+ * \param[in]  begin First character of the text to work on
+ * \param[in]  end   End of the text to work on
  * \param[out] out List of matchs
  */
-void hCopyrightScanner::ScanString(const string& s, list<match>& out) const
+void hCopyrightScanner::ScanString(const char* begin, const char* end, list<match>& out) const
 {
+  matchCandidates everywhere;
+  ScanCandidates(begin, end, everywhere, out);
+}
+
+/**
+ * \brief Literals required by the copyright regex
+ * \see extractRegexLiterals()
+ */
+regexLiterals hCopyrightScanner::GetLiterals() const
+{
+  return literals;
+}
 
-  string::const_iterator begin = s.begin();
-  string::const_iterator pos = begin;
-  string::const_iterator end = s.end();
+/**
+ * \brief Scan a given string for copyright statements, only where they can be
+ * \param[in]     begin      First character of the text to work on
+ * \param[in]     end        End of the text to work on
+ * \param[in,out] candidates Where regCopyright can match
+ * \param[out]    out        List of matchs
+ * \see ScanString()
+ */
+void hCopyrightScanner::ScanCandidates(const char* begin, const char* end, matchCandidates& candidates, list<match>& out) const
+{
+  const char* pos = begin;
   while (pos != end)
   {
+    size_t start = candidates.searchStart(pos - begin);
+    if (start == string::npos)
+      break;
+
     // Find potential copyright statement
-    rx::smatch results;
-    if (!rx::regex_search(pos, end, results, regCopyright))
+    rx::cmatch results;
+    if (!rx::regex_search(begin + start, end, results, regCopyright,
+                          begin + start > pos ? rx::regex_constants::match_prev_avail : rx::regex_constants::match_default))
       // No further copyright statement found
       break;
-    string::const_iterator foundPos = results[0].first;
+    const char* foundPos = results[0].first;
 
     if (!rx::regex_match(foundPos, end, regException))
     {
@@ -79,12 +107,12 @@ void hCopyrightScanner::ScanString(const string& s, list<match>& out) const
        *   - spaces and punctuation
        *   - no word of two letters, no two consecutive digits
       */
-      string::const_iterator j = find(foundPos, end, '\n');
+      const char* j = std::find(foundPos, end, '\n');
       while (j != end)
       {
-        string::const_iterator beginOfLine = j;
+        const char* beginOfLine = j;
         ++beginOfLine;
-        string::const_iterator endOfLine = find(beginOfLine, end, '\n');
+        const char* endOfLine = std::find(beginOfLine, end, '\n');
         if (rx::regex_search(beginOfLine, endOfLine, regSimpleCopyright)
           || !rx::regex_match(beginOfLine, endOfLine, regNonBlank))
         {
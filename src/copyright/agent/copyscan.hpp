@@ -29,7 +29,10 @@
 class hCopyrightScanner : public scanner
 {
 public:
-  void ScanString(const string& s, list<match>& results) const;
+  using scanner::ScanString;
+  void ScanString(const char* begin, const char* end, list<match>& results) const;
+  regexLiterals GetLiterals() const;
+  void ScanCandidates(const char* begin, const char* end, matchCandidates& candidates, list<match>& results) const;
   hCopyrightScanner();
 private:
   /**
@@ -43,6 +46,11 @@ private:
    * Simple regex for copyright
    */
   rx::regex regCopyright, regException, regNonBlank, regSimpleCopyright;
+  /**
+   * \var regexLiterals literals
+   * Literals required by regCopyright
+   */
+  regexLiterals literals;
 } ;
 
 #endif
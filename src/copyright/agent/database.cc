@@ -22,6 +22,10 @@
 #include <iostream>
 #include <libfossUtils.hpp>
 
+extern "C" {
+#include "libfossagent.h"
+}
+
 using namespace fo;
 
 #define RETURN_IF_FALSE(query) \
@@ -31,6 +35,16 @@ using namespace fo;
     }\
   } while(0)
 
+/**
+ * \brief Check if a finding is stored in the author table
+ * \param type Type of the finding
+ * \return True for authors, emails and URLs
+ */
+static bool isAuthorType(const std::string& type)
+{
+  return "author" == type || "email" == type || "url" == type;
+}
+
 /**
  * \brief Default constructor for DatabaseEntry
  */
@@ -308,12 +322,14 @@ bool CopyrightDatabaseHandler::createTableClearing() const
 }
 
 /**
- * \brief Get the list of pfile ids on which the given agent has no findings for a given upload
+ * \brief Get the pfile ids on which the given agent has no findings for a given upload
+ *
+ * The pfile ids are returned while the query runs.
  * \param agentId  Agent id to be removed from result
  * \param uploadId Upload id to scan for files
- * \return List of pfiles on which the given agent has no findings
+ * \return Streamed pfiles on which the given agent has no findings
  */
-std::vector<unsigned long> CopyrightDatabaseHandler::queryFileIdsForUpload(int agentId, int uploadId)
+fo::StreamedQueryResult CopyrightDatabaseHandler::streamFileIdsForUpload(int agentId, int uploadId)
 {
   std::string uploadTreeTableName = queryUploadTreeTableName(uploadId);
 
@@ -337,10 +353,59 @@ std::vector<unsigned long> CopyrightDatabaseHandler::queryFileIdsForUpload(int a
           "WHERE " IDENTITY "_pk IS NULL OR agent_fk <> $2;").c_str(),
 #endif
           int, int);
-  QueryResult queryResult = dbManager.execPrepared(preparedStatement,
-      uploadId, agentId);
+  return dbManager.streamPrepared(preparedStatement, uploadId, agentId);
+}
+
+/**
+ * \brief Copy the findings of an upload from the other versions of the agent
+ * with the same fingerprint
+ *
+ * The findings of every file of the upload not yet scanned by the agent are
+ * copied, in one statement, from the last agent version with the same
+ * fingerprint which scanned the file. The empty findings are copied too, so
+ * that the copied files are not scanned.
+ * \param uploadId    Upload id
+ * \param agentId     Agent id to copy the findings to
+ * \param fingerprint Fingerprint recorded with fo_SetAgentFingerprint()
+ * \return Number of files with copied findings, -1 on failure
+ */
+long CopyrightDatabaseHandler::copyResults(int uploadId, int agentId, const std::string& fingerprint)
+{
+  std::string uploadTreeTableName = queryUploadTreeTableName(uploadId);
+
+  QueryResult queryResult = dbManager.execPrepared(
+    fo_dbManager_PrepareStamement(dbManager.getStruct_dbManager(),
+      ("copyResults:" IDENTITY "Agent" + uploadTreeTableName).c_str(),
+      ("WITH files AS ("
+        " SELECT DISTINCT pfile_fk FROM " + uploadTreeTableName +
+        " WHERE upload_fk = $1 AND (ufile_mode&x'3C000000'::int)=0"
+      "), found AS ("
+        " SELECT pfile_fk, agent_fk FROM " IDENTITY " INNER JOIN files USING (pfile_fk)"
+#ifdef IDENTITY_COPYRIGHT
+        " UNION ALL"
+        " SELECT pfile_fk, agent_fk FROM author INNER JOIN files USING (pfile_fk)"
+#endif
+      "), sources AS ("
+        " SELECT pfile_fk, max(agent_fk) AS agent_fk FROM found"
+        " WHERE agent_fk IN (" FINGERPRINT_SOURCE_AGENTS ")"
+        " AND pfile_fk NOT IN (SELECT pfile_fk FROM found WHERE agent_fk = $2)"
+        " GROUP BY pfile_fk"
+      "), copied AS ("
+        " INSERT INTO " IDENTITY "(agent_fk, pfile_fk, content, hash, type, copy_startbyte, copy_endbyte)"
+        " SELECT $2, pfile_fk, content, hash, type, copy_startbyte, copy_endbyte"
+        " FROM " IDENTITY " INNER JOIN sources USING (pfile_fk, agent_fk)"
+#ifdef IDENTITY_COPYRIGHT
+      "), copiedAuthors AS ("
+        " INSERT INTO author(agent_fk, pfile_fk, content, hash, type, copy_startbyte, copy_endbyte)"
+        " SELECT $2, pfile_fk, content, hash, type, copy_startbyte, copy_endbyte"
+        " FROM author INNER JOIN sources USING (pfile_fk, agent_fk)"
+#endif
+      ") SELECT count(*) FROM sources").c_str(),
+      int, int, char*),
+    uploadId, agentId, fingerprint.c_str());
 
-  return queryResult.getSimpleResults<unsigned long>(0, fo::stringToUnsignedLong);
+  std::vector<unsigned long> copied = queryResult.getSimpleResults(0, fo::stringToUnsignedLong);
+  return (queryResult && copied.size() == 1) ? (long) copied[0] : -1;
 }
 
 /**
@@ -374,11 +439,8 @@ bool CopyrightDatabaseHandler::insertInDatabase(DatabaseEntry& entry) const
 {
   std::string tableName = IDENTITY;
 
-  if("author" == entry.type ||
-     "email" == entry.type ||
-     "url" == entry.type){
+  if (isAuthorType(entry.type))
     tableName = "author";
-   }
 
   return dbManager.execPrepared(
     fo_dbManager_PrepareStamement(
@@ -396,6 +458,96 @@ bool CopyrightDatabaseHandler::insertInDatabase(DatabaseEntry& entry) const
   );
 }
 
+#define BATCH_TABLE IDENTITY "_batch"
+#define BATCH_COLUMNS "agent_fk, pfile_fk, content, type, copy_startbyte, copy_endbyte"
+
+/**
+ * \brief Create the temporary table receiving the rows of insertBatchInDatabase()
+ *
+ * The table belongs to the connection and is emptied at each commit.
+ * \return True on success, false otherwise
+ */
+bool CopyrightDatabaseHandler::createBatchTable() const
+{
+  dbManager.ignoreWarnings(true);
+  bool created = dbManager.queryPrintf(
+    "CREATE TEMPORARY TABLE IF NOT EXISTS " BATCH_TABLE "("
+      "batch_pk serial, agent_fk bigint, pfile_fk bigint, content text,"
+      " type text, copy_startbyte integer, copy_endbyte integer"
+    ") ON COMMIT DELETE ROWS");
+  dbManager.ignoreWarnings(false);
+  return created;
+}
+
+/**
+ * \brief Send rows to the temporary table with COPY
+ * \param rows Rows in COPY text format, with the columns of BATCH_COLUMNS
+ * \return True on success, false otherwise
+ */
+bool CopyrightDatabaseHandler::copyToBatchTable(const std::string& rows) const
+{
+  PGconn* connection = dbManager.getConnection();
+
+  PGresult* result = PQexec(connection, "COPY " BATCH_TABLE "(" BATCH_COLUMNS ") FROM STDIN");
+  bool started = PQresultStatus(result) == PGRES_COPY_IN;
+  PQclear(result);
+  if (!started)
+  {
+    std::cout << "ERROR: cannot start copy: " << PQerrorMessage(connection);
+    return false;
+  }
+
+  bool sent = PQputCopyData(connection, rows.data(), rows.size()) == 1;
+  if (PQputCopyEnd(connection, sent ? NULL : "cannot send rows") != 1)
+    sent = false;
+
+  bool copied = sent;
+  while ((result = PQgetResult(connection)) != NULL)
+  {
+    if (PQresultStatus(result) != PGRES_COMMAND_OK)
+      copied = false;
+    PQclear(result);
+  }
+  if (!copied)
+    std::cout << "ERROR: copy failed: " << PQerrorMessage(connection);
+  return copied;
+}
+
+/**
+ * \brief Insert many findings in database in one transaction
+ *
+ * The rows are copied to the temporary table of createBatchTable(), then
+ * moved to the tables of the findings, which computes their hashes.
+ * \param rows        Rows built with appendCopyValue(), with the columns of BATCH_COLUMNS
+ * \param withAuthors Whether some rows go to the author table
+ * \return True on success, false otherwise
+ */
+bool CopyrightDatabaseHandler::insertBatchInDatabase(const std::string& rows, bool withAuthors) const
+{
+  if (!begin())
+    return false;
+
+  bool inserted = copyToBatchTable(rows) &&
+    dbManager.queryPrintf(
+      "INSERT INTO " IDENTITY "(agent_fk, pfile_fk, content, hash, type, copy_startbyte, copy_endbyte)"
+      " SELECT agent_fk, pfile_fk, content, md5(content), type, copy_startbyte, copy_endbyte"
+      " FROM " BATCH_TABLE
+      " WHERE type NOT IN ('author', 'email', 'url') ORDER BY batch_pk");
+  if (inserted && withAuthors)
+    inserted = dbManager.queryPrintf(
+      "INSERT INTO author(agent_fk, pfile_fk, content, hash, type, copy_startbyte, copy_endbyte)"
+      " SELECT agent_fk, pfile_fk, content, md5(content), type, copy_startbyte, copy_endbyte"
+      " FROM " BATCH_TABLE
+      " WHERE type IN ('author', 'email', 'url') ORDER BY batch_pk");
+
+  if (!inserted)
+  {
+    rollback();
+    return false;
+  }
+  return commit();
+}
+
 /**
  * \brief Constructor to initialize database handler
  */
@@ -404,3 +556,134 @@ CopyrightDatabaseHandler::CopyrightDatabaseHandler(DbManager manager) :
 {
 
 }
+
+/**
+ * \brief Append a value to a row in COPY text format
+ *
+ * The value ends at its first null character, as when it is sent as a
+ * query parameter. A tab is added before every value but the first one.
+ * \param[in,out] row Row to complete
+ * \param value       Value to add
+ */
+void appendCopyValue(std::string& row, const std::string& value)
+{
+  if (!row.empty() && row[row.length() - 1] != '\n')
+    row.push_back('\t');
+
+  for (std::string::const_iterator it = value.begin(); it != value.end() && *it != '\0'; ++it)
+  {
+    switch (*it)
+    {
+      case '\\':
+        row.append("\\\\");
+        break;
+      case '\t':
+        row.append("\\t");
+        break;
+      case '\n':
+        row.append("\\n");
+        break;
+      case '\r':
+        row.append("\\r");
+        break;
+      default:
+        row.push_back(*it);
+    }
+  }
+}
+
+/**
+ * \brief Constructor of an empty buffer
+ *
+ * Creates the temporary table used by
+ * CopyrightDatabaseHandler::insertBatchInDatabase() for the connection.
+ * \param databaseHandler Handler of the connection to write the findings with
+ * \param maxRows         Number of rows which triggers a flush
+ * \param maxSeconds      Time after which the buffered rows are flushed
+ */
+CopyrightResultBuffer::CopyrightResultBuffer(const CopyrightDatabaseHandler& databaseHandler,
+  size_t maxRows, time_t maxSeconds) :
+  databaseHandler(databaseHandler),
+  maxRows(maxRows),
+  maxSeconds(maxSeconds),
+  rows(),
+  rowCount(0),
+  fileWithAuthors(false),
+  files(),
+  batchStart(time(NULL))
+{
+  databaseHandler.createBatchTable();
+}
+
+/**
+ * \brief Add a finding of the current pfile
+ * \param entry Finding to write
+ */
+void CopyrightResultBuffer::addEntry(const DatabaseEntry& entry)
+{
+  appendCopyValue(rows, std::to_string(entry.agent_fk));
+  appendCopyValue(rows, std::to_string(entry.pfile_fk));
+  appendCopyValue(rows, entry.content);
+  appendCopyValue(rows, entry.type);
+  appendCopyValue(rows, std::to_string(entry.copy_startbyte));
+  appendCopyValue(rows, std::to_string(entry.copy_endbyte));
+  rows.push_back('\n');
+
+  ++rowCount;
+  if (isAuthorType(entry.type))
+    fileWithAuthors = true;
+}
+
+/**
+ * \brief Mark the findings of the current pfile as complete
+ *
+ * Flushes the buffer if it is full or too old.
+ * \return False if findings could not be written, true otherwise
+ */
+bool CopyrightResultBuffer::endFile()
+{
+  BufferedFile file = { rows.length(), fileWithAuthors };
+  files.push_back(file);
+  fileWithAuthors = false;
+
+  if (rowCount >= maxRows || time(NULL) - batchStart >= maxSeconds)
+    return flush();
+  return true;
+}
+
+/**
+ * \brief Write and commit the buffered findings
+ *
+ * Must be called between two pfiles. If the batch fails, the pfiles are
+ * written one by one so that only the findings of the failing pfiles are lost.
+ * \return False if findings could not be written, true otherwise
+ */
+bool CopyrightResultBuffer::flush()
+{
+  bool success = true;
+
+  if (!rows.empty())
+  {
+    bool withAuthors = false;
+    for (auto it = files.begin(); it != files.end(); ++it)
+      withAuthors = withAuthors || it->withAuthors;
+
+    if (!databaseHandler.insertBatchInDatabase(rows, withAuthors))
+    {
+      size_t start = 0;
+      for (auto it = files.begin(); it != files.end(); ++it)
+      {
+        if (it->end > start &&
+          !databaseHandler.insertBatchInDatabase(rows.substr(start, it->end - start), it->withAuthors))
+          success = false;
+        start = it->end;
+      }
+    }
+  }
+
+  rows.clear();
+  rowCount = 0;
+  files.clear();
+  batchStart = time(NULL);
+  return success;
+}
@@ -21,12 +21,15 @@
 
 #include <string>
 #include <vector>
+#include <ctime>
 
 #include "libfossdbmanagerclass.hpp"
 #include "libfossAgentDatabaseHandler.hpp"
 #include "cleanEntries.hpp"
 
 #define MAX_TABLE_CREATION_RETRIES 5
+#define RESULT_BUFFER_ROWS 10000    ///< Findings written in one transaction
+#define RESULT_BUFFER_SECONDS 30    ///< Maximum time findings wait in a CopyrightResultBuffer
 
 /**
  * \class DatabaseEntry
@@ -71,7 +74,10 @@ public:
   bool createTables() const;
   bool insertInDatabase(DatabaseEntry& entry) const;
   bool insertNoResultInDatabase(long agentId, long pFileId) const;
-  std::vector<unsigned long> queryFileIdsForUpload(int agentId, int uploadId);
+  bool createBatchTable() const;
+  bool insertBatchInDatabase(const std::string& rows, bool withAuthors) const;
+  fo::StreamedQueryResult streamFileIdsForUpload(int agentId, int uploadId);
+  long copyResults(int uploadId, int agentId, const std::string& fingerprint);
 
 private:
   /**
@@ -93,6 +99,50 @@ private:
   bool createTableClearing() const;
   std::string getColumnListString(const ColumnDef in[], size_t size) const;
   std::string getColumnCreationString(const ColumnDef in[], size_t size) const;
+  bool copyToBatchTable(const std::string& rows) const;
 };
 
+/**
+ * \class CopyrightResultBuffer
+ * \brief Collects the findings of many pfiles and writes them in one transaction
+ *
+ * The findings are sent with COPY and committed when RESULT_BUFFER_ROWS rows
+ * are buffered or after RESULT_BUFFER_SECONDS. The findings of a pfile are
+ * always committed together: if the agent stops, the pfiles of the lost
+ * batch have no findings and are scanned again on the next run.
+ */
+class CopyrightResultBuffer
+{
+public:
+  CopyrightResultBuffer(const CopyrightDatabaseHandler& databaseHandler,
+    size_t maxRows = RESULT_BUFFER_ROWS, time_t maxSeconds = RESULT_BUFFER_SECONDS);
+  CopyrightResultBuffer(const CopyrightResultBuffer&) = delete;
+
+  void addEntry(const DatabaseEntry& entry);
+  bool endFile();
+  bool flush();
+
+private:
+  /**
+   * \struct BufferedFile
+   * \brief Rows of one pfile in the buffer
+   */
+  typedef struct
+  {
+    size_t end;                     /**< End of the rows of the pfile */
+    bool withAuthors;               /**< Whether some rows go to the author table */
+  } BufferedFile;
+
+  const CopyrightDatabaseHandler& databaseHandler;  /**< Handler writing the rows */
+  size_t maxRows;                   /**< Rows which trigger a flush */
+  time_t maxSeconds;                /**< Time after which a flush is done */
+  std::string rows;                 /**< Buffered rows in COPY text format */
+  size_t rowCount;                  /**< Number of buffered rows */
+  bool fileWithAuthors;             /**< Whether some rows of the current pfile go to the author table */
+  std::vector<BufferedFile> files;  /**< Pfiles with buffered rows */
+  time_t batchStart;                /**< Time of the last flush */
+};
+
+void appendCopyValue(std::string& row, const std::string& value);
+
 #endif // DATABASE_HPP
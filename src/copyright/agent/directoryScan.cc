@@ -19,59 +19,297 @@
 /**
  * \file
  * \brief Utilities to scan directories
+ *
+ * The files are scanned in a pipeline: a thread lists the files, worker
+ * threads scan them and the calling thread prints the results in the order
+ * the files were listed. At most SCAN_PIPELINE_SLOTS_PER_WORKER files per
+ * worker are in the pipeline at any time, so the memory used does not depend
+ * on the number of files, and the first results are printed as soon as they
+ * are found.
  */
 
 #include "directoryScan.hpp"
 
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 namespace fs = boost::filesystem;
 
-void scanDirectory(const CopyrightState& state, const bool json,
-    const string directoryPath)
+/**
+ * \class scanPipeline
+ * \brief Scans files with several threads and prints the results in order
+ *
+ * The files in the pipeline are kept in a ring of slots. The file with
+ * sequence number n uses the slot n % slots.size(), from the moment it is
+ * listed until its result is printed.
+ */
+class scanPipeline
 {
-  fs::recursive_directory_iterator dirIterator(directoryPath);
-  fs::recursive_directory_iterator end;
+public:
+  scanPipeline(const CopyrightState& state, bool json, unsigned workerCount);
 
-  vector<string> filePaths;
+  bool run(const function<bool(string&)>& nextFile);
 
-  for (fs::path const &p : boost::make_iterator_range(dirIterator, {}))
+private:
+  /**
+   * \struct slot
+   * \brief A file in the pipeline
+   */
+  struct slot
   {
-    if (fs::is_directory(p))
-    {
-      // Can not do anything with a directory
-      continue;
-    }
-    // Store the paths in a vector as of now since we can not `#pragma omp for`
-    // on recursive_directory_iterator
-    filePaths.push_back(p.string());
-  }
-  const unsigned long filePathsSize = filePaths.size();
-  bool printComma = false;
+    string fileName;                      /**< Path of the file */
+    pair<fo::FileView, list<match>> result; /**< Content and matches, once scanned */
+    bool scanned;                         /**< True when result is set */
+  };
+
+  void listFiles(const function<bool(string&)>& nextFile);
+  void scanFiles();
+  bool printResults();
+
+  const CopyrightState& state;            /**< State with the scanners */
+  const bool json;                        /**< Whether to print JSON */
+  const unsigned workerCount;             /**< Number of scanning threads */
+  vector<slot> slots;                     /**< Ring of the files in the pipeline */
+
+  mutex lock;                             /**< Protects all the members below */
+  condition_variable slotFreed;           /**< Signaled when a result is printed */
+  condition_variable fileListed;          /**< Signaled when a file is listed */
+  condition_variable fileScanned;         /**< Signaled when a file is scanned */
+  size_t listed;                          /**< Number of files listed */
+  size_t taken;                           /**< Number of files taken by workers */
+  size_t printed;                         /**< Number of results printed */
+  bool listingDone;                       /**< True when all the files are listed */
+  exception_ptr listingError;             /**< Exception thrown while listing files */
+};
+
+/**
+ * \brief Number of slots of the pipeline for each scanning thread
+ */
+#define SCAN_PIPELINE_SLOTS_PER_WORKER 4
+
+/**
+ * \brief Create a pipeline
+ * \param state       State with the scanners to run
+ * \param json        Whether to print JSON
+ * \param workerCount Number of threads scanning files
+ */
+scanPipeline::scanPipeline(const CopyrightState& state, bool json, unsigned workerCount) :
+  state(state), json(json), workerCount(workerCount),
+  slots(workerCount * SCAN_PIPELINE_SLOTS_PER_WORKER),
+  listed(0), taken(0), printed(0), listingDone(false)
+{
+}
+
+/**
+ * \brief Scan all the files and print their results
+ * \param nextFile Sets its argument to the next file to scan, returns false
+ *                 when there are no more files
+ * \return False if a file could not be read, true otherwise
+ */
+bool scanPipeline::run(const function<bool(string&)>& nextFile)
+{
+  thread lister(&scanPipeline::listFiles, this, cref(nextFile));
+  vector<thread> workers;
+  for (unsigned i = 0; i < workerCount; i++)
+    workers.push_back(thread(&scanPipeline::scanFiles, this));
 
   if (json)
   {
     cout << "[" << endl;
   }
+  bool success = printResults();
+  if (json)
+  {
+    cout << endl << "]" << endl;
+  }
+
+  lister.join();
+  for (auto it = workers.begin(); it != workers.end(); ++it)
+    it->join();
 
-#pragma omp parallel
+  if (listingError)
+    rethrow_exception(listingError);
+  return success;
+}
+
+/**
+ * \brief Put the files in the pipeline, waiting for free slots
+ */
+void scanPipeline::listFiles(const function<bool(string&)>& nextFile)
+{
+  string fileName;
+  try
   {
-#pragma omp for
-    for (unsigned int i = 0; i < filePathsSize; i++)
+    while (nextFile(fileName))
     {
-      string fileName = filePaths[i];
-      pair<string, list<match>> scanResult = processSingleFile(state, fileName);
-      if (json)
-      {
-        appendToJson(fileName, scanResult, printComma);
-      }
-      else
-      {
-        printResultToStdout(fileName, scanResult);
-      }
+      unique_lock<mutex> guard(lock);
+      slotFreed.wait(guard, [this] { return listed - printed < slots.size(); });
+
+      slot& s = slots[listed % slots.size()];
+      s.fileName.swap(fileName);
+      s.scanned = false;
+      ++listed;
+      fileListed.notify_one();
     }
   }
-  if (json)
+  catch (...)
   {
-    cout << endl << "]" << endl;
+    lock_guard<mutex> guard(lock);
+    listingError = current_exception();
   }
+
+  lock_guard<mutex> guard(lock);
+  listingDone = true;
+  fileListed.notify_all();
+  fileScanned.notify_all();
+}
+
+/**
+ * \brief Scan the listed files until all of them are taken
+ */
+void scanPipeline::scanFiles()
+{
+  unique_lock<mutex> guard(lock);
+  while (true)
+  {
+    fileListed.wait(guard, [this] { return taken < listed || listingDone; });
+    if (taken == listed)
+      return;
+
+    size_t index = taken++;
+    slot& s = slots[index % slots.size()];
+    guard.unlock();
+
+    /* the slot is not reused before its result is printed */
+    pair<fo::FileView, list<match>> result = processSingleFile(state, s.fileName);
+
+    guard.lock();
+    s.result.swap(result);
+    s.scanned = true;
+    if (index == printed)
+      fileScanned.notify_one();
+  }
+}
+
+/**
+ * \brief Print the results in the order of the files
+ * \return False if a file could not be read, true otherwise
+ */
+bool scanPipeline::printResults()
+{
+  bool success = true;
+  bool printComma = false;
+
+  unique_lock<mutex> guard(lock);
+  while (true)
+  {
+    if (!(printed < listed && slots[printed % slots.size()].scanned))
+    {
+      /* show what is already printed while waiting for the next result */
+      guard.unlock();
+      cout << flush;
+      guard.lock();
+    }
+    fileScanned.wait(guard, [this] {
+      return (printed < listed && slots[printed % slots.size()].scanned) ||
+        (printed == listed && listingDone);
+    });
+    if (printed == listed)
+      return success;
+
+    slot& s = slots[printed % slots.size()];
+    guard.unlock();
+
+    if (json)
+    {
+      appendToJson(s.fileName, s.result, printComma);
+    }
+    else
+    {
+      printResultToStdout(s.fileName, s.result);
+    }
+    if (s.result.first.empty())
+    {
+      success = false;
+    }
+    /* free the content of the file now rather than when the slot is reused */
+    s.result = pair<fo::FileView, list<match>>();
+
+    guard.lock();
+    ++printed;
+    slotFreed.notify_one();
+  }
+}
+
+/**
+ * \brief Number of threads to scan files with, as for OpenMP loops
+ */
+static unsigned scanThreadCount()
+{
+#ifdef _OPENMP
+  int threads = omp_get_max_threads();
+#else
+  int threads = thread::hardware_concurrency();
+#endif
+  return threads > 0 ? threads : 1;
+}
+
+/**
+ * \brief Scan all the files of a directory and its subdirectories
+ *
+ * The results are printed in the order of the directory listing.
+ * \param state         State with the scanners to run
+ * \param json          Whether to print JSON
+ * \param directoryPath Directory to scan
+ */
+void scanDirectory(const CopyrightState& state, const bool json,
+    const string directoryPath)
+{
+  fs::recursive_directory_iterator dirIterator(directoryPath);
+  fs::recursive_directory_iterator end;
+
+  scanPipeline pipeline(state, json, scanThreadCount());
+  pipeline.run([&dirIterator, &end](string& fileName) {
+    for (; dirIterator != end; ++dirIterator)
+    {
+      if (fs::is_directory(dirIterator->path()))
+      {
+        // Can not do anything with a directory
+        continue;
+      }
+      fileName = dirIterator->path().string();
+      ++dirIterator;
+      return true;
+    }
+    return false;
+  });
+}
+
+/**
+ * \brief Scan a list of files
+ *
+ * The results are printed in the order of the list.
+ * \param state     State with the scanners to run
+ * \param json      Whether to print JSON
+ * \param fileNames Files to scan
+ * \return False if a file could not be read, true otherwise
+ */
+bool scanFiles(const CopyrightState& state, const bool json,
+    const vector<string>& fileNames)
+{
+  vector<string>::const_iterator it = fileNames.begin();
+
+  scanPipeline pipeline(state, json, scanThreadCount());
+  return pipeline.run([&it, &fileNames](string& fileName) {
+    if (it == fileNames.end())
+      return false;
+    fileName = *it++;
+    return true;
+  });
 }
@@ -28,4 +28,7 @@
 void scanDirectory(const CopyrightState& state, const bool json,
     const std::string directoryPath);
 
+bool scanFiles(const CopyrightState& state, const bool json,
+    const std::vector<std::string>& fileNames);
+
 #endif /* DIRECTORYSCAN_HPP_ */
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "multiscan.hpp"
+
+#include <algorithm>
+#include <deque>
+
+/** Transition which is not yet known while building the automaton */
+static const unsigned NO_STATE = ~0u;
+
+/** ASCII letters are compared ignoring their case */
+static inline unsigned char foldByte(unsigned char c)
+{
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+/**
+ * \brief Build the automaton from the literals of the scanners
+ * \param scanners Scanners to run, in order
+ */
+multiScanner::multiScanner(const list<unptr::shared_ptr<scanner>>& scanners) :
+  _scanners(scanners.begin(), scanners.end())
+{
+  newState();
+  for (unsigned i = 0; i < _scanners.size(); i++)
+  {
+    _literals.push_back(_scanners[i]->GetLiterals());
+    const regexLiterals& literals = _literals.back();
+    if (literals.valid)
+    {
+      for (auto it = literals.literals.begin(); it != literals.literals.end(); ++it)
+        addLiteral(*it, i);
+    }
+  }
+  buildTransitions();
+}
+
+unsigned multiScanner::newState()
+{
+  _transitions.resize(_transitions.size() + 256, NO_STATE);
+  _outputs.push_back(std::vector<literalOutput>());
+  return _outputs.size() - 1;
+}
+
+/**
+ * \brief Add a literal to the trie of the automaton
+ */
+void multiScanner::addLiteral(const string& literal, unsigned scannerIndex)
+{
+  unsigned state = 0;
+  for (auto it = literal.begin(); it != literal.end(); ++it)
+  {
+    unsigned char c = foldByte((unsigned char) *it);
+    if (_transitions[state * 256 + c] == NO_STATE)
+    {
+      unsigned next = newState();
+      _transitions[state * 256 + c] = next;
+    }
+    state = _transitions[state * 256 + c];
+  }
+
+  literalOutput output = { scannerIndex, (unsigned) literal.length() };
+  _outputs[state].push_back(output);
+}
+
+/**
+ * \brief Complete the trie with the failure transitions, in breadth first order
+ */
+void multiScanner::buildTransitions()
+{
+  std::vector<unsigned> failure(_outputs.size(), 0);
+  std::deque<unsigned> queue;
+
+  for (unsigned c = 0; c < 256; c++)
+  {
+    unsigned& next = _transitions[c];
+    if (next == NO_STATE)
+      next = 0;
+    else
+      queue.push_back(next);
+  }
+
+  while (!queue.empty())
+  {
+    unsigned state = queue.front();
+    queue.pop_front();
+
+    /* the literals of the longest proper suffix also end here */
+    const std::vector<literalOutput>& inherited = _outputs[failure[state]];
+    _outputs[state].insert(_outputs[state].end(), inherited.begin(), inherited.end());
+
+    for (unsigned c = 0; c < 256; c++)
+    {
+      unsigned& next = _transitions[state * 256 + c];
+      unsigned fallback = _transitions[failure[state] * 256 + c];
+      if (next == NO_STATE)
+        next = fallback;
+      else
+      {
+        failure[next] = fallback;
+        queue.push_back(next);
+      }
+    }
+  }
+}
+
+/**
+ * \brief Scan a text with all the scanners
+ * \param[in]  begin   First character of the text
+ * \param[in]  end     End of the text
+ * \param[out] results Matches of all the scanners are appended to this list
+ */
+void multiScanner::ScanString(const char* begin, const char* end, list<match>& results) const
+{
+  std::vector<std::vector<size_t>> positions(_scanners.size());
+
+  unsigned state = 0;
+  const size_t length = end - begin;
+  for (size_t i = 0; i < length; i++)
+  {
+    state = _transitions[state * 256 + foldByte((unsigned char) begin[i])];
+    const std::vector<literalOutput>& outputs = _outputs[state];
+    for (auto it = outputs.begin(); it != outputs.end(); ++it)
+      positions[it->scanner].push_back(i + 1 - it->length);
+  }
+
+  for (unsigned i = 0; i < _scanners.size(); i++)
+  {
+    if (!_literals[i].valid)
+    {
+      _scanners[i]->ScanString(begin, end, results);
+      continue;
+    }
+
+    std::vector<size_t>& found = positions[i];
+    if (found.empty())
+      continue;
+
+    /* literals of different lengths are not found in the order of their start */
+    std::sort(found.begin(), found.end());
+    matchCandidates candidates(found, _literals[i].maxLeading);
+    _scanners[i]->ScanCandidates(begin, end, candidates, results);
+  }
+}
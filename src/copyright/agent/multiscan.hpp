@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MULTISCAN_HPP_
+#define MULTISCAN_HPP_
+
+#include "scanners.hpp"
+#include "uniquePtr.hpp"
+#include <vector>
+
+/**
+ * \class multiScanner
+ * \brief Runs several scanners, finding where they can match in a single pass
+ *
+ * The literals of all the scanners are compiled into one Aho-Corasick
+ * automaton. Each string is read once to find them, then every scanner only
+ * searches its regex where one of its literals was found. Scanners without
+ * literals scan the whole string.
+ *
+ * The matches are the same, and in the same order, as the ones of calling
+ * ScanString() of each scanner in turn.
+ */
+class multiScanner : public scanner
+{
+public:
+  explicit multiScanner(const list<unptr::shared_ptr<scanner>>& scanners);
+
+  using scanner::ScanString;
+  void ScanString(const char* begin, const char* end, list<match>& results) const;
+
+private:
+  /**
+   * \struct literalOutput
+   * \brief A literal found when reaching a state of the automaton
+   */
+  struct literalOutput {
+    /** Position of the scanner in _scanners */
+    unsigned scanner;
+    /** Length of the literal */
+    unsigned length;
+  } ;
+
+  void addLiteral(const string& literal, unsigned scannerIndex);
+  void buildTransitions();
+  unsigned newState();
+
+  /**
+   * \var std::vector<unptr::shared_ptr<scanner>> _scanners
+   * Scanners in the order of their matches
+   * \var std::vector<regexLiterals> _literals
+   * Literals of each scanner
+   */
+  std::vector<unptr::shared_ptr<scanner>> _scanners;
+  std::vector<regexLiterals> _literals;
+  /**
+   * \var std::vector<unsigned> _transitions
+   * Next state for each state and byte: _transitions[state * 256 + byte]
+   * \var std::vector<std::vector<literalOutput>> _outputs
+   * Literals ending in each state
+   */
+  std::vector<unsigned> _transitions;
+  std::vector<std::vector<literalOutput>> _outputs;
+} ;
+
+#endif
@@ -175,3 +175,26 @@ const char* RegexConfProvider::getRegexValue(const string& identity,
   }
   return (*rv).c_str();
 }
+
+/**
+ * \brief Get all the regexes loaded so far
+ *
+ * Each regex is on its own line, as `identity.key=value`. The identities and
+ * keys are sorted, so that the same regexes always give the same string.
+ * \return Loaded regexes
+ */
+string RegexConfProvider::getLoadedRegexes()
+{
+  ostringstream result;
+#pragma omp critical(rmm)
+  {
+    for (auto& identity : RegexConfProvider::_regexMapMap)
+    {
+      for (auto& regex : identity.second)
+      {
+        result << identity.first << "." << regex.first << "=" << regex.second << "\n";
+      }
+    }
+  }
+  return result.str();
+}
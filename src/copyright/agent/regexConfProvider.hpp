@@ -46,6 +46,8 @@ public:
   const char* getRegexValue(const std::string& name,
                             const std::string& key);
 
+  static std::string getLoadedRegexes();
+
 private:
   static std::map<std::string,RegexMap> _regexMapMap;
 
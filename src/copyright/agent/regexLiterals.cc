@@ -0,0 +1,681 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/**
+ * \file regexLiterals.cc
+ * \brief Find the literals required by a regex
+ *
+ * The regex is parsed with the perl syntax of boost::regex. Every construct
+ * which is not understood makes the result invalid, which is always safe:
+ * the regex is then searched everywhere.
+ */
+#include "regexLiterals.hpp"
+
+#include <set>
+#include <cctype>
+#include <cstdlib>
+
+using std::string;
+using std::vector;
+using std::set;
+
+namespace {
+
+const size_t UNBOUNDED = string::npos;
+/** Number of strings kept when enumerating what a fragment can match */
+const size_t MAX_EXACT_STRINGS = 64;
+/** Number of bytes of a bracket expression for which its single bytes are enumerated */
+const size_t MAX_CLASS_BYTES = 8;
+
+/**
+ * \struct fragment
+ * \brief What is known about the matches of a part of the regex
+ */
+struct fragment {
+  /** strings holds all what the fragment can match */
+  bool exact;
+  set<string> strings;
+  /** every match contains one of factors, starting at most leading bytes after the match */
+  bool hasFactors;
+  vector<string> factors;
+  size_t leading;
+  size_t minLength, maxLength;
+
+  fragment() : exact(false), strings(), hasFactors(false), factors(), leading(UNBOUNDED),
+               minLength(0), maxLength(UNBOUNDED) { }
+} ;
+
+struct parseError { };
+
+size_t addLengths(size_t a, size_t b)
+{
+  return (a == UNBOUNDED || b == UNBOUNDED) ? UNBOUNDED : a + b;
+}
+
+size_t multiplyLength(size_t a, size_t n)
+{
+  if (a == 0 || n == 0)
+    return 0;
+  return (a == UNBOUNDED || n == UNBOUNDED) ? UNBOUNDED : a * n;
+}
+
+string foldCase(const string& s)
+{
+  string result(s);
+  for (string::iterator it = result.begin(); it != result.end(); ++it)
+    if (*it >= 'A' && *it <= 'Z')
+      *it = *it - 'A' + 'a';
+  return result;
+}
+
+/**
+ * Keep only the strings not containing another one: finding the shorter one is enough
+ * \param[out] shift Maximum position of the first kept string in a dropped one
+ */
+vector<string> minimize(const set<string>& strings, size_t& shift)
+{
+  set<string> folded;
+  for (set<string>::const_iterator it = strings.begin(); it != strings.end(); ++it)
+    folded.insert(foldCase(*it));
+
+  vector<string> result;
+  vector<string> dropped;
+  for (set<string>::const_iterator it = folded.begin(); it != folded.end(); ++it)
+  {
+    bool contained = false;
+    for (set<string>::const_iterator other = folded.begin(); other != folded.end() && !contained; ++other)
+      contained = other->length() < it->length() && it->find(*other) != string::npos;
+    if (contained)
+      dropped.push_back(*it);
+    else
+      result.push_back(*it);
+  }
+
+  /* a dropped string is found through the first kept string it contains */
+  shift = 0;
+  for (vector<string>::const_iterator it = dropped.begin(); it != dropped.end(); ++it)
+  {
+    size_t first = string::npos;
+    for (vector<string>::const_iterator kept = result.begin(); kept != result.end(); ++kept)
+    {
+      size_t found = it->find(*kept);
+      if (found < first)
+        first = found;
+    }
+    if (first > shift)
+      shift = first;
+  }
+  return result;
+}
+
+/**
+ * How rare a literal is expected to be in a text: spaces are everywhere,
+ * letters and digits are common, punctuation and non ASCII bytes less so
+ */
+size_t weight(const string& literal)
+{
+  size_t result = 0;
+  for (string::const_iterator it = literal.begin(); it != literal.end(); ++it)
+  {
+    unsigned char c = (unsigned char) *it;
+    if (c >= 0x80)
+      result += 3;
+    else if (isalnum(c))
+      result += 1;
+    else if (!isspace(c))
+      result += 2;
+  }
+  return result;
+}
+
+size_t lightest(const vector<string>& strings)
+{
+  size_t result = UNBOUNDED;
+  for (vector<string>::const_iterator it = strings.begin(); it != strings.end(); ++it)
+    if (weight(*it) < result)
+      result = weight(*it);
+  return result;
+}
+
+/**
+ * Prefer a bounded leading, then rarer literals, then less of them, then a smaller leading
+ */
+bool betterFactors(const vector<string>& a, size_t aLeading, const vector<string>& b, size_t bLeading)
+{
+  if ((aLeading == UNBOUNDED) != (bLeading == UNBOUNDED))
+    return bLeading == UNBOUNDED;
+  if (lightest(a) != lightest(b))
+    return lightest(a) > lightest(b);
+  if (a.size() != b.size())
+    return a.size() < b.size();
+  return aLeading < bLeading;
+}
+
+void offerFactors(fragment& f, const vector<string>& factors, size_t leading)
+{
+  if (factors.empty() || lightest(factors) == 0)
+    return;
+  if (!f.hasFactors || betterFactors(factors, leading, f.factors, f.leading))
+  {
+    f.hasFactors = true;
+    f.factors = factors;
+    f.leading = leading;
+  }
+}
+
+/** An exact fragment is its own factor */
+void finish(fragment& f)
+{
+  if (f.exact)
+  {
+    size_t shift;
+    vector<string> factors = minimize(f.strings, shift);
+    offerFactors(f, factors, shift);
+  }
+}
+
+fragment emptyFragment()
+{
+  fragment f;
+  f.exact = true;
+  f.strings.insert("");
+  f.minLength = f.maxLength = 0;
+  return f;
+}
+
+fragment byteFragment(const set<unsigned char>& bytes, bool enumerable)
+{
+  fragment f;
+  f.minLength = f.maxLength = 1;
+  if (enumerable && !bytes.empty() && bytes.size() <= MAX_CLASS_BYTES)
+  {
+    f.exact = true;
+    for (set<unsigned char>::const_iterator it = bytes.begin(); it != bytes.end(); ++it)
+      f.strings.insert(string(1, (char) *it));
+    finish(f);
+  }
+  return f;
+}
+
+fragment anyByteFragment()
+{
+  return byteFragment(set<unsigned char>(), false);
+}
+
+fragment concatenate(const fragment& a, const fragment& b)
+{
+  fragment f;
+  f.minLength = addLengths(a.minLength, b.minLength);
+  f.maxLength = addLengths(a.maxLength, b.maxLength);
+
+  if (a.exact && b.exact && a.strings.size() * b.strings.size() <= MAX_EXACT_STRINGS)
+  {
+    f.exact = true;
+    for (set<string>::const_iterator x = a.strings.begin(); x != a.strings.end(); ++x)
+      for (set<string>::const_iterator y = b.strings.begin(); y != b.strings.end(); ++y)
+        f.strings.insert(*x + *y);
+  }
+
+  if (a.hasFactors)
+    offerFactors(f, a.factors, a.leading);
+  if (b.hasFactors)
+    offerFactors(f, b.factors, addLengths(a.maxLength, b.leading));
+  finish(f);
+  return f;
+}
+
+fragment alternate(const vector<fragment>& branches)
+{
+  fragment f;
+  f.exact = true;
+  f.hasFactors = true;
+  f.leading = 0;
+  f.minLength = UNBOUNDED;
+  f.maxLength = 0;
+
+  set<string> factors;
+  for (vector<fragment>::const_iterator it = branches.begin(); it != branches.end(); ++it)
+  {
+    if (it->minLength < f.minLength)
+      f.minLength = it->minLength;
+    if (it->maxLength == UNBOUNDED || it->maxLength > f.maxLength)
+      f.maxLength = it->maxLength;
+
+    if (f.exact && it->exact && f.strings.size() + it->strings.size() <= MAX_EXACT_STRINGS)
+      f.strings.insert(it->strings.begin(), it->strings.end());
+    else
+    {
+      f.exact = false;
+      f.strings.clear();
+    }
+
+    if (f.hasFactors && it->hasFactors)
+    {
+      factors.insert(it->factors.begin(), it->factors.end());
+      if (it->leading == UNBOUNDED || it->leading > f.leading)
+        f.leading = it->leading;
+    }
+    else
+      f.hasFactors = false;
+  }
+
+  if (f.hasFactors)
+  {
+    size_t shift;
+    f.factors = minimize(factors, shift);
+    f.leading = addLengths(f.leading, shift);
+  }
+  else
+  {
+    f.factors.clear();
+    f.leading = UNBOUNDED;
+  }
+  finish(f);
+  return f;
+}
+
+fragment repeat(const fragment& child, size_t min, size_t max)
+{
+  fragment f;
+  f.minLength = multiplyLength(child.minLength, min);
+  f.maxLength = multiplyLength(child.maxLength, max);
+
+  if (child.exact && max != UNBOUNDED)
+  {
+    set<string> current;
+    current.insert("");
+    f.exact = true;
+    for (size_t n = 0; n <= max && f.exact; n++)
+    {
+      if (n >= min)
+        f.strings.insert(current.begin(), current.end());
+      if (n == max)
+        break;
+
+      set<string> next;
+      for (set<string>::const_iterator x = current.begin(); x != current.end(); ++x)
+        for (set<string>::const_iterator y = child.strings.begin(); y != child.strings.end(); ++y)
+          next.insert(*x + *y);
+      current.swap(next);
+      f.exact = (current.size() <= MAX_EXACT_STRINGS) && (f.strings.size() <= MAX_EXACT_STRINGS);
+    }
+    if (!f.exact)
+      f.strings.clear();
+  }
+
+  /* the first repetition contains a factor */
+  if (min > 0 && child.hasFactors)
+    offerFactors(f, child.factors, child.leading);
+  finish(f);
+  return f;
+}
+
+/**
+ * \class regexParser
+ * \brief Recursive descent parser of the perl syntax of boost::regex
+ */
+class regexParser
+{
+public:
+  explicit regexParser(const string& regex) : _regex(regex), _pos(0) { }
+
+  fragment parse()
+  {
+    fragment f = parseAlternation();
+    if (_pos != _regex.length())
+      throw parseError();
+    return f;
+  }
+
+private:
+  const string& _regex;
+  size_t _pos;
+
+  bool atEnd() const
+  {
+    return _pos >= _regex.length();
+  }
+
+  char peek() const
+  {
+    if (atEnd())
+      throw parseError();
+    return _regex[_pos];
+  }
+
+  char next()
+  {
+    char c = peek();
+    _pos++;
+    return c;
+  }
+
+  fragment parseAlternation()
+  {
+    vector<fragment> branches;
+    branches.push_back(parseSequence());
+    while (!atEnd() && peek() == '|')
+    {
+      _pos++;
+      branches.push_back(parseSequence());
+    }
+    return branches.size() == 1 ? branches[0] : alternate(branches);
+  }
+
+  fragment parseSequence()
+  {
+    fragment f = emptyFragment();
+    /* exact atoms since the last inexact one, kept apart to get the longest literals */
+    fragment run = emptyFragment();
+    while (!atEnd() && peek() != '|' && peek() != ')')
+    {
+      fragment atom = parseQuantifiers(parseAtom());
+      if (atom.exact)
+      {
+        fragment joined = concatenate(run, atom);
+        if (joined.exact)
+        {
+          run = joined;
+          continue;
+        }
+      }
+
+      f = concatenate(f, run);
+      run = emptyFragment();
+      if (atom.exact)
+        run = atom;
+      else
+        f = concatenate(f, atom);
+    }
+    return concatenate(f, run);
+  }
+
+  size_t parseNumber()
+  {
+    size_t start = _pos;
+    while (!atEnd() && isdigit((unsigned char) peek()))
+      _pos++;
+    if (_pos == start || _pos - start > 6)
+      throw parseError();
+    return strtoul(_regex.substr(start, _pos - start).c_str(), NULL, 10);
+  }
+
+  fragment parseQuantifiers(fragment f)
+  {
+    while (!atEnd())
+    {
+      size_t min, max;
+      char c = peek();
+      if (c == '*')
+      {
+        min = 0; max = UNBOUNDED;
+      }
+      else if (c == '+')
+      {
+        min = 1; max = UNBOUNDED;
+      }
+      else if (c == '?')
+      {
+        min = 0; max = 1;
+      }
+      else if (c == '{')
+      {
+        _pos++;
+        min = parseNumber();
+        max = min;
+        if (peek() == ',')
+        {
+          _pos++;
+          max = (peek() == '}') ? UNBOUNDED : parseNumber();
+        }
+        if (peek() != '}' || max < min)
+          throw parseError();
+      }
+      else
+        break;
+      _pos++;
+
+      /* lazy or possessive */
+      if (!atEnd() && (peek() == '?' || peek() == '+'))
+        _pos++;
+
+      f = repeat(f, min, max);
+    }
+    return f;
+  }
+
+  fragment parseAtom()
+  {
+    char c = next();
+    switch (c)
+    {
+      case '(':
+        return parseGroup();
+      case '[':
+        return parseBracket();
+      case '.':
+        return anyByteFragment();
+      case '\\':
+        return parseEscape();
+      case '^': case '$': case ')': case '|': case '*': case '+': case '?': case '{':
+        throw parseError();
+      default:
+        {
+          set<unsigned char> byte;
+          byte.insert((unsigned char) c);
+          return byteFragment(byte, true);
+        }
+    }
+  }
+
+  fragment parseGroup()
+  {
+    bool zeroWidth = false;
+    if (peek() == '?')
+    {
+      _pos++;
+      char kind = next();
+      if (kind == '<')
+        kind = next();
+      if (kind == '=' || kind == '!')
+        zeroWidth = true;
+      else if (kind != ':')
+        throw parseError();
+    }
+
+    fragment f = parseAlternation();
+    if (next() != ')')
+      throw parseError();
+    return zeroWidth ? emptyFragment() : f;
+  }
+
+  int hexValue(char c)
+  {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    c = tolower((unsigned char) c);
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    throw parseError();
+  }
+
+  unsigned char parseHexByte()
+  {
+    int value;
+    if (peek() == '{')
+    {
+      _pos++;
+      value = 0;
+      while (peek() != '}')
+      {
+        value = value * 16 + hexValue(next());
+        if (value > 0xFF)
+          throw parseError();
+      }
+      _pos++;
+    }
+    else
+    {
+      value = hexValue(next());
+      value = value * 16 + hexValue(next());
+    }
+    return (unsigned char) value;
+  }
+
+  /**
+   * \return true if the escape is a single byte, stored in byte
+   */
+  bool parseByteEscape(char c, unsigned char& byte)
+  {
+    switch (c)
+    {
+      case 'x': byte = parseHexByte(); return true;
+      case 'n': byte = '\n'; return true;
+      case 't': byte = '\t'; return true;
+      case 'r': byte = '\r'; return true;
+      case 'f': byte = '\f'; return true;
+      case 'a': byte = '\a'; return true;
+      case 'e': byte = 0x1B; return true;
+      default:
+        if (isalnum((unsigned char) c))
+          return false;
+        byte = (unsigned char) c;
+        return true;
+    }
+  }
+
+  fragment parseEscape()
+  {
+    char c = next();
+    switch (c)
+    {
+      case 'b': case 'B': case '<': case '>':
+        return emptyFragment();
+      case 'w': case 'W': case 's': case 'S': case 'd': case 'D':
+        return anyByteFragment();
+      default:
+        {
+          unsigned char byte;
+          if (!parseByteEscape(c, byte))
+            throw parseError();
+          set<unsigned char> bytes;
+          bytes.insert(byte);
+          return byteFragment(bytes, true);
+        }
+    }
+  }
+
+  /**
+   * Parse a bracket expression, its bytes are only enumerated if they are given one by one or as ranges
+   */
+  fragment parseBracket()
+  {
+    bool enumerable = true;
+    if (peek() == '^')
+    {
+      _pos++;
+      enumerable = false;
+    }
+
+    set<unsigned char> bytes;
+    bool first = true;
+    while (first || peek() != ']')
+    {
+      first = false;
+      unsigned char low;
+      char c = next();
+      if (c == '[' && (peek() == ':' || peek() == '=' || peek() == '.'))
+      {
+        char kind = next();
+        size_t close = _regex.find(string(1, kind) + "]", _pos);
+        if (close == string::npos)
+          throw parseError();
+        _pos = close + 2;
+        enumerable = false;
+        continue;
+      }
+      else if (c == '\\')
+      {
+        char e = next();
+        if (!parseByteEscape(e, low))
+        {
+          enumerable = false;
+          continue;
+        }
+      }
+      else
+        low = (unsigned char) c;
+
+      if (peek() == '-' && _pos + 1 < _regex.length() && _regex[_pos + 1] != ']')
+      {
+        _pos++;
+        unsigned char high;
+        char h = next();
+        if (h == '\\')
+        {
+          if (!parseByteEscape(next(), high))
+            throw parseError();
+        }
+        else if (h == '[')
+          throw parseError();
+        else
+          high = (unsigned char) h;
+
+        if (high < low)
+          throw parseError();
+        if ((size_t) (high - low) >= MAX_CLASS_BYTES)
+          enumerable = false;
+        else
+          for (unsigned b = low; b <= high; b++)
+            bytes.insert((unsigned char) b);
+      }
+      else
+        bytes.insert(low);
+    }
+    _pos++;
+
+    return byteFragment(bytes, enumerable);
+  }
+} ;
+
+} // namespace
+
+/**
+ * \brief Find strings one of which is in every match of a regex
+ *
+ * The result is not valid if the regex can match an empty string or uses
+ * syntax which is not understood.
+ * \param regex Regex in the perl syntax of boost::regex
+ * \return Literals of the regex
+ */
+regexLiterals extractRegexLiterals(const string& regex)
+{
+  regexLiterals result;
+  try
+  {
+    fragment f = regexParser(regex).parse();
+    if (f.hasFactors && f.minLength > 0)
+    {
+      result.valid = true;
+      result.literals = f.factors;
+      result.maxLeading = f.leading;
+    }
+  }
+  catch (parseError&)
+  {
+  }
+  return result;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/**
+ * \file regexLiterals.hpp
+ * \brief Literal strings required by the matches of a regex
+ */
+#ifndef REGEXLITERALS_HPP_
+#define REGEXLITERALS_HPP_
+
+#include <string>
+#include <vector>
+
+/**
+ * \struct regexLiterals
+ * \brief Strings one of which is contained in every match of a regex
+ *
+ * The strings are compared ignoring the case of ASCII letters.
+ */
+struct regexLiterals {
+  /**
+   * \var bool valid
+   * False if nothing is known about the matches, the regex must then be
+   * searched in the whole text
+   */
+  bool valid;
+  /**
+   * \var std::vector<std::string> literals
+   * Every match contains at least one of these strings
+   */
+  std::vector<std::string> literals;
+  /**
+   * \var size_t maxLeading
+   * A match starts at most this many bytes before its literal,
+   * std::string::npos if there is no bound
+   */
+  size_t maxLeading;
+
+  regexLiterals() : valid(false), literals(), maxLeading(std::string::npos) { }
+} ;
+
+regexLiterals extractRegexLiterals(const std::string& regex);
+
+#endif /* REGEXLITERALS_HPP_ */
@@ -31,8 +31,9 @@ regexScanner::regexScanner(const string& type,
 {
   RegexConfProvider rcp;
   rcp.maybeLoad(_identity);
-  _reg = rx::regex(rcp.getRegexValue(_identity, _type),
-                   rx::regex_constants::icase);
+  const char* regex = rcp.getRegexValue(_identity, _type);
+  _reg = rx::regex(regex, rx::regex_constants::icase);
+  _literals = extractRegexLiterals(regex);
 }
 
 /**
@@ -50,38 +51,63 @@ regexScanner::regexScanner(const string& type,
 {
   RegexConfProvider rcp;
   rcp.maybeLoad(_identity,stream);
-  _reg = rx::regex(rcp.getRegexValue(_identity, _type),
-                   rx::regex_constants::icase);
+  const char* regex = rcp.getRegexValue(_identity, _type);
+  _reg = rx::regex(regex, rx::regex_constants::icase);
+  _literals = extractRegexLiterals(regex);
 }
 
 /**
  * \brief Scan a string using regex defined during initialization
- * \param[in]  s       String to scan
+ * \param[in]  begin   First character of the text to scan
+ * \param[in]  end     End of the text to scan
  * \param[out] results List of match results
  */
-void regexScanner::ScanString(const string& s, list<match>& results) const
+void regexScanner::ScanString(const char* begin, const char* end, list<match>& results) const
 {
-  // Read file into one string
-  string::const_iterator end = s.end();
-  string::const_iterator pos = s.begin();
-  unsigned int intPos = 0;
+  matchCandidates everywhere;
+  ScanCandidates(begin, end, everywhere, results);
+}
 
-  while (pos != end)
+/**
+ * \brief Literals required by the regex
+ * \see extractRegexLiterals()
+ */
+regexLiterals regexScanner::GetLiterals() const
+{
+  return _literals;
+}
+
+/**
+ * \brief Scan a string using regex defined during initialization, only where matches can be
+ * \param[in]     begin      First character of the text to scan
+ * \param[in]     end        End of the text to scan
+ * \param[in,out] candidates Where the matches can start
+ * \param[out]    results    List of match results
+ */
+void regexScanner::ScanCandidates(const char* begin, const char* end, matchCandidates& candidates, list<match>& results) const
+{
+  size_t length = end - begin;
+  size_t pos = 0;
+
+  while (pos < length)
   {
-    // Find next match
-    rx::smatch res;
-    if (rx::regex_search(pos, end, res, _reg))
+    size_t start = candidates.searchStart(pos);
+    if (start == string::npos)
+      break;
+
+    // Find next match, where it is searched after a skipped part the previous character is known
+    rx::cmatch res;
+    if (rx::regex_search(begin + start, end, res, _reg,
+                         start > pos ? rx::regex_constants::match_prev_avail : rx::regex_constants::match_default))
     {
       // Found match
-      results.push_back(match(intPos + res.position(_index),
-                              intPos + res.position(_index) + res.length(_index),
+      results.push_back(match(start + res.position(_index),
+                              start + res.position(_index) + res.length(_index),
                               _type));
-      pos = res[0].second;
-      intPos += res.position() + res.length();
+      pos = res[0].second - begin;
     }
     else
       // No match found
       break;
   }
 }
-
@@ -47,9 +47,17 @@ class regexScanner : public scanner
    * Index of regex
    */
   int _index;
+  /**
+   * \var regexLiterals _literals
+   * Literals required by the regex
+   */
+  regexLiterals _literals;
 
 public:
-  void ScanString(const string& str, list<match>& results) const;
+  using scanner::ScanString;
+  void ScanString(const char* begin, const char* end, list<match>& results) const;
+  regexLiterals GetLiterals() const;
+  void ScanCandidates(const char* begin, const char* end, matchCandidates& candidates, list<match>& results) const;
 
   regexScanner(const string& type,
                const string& identity,
@@ -18,7 +18,6 @@
 
 #include "scanners.hpp"
 
-#include <sstream>
 #include <cstring>
 
 /**
@@ -27,15 +26,14 @@
  * \param[out] out      String created from file
  * \return True on success, fail otherwise
  * \todo There should be a maximum string size
+ * \see fo::FileView to scan a file without copying it
  */
 
 bool ReadFileToString(const string& fileName, string& out)
 {
-  ifstream stream(fileName);
-  std::stringstream sstr;
-  sstr << stream.rdbuf();
-  out = sstr.str();
-  return !stream.fail();
+  fo::FileView content(fileName);
+  out.assign(content.begin(), content.end());
+  return content.isOpen();
 }
 
 /**
@@ -57,3 +55,46 @@ bool operator!=(const match& m1, const match& m2)
   return !(m1 == m2);
 }
 
+
+matchCandidates::matchCandidates() :
+  positions(NULL),
+  maxLeading(0),
+  next(0)
+{
+}
+
+/**
+ * \param positions  Sorted positions of the literals of the scanner in the string
+ * \param maxLeading Maximum distance from a match start to its literal,
+ *                   string::npos if unknown
+ */
+matchCandidates::matchCandidates(const std::vector<size_t>& positions, size_t maxLeading) :
+  positions(&positions),
+  maxLeading(maxLeading),
+  next(0)
+{
+}
+
+/**
+ * \brief Position from which to search for the next match starting at or after pos
+ *
+ * A match contains a literal, so it starts at most maxLeading bytes before
+ * the first literal at or after pos.
+ * \param pos Position from which a match is searched, must not decrease between calls
+ * \return Position where to start searching, string::npos if no match can be found
+ */
+size_t matchCandidates::searchStart(size_t pos)
+{
+  if (!positions)
+    return pos;
+
+  while (next < positions->size() && (*positions)[next] < pos)
+    next++;
+  if (next == positions->size())
+    return string::npos;
+
+  size_t literal = (*positions)[next];
+  if (maxLeading != string::npos && literal - pos > maxLeading)
+    return literal - maxLeading;
+  return pos;
+}
@@ -29,6 +29,10 @@ using std::istream;
 using std::string;
 #include <list>
 using std::list;
+#include <vector>
+
+#include "regexLiterals.hpp"
+#include "files.hpp"
 
 bool ReadFileToString(const string& fileName, string& out);
 
@@ -55,6 +59,35 @@ struct match {
 bool operator==(const match& m1, const match& m2);
 bool operator!=(const match& m1, const match& m2);
 
+/**
+ * \class matchCandidates
+ * \brief Where the matches of a scanner can be found in a string
+ *
+ * Built from the positions of the literals of the scanner, see multiScanner.
+ * A default constructed matchCandidates allows matches everywhere.
+ */
+class matchCandidates
+{
+public:
+  matchCandidates();
+  matchCandidates(const std::vector<size_t>& positions, size_t maxLeading);
+
+  size_t searchStart(size_t pos);
+
+private:
+  /**
+   * \var const std::vector<size_t>* positions
+   * Sorted positions of the literals, NULL to allow matches everywhere
+   * \var size_t maxLeading
+   * Maximum distance from a match start to its literal
+   * \var size_t next
+   * First position not yet known to be before the searched position
+   */
+  const std::vector<size_t>* positions;
+  size_t maxLeading;
+  size_t next;
+} ;
+
 /**
  * \class scanner
  * \brief Abstract class to provide interface to scanners
@@ -64,25 +97,61 @@ class scanner
 public:
   virtual ~scanner() {};
 
+  /**
+   * \brief Scan the given text and add matches to results
+   * \param[in]  begin   First character of the text
+   * \param[in]  end     End of the text
+   * \param[out] results Copyright matches are appended to this list,
+   *                     their positions are counted from begin
+   */
+  virtual void ScanString(const char* begin, const char* end, list<match>& results) const = 0;
+
   /**
    * \brief Scan the given string and add matches to results
    * \param[in]  s       String to scan
    * \param[out] results Copyright matches are appended to this list
    */
-  virtual void ScanString(const string& s, list<match>& results) const = 0;
+  void ScanString(const string& s, list<match>& results) const
+  {
+    ScanString(s.data(), s.data() + s.length(), results);
+  }
+
+  /**
+   * \brief Literals one of which every match contains
+   *
+   * By default nothing is known and the scanner always scans the whole string.
+   */
+  virtual regexLiterals GetLiterals() const
+  {
+    return regexLiterals();
+  }
+
+  /**
+   * \brief Scan the given text looking for matches only where they can be
+   *
+   * Must add the same matches as ScanString()
+   * \param[in]     begin      First character of the text
+   * \param[in]     end        End of the text
+   * \param[in,out] candidates Where the matches can be found
+   * \param[out]    results    Copyright matches are appended to this list
+   */
+  virtual void ScanCandidates(const char* begin, const char* end, matchCandidates& candidates, list<match>& results) const
+  {
+    (void) candidates;
+    ScanString(begin, end, results);
+  }
 
   /**
    * \brief Helper function to scan file
    *
-   * Reads file contents to string and pass to ScanString()
+   * Maps the file and pass its content to ScanString()
    * \param[in]  fileName File name to scan
    * \param[out] results  Copyright matches are appended to this list
    */
   virtual void ScanFile(const string& fileName, list<match>& results) const
   {
-    string s;
-    ReadFileToString(fileName, s);
-    ScanString(s, results);
+    fo::FileView content(fileName);
+    ScanString(content.begin(), content.end(), results);
   }
 } ;
 
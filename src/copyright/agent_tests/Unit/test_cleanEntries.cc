@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/**
+ * \file test_cleanEntries.cc
+ * \brief Test the cleaning of the matches against the regex based cleaning
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "cleanEntries.hpp"
+#include <sstream>
+#include <iterator>
+#include <vector>
+
+using namespace std;
+
+/**
+ * \brief Reference cleaning of general matches, with the regex used before
+ */
+static string regexCleanGeneral(const string& s)
+{
+  stringstream ss;
+  rx::regex_replace(ostream_iterator<char>(ss), s.begin(), s.end(), rx::regex("[[:space:]\\x0-\\x1f]{2,}"), " ");
+  string r = ss.str();
+  string::size_type len = r.length();
+  if (len > 1)
+  {
+    char cBegin = r[0];
+    char cEnd = r[len - 1];
+    if (cBegin == ' ' && cEnd == ' ')
+      return r.substr(1, len - 2);
+    else if (cBegin == ' ')
+      return r.substr(1);
+    else if (cEnd == ' ')
+      return r.substr(0, len - 1);
+  }
+  return r == " " ? "" : r;
+}
+
+/**
+ * \brief Reference cleaning of statements, with the regex used before
+ */
+static string regexCleanStatement(const string& s)
+{
+  stringstream ss;
+  rx::regex_replace(ostream_iterator<char>(ss), s.begin(), s.end(), rx::regex("\n[[:space:][:punct:]]*"), " ");
+  return regexCleanGeneral(ss.str());
+}
+
+/**
+ * \class cleanEntriesTestSuite
+ * \brief Compare cleanMatch() with the regex based cleaning
+ */
+class cleanEntriesTestSuite : public CPPUNIT_NS :: TestFixture {
+  CPPUNIT_TEST_SUITE (cleanEntriesTestSuite);
+  CPPUNIT_TEST (cleanExamplesTest);
+  CPPUNIT_TEST (cleanAllBytePairsTest);
+  CPPUNIT_TEST (cleanShortStringsTest);
+  CPPUNIT_TEST (cleanRandomStringsTest);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+private:
+  /**
+   * \brief Clean the whole string as both types and compare with the regexes
+   */
+  void assertSameCleaning(const string& s)
+  {
+    CPPUNIT_ASSERT_EQUAL(regexCleanStatement(s), cleanMatch(s, match(0, s.length(), "statement")));
+    CPPUNIT_ASSERT_EQUAL(regexCleanGeneral(s), cleanMatch(s, match(0, s.length(), "email")));
+  }
+
+protected:
+  /**
+   * \brief Test cleaning of typical matches
+   * \test
+   * -# Clean statements and other matches, in the middle of a text
+   * -# Check the results
+   * -# Reuse one buffer for all of them and check the results again
+   */
+  void cleanExamplesTest () {
+    const string text = "x * Copyright (c) 1989, 1993\n *  \tThe Regents\r\n// All rights  reserved.\n\n"
+      "  <benj@debian.org>\t\t\n";
+    const string statementType = "statement";
+    const string authorType = "author";
+    const size_t statementEnd = text.find("<") - 2;
+    match statement(text.find("Copyright"), statementEnd, statementType);
+    match author(statementEnd, text.length(), authorType);
+
+    CPPUNIT_ASSERT_EQUAL(string("Copyright (c) 1989, 1993 The Regents All rights reserved."),
+      cleanMatch(text, statement));
+    CPPUNIT_ASSERT_EQUAL(string("<benj@debian.org>"), cleanMatch(text, author));
+
+    string buffer = "previous content";
+    cleanMatch(text, statement, buffer);
+    CPPUNIT_ASSERT_EQUAL(cleanMatch(text, statement), buffer);
+    cleanMatch(text, author, buffer);
+    CPPUNIT_ASSERT_EQUAL(cleanMatch(text, author), buffer);
+    cleanMatch(text, match(0, 0, "statement"), buffer);
+    CPPUNIT_ASSERT_EQUAL(string(), buffer);
+  }
+
+  /**
+   * \brief Test every byte alone and followed by every byte
+   * \test
+   * -# Clean all the strings of one and two bytes, next to a letter or not
+   * -# Compare with the regex cleaning
+   */
+  void cleanAllBytePairsTest () {
+    for (int c1 = 0; c1 < 256; c1++)
+    {
+      assertSameCleaning(string(1, (char) c1));
+      for (int c2 = 0; c2 < 256; c2++)
+      {
+        string s;
+        s.push_back((char) c1);
+        s.push_back((char) c2);
+        assertSameCleaning(s);
+        assertSameCleaning("a" + s + "b");
+      }
+    }
+  }
+
+  /**
+   * \brief Test all short strings of the bytes the cleaning looks at
+   * \test
+   * -# Clean all the strings of up to five bytes among spaces, new lines,
+   *    control characters, punctuation and letters
+   * -# Compare with the regex cleaning
+   */
+  void cleanShortStringsTest () {
+    const string alphabet("\n \t\r\x1f\x7f*/#,a\xa0", 12);
+    vector<size_t> digits;
+    for (size_t length = 0; length <= 5; length++)
+    {
+      digits.assign(length, 0);
+      while (true)
+      {
+        string s;
+        for (size_t i = 0; i < length; i++)
+          s.push_back(alphabet[digits[i]]);
+        assertSameCleaning(s);
+
+        size_t i = 0;
+        while (i < length && ++digits[i] == alphabet.length())
+          digits[i++] = 0;
+        if (i == length)
+          break;
+      }
+    }
+  }
+
+  /**
+   * \brief Test random strings made mostly of spaces and punctuation
+   * \test
+   * -# Clean pseudo random strings of up to 200 bytes
+   * -# Compare with the regex cleaning
+   */
+  void cleanRandomStringsTest () {
+    const string alphabet("\n\n  \t\r\v\f\x01*/#;-.()<>@ABCabc019\xc2\xa9\xff", 34);
+    unsigned seed = 12345;
+    for (int n = 0; n < 2000; n++)
+    {
+      seed = seed * 1103515245 + 12345;
+      size_t length = (seed >> 16) % 200;
+      string s;
+      for (size_t i = 0; i < length; i++)
+      {
+        seed = seed * 1103515245 + 12345;
+        s.push_back(alphabet[(seed >> 16) % alphabet.length()]);
+      }
+      assertSameCleaning(s);
+    }
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( cleanEntriesTestSuite );
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/**
+ * \file test_database.cc
+ * \brief Test the rows sent to the database with COPY
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "database.hpp"
+
+using namespace std;
+
+/**
+ * \class databaseTestSuite
+ * \brief Test the formatting of the findings for COPY
+ */
+class databaseTestSuite : public CPPUNIT_NS :: TestFixture {
+  CPPUNIT_TEST_SUITE (databaseTestSuite);
+  CPPUNIT_TEST (appendCopyValueTest);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+protected:
+  /**
+   * \brief Test appendCopyValue()
+   * \test
+   * -# Append values with special characters to a row
+   * -# Check that they are separated by tabs and escaped
+   * -# Check that a new row starts without a tab
+   * -# Check that a value ends at its first null character
+   */
+  void appendCopyValueTest () {
+    string row;
+    appendCopyValue(row, "42");
+    appendCopyValue(row, "a\tb\\c\nd\re");
+    appendCopyValue(row, "");
+    appendCopyValue(row, "statement");
+    CPPUNIT_ASSERT_EQUAL(string("42\ta\\tb\\\\c\\nd\\re\t\tstatement"), row);
+
+    row.push_back('\n');
+    appendCopyValue(row, string("x\0y", 3));
+    CPPUNIT_ASSERT_EQUAL(string("42\ta\\tb\\\\c\\nd\\re\t\tstatement\nx"), row);
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( databaseTestSuite );
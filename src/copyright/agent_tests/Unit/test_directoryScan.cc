@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/**
+ * \file test_directoryScan.cc
+ * \brief Test the scan of file lists and directories
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "directoryScan.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+/**
+ * \class directoryScanTestSuite
+ * \brief Test that the pipelined scans print the results of every file in order
+ */
+class directoryScanTestSuite : public CPPUNIT_NS :: TestFixture {
+  CPPUNIT_TEST_SUITE (directoryScanTestSuite);
+  CPPUNIT_TEST (scanFilesTest);
+  CPPUNIT_TEST (scanDirectoryTest);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+private:
+  fs::path directory;
+  vector<string> fileNames;
+
+  /**
+   * \brief Run a scan and return what it prints
+   */
+  template <typename Scan>
+  string captureOutput(Scan scan)
+  {
+    stringstream out;
+    streambuf* original = cout.rdbuf(out.rdbuf());
+    scan();
+    cout.rdbuf(original);
+    return out.str();
+  }
+
+  /**
+   * \brief Results of the files printed one after the other
+   */
+  string expectedOutput(const CopyrightState& state, const vector<string>& files)
+  {
+    return captureOutput([&] {
+      for (auto it = files.begin(); it != files.end(); ++it)
+        printResultToStdout(*it, processSingleFile(state, *it));
+    });
+  }
+
+public:
+  /**
+   * \brief Create files of different sizes, with and without URLs
+   */
+  void setUp()
+  {
+    directory = fs::temp_directory_path() / fs::unique_path("copyright-%%%%-%%%%");
+    fs::create_directories(directory / "sub");
+    fileNames.clear();
+    for (int i = 0; i < 200; i++)
+    {
+      fs::path file = directory / (i % 3 ? "sub" : "") / ("file" + to_string(i));
+      ofstream stream(file.string());
+      for (int j = 0; j < (i * 37) % 500; j++)
+        stream << "line " << j << " of file " << i << "\n";
+      if (i % 2)
+        stream << "see http://example.org/" << i << "\n";
+      fileNames.push_back(file.string());
+    }
+  }
+
+  void tearDown()
+  {
+    fs::remove_all(directory);
+  }
+
+protected:
+  /**
+   * \brief Test scanFiles()
+   * \test
+   * -# Scan a list of files, one of which does not exist
+   * -# Check that the results are printed in the order of the list
+   * -# Check that the missing file is reported
+   */
+  void scanFilesTest () {
+    CliOptions options;
+    options.addScanner(new regexScanner("url", "copyright"));
+    CopyrightState state(std::move(options));
+
+    vector<string> files(fileNames);
+    files.insert(files.begin() + 50, (directory / "missing").string());
+
+    bool success = true;
+    string output = captureOutput([&] { success = scanFiles(state, false, files); });
+
+    CPPUNIT_ASSERT_EQUAL(expectedOutput(state, files), output);
+    CPPUNIT_ASSERT(!success);
+    CPPUNIT_ASSERT(output.find("missing :: Unable to read file") != string::npos);
+  }
+
+  /**
+   * \brief Test scanDirectory()
+   * \test
+   * -# Scan the directory
+   * -# Check that the results of all the files are printed in the order of the directory listing
+   */
+  void scanDirectoryTest () {
+    CliOptions options;
+    options.addScanner(new regexScanner("url", "copyright"));
+    CopyrightState state(std::move(options));
+
+    vector<string> files;
+    for (fs::recursive_directory_iterator it(directory), end; it != end; ++it)
+      if (!fs::is_directory(it->path()))
+        files.push_back(it->path().string());
+    CPPUNIT_ASSERT_EQUAL(fileNames.size(), files.size());
+
+    string output = captureOutput([&] { scanDirectory(state, false, directory.string()); });
+
+    CPPUNIT_ASSERT_EQUAL(expectedOutput(state, files), output);
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( directoryScanTestSuite );
@@ -30,6 +30,7 @@ class regexConfProviderTestSuite : public CPPUNIT_NS :: TestFixture {
   CPPUNIT_TEST (simpleReplacementTest);
   CPPUNIT_TEST (multipleReplacementTest);
   CPPUNIT_TEST (testForInfiniteRecursion);
+  CPPUNIT_TEST (loadedRegexesTest);
 
   CPPUNIT_TEST_SUITE_END ();
 
@@ -139,6 +140,23 @@ protected:
     CPPUNIT_ASSERT_MESSAGE("This should just terminate (the return value is not specified)",
                            rcp.getRegexValue(testIdentity,testKey));
   }
+
+  /**
+   * \test
+   * -# Load a test stream with unsorted keys
+   * -# Check that RegexConfProvider::getLoadedRegexes() lists them sorted
+   */
+  void loadedRegexesTest()
+  {
+    istringstream testStream("LOREM=Lorem\nIPSUM=Ipsum\n");
+
+    RegexConfProvider rcp;
+    rcp.maybeLoad("loadedIdentity", testStream);
+
+    string loaded = RegexConfProvider::getLoadedRegexes();
+    CPPUNIT_ASSERT(loaded.find(
+      "loadedIdentity.IPSUM=Ipsum\nloadedIdentity.LOREM=Lorem\n") != string::npos);
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( regexConfProviderTestSuite );
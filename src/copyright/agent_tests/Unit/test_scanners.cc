@@ -20,8 +20,11 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 #include "regex.hpp"
 #include "regscan.hpp"
+#include "multiscan.hpp"
 #include "copyrightUtils.hpp"
 #include <list>
+#include <vector>
+#include <sstream>
 #include <cstring>
 #include <ostream>
 
@@ -39,6 +42,16 @@ ostream& operator<<(ostream& out, const list<match>& l)
   return out;
 }
 
+/**
+ * \brief Helper to print vector of strings
+ */
+ostream& operator<<(ostream& out, const vector<string>& v)
+{
+  for (auto s = v.begin(); s != v.end(); ++s)
+    out << '[' << *s << ']';
+  return out;
+}
+
 /**
  * \brief test data
  */
@@ -68,6 +81,9 @@ class scannerTestSuite : public CPPUNIT_NS :: TestFixture {
   CPPUNIT_TEST (regUrlTest);
   CPPUNIT_TEST (regEmailTest);
   CPPUNIT_TEST (regKeywordTest);
+  CPPUNIT_TEST (regexLiteralsTest);
+  CPPUNIT_TEST (multiScannerTest);
+  CPPUNIT_TEST (multiScannerLeadingTest);
 
   CPPUNIT_TEST_SUITE_END ();
 
@@ -176,6 +192,125 @@ protected:
     regexScanner sc("keyword", "keyword");
     scannerTest(sc, testContent, "keyword", {"patent", "licensed as"});
   }
+
+  /**
+   * \brief Test literals required by regexes
+   * \test
+   * -# Extract the literals of regexes using all the supported constructs
+   * -# Check that regexes which can match anything have no literals
+   */
+  void regexLiteralsTest () {
+    regexLiterals literals = extractRegexLiterals("\\bCopyright(?:ed|s)?[[:space:]:]*");
+    CPPUNIT_ASSERT(literals.valid);
+    CPPUNIT_ASSERT_EQUAL(vector<string>({"copyright"}), literals.literals);
+    CPPUNIT_ASSERT_EQUAL((size_t) 0, literals.maxLeading);
+
+    literals = extractRegexLiterals("(:?ht|f)tps?\\:\\/\\/[^\\s\\<]+");
+    CPPUNIT_ASSERT(literals.valid);
+    CPPUNIT_ASSERT_EQUAL(vector<string>({"ftp://", "ftps://", "http://", "https://"}), literals.literals);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, literals.maxLeading);
+
+    literals = extractRegexLiterals("[\\<\\(]?([\\w\\-\\.]{1,100}@[\\w]+)");
+    CPPUNIT_ASSERT(literals.valid);
+    CPPUNIT_ASSERT_EQUAL(vector<string>({"@"}), literals.literals);
+    CPPUNIT_ASSERT_EQUAL((size_t) 101, literals.maxLeading);
+
+    literals = extractRegexLiterals("(?:\\(c\\)|\\xA9|\\xC2\\xA9)[ \\t]+[[:alnum:]]{5,}");
+    CPPUNIT_ASSERT(literals.valid);
+    CPPUNIT_ASSERT_EQUAL(vector<string>({"(c)", "\xA9"}), literals.literals);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, literals.maxLeading);
+
+    literals = extractRegexLiterals("[[:alpha:]]+ written[ \t]+by");
+    CPPUNIT_ASSERT(literals.valid);
+    CPPUNIT_ASSERT_EQUAL(vector<string>({" written"}), literals.literals);
+    CPPUNIT_ASSERT_EQUAL(string::npos, literals.maxLeading);
+
+    literals = extractRegexLiterals("(xabc|bc|c)");
+    CPPUNIT_ASSERT(literals.valid);
+    CPPUNIT_ASSERT_EQUAL(vector<string>({"c"}), literals.literals);
+    CPPUNIT_ASSERT_EQUAL((size_t) 3, literals.maxLeading);
+
+    literals = extractRegexLiterals("(abcd|bcd|cd)");
+    CPPUNIT_ASSERT(literals.valid);
+    CPPUNIT_ASSERT_EQUAL(vector<string>({"cd"}), literals.literals);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, literals.maxLeading);
+
+    CPPUNIT_ASSERT(!extractRegexLiterals("a*").valid);
+    CPPUNIT_ASSERT(!extractRegexLiterals("patent|[[:alpha:]]+").valid);
+    CPPUNIT_ASSERT(!extractRegexLiterals("(a)\\1").valid);
+    CPPUNIT_ASSERT(!extractRegexLiterals("^license").valid);
+    CPPUNIT_ASSERT(!extractRegexLiterals("(?i)license").valid);
+    CPPUNIT_ASSERT(!extractRegexLiterals("[ \t]+").valid);
+  }
+
+  /**
+   * \brief Test scanning with all scanners at once
+   * \test
+   * -# Create a multiScanner from the scanners of the other tests
+   * -# Check that it finds the same matches as the scanners one after the other
+   * -# Check on texts where literals are found and the regexes do not match
+   */
+  void multiScannerTest () {
+    list<unptr::shared_ptr<scanner>> scanners;
+    scanners.push_back(unptr::shared_ptr<scanner>(new hCopyrightScanner()));
+    scanners.push_back(unptr::shared_ptr<scanner>(new regexScanner("url", "copyright")));
+    scanners.push_back(unptr::shared_ptr<scanner>(new regexScanner("email", "copyright", 1)));
+    scanners.push_back(unptr::shared_ptr<scanner>(new regexScanner("author", "copyright")));
+    scanners.push_back(unptr::shared_ptr<scanner>(new regexScanner("ecc", "ecc")));
+    scanners.push_back(unptr::shared_ptr<scanner>(new regexScanner("keyword", "keyword")));
+    std::istringstream cliRegex("cli=foo[0-9]+");
+    scanners.push_back(unptr::shared_ptr<scanner>(new regexScanner("cli", cliRegex)));
+    multiScanner multi(scanners);
+
+    const char* contents[] = {
+      testContent,
+      "",
+      "no statement here",
+      "COPYRIGHT notice\ncopyright: mail@ x@y and http:// are not enough, foo12 (C)x",
+      "x@y.com@z.org write to A@B.ORG. Written  By Me, (c) 2001 ACME\nand friends\n\nfoo7",
+    };
+    for (size_t i = 0; i < sizeof(contents) / sizeof(contents[0]); i++)
+    {
+      list<match> expected;
+      for (auto sc = scanners.begin(); sc != scanners.end(); ++sc)
+        (*sc)->ScanString(contents[i], expected);
+
+      list<match> matches;
+      multi.ScanString(contents[i], matches);
+      CPPUNIT_ASSERT_EQUAL(expected, matches);
+    }
+  }
+
+  /**
+   * \brief Test scanning with regexes whose alternatives contain each other
+   * \test
+   * -# Create scanners for regexes where the literal kept is found after the
+   *    start of the longer alternatives
+   * -# Check that a multiScanner finds the same matches as the scanners
+   */
+  void multiScannerLeadingTest () {
+    const char* regexes[] = {
+      "lead1=(xabc|bc|c)",
+      "lead2=(abcd|bcd|cd)",
+    };
+    const char* content = "zzzzzzzzzzzzzzz xabc zz abcd";
+    for (size_t i = 0; i < sizeof(regexes) / sizeof(regexes[0]); i++)
+    {
+      std::istringstream regex(regexes[i]);
+      string type(regexes[i], strchr(regexes[i], '='));
+      list<unptr::shared_ptr<scanner>> scanners;
+      scanners.push_back(unptr::shared_ptr<scanner>(new regexScanner(type, regex)));
+      multiScanner multi(scanners);
+
+      list<match> expected;
+      scanners.front()->ScanString(content, expected);
+      CPPUNIT_ASSERT(!expected.empty());
+
+      list<match> matches;
+      multi.ScanString(content, matches);
+      CPPUNIT_ASSERT_EQUAL(expected, matches);
+    }
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( scannerTestSuite );
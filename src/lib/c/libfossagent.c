@@ -415,3 +415,145 @@ FUNCTION char* GetUploadtreeTableName(PGconn* pgConn, int upload_pk)
 
   return (uploadtree_tablename);
 }
+
+/**
+ * \brief Check if the agents reuse the results of their other versions
+ *
+ * Enabled by `result_reuse = yes` in the FOSSOLOGY group of the system
+ * configuration.
+ * \return 1 if enabled, 0 otherwise
+ * \see fo_SetAgentFingerprint()
+ */
+FUNCTION int fo_ResultReuseEnabled()
+{
+  if (!sysconfig || !fo_config_has_key(sysconfig, "FOSSOLOGY", "result_reuse"))
+    return 0;
+
+  char* value = fo_config_get(sysconfig, "FOSSOLOGY", "result_reuse", NULL);
+  return value && (strcmp(value, "yes") == 0 || strcmp(value, "true") == 0 || strcmp(value, "1") == 0);
+}
+
+/**
+ * \brief Record the fingerprint of the configuration of an agent
+ *
+ * The fingerprint identifies everything the results of an agent depend on,
+ * besides the scanned file: the results of an agent version are valid for
+ * every other version of the same agent with the same fingerprint.
+ *
+ * If the agent was already run with another fingerprint, its results are
+ * not reused anymore. The agent_fingerprint table is created if needed.
+ * \param dbManager   DB manager in use
+ * \param agentId     Agent id (agent_pk)
+ * \param fingerprint Fingerprint of the configuration of the agent
+ * \return 1 on success, 0 on failure
+ */
+FUNCTION int fo_SetAgentFingerprint(fo_dbManager* dbManager, int agentId, const char* fingerprint)
+{
+  PGconn* pgConn = fo_dbManager_getWrappedConnection(dbManager);
+  PGresult* result;
+
+  if (!fo_tableExists(pgConn, "agent_fingerprint"))
+  {
+    result = fo_dbManager_Exec_printf(dbManager,
+      "CREATE TABLE agent_fingerprint ("
+      "agent_fk integer PRIMARY KEY REFERENCES agent(agent_pk) ON DELETE CASCADE,"
+      " fingerprint text)"
+    );
+    /* another agent can create it at the same time */
+    if (!result && !fo_tableExists(pgConn, "agent_fingerprint"))
+      return 0;
+    if (result)
+      PQclear(result);
+  }
+
+  fo_dbManager_PreparedStatement* stmt = fo_dbManager_PrepareStamement(
+    dbManager,
+    "setAgentFingerprint",
+    "WITH changed AS ("
+    " UPDATE agent_fingerprint SET fingerprint = NULL"
+    " WHERE agent_fk = $1 AND fingerprint <> $2 RETURNING agent_fk"
+    ") INSERT INTO agent_fingerprint (agent_fk, fingerprint)"
+    " SELECT $1, $2 WHERE NOT EXISTS (SELECT 1 FROM agent_fingerprint WHERE agent_fk = $1)",
+    int, char*
+  );
+
+  /* retry once if another instance of the agent inserted it first */
+  result = fo_dbManager_ExecPrepared(stmt, agentId, fingerprint);
+  if (!result)
+    result = fo_dbManager_ExecPrepared(stmt, agentId, fingerprint);
+  if (!result)
+    return 0;
+
+  PQclear(result);
+  return 1;
+}
+
+/**
+ * \brief Copy the license findings of an upload from the other versions of
+ * an agent with the same fingerprint
+ *
+ * The rows of license_file and highlight of every file of the upload not yet
+ * scanned by the agent are copied, in one statement, from the last agent
+ * version with the same fingerprint which scanned the file. The copied files
+ * are then skipped by the agent as already scanned.
+ * \param dbManager   DB manager in use
+ * \param uploadId    Upload id
+ * \param agentId     Agent id (agent_pk) to copy the results to
+ * \param fingerprint Fingerprint recorded with fo_SetAgentFingerprint()
+ * \return Number of files with copied results, -1 on failure
+ */
+FUNCTION long fo_CopyLicenseFileResults(fo_dbManager* dbManager, int uploadId, int agentId, const char* fingerprint)
+{
+  long copied = -1;
+  char* uploadtreeTableName = getUploadTreeTableName(dbManager, uploadId);
+  char* queryName = g_strdup_printf("copyLicenseFileResults.%s", uploadtreeTableName);
+  char* sql = g_strdup_printf(
+    "WITH sources AS ("
+    " SELECT lf.pfile_fk, max(lf.agent_fk) AS agent_fk"
+    " FROM (SELECT DISTINCT pfile_fk FROM %s"
+    "  WHERE upload_fk = $1 AND (ufile_mode&x'3C000000'::int)=0) AS ut"
+    " INNER JOIN license_file AS lf ON lf.pfile_fk = ut.pfile_fk"
+    " WHERE lf.agent_fk IN (" FINGERPRINT_SOURCE_AGENTS ")"
+    " AND NOT EXISTS (SELECT 1 FROM license_file AS scanned"
+    "  WHERE scanned.pfile_fk = ut.pfile_fk AND scanned.agent_fk = $2)"
+    " GROUP BY lf.pfile_fk"
+    "), findings AS ("
+    " SELECT lf.fl_pk AS source_fl_pk, nextval('license_file_fl_pk_seq') AS fl_pk,"
+    "  lf.rf_fk, lf.pfile_fk, lf.rf_match_pct,"
+    "  lf.fl_ref_start_byte, lf.fl_ref_end_byte, lf.fl_start_byte, lf.fl_end_byte"
+    " FROM license_file AS lf INNER JOIN sources USING (pfile_fk, agent_fk)"
+    "), copiedFindings AS ("
+    " INSERT INTO license_file (fl_pk, rf_fk, agent_fk, pfile_fk, rf_match_pct,"
+    "  fl_ref_start_byte, fl_ref_end_byte, fl_start_byte, fl_end_byte)"
+    " SELECT fl_pk, rf_fk, $2, pfile_fk, rf_match_pct,"
+    "  fl_ref_start_byte, fl_ref_end_byte, fl_start_byte, fl_end_byte"
+    " FROM findings"
+    "), copiedHighlights AS ("
+    " INSERT INTO highlight (fl_fk, type, start, len, rf_start, rf_len)"
+    " SELECT findings.fl_pk, h.type, h.start, h.len, h.rf_start, h.rf_len"
+    " FROM highlight AS h INNER JOIN findings ON h.fl_fk = findings.source_fl_pk"
+    ") SELECT count(*) FROM sources",
+    uploadtreeTableName);
+
+  PGresult* result = fo_dbManager_ExecPrepared(
+    fo_dbManager_PrepareStamement(
+      dbManager,
+      queryName,
+      sql,
+      int, int, char*),
+    uploadId, agentId, fingerprint
+  );
+
+  if (result)
+  {
+    if (PQntuples(result) == 1)
+      copied = atol(PQgetvalue(result, 0, 0));
+    PQclear(result);
+  }
+
+  g_free(sql);
+  g_free(queryName);
+  g_free(uploadtreeTableName);
+
+  return copied;
+}
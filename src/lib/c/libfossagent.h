@@ -35,4 +35,19 @@ int getEffectivePermissionOnUpload(PGconn* pgConn, long UploadPk, int user_pk, i
 int GetUploadPerm(PGconn* pgConn, long UploadPk, int user_pk);
 char* GetUploadtreeTableName(PGconn* pgConn, int upload_pk);
 
+/**
+ * \brief SQL selecting the agents, other than the agent $2, with the same
+ * name as the agent $2 and whose results were produced with the fingerprint $3
+ * \see fo_SetAgentFingerprint()
+ */
+#define FINGERPRINT_SOURCE_AGENTS \
+  "SELECT af.agent_fk FROM agent_fingerprint AS af" \
+  " INNER JOIN agent AS a ON a.agent_pk = af.agent_fk" \
+  " WHERE af.fingerprint = $3 AND af.agent_fk <> $2" \
+  " AND a.agent_name = (SELECT agent_name FROM agent WHERE agent_pk = $2)"
+
+int fo_ResultReuseEnabled();
+int fo_SetAgentFingerprint(fo_dbManager* dbManager, int agentId, const char* fingerprint);
+long fo_CopyLicenseFileResults(fo_dbManager* dbManager, int uploadId, int agentId, const char* fingerprint);
+
 #endif
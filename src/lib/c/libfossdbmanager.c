@@ -42,6 +42,14 @@ struct fo_dbmanager_preparedstatement
   int paramc;     ///< Number of paramenters
 };
 
+/** Pool of idle forked DB managers */
+typedef struct
+{
+  GQueue* idle;   ///< DB managers with an idle connection
+  int size;       ///< Maximum number of idle DB managers kept
+  int refCount;   ///< Number of DB managers using the pool
+} fo_dbManagerPool;
+
 /** Database manager object */
 struct fo_dbmanager
 {
@@ -50,8 +58,26 @@ struct fo_dbmanager
   char* dbConf;         ///< DB conf file location
   FILE* logFile;        ///< FOSSology log file pointer
   int ignoreWarns;      ///< Set to ignore warnings from logging
+  fo_dbManagerPool* pool; ///< Pool of the forks, NULL if not pooled
+  int pooled;           ///< Set if the connection goes back to the pool
+  int pipeline;         ///< Set if the connection is in pipeline mode
+  GQueue* pipelineSent; ///< Statements sent and not read yet
+  GQueue* pipelineResults; ///< Results read and not returned yet
 };
 
+/** Maximum number of statements sent in a pipeline before reading results */
+#define PIPELINE_MAX_SENT 256
+
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+static GMutex poolLock;  ///< Lock for all the pools
+#define POOL_LOCK() g_mutex_lock(&poolLock)
+#define POOL_UNLOCK() g_mutex_unlock(&poolLock)
+#else
+static GStaticMutex poolLock = G_STATIC_MUTEX_INIT;  ///< Lock for all the pools
+#define POOL_LOCK() g_static_mutex_lock(&poolLock)
+#define POOL_UNLOCK() g_static_mutex_unlock(&poolLock)
+#endif
+
 /** Print the log in logfile or stdout */
 #define LOG(level, str, ...) \
   do {\
@@ -137,6 +163,11 @@ fo_dbManager* fo_dbManager_new(PGconn* dbConnection)
   result->logFile = NULL;
   result->dbConf = NULL;
   result->ignoreWarns = 0;
+  result->pool = NULL;
+  result->pooled = 0;
+  result->pipeline = 0;
+  result->pipelineSent = g_queue_new();
+  result->pipelineResults = g_queue_new();
 
   PQsetNoticeReceiver(dbConnection, noticeReceiver, result);
 
@@ -163,6 +194,11 @@ fo_dbManager* fo_dbManager_new(PGconn* dbConnection)
  *
  * dbManager2 = fo_dbManager_fork(dbManager1);
  * \endcode
+ *
+ * If a pool was set with fo_dbManager_setPoolSize(), an idle instance given
+ * back to the pool by fo_dbManager_finish() is returned instead, with its
+ * connection and prepared statements.
+ *
  * \param dbManager Existing DB manager
  * \return New DB manager forked from existing manager, else log a fatal error.
  * \sa fo_dbManager_new_withConf()
@@ -170,20 +206,152 @@ fo_dbManager* fo_dbManager_new(PGconn* dbConnection)
 fo_dbManager* fo_dbManager_fork(fo_dbManager* dbManager)
 {
   fo_dbManager* result = NULL;
+  fo_dbManagerPool* pool = dbManager->pool;
+
+  if (pool)
+  {
+    POOL_LOCK();
+    result = g_queue_pop_head(pool->idle);
+    pool->refCount++;
+    POOL_UNLOCK();
+    if (result)
+      return result;
+  }
+
   char* error = NULL;
   PGconn* newDbConnection = fo_dbconnect(dbManager->dbConf, &error);
   if (newDbConnection)
   {
     result = fo_dbManager_new_withConf(newDbConnection, dbManager->dbConf);
+    result->pool = pool;
+    result->pooled = pool != NULL;
   } else
   {
     LOG_FATAL("Can not open connection\n%s\nWhile forking dbManager using config: '%s'\n",
       error, dbManager->dbConf);
     free(error);
   }
+  if (pool && !result)
+  {
+    POOL_LOCK();
+    pool->refCount--;
+    POOL_UNLOCK();
+  }
   return result;
 }
 
+/**
+ * \brief Keep the connections of the forks of a DB manager for reuse.
+ *
+ * The instances forked from the DB manager (and from its forks) are given
+ * back to a pool by fo_dbManager_finish() instead of closing their
+ * connection, and fo_dbManager_fork() takes them from the pool. An agent
+ * forking one instance per thread for every upload opens its connections
+ * only once.
+ *
+ * At most poolSize idle instances are kept, the others are closed. The pool
+ * is closed when the DB manager and all its forks are finished.
+ * \param dbManager DB manager to fork from
+ * \param poolSize  Maximum number of idle connections, 0 to close them
+ */
+void fo_dbManager_setPoolSize(fo_dbManager* dbManager, int poolSize)
+{
+  GList* closed = NULL;
+
+  POOL_LOCK();
+  fo_dbManagerPool* pool = dbManager->pool;
+  if (!pool)
+  {
+    pool = malloc(sizeof(fo_dbManagerPool));
+    pool->idle = g_queue_new();
+    pool->size = 0;
+    pool->refCount = 1;
+    dbManager->pool = pool;
+  }
+  pool->size = poolSize > 0 ? poolSize : 0;
+  while ((int) g_queue_get_length(pool->idle) > pool->size)
+  {
+    closed = g_list_prepend(closed, g_queue_pop_tail(pool->idle));
+  }
+  POOL_UNLOCK();
+
+  GList* it;
+  for (it = closed; it; it = it->next)
+  {
+    fo_dbManager* idle = it->data;
+    idle->pooled = 0;
+    idle->pool = NULL;
+    fo_dbManager_finish(idle);
+  }
+  g_list_free(closed);
+}
+
+/**
+ * \brief Release the pool used by a DB manager
+ *
+ * Closes the idle connections when the pool is not used anymore.
+ * \param pool The pool to release, can be NULL
+ */
+static void pool_unref(fo_dbManagerPool* pool)
+{
+  if (!pool)
+    return;
+
+  POOL_LOCK();
+  int unused = --pool->refCount == 0;
+  POOL_UNLOCK();
+
+  if (unused)
+  {
+    fo_dbManager* idle;
+    while ((idle = g_queue_pop_head(pool->idle)))
+    {
+      idle->pooled = 0;
+      idle->pool = NULL;
+      fo_dbManager_finish(idle);
+    }
+    g_queue_free(pool->idle);
+    free(pool);
+  }
+}
+
+/**
+ * \brief Give a DB manager back to its pool
+ *
+ * Only connections in a usable state, outside of a transaction and of a
+ * pipeline, are kept.
+ * \param dbManager Forked DB manager
+ * \return 1 if the pool took the DB manager, 0 otherwise
+ */
+static int pool_giveBack(fo_dbManager* dbManager)
+{
+  fo_dbManagerPool* pool = dbManager->pool;
+  PGconn* dbConnection = dbManager->dbConnection;
+
+  if (!dbManager->pooled || dbManager->pipeline
+    || PQstatus(dbConnection) != CONNECTION_OK
+    || PQtransactionStatus(dbConnection) != PQTRANS_IDLE)
+    return 0;
+
+  while (!g_queue_is_empty(dbManager->pipelineResults))
+    PQclear(g_queue_pop_head(dbManager->pipelineResults));
+  fo_dbManager_setLogFile(dbManager, NULL);
+  dbManager->ignoreWarns = 0;
+
+  int kept = 0;
+  POOL_LOCK();
+  if ((int) g_queue_get_length(pool->idle) < pool->size)
+  {
+    g_queue_push_head(pool->idle, dbManager);
+    kept = 1;
+  }
+  POOL_UNLOCK();
+
+  if (kept)
+    pool_unref(pool);
+  return kept;
+}
+
 /**
  * \brief Set the log file pointer for a given DB manager
  * \param dbManager   DB manager to be updated
@@ -233,10 +401,16 @@ PGconn* fo_dbManager_getWrappedConnection(fo_dbManager* dbManager)
  * -# Unref the cached table
  * -# Free the DB conf file location
  * -# Close the log file FP
+ * -# Release the pool
  * \param dbManager The DB manager to be free-ed
  */
 void fo_dbManager_free(fo_dbManager* dbManager)
 {
+  pool_unref(dbManager->pool);
+  g_queue_free(dbManager->pipelineSent);
+  while (!g_queue_is_empty(dbManager->pipelineResults))
+    PQclear(g_queue_pop_head(dbManager->pipelineResults));
+  g_queue_free(dbManager->pipelineResults);
   g_hash_table_unref(dbManager->cachedPrepared);
   if (dbManager->dbConf)
     free(dbManager->dbConf);
@@ -248,12 +422,17 @@ void fo_dbManager_free(fo_dbManager* dbManager)
 /**
  * \brief Finish a connection on fo_dbManager
  *
+ * A DB manager forked from a pool is given back to the pool, else
  * -# Call PQfinish()
  * -# Free the DB manager using fo_dbManager_free()
  * \param dbManager DB manager
+ * \sa fo_dbManager_setPoolSize()
  */
 void fo_dbManager_finish(fo_dbManager* dbManager)
 {
+  if (pool_giveBack(dbManager))
+    return;
+
   PQfinish(dbManager->dbConnection);
   fo_dbManager_free(dbManager);
 }
@@ -661,6 +840,379 @@ PGresult* fo_dbManager_ExecPreparedv(fo_dbManager_PreparedStatement* preparedSta
   return result;
 }
 
+#ifdef LIBPQ_HAS_PIPELINING
+/**
+ * \brief Check the result of a statement executed in a pipeline
+ * \param preparedStatement Prepared statement sent in the pipeline
+ * \param result            Result read from the connection
+ * \return Result on success; NULL otherwise
+ */
+static PGresult* pipeline_checkResult(fo_dbManager_PreparedStatement* preparedStatement, PGresult* result)
+{
+  fo_dbManager* dbManager = preparedStatement->dbManager;
+  char* printedStatement;
+
+  if (!result)
+  {
+    printedStatement = fo_dbManager_printStatement(preparedStatement);
+    LOG_FATAL("%sExecuting prepared '%s' in pipeline\n",
+      PQerrorMessage(dbManager->dbConnection),
+      printedStatement);
+    g_free(printedStatement);
+  } else if (PQresultStatus(result) == PGRES_FATAL_ERROR)
+  {
+    printedStatement = fo_dbManager_printStatement(preparedStatement);
+    LOG_ERROR("%sExecuting prepared '%s' in pipeline\n",
+      PQresultErrorMessage(result),
+      printedStatement);
+    g_free(printedStatement);
+    PQclear(result);
+    result = NULL;
+  } else if (PQresultStatus(result) == PGRES_PIPELINE_ABORTED)
+  {
+    printedStatement = fo_dbManager_printStatement(preparedStatement);
+    LOG_ERROR("Skipped prepared '%s' in pipeline after a previous error\n",
+      printedStatement);
+    g_free(printedStatement);
+    PQclear(result);
+    result = NULL;
+  }
+
+  return result;
+}
+
+/**
+ * \brief Read the results of all the statements sent in a pipeline
+ *
+ * Sends a synchronization point and reads the results up to it, in the order
+ * the statements were sent.
+ * \param dbManager DB manager in pipeline mode
+ */
+static void pipeline_readResults(fo_dbManager* dbManager)
+{
+  PGconn* dbConnection = dbManager->dbConnection;
+  fo_dbManager_PreparedStatement* preparedStatement;
+  PGresult* result;
+
+  if (g_queue_is_empty(dbManager->pipelineSent))
+    return;
+
+  int synced = PQpipelineSync(dbConnection);
+  if (!synced)
+  {
+    LOG_FATAL("%sSynchronizing pipeline\n", PQerrorMessage(dbConnection));
+  }
+
+  while ((preparedStatement = g_queue_pop_head(dbManager->pipelineSent)))
+  {
+    result = synced ? PQgetResult(dbConnection) : NULL;
+    if (result)
+    {
+      /* the result of each statement ends with NULL */
+      PGresult* extra;
+      while ((extra = PQgetResult(dbConnection)))
+        PQclear(extra);
+    }
+    g_queue_push_tail(dbManager->pipelineResults,
+      pipeline_checkResult(preparedStatement, result));
+  }
+
+  if (synced)
+  {
+    /* result of the synchronization point */
+    PQclear(PQgetResult(dbConnection));
+  }
+}
+#endif
+
+/**
+ * \brief Put a DB manager in pipeline mode
+ *
+ * In pipeline mode fo_dbManager_sendPrepared() sends the statements without
+ * waiting for their results, they are read later with
+ * fo_dbManager_getPipelineResult(). This saves a round trip to the server
+ * for each statement.
+ *
+ * The statements must be prepared before entering the pipeline, and no other
+ * query can be executed until fo_dbManager_exitPipeline(). The statements
+ * up to a synchronization point, sent when the results are read, run in one
+ * transaction: when a statement fails, the previous ones are rolled back and
+ * the following ones are skipped.
+ *
+ * Without pipeline support in libpq, the statements are executed when sent.
+ * \param dbManager DB manager
+ * \return 1 on success, 0 on failure
+ */
+int fo_dbManager_enterPipeline(fo_dbManager* dbManager)
+{
+  if (dbManager->pipeline)
+    return 1;
+
+#ifdef LIBPQ_HAS_PIPELINING
+  if (!PQenterPipelineMode(dbManager->dbConnection))
+  {
+    LOG_ERROR("%sEntering pipeline mode\n",
+      PQerrorMessage(dbManager->dbConnection));
+    return 0;
+  }
+#endif
+  dbManager->pipeline = 1;
+  return 1;
+}
+
+/**
+ * \brief Send a prepared statement in the pipeline
+ * \param preparedStatement Prepared statement
+ * \return 1 if the statement was sent, 0 otherwise
+ * \sa fo_dbManager_sendPreparedv()
+ */
+int fo_dbManager_sendPrepared(fo_dbManager_PreparedStatement* preparedStatement, ...)
+{
+  if (!preparedStatement)
+  {
+    return 0;
+  }
+  va_list vars;
+  va_start(vars, preparedStatement);
+  int result = fo_dbManager_sendPreparedv(preparedStatement, vars);
+  va_end(vars);
+
+  return result;
+}
+
+/**
+ * \brief Send a prepared statement in the pipeline
+ *
+ * The result of the statement is returned by
+ * fo_dbManager_getPipelineResult(). Outside of pipeline mode the statement
+ * is executed immediately and its result is returned in the same way.
+ * \param preparedStatement Prepared statement
+ * \param args              Values for the parameter placeholders
+ * \return 1 if the statement was sent, 0 otherwise
+ * \sa fo_dbManager_enterPipeline()
+ */
+int fo_dbManager_sendPreparedv(fo_dbManager_PreparedStatement* preparedStatement, va_list args)
+{
+  if (!preparedStatement)
+  {
+    return 0;
+  }
+
+  fo_dbManager* dbManager = preparedStatement->dbManager;
+
+#ifdef LIBPQ_HAS_PIPELINING
+  if (dbManager->pipeline)
+  {
+    PGconn* dbConnection = dbManager->dbConnection;
+
+    /* do not let the results pile up on the server */
+    if (g_queue_get_length(dbManager->pipelineSent) >= PIPELINE_MAX_SENT)
+      pipeline_readResults(dbManager);
+
+    char** parameters = buildStringArray(preparedStatement->paramc, preparedStatement->params, args);
+    int sent = PQsendQueryPrepared(dbConnection,
+      preparedStatement->name,
+      preparedStatement->paramc,
+      (const char* const*) parameters,
+      NULL,
+      NULL,
+      0);
+
+    if (sent)
+    {
+      g_queue_push_tail(dbManager->pipelineSent, preparedStatement);
+    } else
+    {
+      char* printedStatement = fo_dbManager_printStatement(preparedStatement);
+      char* params = array_print(parameters, preparedStatement->paramc);
+      LOG_FATAL("%sSending prepared '%s' with params %s\n",
+        PQerrorMessage(dbConnection),
+        printedStatement,
+        params);
+      g_free(printedStatement);
+      g_free(params);
+    }
+
+    array_free(parameters, preparedStatement->paramc);
+    return sent;
+  }
+#endif
+
+  g_queue_push_tail(dbManager->pipelineResults,
+    fo_dbManager_ExecPreparedv(preparedStatement, args));
+  return 1;
+}
+
+/**
+ * \brief Get the result of the next statement sent in the pipeline
+ *
+ * The results are returned in the order the statements were sent.
+ * \param dbManager DB manager
+ * \return Result of the statement, to be freed with PQclear(); NULL if the
+ * statement failed or if there is no result left
+ * \sa fo_dbManager_pipelinePending()
+ */
+PGresult* fo_dbManager_getPipelineResult(fo_dbManager* dbManager)
+{
+#ifdef LIBPQ_HAS_PIPELINING
+  if (g_queue_is_empty(dbManager->pipelineResults))
+    pipeline_readResults(dbManager);
+#endif
+
+  return g_queue_pop_head(dbManager->pipelineResults);
+}
+
+/**
+ * \brief Get the number of results not returned yet
+ * \param dbManager DB manager
+ * \return Number of statements sent whose result was not returned by
+ * fo_dbManager_getPipelineResult()
+ */
+int fo_dbManager_pipelinePending(fo_dbManager* dbManager)
+{
+  return g_queue_get_length(dbManager->pipelineSent)
+    + g_queue_get_length(dbManager->pipelineResults);
+}
+
+/**
+ * \brief Leave pipeline mode
+ *
+ * The results not returned yet are discarded.
+ * \param dbManager DB manager
+ * \return 1 on success, 0 on failure
+ */
+int fo_dbManager_exitPipeline(fo_dbManager* dbManager)
+{
+  while (fo_dbManager_pipelinePending(dbManager) > 0)
+    PQclear(fo_dbManager_getPipelineResult(dbManager));
+
+  if (!dbManager->pipeline)
+    return 1;
+
+#ifdef LIBPQ_HAS_PIPELINING
+  if (!PQexitPipelineMode(dbManager->dbConnection))
+  {
+    LOG_ERROR("%sLeaving pipeline mode\n",
+      PQerrorMessage(dbManager->dbConnection));
+    return 0;
+  }
+#endif
+  dbManager->pipeline = 0;
+  return 1;
+}
+
+/**
+ * \brief Execute a prepared statement, returning its rows while they arrive
+ *
+ * The rows are read with fo_dbManager_streamNext(), the first ones are
+ * available before the server has found the others and the whole result is
+ * never held in memory. No other query can be executed on the connection
+ * until all the rows are read.
+ *
+ * In binary format, the integer columns are returned in network byte order
+ * instead of text (see PQfformat()).
+ * \param preparedStatement Prepared statement
+ * \param binary            Set to get the result in binary format
+ * \return 1 if the statement was sent, 0 otherwise
+ * \sa fo_dbManager_streamPreparedv()
+ */
+int fo_dbManager_streamPrepared(fo_dbManager_PreparedStatement* preparedStatement, int binary, ...)
+{
+  if (!preparedStatement)
+  {
+    return 0;
+  }
+  va_list vars;
+  va_start(vars, binary);
+  int result = fo_dbManager_streamPreparedv(preparedStatement, binary, vars);
+  va_end(vars);
+
+  return result;
+}
+
+/**
+ * \brief Execute a prepared statement, returning its rows while they arrive
+ * \param preparedStatement Prepared statement
+ * \param binary            Set to get the result in binary format
+ * \param args              Values for the parameter placeholders
+ * \return 1 if the statement was sent, 0 otherwise
+ * \sa fo_dbManager_streamPrepared()
+ */
+int fo_dbManager_streamPreparedv(fo_dbManager_PreparedStatement* preparedStatement, int binary, va_list args)
+{
+  if (!preparedStatement)
+  {
+    return 0;
+  }
+
+  fo_dbManager* dbManager = preparedStatement->dbManager;
+  PGconn* dbConnection = dbManager->dbConnection;
+
+  char** parameters = buildStringArray(preparedStatement->paramc, preparedStatement->params, args);
+  int sent = PQsendQueryPrepared(dbConnection,
+    preparedStatement->name,
+    preparedStatement->paramc,
+    (const char* const*) parameters,
+    NULL,
+    NULL,
+    binary ? 1 : 0);
+
+  if (sent)
+  {
+    PQsetSingleRowMode(dbConnection);
+  } else
+  {
+    char* printedStatement = fo_dbManager_printStatement(preparedStatement);
+    char* params = array_print(parameters, preparedStatement->paramc);
+    LOG_FATAL("%sStreaming prepared '%s' with params %s\n",
+      PQerrorMessage(dbConnection),
+      printedStatement,
+      params);
+    g_free(printedStatement);
+    g_free(params);
+  }
+
+  array_free(parameters, preparedStatement->paramc);
+  return sent;
+}
+
+/**
+ * \brief Get the next rows of a statement executed with
+ * fo_dbManager_streamPrepared()
+ *
+ * On error, the remaining rows are discarded.
+ * \param dbManager DB manager executing the statement
+ * \param[out] rows Result with the next rows, to be freed with PQclear()
+ * \return 1 if rows were returned, 0 if all the rows were read, -1 on error
+ */
+int fo_dbManager_streamNext(fo_dbManager* dbManager, PGresult** rows)
+{
+  PGconn* dbConnection = dbManager->dbConnection;
+  PGresult* result = PQgetResult(dbConnection);
+  int status = 0;
+
+  *rows = NULL;
+  if (result && PQresultStatus(result) == PGRES_SINGLE_TUPLE)
+  {
+    *rows = result;
+    return 1;
+  }
+
+  if (result && PQresultStatus(result) != PGRES_TUPLES_OK)
+  {
+    LOG_ERROR("%sStreaming rows\n", PQresultErrorMessage(result));
+    status = -1;
+  }
+
+  /* discard the end of the result */
+  while (result)
+  {
+    PQclear(result);
+    result = PQgetResult(dbConnection);
+  }
+  return status;
+}
+
 /**
  * \brief Compare two strings ignoring consecutive spaces in b
  * \param a       First string
@@ -30,6 +30,7 @@ fo_dbManager* fo_dbManager_new(PGconn* dbConnection);
 fo_dbManager* fo_dbManager_new_withConf(PGconn* dbConnection, const char* dbConf);
 PGconn* fo_dbManager_getWrappedConnection(fo_dbManager* dbManager);
 fo_dbManager* fo_dbManager_fork(fo_dbManager* dbManager);
+void fo_dbManager_setPoolSize(fo_dbManager* dbManager, int poolSize);
 void fo_dbManager_free(fo_dbManager* dbManager);
 void fo_dbManager_finish(fo_dbManager* dbManager);
 int fo_dbManager_setLogFile(fo_dbManager* dbManager, const char* logFileName);
@@ -85,6 +86,17 @@ fo_dbManager_PreparedStatement* fo_dbManager_PrepareStamement_str(fo_dbManager*
 PGresult* fo_dbManager_ExecPrepared(fo_dbManager_PreparedStatement* preparedStatement, ...);
 PGresult* fo_dbManager_ExecPreparedv(fo_dbManager_PreparedStatement* preparedStatement, va_list args);
 
+int fo_dbManager_enterPipeline(fo_dbManager* dbManager);
+int fo_dbManager_sendPrepared(fo_dbManager_PreparedStatement* preparedStatement, ...);
+int fo_dbManager_sendPreparedv(fo_dbManager_PreparedStatement* preparedStatement, va_list args);
+PGresult* fo_dbManager_getPipelineResult(fo_dbManager* dbManager);
+int fo_dbManager_pipelinePending(fo_dbManager* dbManager);
+int fo_dbManager_exitPipeline(fo_dbManager* dbManager);
+
+int fo_dbManager_streamPrepared(fo_dbManager_PreparedStatement* preparedStatement, int binary, ...);
+int fo_dbManager_streamPreparedv(fo_dbManager_PreparedStatement* preparedStatement, int binary, va_list args);
+int fo_dbManager_streamNext(fo_dbManager* dbManager, PGresult** rows);
+
 int fo_dbManager_tableExists(fo_dbManager* dbManager, const char* tableName);
 int fo_dbManager_exists(fo_dbManager* dbManager, const char* type, const char* name);
 
@@ -156,65 +156,218 @@ int fo_RepHostExist(char* Type, char* Host)
 } /* fo_RepHostExist() */
 
 /*!
- \brief Determine the host for the tree.
+ \brief A line of the REPOSITORY configuration.
 
- \note This is an internal only function.
+ The files of a type whose names are between Start and End are stored on Host.
+ */
+typedef struct
+{
+  char* Host;      ///< Host storing the files
+  char* Type;      ///< Type of the files, "*" for all types
+  char* Start;     ///< Beginning of the range of names
+  char* End;       ///< End of the range of names
+  size_t StartLen; ///< Length of Start
+  size_t EndLen;   ///< Length of End
+} RepRange;
 
- \param Type Type of data.
- \param Filename Filename to match.
- \param MatchNum Used to identify WHICH match to return.
-        (MatchNum permits fallback paths.)
+/*!
+ \brief The ranges of the REPOSITORY configuration, in the order of the hosts
+ and of their lines.
+ */
+typedef struct
+{
+  RepRange* Ranges; ///< The ranges
+  int Count;        ///< Number of ranges
+} RepRangeTable;
+
+/** Ranges loaded from the configuration, NULL until first used */
+static RepRangeTable* RepRanges = NULL;
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+static GMutex RepRangesLock;  ///< Lock to load RepRanges
+#else
+static GStaticMutex RepRangesLock = G_STATIC_MUTEX_INIT;  ///< Lock to load RepRanges
+#endif
 
- \return Allocates and returns string with hostname or NULL.
+/*!
+ \note This is an internal function.
+
+ \brief Free a table of ranges.
+ \param Table The table to free
  */
-char* _RepGetHost(const char* Type, char* Filename, int MatchNum)
+static void _RepFreeRanges(RepRangeTable* Table)
+{
+  int i;
+  if (!Table) return;
+  for (i = 0; i < Table->Count; i++)
+  {
+    g_free(Table->Ranges[i].Host);
+    g_free(Table->Ranges[i].Type);
+    g_free(Table->Ranges[i].Start);
+    g_free(Table->Ranges[i].End);
+  }
+  g_free(Table->Ranges);
+  g_free(Table);
+} /* _RepFreeRanges() */
+
+/*!
+ \note This is an internal function.
+
+ \brief Read the REPOSITORY configuration into a table of ranges.
+
+ Each line of a host is "type start end". Lines without start or end are
+ ignored.
+ \return Allocates and returns the table.
+ */
+static RepRangeTable* _RepLoadRanges()
 {
+  RepRangeTable* Table;
   char** hosts;
   char* entry;
+  char* remainder;
+  char* type;
   char* start;
   char* end;
-  char* ret = NULL;
-  int Match = 0;
   int i, j, kl, hl;
   GError* error = NULL;
 
-  REPCONFCHECK();
-  if (!_RepCheckType(Type) || !_RepCheckString(Filename))
-    return (NULL);
-
+  Table = g_new0(RepRangeTable, 1);
   hosts = fo_config_key_set(sysconfig, REPONAME, &kl);
   for (i = 0; i < kl; i++)
   {
     hl = fo_config_list_length(sysconfig, REPONAME, hosts[i], &error);
+    if (error)
+    {
+      g_clear_error(&error);
+      continue;
+    }
+    Table->Ranges = g_renew(RepRange, Table->Ranges, Table->Count + hl);
     for (j = 0; j < hl; j++)
     {
       entry = fo_config_get_list(sysconfig, REPONAME, hosts[i], j, &error);
-      char* remainder = NULL;
-      strtok_r(entry, " ", &remainder);
+      if (!entry)
+      {
+        g_clear_error(&error);
+        continue;
+      }
+      remainder = NULL;
+      type = strtok_r(entry, " ", &remainder);
       start = strtok_r(NULL, " ", &remainder);
       end = strtok_r(NULL, " ", &remainder);
-
-      if (strcmp(entry, "*") == 0 || strcmp(entry, Type) == 0)
+      if (type && start && end)
       {
-        if ((strncasecmp(start, Filename, strlen(start)) <= 0) &&
-          (strncasecmp(end, Filename, strlen(end)) >= 0))
-        {
-          Match++;
-          if (Match == MatchNum)
-          {
-            ret = (char*) calloc(strlen(hosts[i]) + 1, sizeof(char));
-            strcpy(ret, hosts[i]);
-            g_free(entry);
-            return ret;
-          }
-        }
+        RepRange* Range = &Table->Ranges[Table->Count++];
+        Range->Host = g_strdup(hosts[i]);
+        Range->Type = g_strdup(type);
+        Range->Start = g_strdup(start);
+        Range->End = g_strdup(end);
+        Range->StartLen = strlen(Range->Start);
+        Range->EndLen = strlen(Range->End);
       }
-
       g_free(entry);
     }
   }
 
+  return Table;
+} /* _RepLoadRanges() */
+
+/*!
+ \note This is an internal function.
+
+ \brief Get the ranges of the REPOSITORY configuration.
+
+ The configuration is read only once, the following calls return the same
+ table without locking. The table is freed by fo_RepClose().
+ \return The table of ranges.
+ */
+static RepRangeTable* _RepGetRanges()
+{
+  RepRangeTable* Table = g_atomic_pointer_get(&RepRanges);
+  if (Table) return Table;
+
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+  g_mutex_lock(&RepRangesLock);
+#else
+  g_static_mutex_lock(&RepRangesLock);
+#endif
+  Table = RepRanges;
+  if (!Table)
+  {
+    REPCONFCHECK();
+    Table = _RepLoadRanges();
+    g_atomic_pointer_set(&RepRanges, Table);
+  }
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+  g_mutex_unlock(&RepRangesLock);
+#else
+  g_static_mutex_unlock(&RepRangesLock);
+#endif
+  return Table;
+} /* _RepGetRanges() */
+
+/*!
+ \note This is an internal function.
+
+ \brief Find the range of the host for the tree.
+
+ \param Type Type of data.
+ \param Filename Filename to match.
+ \param MatchNum Used to identify WHICH match to return.
+        (MatchNum permits fallback paths.)
+
+ \return The range of the MatchNum-th host storing the file, or NULL.
+ */
+static RepRange* _RepFindRange(const char* Type, char* Filename, int MatchNum)
+{
+  RepRangeTable* Table;
+  RepRange* Range;
+  int Match = 0;
+  int i;
+
+  Table = _RepGetRanges();
+  for (i = 0; i < Table->Count; i++)
+  {
+    Range = &Table->Ranges[i];
+    if (strcmp(Range->Type, "*") == 0 || strcmp(Range->Type, Type) == 0)
+    {
+      if ((strncasecmp(Range->Start, Filename, Range->StartLen) <= 0) &&
+        (strncasecmp(Range->End, Filename, Range->EndLen) >= 0))
+      {
+        Match++;
+        if (Match == MatchNum) return Range;
+      }
+    }
+  }
+
   return NULL;
+} /* _RepFindRange() */
+
+/*!
+ \brief Determine the host for the tree.
+
+ \note This is an internal only function.
+
+ \param Type Type of data.
+ \param Filename Filename to match.
+ \param MatchNum Used to identify WHICH match to return.
+        (MatchNum permits fallback paths.)
+
+ \return Allocates and returns string with hostname or NULL.
+ */
+char* _RepGetHost(const char* Type, char* Filename, int MatchNum)
+{
+  RepRange* Range;
+  char* ret;
+
+  if (!_RepCheckType(Type) || !_RepCheckString(Filename))
+    return (NULL);
+
+  Range = _RepFindRange(Type, Filename, MatchNum);
+  if (!Range)
+    return NULL;
+
+  ret = (char*) calloc(strlen(Range->Host) + 1, sizeof(char));
+  strcpy(ret, Range->Host);
+  return ret;
 } /* _RepGetHost() */
 
 /*!
@@ -358,6 +511,7 @@ char* fo_RepMkPathTmp(const char* Type, char* Filename, char* Ext, int Which)
  This does NOT make the actual file or modify the file system!
  \note Caller must free the string!
  \note This scans for alternate file locations, in case the file exists.
+ \note This can be called from several threads at the same time.
 
  \return Allocates and returns a string.
  */
@@ -369,6 +523,9 @@ char* fo_RepMkPath(const char* Type, char* Filename)
 
   Path = fo_RepMkPathTmp(Type, Filename, NULL, 1);
   if (!Path) return (NULL);
+  /* without alternate path, the path is the same whether it exists or not */
+  if (!_RepFindRange(Type, Filename, 2))
+  {return (Path);}
   /* if something exists, then return it! */
   if (!stat(Path, &Stat))
   {return (Path);}
@@ -392,6 +549,31 @@ char* fo_RepMkPath(const char* Type, char* Filename)
   return (Path);
 } /* fo_RepMkPath() */
 
+/*!
+ \brief Given filenames, construct the full paths to the files.
+
+ Same as calling fo_RepMkPath() for each file.
+ \param Type Type of data.
+ \param Filenames Filenames to construct
+ \param Count Number of filenames
+ \param[out] Paths Array of Count paths, set to the path of each file or to
+        NULL on error.
+ \note Caller must free each path!
+ \return Number of paths constructed.
+ */
+int fo_RepMkPaths(const char* Type, char** Filenames, int Count, char** Paths)
+{
+  int i;
+  int Made = 0;
+
+  for (i = 0; i < Count; i++)
+  {
+    Paths[i] = fo_RepMkPath(Type, Filenames[i]);
+    if (Paths[i]) Made++;
+  }
+  return (Made);
+} /* fo_RepMkPaths() */
+
 /*!
  \brief Update the last modified time of a file.
 
@@ -905,6 +1087,8 @@ int fo_RepImport(char* Source, char* Type, char* Filename, int Link)
  */
 void fo_RepClose()
 {
+  _RepFreeRanges(RepRanges);
+  g_atomic_pointer_set(&RepRanges, NULL);
   RepDepth = 2; /* default depth */
   memset(RepPath, '\0', sizeof(RepPath));
   RepPath[0] = '.'; /* default to local directory */
@@ -78,6 +78,7 @@ char* fo_RepGetRepPath();
 /* path to mounted repository */
 char* fo_RepGetHost(char* Type, char* Filename);
 char* fo_RepMkPath(const char* Type, char* Filename);
+int fo_RepMkPaths(const char* Type, char** Filenames, int Count, char** Paths);
 
 /* Not intended for external use */
 int _RepMkDirs(char* Filename);
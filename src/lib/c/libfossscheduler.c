@@ -156,6 +156,10 @@ void fo_check_agentdb(PGconn* db_conn)
 * @brief This function must be called by agents to let the scheduler know they
 * are alive and how many items they have processed.
 *
+* The scheduler keeps the items processed and the time between the heartbeats
+* in its metrics, so calling this regularly also shows the throughput of the
+* agent.
+*
 * @param i   This is the number of itmes processed since the last call to
 * fo_scheduler_heart()
 *
@@ -404,6 +408,10 @@ void fo_scheduler_disconnect(int retcode)
 *     - a new line must be received, perform same task (i.e. recursive call)
 *   - check for "END" from scheduler, if received print OK and recurse
 *     - this is used to simplify communications within the scheduler
+*   - check for "RESET" from scheduler
+*     - the scheduler reuses this agent for a new job, the job id, user id and
+*       group id are replaced with the ones that follow the command
+*     - print OK and recurse, the next thing received belongs to the new job
 *   - return whatever has been received
 *
 * @return char* for the next thing to analyze, NULL if there is nothing
@@ -434,6 +442,16 @@ char* fo_scheduler_next()
       valid = 0;
       continue;
     }
+    else if (strncmp(buffer, "RESET", 5) == 0)
+    {
+      sscanf(&buffer[6], "%d %d %d", &jobId, &userID, &groupID);
+      g_atomic_int_set(&items_processed, 0);
+      fprintf(stdout, "\nOK\n");
+      fflush(stdout);
+      fflush(stderr);
+      valid = 0;
+      continue;
+    }
     else if (strncmp(buffer, "VERSION", 7) == 0)
     {
       if (fo_config_has_key(sysconfig, module_name, "VERSION"))
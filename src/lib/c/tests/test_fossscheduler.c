@@ -164,6 +164,26 @@ void signal_connect_version()
   write_con("CLOSE\n");
 }
 
+/**
+* @brief Serves the same purpose for the reset command as the
+*        signal_connect_end() function does for the end command
+*
+* @test
+* -# Read the `OK` from the scheduler connection
+* -# Check that the job context was replaced
+*/
+void signal_connect_reset()
+{
+  FO_ASSERT_FALSE(valid);
+  FO_ASSERT_STRING_EQUAL(fgets(buffer, sizeof(buffer), read_from), "OK\n");
+  FO_ASSERT_EQUAL(fo_scheduler_jobId(), 5);
+  FO_ASSERT_EQUAL(fo_scheduler_userID(), 3);
+  FO_ASSERT_EQUAL(fo_scheduler_groupID(), 2);
+  FO_ASSERT_EQUAL(items_processed, 0);
+
+  write_con("CLOSE\n");
+}
+
 /* ************************************************************************** */
 /* *** tests **************************************************************** */
 /* ************************************************************************** */
@@ -317,6 +337,27 @@ void test_scheduler_next_version()
   FO_ASSERT_FALSE(valid);
 }
 
+/**
+* @brief Tests sending `"RESET # # #\n"` to the stdin for the scheduler next
+* function
+* @test
+* -# Send `RESET # # #\n` to the scheduler
+* -# Send a `SIGALRM`
+* -# Call fo_scheduler_next().
+* -# Check if NULL is returned.
+* @return void
+*/
+void test_scheduler_next_reset()
+{
+  write_con("RESET 5 3 2\n");
+
+  signal(SIGALRM, signal_connect_reset);
+  ualarm(10, 0);
+
+  FO_ASSERT_PTR_NULL(fo_scheduler_next());
+  FO_ASSERT_FALSE(valid);
+}
+
 /**
 * @brief Tests scheduler for non commands.
 * @test
@@ -412,6 +453,7 @@ CU_TestInfo fossscheduler_testcases[] =
     {"fossscheduler next end", test_scheduler_next_end},
     {"fossscheduler next verbose", test_scheduler_next_verbose},
     {"fossscheduler next version", test_scheduler_next_version},
+    {"fossscheduler next reset", test_scheduler_next_reset},
     {"fossscheduler next oth", test_scheduler_next_oth},
     {"fossscheduler current", test_scheduler_current},
     {"fossscheduler disconnect", test_scheduler_disconnect},
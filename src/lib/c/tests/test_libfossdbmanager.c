@@ -26,6 +26,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <libfossdb.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <arpa/inet.h>
 
 /* cunit includes */
 #include <CUnit/CUnit.h>
@@ -590,6 +591,135 @@ void test_fork()
   PQfinish(pgConn);
 }
 
+void test_fork_pool()
+{
+  PGconn* pgConn;
+  char* ErrorBuf;
+
+  pgConn = fo_dbconnect(dbConf, &ErrorBuf);
+  fo_dbManager* dbManager0 = fo_dbManager_new_withConf(pgConn, dbConf);
+  fo_dbManager_setPoolSize(dbManager0, 1);
+
+  fo_dbManager* dbManager1 = fo_dbManager_fork(dbManager0);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(dbManager1);
+  fo_dbManager_PreparedStatement* stmt1 = fo_dbManager_PrepareStamement(
+    dbManager1, "testforkpool", "SELECT 1");
+  fo_dbManager_finish(dbManager1);
+
+  /* the idle instance is reused with its prepared statements */
+  fo_dbManager* dbManager2 = fo_dbManager_fork(dbManager0);
+  CU_ASSERT_PTR_EQUAL(dbManager2, dbManager1);
+  CU_ASSERT_PTR_EQUAL(fo_dbManager_PrepareStamement(
+    dbManager2, "testforkpool", "SELECT 1"), stmt1);
+
+  /* only one idle instance is kept */
+  fo_dbManager* dbManager3 = fo_dbManager_fork(dbManager0);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(dbManager3);
+  CU_ASSERT_NOT_EQUAL(dbManager3, dbManager2);
+  fo_dbManager_finish(dbManager2);
+  fo_dbManager_finish(dbManager3);
+
+  /* an instance inside a transaction is not kept */
+  fo_dbManager* dbManager4 = fo_dbManager_fork(dbManager0);
+  CU_ASSERT_PTR_EQUAL(dbManager4, dbManager2);
+  int backend4 = PQbackendPID(fo_dbManager_getWrappedConnection(dbManager4));
+  fo_dbManager_begin(dbManager4);
+  fo_dbManager_finish(dbManager4);
+  fo_dbManager* dbManager5 = fo_dbManager_fork(dbManager0);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(dbManager5);
+  CU_ASSERT_NOT_EQUAL(PQbackendPID(fo_dbManager_getWrappedConnection(dbManager5)), backend4);
+  fo_dbManager_finish(dbManager5);
+
+  fo_dbManager_finish(dbManager0);
+}
+
+void test_stream()
+{
+  PGconn* pgConn;
+  char* ErrorBuf;
+
+  pgConn = fo_dbconnect(dbConf, &ErrorBuf);
+  fo_dbManager* dbManager = fo_dbManager_new(pgConn);
+
+  char* testTableName = TESTTABLE;
+  if (_getTestTable(dbManager, &testTableName, "a int, b bigint"))
+  {
+    PGresult* rows;
+    int status;
+
+    PGresult* insert = fo_dbManager_Exec_printf(dbManager,
+      "INSERT INTO %s (a,b) SELECT i, i * 2 FROM generate_series(1, 50) i",
+      testTableName);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(insert);
+    PQclear(insert);
+
+    char* querySelect = g_strdup_printf(
+      "SELECT a,b FROM %s WHERE a > $1 ORDER BY a", testTableName);
+    fo_dbManager_PreparedStatement* stmtSelect = fo_dbManager_PrepareStamement(
+      dbManager,
+      "teststream:select",
+      querySelect,
+      int
+    );
+    char* queryFail = g_strdup_printf(
+      "SELECT 1 / (a - 20) FROM %s ORDER BY a", testTableName);
+    fo_dbManager_PreparedStatement* stmtFail = fo_dbManager_PrepareStamement(
+      dbManager,
+      "teststream:fail",
+      queryFail
+    );
+
+    /* the rows arrive one at a time, integers in network byte order */
+    CU_ASSERT_TRUE_FATAL(fo_dbManager_streamPrepared(stmtSelect, 1, 10));
+    int expected = 11;
+    while ((status = fo_dbManager_streamNext(dbManager, &rows)) > 0)
+    {
+      CU_ASSERT_EQUAL(PQntuples(rows), 1);
+      CU_ASSERT_EQUAL(PQfformat(rows, 0), 1);
+      CU_ASSERT_EQUAL(ntohl(*((uint32_t*) PQgetvalue(rows, 0, 0))), expected);
+      expected++;
+      PQclear(rows);
+    }
+    CU_ASSERT_EQUAL(status, 0);
+    CU_ASSERT_PTR_NULL(rows);
+    CU_ASSERT_EQUAL(expected, 51);
+
+    CU_ASSERT_TRUE_FATAL(fo_dbManager_streamPrepared(stmtSelect, 0, 48));
+    CU_ASSERT_EQUAL(fo_dbManager_streamNext(dbManager, &rows), 1);
+    CU_ASSERT_STRING_EQUAL(PQgetvalue(rows, 0, 1), "98");
+    PQclear(rows);
+    CU_ASSERT_EQUAL(fo_dbManager_streamNext(dbManager, &rows), 1);
+    PQclear(rows);
+    CU_ASSERT_EQUAL(fo_dbManager_streamNext(dbManager, &rows), 0);
+
+    /* the statement can fail after some rows were returned */
+    CU_ASSERT_TRUE_FATAL(fo_dbManager_streamPrepared(stmtFail, 0));
+    int count = 0;
+    printf("expecting an error\n-----\n");
+    while ((status = fo_dbManager_streamNext(dbManager, &rows)) > 0)
+    {
+      count++;
+      PQclear(rows);
+    }
+    printf("-----\n");
+    CU_ASSERT_EQUAL(status, -1);
+    CU_ASSERT_TRUE(count < 20);
+
+    /* the connection can be used again */
+    PGresult* drop = fo_dbManager_Exec_printf(dbManager, "DROP TABLE %s", testTableName);
+    CU_ASSERT_PTR_NOT_NULL(drop);
+    PQclear(drop);
+
+    g_free(querySelect);
+    g_free(queryFail);
+  } else
+  {
+    CU_FAIL("could not get test table");
+  }
+
+  fo_dbManager_finish(dbManager);
+}
+
 void _test_wrongQueries_runner(char* (* test)(fo_dbManager**, const char*), int testNumber)
 {
   PGconn* pgConn;
@@ -962,5 +1092,7 @@ CU_TestInfo libfossdbmanager_testcases[] =
 //    { "performance test", test_perf },
     {"fork dbManager", test_fork},
     {"fork dbManager without configuration", test_fork_error},
+    {"fork dbManager from a pool", test_fork_pool},
+    {"stream the rows of a statement", test_stream},
     CU_TEST_INFO_NULL
   };
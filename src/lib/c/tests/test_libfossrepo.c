@@ -0,0 +1,204 @@
+/*********************************************************************
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*********************************************************************/
+
+/**
+* @file
+* @brief Unit tests for the repository path functions of libfossology.
+*/
+
+/* includes for files that will be tested */
+#include <libfossrepo.h>
+#include <libfossscheduler.h>
+
+/* library includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+/* cunit includes */
+#include <libfocunit.h>
+
+/* ************************************************************************** */
+/* *** declaration of private members *************************************** */
+/* ************************************************************************** */
+
+#define CONF_FILE "confdata/repo.conf"
+#define REPO_PATH "repo_test"
+
+/** File stored only on the second host of its range */
+#define ALT_FILE  "abcdef"
+#define ALT_DIR   REPO_PATH "/beta/files/ab/cd"
+#define ALT_PATH  ALT_DIR "/" ALT_FILE
+
+static fo_conf* test_conf;
+static fo_conf* saved_sysconfig;
+
+/**
+* @brief Use the test configuration as the system configuration.
+*/
+static void repo_setup()
+{
+  GError* error = NULL;
+
+  test_conf = fo_config_load(CONF_FILE, &error);
+  if (error)
+  {
+    FO_FAIL_FATAL("can't load repository configuration, aborting");
+  }
+  saved_sysconfig = sysconfig;
+  sysconfig = test_conf;
+  FO_ASSERT_TRUE_FATAL(fo_RepOpenFull(test_conf));
+}
+
+/**
+* @brief Restore the system configuration.
+*/
+static void repo_teardown()
+{
+  fo_RepClose();
+  sysconfig = saved_sysconfig;
+  fo_config_free(test_conf);
+}
+
+/* ************************************************************************** */
+/* *** tests **************************************************************** */
+/* ************************************************************************** */
+
+/**
+* @brief Test the host selected for a file.
+*
+* @test
+* -# Get the host of files in ranges of one or more hosts
+* -# Check that the first host of the configuration in range is selected
+* -# Check that the type of the range is respected
+* -# Check that there is no host for files out of every range
+*/
+void test_fo_RepGetHost()
+{
+  char* host;
+
+  repo_setup();
+
+  host = fo_RepGetHost("files", "0123456789");
+  FO_ASSERT_STRING_EQUAL(host, "alpha");
+  free(host);
+
+  host = fo_RepGetHost("files", "ABCDEF");
+  FO_ASSERT_STRING_EQUAL(host, "alpha");
+  free(host);
+
+  host = fo_RepGetHost("gold", "2345");
+  FO_ASSERT_STRING_EQUAL(host, "alpha");
+  free(host);
+
+  host = fo_RepGetHost("gold", "90ab");
+  FO_ASSERT_PTR_NULL(host);
+
+  host = fo_RepGetHost("ununpack", "abcd");
+  FO_ASSERT_PTR_NULL(host);
+
+  repo_teardown();
+}
+
+/**
+* @brief Test the path of a file in the repository.
+*
+* @test
+* -# Make the path of files with and without an alternate host
+* -# Check that the path is on the first host when the file does not exist
+* -# Store a file on the alternate host
+* -# Check that the path is on the alternate host
+*/
+void test_fo_RepMkPath()
+{
+  char* path;
+
+  repo_setup();
+
+  path = fo_RepMkPath("gold", "2345");
+  FO_ASSERT_STRING_EQUAL(path, REPO_PATH "/alpha/gold/23/45/2345");
+  free(path);
+
+  path = fo_RepMkPath("gold", "90ab");
+  FO_ASSERT_STRING_EQUAL(path, REPO_PATH "/gold/90/ab/90ab");
+  free(path);
+
+  path = fo_RepMkPath("files", ALT_FILE);
+  FO_ASSERT_STRING_EQUAL(path, REPO_PATH "/alpha/files/ab/cd/" ALT_FILE);
+  free(path);
+
+  FO_ASSERT_EQUAL_FATAL(g_mkdir_with_parents(ALT_DIR, 0770), 0);
+  FO_ASSERT_TRUE_FATAL(g_file_set_contents(ALT_PATH, "", 0, NULL));
+
+  path = fo_RepMkPath("files", ALT_FILE);
+  FO_ASSERT_STRING_EQUAL(path, ALT_PATH);
+  free(path);
+
+  g_remove(ALT_PATH);
+  g_rmdir(ALT_DIR);
+  g_rmdir(REPO_PATH "/beta/files/ab");
+  g_rmdir(REPO_PATH "/beta/files");
+  g_rmdir(REPO_PATH "/beta");
+  g_rmdir(REPO_PATH);
+
+  repo_teardown();
+}
+
+/**
+* @brief Test the paths of several files.
+*
+* @test
+* -# Make the paths of valid and invalid filenames
+* -# Check that the paths are the ones of fo_RepMkPath()
+* -# Check that the invalid filenames have no path and are not counted
+*/
+void test_fo_RepMkPaths()
+{
+  char* filenames[] = {"0123456789", "ABCDEF", "bad/name", "ff00"};
+  char* paths[4];
+  char* path;
+  int i;
+
+  repo_setup();
+
+  FO_ASSERT_EQUAL(fo_RepMkPaths("files", filenames, 4, paths), 3);
+  FO_ASSERT_PTR_NULL(paths[2]);
+  for (i = 0; i < 4; i++)
+  {
+    if (!paths[i])
+      continue;
+    path = fo_RepMkPath("files", filenames[i]);
+    FO_ASSERT_STRING_EQUAL(paths[i], path);
+    free(path);
+    free(paths[i]);
+  }
+
+  repo_teardown();
+}
+
+/* ************************************************************************** */
+/* *** cunit test info ****************************************************** */
+/* ************************************************************************** */
+
+CU_TestInfo libfossrepo_testcases[] =
+  {
+    {"fo_RepGetHost()", test_fo_RepGetHost},
+    {"fo_RepMkPath()", test_fo_RepMkPath},
+    {"fo_RepMkPaths()", test_fo_RepMkPaths},
+    CU_TEST_INFO_NULL
+  };
@@ -33,6 +33,7 @@ extern CU_TestInfo fossconfig_testcases[];
 extern CU_TestInfo fossscheduler_testcases[];
 extern CU_TestInfo libfossdb_testcases[];
 extern CU_TestInfo libfossdbmanager_testcases[];
+extern CU_TestInfo libfossrepo_testcases[];
 
 /**
 * array of every test suite. There should be at least one test suite for every
@@ -46,6 +47,7 @@ CU_SuiteInfo suites[] =
     {"Testing libfossdb", NULL, NULL, NULL, NULL, libfossdb_testcases},
     {"Testing fossconfig", NULL, NULL, NULL, NULL, fossconfig_testcases},
     {"Testing libfossdbmanger", NULL, NULL, NULL, NULL, libfossdbmanager_testcases},
+    {"Testing libfossrepo", NULL, NULL, NULL, NULL, libfossrepo_testcases},
     // TODO fix { "Testing fossscheduler", NULL, NULL, fossscheduler_testcases },
     CU_SUITE_INFO_NULL
   };
@@ -55,6 +57,7 @@ CU_SuiteInfo suites[] =
     {"Testing libfossdb", NULL, NULL, libfossdb_testcases},
     {"Testing fossconfig", NULL, NULL, fossconfig_testcases},
     {"Testing libfossdbmanger", NULL, NULL, libfossdbmanager_testcases},
+    {"Testing libfossrepo", NULL, NULL, libfossrepo_testcases},
     // TODO fix { "Testing fossscheduler", NULL, NULL, fossscheduler_testcases },
     CU_SUITE_INFO_NULL
   };
@@ -9,9 +9,11 @@ You should have received a copy of the GNU General Public License along with thi
 */
 
 #include "files.hpp"
-#include <fstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
-#include <sstream>
+#include <unistd.h>
 
 /**
  * \file
@@ -26,45 +28,198 @@ namespace fo
 {
 
   /**
-   * \brief Reads the content of a file and return it as a string.
+   * \brief Create a view of nothing
+   */
+  FileView::FileView() :
+    content(""), length(0), mapping(NULL), buffer(), open(false)
+  {
+  }
+
+  /**
+   * \brief Map or read the content of a file
    *
-   * Read the content of the file defined by the filename. Function also limits
-   * the length of the file content by using maximumBytes.
-   * \param filename     Path of the file to read.
+   * Regular files are mapped in memory with a hint that they are read
+   * sequentially. Other files, or regular files which can not be mapped,
+   * are read in a buffer. Use isOpen() to know if the file could be read.
+   * \param fileName     Path of the file to read.
    * \param maximumBytes Maximum length to read (set -1 to read full length).
-   * \return The file content limited by maximumBytes as string.
-   * \todo respect limit of maximumBytes
    */
-  std::string getStringFromFile(const char* filename, const unsigned long int maximumBytes)
+  FileView::FileView(const char* fileName, const unsigned long int maximumBytes) :
+    content(""), length(0), mapping(NULL), buffer(), open(false)
   {
+    const size_t limit = maximumBytes > 0 ? maximumBytes : -1;
 
+    int fd = ::open(fileName, O_RDONLY);
+    if (fd < 0)
+      return;
 
-    std::ifstream inStream(filename, std::ios::in | std::ios::binary);
-    if (inStream)
+    struct stat statStr;
+    if (fstat(fd, &statStr) == 0 && S_ISREG(statStr.st_mode) && statStr.st_size > 0)
     {
-      std::string contents;
-      inStream.seekg(0, std::ios::end);
-      if (!(inStream.rdstate() & std::ifstream::failbit))
+      size_t mappedLength = (size_t) statStr.st_size < limit ? statStr.st_size : limit;
+      void* mapped = mmap(NULL, mappedLength, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED)
       {
-        const unsigned long int endPos = inStream.tellg();
-        contents.resize((maximumBytes > 0 && (endPos > maximumBytes)) ? maximumBytes : endPos);
-        inStream.seekg(0, std::ios::beg);
-        inStream.read(&contents[0], contents.size());
+        madvise(mapped, mappedLength, MADV_SEQUENTIAL);
+        mapping = mapped;
+        content = static_cast<const char*>(mapped);
+        length = mappedLength;
+        open = true;
+        close(fd);
+        return;
       }
-      else
+    }
+
+    /* pipes, special files and files the kernel reports as empty */
+    char chunk[1 << 16];
+    while (buffer.length() < limit)
+    {
+      size_t wanted = limit - buffer.length() < sizeof(chunk) ? limit - buffer.length() : sizeof(chunk);
+      ssize_t got = read(fd, chunk, wanted);
+      if (got < 0 && errno == EINTR)
+        continue;
+      if (got < 0)
       {
-        // TODO respect limit of maximumBytes
-        inStream.clear(std::ifstream::goodbit);
+        int readErrno = errno;
+        close(fd);
+        errno = readErrno;
+        return;
+      }
+      if (got == 0)
+        break;
+      buffer.append(chunk, got);
+    }
+    close(fd);
 
-        std::stringstream ss;
-        ss << inStream.rdbuf();
+    content = buffer.data();
+    length = buffer.length();
+    open = true;
+  }
 
-        return ss.str();
-      }
-      inStream.close();
-      return (contents);
+  /**
+   * \overload FileView::FileView(std::string const& fileName, const unsigned long int maximumBytes)
+   */
+  FileView::FileView(std::string const& fileName, const unsigned long int maximumBytes) :
+    FileView(fileName.c_str(), maximumBytes)
+  {
+  }
+
+  /**
+   * \brief Take over the content of another view, which becomes empty
+   */
+  FileView::FileView(FileView&& other) :
+    content(""), length(0), mapping(NULL), buffer(), open(false)
+  {
+    *this = std::move(other);
+  }
+
+  /**
+   * \brief Take over the content of another view, which becomes empty
+   */
+  FileView& FileView::operator=(FileView&& other)
+  {
+    if (this != &other)
+    {
+      unmap();
+      mapping = other.mapping;
+      length = other.length;
+      open = other.open;
+      buffer.swap(other.buffer);
+      content = mapping ? other.content : buffer.data();
+
+      other.mapping = NULL;
+      other.content = "";
+      other.length = 0;
+      other.open = false;
+      other.buffer.clear();
     }
-    throw(errno);
+    return *this;
+  }
+
+  FileView::~FileView()
+  {
+    unmap();
+  }
+
+  void FileView::unmap()
+  {
+    if (mapping)
+      munmap(mapping, length);
+    mapping = NULL;
+  }
+
+  /**
+   * \return True if the file could be read, false otherwise
+   */
+  bool FileView::isOpen() const
+  {
+    return open;
+  }
+
+  /**
+   * \return First character of the content, the content is not null terminated
+   */
+  const char* FileView::data() const
+  {
+    return content;
+  }
+
+  /**
+   * \return Iterator to the first character of the content
+   */
+  const char* FileView::begin() const
+  {
+    return content;
+  }
+
+  /**
+   * \return Iterator past the last character of the content
+   */
+  const char* FileView::end() const
+  {
+    return content + length;
+  }
+
+  /**
+   * \return Length of the content
+   */
+  size_t FileView::size() const
+  {
+    return length;
+  }
+
+  /**
+   * \return True if the content is empty or the file could not be read
+   */
+  bool FileView::empty() const
+  {
+    return length == 0;
+  }
+
+  /**
+   * \return Copy of the content as a string
+   */
+  std::string FileView::str() const
+  {
+    return std::string(content, length);
+  }
+
+  /**
+   * \brief Reads the content of a file and return it as a string.
+   *
+   * Read the content of the file defined by the filename. Function also limits
+   * the length of the file content by using maximumBytes.
+   * \param filename     Path of the file to read.
+   * \param maximumBytes Maximum length to read (set -1 to read full length).
+   * \return The file content limited by maximumBytes as string.
+   * \throws int errno if the file can not be read
+   */
+  std::string getStringFromFile(const char* filename, const unsigned long int maximumBytes)
+  {
+    FileView view(filename, maximumBytes);
+    if (!view.isOpen())
+      throw(errno);
+    return view.str();
   }
 
   /**
@@ -41,6 +41,44 @@ namespace fo
     std::string fileName;     ///< Path of the file
   };
 
+  /**
+   * \class FileView
+   * \brief Read only view of the content of a file
+   *
+   * Regular files are mapped in memory, other files (pipes, special files)
+   * are read in a buffer. Either way the content is available as a range of
+   * characters, without copying it to a string.
+   */
+  class FileView
+  {
+  public:
+    FileView();
+    explicit FileView(const char* fileName, const unsigned long int maximumBytes = -1);
+    explicit FileView(std::string const& fileName, const unsigned long int maximumBytes = -1);
+    FileView(FileView&& other);
+    FileView& operator=(FileView&& other);
+    FileView(const FileView&) = delete;
+    FileView& operator=(const FileView&) = delete;
+    ~FileView();
+
+    bool isOpen() const;
+    const char* data() const;
+    const char* begin() const;
+    const char* end() const;
+    size_t size() const;
+    bool empty() const;
+    std::string str() const;
+
+  private:
+    void unmap();
+
+    const char* content;      ///< First character of the content
+    size_t length;            ///< Length of the content
+    void* mapping;            ///< Mapped memory, NULL if the file was read
+    std::string buffer;       ///< Content of files which are read
+    bool open;                ///< True if the file could be read
+  };
+
   std::string getStringFromFile(const char* filename, const unsigned long int maximumBytes = 1 << 20);
   std::string getStringFromFile(std::string const& filename, const unsigned long int maximumBytes = 1 << 20);
 }
@@ -105,6 +105,26 @@ std::vector<unsigned long> fo::AgentDatabaseHandler::queryFileIdsVectorForUpload
   return queryResult.getSimpleResults(0, fo::stringToUnsignedLong);
 }
 
+/**
+ * \brief Get the pfile ids of an upload while the query returns them
+ * \param uploadId Upload id to check
+ * \return Streamed pfile ids
+ * \sa queryFileIdsVectorForUpload()
+ */
+fo::StreamedQueryResult fo::AgentDatabaseHandler::streamFileIdsForUpload(int uploadId)
+{
+  std::string uploadTreeTableName = queryUploadTreeTableName(uploadId);
+
+  fo_dbManager_PreparedStatement* preparedStatement =
+    fo_dbManager_PrepareStamement(dbManager.getStruct_dbManager(),
+      ("streamFileIdsForUpload." + uploadTreeTableName).c_str(),
+      ("SELECT distinct(pfile_fk) FROM " + uploadTreeTableName +
+      " WHERE upload_fk = $1 AND (ufile_mode&x'3C000000'::int)=0").c_str(),
+      int);
+
+  return dbManager.streamPrepared(preparedStatement, uploadId);
+}
+
 /**
  * \brief Get the upload tree table name for a given upload id
  * \param uploadId Upload id to check
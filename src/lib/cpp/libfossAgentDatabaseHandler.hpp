@@ -22,6 +22,11 @@
 
 #include "libfossdbmanagerclass.hpp"
 
+/**
+ * Number of file ids a thread takes at once from a StreamedQueryResult
+ */
+#define FILE_ID_BATCH_SIZE 16
+
 /**
  * \file
  * \brief DB utility functions for agents
@@ -58,6 +63,7 @@ namespace fo
     char* getPFileNameForFileId(unsigned long pfileId) const;
     std::string queryUploadTreeTableName(int uploadId);
     std::vector<unsigned long> queryFileIdsVectorForUpload(int uploadId) const;
+    StreamedQueryResult streamFileIdsForUpload(int uploadId);
   };
 }
 
@@ -18,6 +18,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
 
 #include "libfossdbQueryResult.hpp"
 
+#include <cstdlib>
 #include <string>
 
 using namespace fo;
@@ -76,3 +77,116 @@ std::vector<std::string> QueryResult::getRow(int i) const {
 
   return result;
 }
+
+/**
+ * Constructor for StreamedQueryResult
+ * @param dbManager DB manager executing the query
+ * @param sent      Set if the query was sent
+ */
+StreamedQueryResult::StreamedQueryResult(fo_dbManager* dbManager, bool sent) :
+  dbManager(dbManager), finished(!sent), failed(!sent), lock(new std::mutex())
+{
+}
+
+/**
+ * Move constructor for StreamedQueryResult
+ * @param o Object to move
+ */
+StreamedQueryResult::StreamedQueryResult(StreamedQueryResult&& o) :
+  dbManager(o.dbManager), finished(o.finished), failed(o.failed),
+  lock(std::move(o.lock))
+{
+  o.finished = true;
+}
+
+/**
+ * Read the rows left, so that the connection can be used again
+ */
+StreamedQueryResult::~StreamedQueryResult()
+{
+  finish();
+}
+
+/**
+ * Discard the rows not read yet
+ */
+void StreamedQueryResult::finish()
+{
+  PGresult* rows;
+  while (!finished)
+  {
+    int status = fo_dbManager_streamNext(dbManager, &rows);
+    PQclear(rows);
+    if (status <= 0)
+    {
+      finished = true;
+      failed = failed || status < 0;
+    }
+  }
+}
+
+/**
+ * \brief Check if the query failed
+ *
+ * The query can also fail after some rows were read.
+ * \return True if failed, false on success.
+ */
+bool StreamedQueryResult::isFailed() const
+{
+  return failed;
+}
+
+/**
+ * \brief Get the values of a column from the next rows
+ *
+ * The values of integer columns can be in text or binary format. NULL
+ * values are returned as 0.
+ * \param columnN    Position of the column
+ * \param count      Maximum number of rows to read
+ * \param[out] values Vector to add the values to
+ * \return Number of values added, 0 when all the rows were read
+ */
+size_t StreamedQueryResult::getNextUnsignedLongs(int columnN, size_t count,
+  std::vector<unsigned long>& values)
+{
+  std::lock_guard<std::mutex> guard(*lock);
+  size_t added = 0;
+  PGresult* rows;
+
+  while (added < count && !finished)
+  {
+    int status = fo_dbManager_streamNext(dbManager, &rows);
+    if (status <= 0)
+    {
+      finished = true;
+      failed = status < 0;
+      break;
+    }
+
+    for (int i = 0; i < PQntuples(rows) && columnN < PQnfields(rows); i++)
+    {
+      unsigned long value = 0;
+      if (PQgetisnull(rows, i, columnN))
+      {
+        value = 0;
+      } else if (PQfformat(rows, columnN) == 0)
+      {
+        value = strtoul(PQgetvalue(rows, i, columnN), NULL, 10);
+      } else
+      {
+        // integers in network byte order
+        const unsigned char* bytes =
+          (const unsigned char*) PQgetvalue(rows, i, columnN);
+        for (int j = 0; j < PQgetlength(rows, i, columnN); j++)
+        {
+          value = (value << 8) | bytes[j];
+        }
+      }
+      values.push_back(value);
+      added++;
+    }
+    PQclear(rows);
+  }
+
+  return added;
+}
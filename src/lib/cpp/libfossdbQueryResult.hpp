@@ -25,6 +25,7 @@ extern "C" {
 
 #include "uniquePtr.hpp"
 
+#include <mutex>
 #include <vector>
 
 /**
@@ -85,6 +86,51 @@ namespace fo {
     unptr::unique_ptr <PGresult, PGresultDeleter> ptr;   ///< Unique pointer to the actual PGresult
   };
 
+  /**
+   * \class StreamedQueryResult
+   * \brief Rows of a query read while the server returns them
+   *
+   * The rows are never all held in memory. Several threads can take the
+   * next rows at the same time, each call returns different rows. The
+   * connection of the DbManager can not be used for other queries until
+   * all the rows are read or the object is destroyed.
+   */
+  class StreamedQueryResult {
+    friend class DbManager;
+
+  private:
+    StreamedQueryResult(fo_dbManager* dbManager, bool sent);
+
+  public:
+    StreamedQueryResult(StreamedQueryResult&& o);
+    ~StreamedQueryResult();
+
+    bool isFailed() const;
+
+    /**
+     * Check if the query failed
+     * \return True if failed, false on success.
+     * \sa fo::StreamedQueryResult::isFailed()
+     */
+    operator bool() const {
+      return !isFailed();
+    };
+
+    size_t getNextUnsignedLongs(int columnN, size_t count,
+      std::vector<unsigned long>& values);
+
+  private:
+    StreamedQueryResult(const StreamedQueryResult&) = delete;
+    StreamedQueryResult& operator=(const StreamedQueryResult&) = delete;
+
+    void finish();
+
+    fo_dbManager* dbManager;    ///< DB manager executing the query
+    bool finished;              ///< Set when all the rows were read
+    bool failed;                ///< Set if the query failed
+    unptr::unique_ptr<std::mutex> lock; ///< Lock to read the rows
+  };
+
   /**
    * \brief Get vector of a single column from query result
    *
@@ -89,6 +89,19 @@ DbManager DbManager::spawn() const
   return DbManager(fo_dbManager_fork(getStruct_dbManager()));
 }
 
+/**
+ * Keep the connections of the spawned DbManager objects for reuse
+ *
+ * When a spawned DbManager is destroyed, its connection is kept for the
+ * next call of spawn() instead of being closed.
+ * \param poolSize Maximum number of idle connections, 0 to close them
+ * \sa fo_dbManager_setPoolSize()
+ */
+void DbManager::setPoolSize(int poolSize) const
+{
+  fo_dbManager_setPoolSize(getStruct_dbManager(), poolSize);
+}
+
 /**
  * Get the C wrapper for DB manager
  * \return C wrapper for DB manager
@@ -188,6 +201,24 @@ QueryResult DbManager::execPrepared(fo_dbManager_PreparedStatement* stmt, ...) c
   return QueryResult(pgResult);
 }
 
+/**
+ * \brief Execute a prepared statement, reading its rows while they arrive.
+ *
+ * The result is in binary format, meant for integer columns.
+ * \param stmt Pointer to the prepared statement
+ * \return StreamedQueryResult
+ * \sa fo_dbManager_streamPreparedv()
+ */
+StreamedQueryResult DbManager::streamPrepared(fo_dbManager_PreparedStatement* stmt, ...) const
+{
+  va_list args;
+  va_start(args, stmt);
+  int sent = fo_dbManager_streamPreparedv(stmt, 1, args);
+  va_end(args);
+
+  return StreamedQueryResult(getStruct_dbManager(), sent != 0);
+}
+
 /**
  * Set the ignore warning flag for connection
  * \param b True to ignore waring
@@ -198,4 +229,60 @@ void DbManager::ignoreWarnings(bool b) const
   fo_dbManager_ignoreWarnings(getStruct_dbManager(), b);
 }
 
+/**
+ * Put the connection in pipeline mode
+ * \return True on success, false otherwise
+ * \sa fo_dbManager_enterPipeline()
+ */
+bool DbManager::enterPipeline() const
+{
+  return fo_dbManager_enterPipeline(getStruct_dbManager()) != 0;
+}
+
+/**
+ * \brief Send a prepared statement in the pipeline
+ *
+ * The result is returned later by getPipelineResult().
+ * \param stmt Pointer to the prepared statement
+ * \return True if the statement was sent, false otherwise
+ * \sa fo_dbManager_sendPreparedv()
+ */
+bool DbManager::sendPrepared(fo_dbManager_PreparedStatement* stmt, ...) const
+{
+  va_list args;
+  va_start(args, stmt);
+  int sent = fo_dbManager_sendPreparedv(stmt, args);
+  va_end(args);
+
+  return sent != 0;
+}
+
+/**
+ * Get the result of the next statement sent in the pipeline
+ * \return QueryResult, failed if the statement failed
+ * \sa fo_dbManager_getPipelineResult()
+ */
+QueryResult DbManager::getPipelineResult() const
+{
+  return QueryResult(fo_dbManager_getPipelineResult(getStruct_dbManager()));
+}
+
+/**
+ * Get the number of results of the pipeline not returned yet
+ * \return Number of results to get with getPipelineResult()
+ * \sa fo_dbManager_pipelinePending()
+ */
+int DbManager::pipelinePending() const
+{
+  return fo_dbManager_pipelinePending(getStruct_dbManager());
+}
 
+/**
+ * Leave pipeline mode, discarding the results not returned yet
+ * \return True on success, false otherwise
+ * \sa fo_dbManager_exitPipeline()
+ */
+bool DbManager::exitPipeline() const
+{
+  return fo_dbManager_exitPipeline(getStruct_dbManager()) != 0;
+}
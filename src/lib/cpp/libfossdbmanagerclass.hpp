@@ -66,6 +66,7 @@ namespace fo
 
     PGconn* getConnection() const;
     DbManager spawn() const;
+    void setPoolSize(int poolSize) const;
 
     fo_dbManager* getStruct_dbManager() const;
     bool tableExists(const char* tableName) const;
@@ -77,6 +78,13 @@ namespace fo
 
     QueryResult queryPrintf(const char* queryFormat, ...) const;
     QueryResult execPrepared(fo_dbManager_PreparedStatement* stmt, ...) const;
+    StreamedQueryResult streamPrepared(fo_dbManager_PreparedStatement* stmt, ...) const;
+
+    bool enterPipeline() const;
+    bool sendPrepared(fo_dbManager_PreparedStatement* stmt, ...) const;
+    QueryResult getPipelineResult() const;
+    int pipelinePending() const;
+    bool exitPipeline() const;
 
   private:
     unptr::shared_ptr <fo_dbManager> dbManager;    ///< Shared DB manager
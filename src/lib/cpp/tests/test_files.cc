@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+#include "files.hpp"
+
+/**
+ * \file
+ * \brief Test cases for file reading
+ */
+
+/**
+ * \class FileViewTest
+ * \brief Test cases for fo::FileView and fo::getStringFromFile()
+ */
+class FileViewTest : public CPPUNIT_NS::TestFixture {
+CPPUNIT_TEST_SUITE(FileViewTest);
+    CPPUNIT_TEST(test_mapRegularFile);
+    CPPUNIT_TEST(test_maximumBytes);
+    CPPUNIT_TEST(test_readPipe);
+    CPPUNIT_TEST(test_missingFile);
+    CPPUNIT_TEST(test_move);
+  CPPUNIT_TEST_SUITE_END();
+private:
+  std::string fileName;           ///< Temporary file
+  std::string content;            ///< Content of the temporary file
+
+public:
+  /**
+   * Create a temporary file with some binary content
+   */
+  void setUp() {
+    char name[] = "/tmp/fileViewTestXXXXXX";
+    int fd = mkstemp(name);
+    CPPUNIT_ASSERT(fd >= 0);
+    fileName = name;
+
+    content.clear();
+    for (int i = 0; i < 100000; i++)
+      content.push_back((char) (i * 7));
+    CPPUNIT_ASSERT_EQUAL((ssize_t) content.length(), write(fd, content.data(), content.length()));
+    close(fd);
+  }
+
+  void tearDown() {
+    unlink(fileName.c_str());
+  }
+
+protected:
+  /**
+   * \brief Test that a regular file is viewed entirely
+   * \test
+   * -# Create a view of the temporary file
+   * -# Check the content of the view and the string read from the file
+   */
+  void test_mapRegularFile() {
+    fo::FileView view(fileName);
+    CPPUNIT_ASSERT(view.isOpen());
+    CPPUNIT_ASSERT_EQUAL(content.length(), view.size());
+    CPPUNIT_ASSERT(std::string(view.begin(), view.end()) == content);
+    CPPUNIT_ASSERT(fo::getStringFromFile(fileName, -1) == content);
+  }
+
+  /**
+   * \brief Test that the length of the content is limited
+   * \test
+   * -# Create views and read strings limited to part of the file
+   * -# Check that only the beginning of the file is in them
+   */
+  void test_maximumBytes() {
+    fo::FileView view(fileName, 1000);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1000, view.size());
+    CPPUNIT_ASSERT(view.str() == content.substr(0, 1000));
+    CPPUNIT_ASSERT(fo::getStringFromFile(fileName, 12345) == content.substr(0, 12345));
+    CPPUNIT_ASSERT(fo::getStringFromFile(fileName, 0) == content);
+  }
+
+  /**
+   * \brief Test that pipes are read
+   * \test
+   * -# Write to a pipe and close it
+   * -# Create views of the read end of the pipe, with and without a limit
+   * -# Check that they hold what was written
+   */
+  void test_readPipe() {
+    const std::string written = "some text sent through a pipe";
+    for (unsigned long maximumBytes = 4; maximumBytes <= 1000; maximumBytes += 996)
+    {
+      int fds[2];
+      CPPUNIT_ASSERT_EQUAL(0, pipe(fds));
+      CPPUNIT_ASSERT_EQUAL((ssize_t) written.length(), write(fds[1], written.data(), written.length()));
+      close(fds[1]);
+
+      fo::FileView view("/dev/fd/" + std::to_string(fds[0]), maximumBytes);
+      close(fds[0]);
+      CPPUNIT_ASSERT(view.isOpen());
+      CPPUNIT_ASSERT(view.str() == written.substr(0, maximumBytes));
+    }
+  }
+
+  /**
+   * \brief Test that a missing file is reported
+   * \test
+   * -# Create a view of a file which does not exist
+   * -# Check that it is not open and empty
+   * -# Check that getStringFromFile() throws
+   */
+  void test_missingFile() {
+    fo::FileView view(fileName + ".missing");
+    CPPUNIT_ASSERT(!view.isOpen());
+    CPPUNIT_ASSERT(view.empty());
+    CPPUNIT_ASSERT_THROW(fo::getStringFromFile(fileName + ".missing"), int);
+  }
+
+  /**
+   * \brief Test that views can be moved
+   * \test
+   * -# Move a mapped view and a read view
+   * -# Check that the content moved with them
+   */
+  void test_move() {
+    fo::FileView view(fileName);
+    fo::FileView moved(std::move(view));
+    CPPUNIT_ASSERT(view.empty());
+    CPPUNIT_ASSERT(moved.str() == content);
+
+    int fds[2];
+    CPPUNIT_ASSERT_EQUAL(0, pipe(fds));
+    CPPUNIT_ASSERT_EQUAL((ssize_t) 3, write(fds[1], "abc", 3));
+    close(fds[1]);
+    fo::FileView piped("/dev/fd/" + std::to_string(fds[0]));
+    close(fds[0]);
+
+    moved = std::move(piped);
+    CPPUNIT_ASSERT(!piped.isOpen());
+    CPPUNIT_ASSERT(moved.str() == "abc");
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FileViewTest);
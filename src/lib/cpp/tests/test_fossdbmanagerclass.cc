@@ -46,6 +46,9 @@ CPPUNIT_TEST_SUITE(FoLibCPPTest);
     CPPUNIT_TEST(test_tableExists);
     CPPUNIT_TEST(test_runPreparedStatement);
     CPPUNIT_TEST(test_transactions);
+    CPPUNIT_TEST(test_spawnFromPool);
+    CPPUNIT_TEST(test_pipeline);
+    CPPUNIT_TEST(test_streamPrepared);
     CPPUNIT_TEST(test_runBadCommandQueryCheckIfError);
     CPPUNIT_TEST(test_runSchedulerConnectConstructor);
   CPPUNIT_TEST_SUITE_END();
@@ -230,6 +233,138 @@ public:
     CPPUNIT_ASSERT_EQUAL(expected, results);
   }
 
+  /**
+   * Test to check that spawned managers reuse the pooled connections
+   * \test
+   * -# Set the pool size of the DbManager.
+   * -# Spawn a new DbManager and destroy it.
+   * -# Spawn a new DbManager again.
+   * -# Check that the connection is the same server process.
+   * -# Destroy a DbManager inside a transaction.
+   * -# Check that its connection is not reused.
+   */
+  void test_spawnFromPool() {
+    dbManager->setPoolSize(2);
+
+    int backend;
+    {
+      fo::DbManager manager = dbManager->spawn();
+      backend = PQbackendPID(manager.getConnection());
+      CPPUNIT_ASSERT(manager.queryPrintf("SELECT 1"));
+    }
+    {
+      fo::DbManager manager = dbManager->spawn();
+      CPPUNIT_ASSERT_EQUAL(backend, PQbackendPID(manager.getConnection()));
+      CPPUNIT_ASSERT(manager.begin());
+    }
+    {
+      fo::DbManager manager = dbManager->spawn();
+      CPPUNIT_ASSERT(backend != PQbackendPID(manager.getConnection()));
+      CPPUNIT_ASSERT(manager.queryPrintf("SELECT 1"));
+    }
+  }
+
+  /**
+   * Test to check the pipeline functions
+   * \test
+   * -# Spawn a new DbManager and create a test table.
+   * -# Send prepared inserts in the pipeline.
+   * -# Check the results in the order they were sent.
+   * -# Send prepared inserts in the pipeline, the last one failing.
+   * -# Check that the last result failed.
+   * -# Leave the pipeline and check that only the first inserts were kept.
+   */
+  void test_pipeline() {
+    fo::DbManager manager = dbManager->spawn();
+
+    CPPUNIT_ASSERT(manager.queryPrintf("CREATE TABLE tbl(col integer CHECK (col < 8))"));
+
+    fo_dbManager_PreparedStatement* preparedStatement = fo_dbManager_PrepareStamement(
+      manager.getStruct_dbManager(),
+      "test",
+      "INSERT INTO tbl(col) VALUES ($1) RETURNING col",
+      int
+    );
+
+    CPPUNIT_ASSERT(manager.enterPipeline());
+    for (int i = 0; i < 4; ++i) {
+      CPPUNIT_ASSERT(manager.sendPrepared(preparedStatement, i * 2));
+    }
+    CPPUNIT_ASSERT_EQUAL(4, manager.pipelinePending());
+    for (int i = 0; i < 4; ++i) {
+      fo::QueryResult result = manager.getPipelineResult();
+      CPPUNIT_ASSERT(result);
+      CPPUNIT_ASSERT_EQUAL(i * 2, result.getSimpleResults(0, atoi)[0]);
+    }
+    CPPUNIT_ASSERT_EQUAL(0, manager.pipelinePending());
+
+    // the statements up to the failing one are rolled back
+    for (int i = 1; i < 5; ++i) {
+      CPPUNIT_ASSERT(manager.sendPrepared(preparedStatement, i * 2));
+    }
+    std::cout << std::endl << "expecting errors" << std::endl << "-----" << std::endl;
+    for (int i = 1; i < 5; ++i) {
+      fo::QueryResult result = manager.getPipelineResult();
+      CPPUNIT_ASSERT_EQUAL(i < 4, (bool) result);
+    }
+    std::cout << std::endl << "-----" << std::endl;
+    CPPUNIT_ASSERT(manager.exitPipeline());
+
+    fo::QueryResult result = manager.queryPrintf("SELECT * FROM tbl");
+    std::vector<int> results = result.getSimpleResults(0, atoi);
+    std::vector<int> expected = {0, 2, 4, 6};
+
+    CPPUNIT_ASSERT_EQUAL(expected, results);
+  }
+
+  /**
+   * Test to check fo::DbManager::streamPrepared() function
+   * \test
+   * -# Spawn a new DbManager and create a test table with some rows.
+   * -# Stream the rows with a prepared statement.
+   * -# Read the values in batches with
+   *    fo::StreamedQueryResult::getNextUnsignedLongs().
+   * -# Check that all the values were read in order.
+   * -# Destroy a result before reading all the rows.
+   * -# Check that the connection can be used again.
+   */
+  void test_streamPrepared() {
+    fo::DbManager manager = dbManager->spawn();
+
+    CPPUNIT_ASSERT(manager.queryPrintf("CREATE TABLE tbl(col integer)"));
+    CPPUNIT_ASSERT(manager.queryPrintf("INSERT INTO tbl(col) SELECT generate_series(1, 10)"));
+
+    fo_dbManager_PreparedStatement* preparedStatement = fo_dbManager_PrepareStamement(
+      manager.getStruct_dbManager(),
+      "test",
+      "SELECT col FROM tbl WHERE col > $1 ORDER BY col",
+      int
+    );
+
+    {
+      fo::StreamedQueryResult result = manager.streamPrepared(preparedStatement, 2);
+      std::vector<unsigned long> values;
+      CPPUNIT_ASSERT_EQUAL((size_t) 3, result.getNextUnsignedLongs(0, 3, values));
+      CPPUNIT_ASSERT_EQUAL((size_t) 3, result.getNextUnsignedLongs(0, 3, values));
+      CPPUNIT_ASSERT_EQUAL((size_t) 2, result.getNextUnsignedLongs(0, 3, values));
+      CPPUNIT_ASSERT_EQUAL((size_t) 0, result.getNextUnsignedLongs(0, 3, values));
+      CPPUNIT_ASSERT(result);
+
+      std::vector<int> expected = {3, 4, 5, 6, 7, 8, 9, 10};
+      CPPUNIT_ASSERT_EQUAL(expected, std::vector<int>(values.begin(), values.end()));
+    }
+
+    {
+      fo::StreamedQueryResult result = manager.streamPrepared(preparedStatement, 0);
+      std::vector<unsigned long> values;
+      CPPUNIT_ASSERT_EQUAL((size_t) 1, result.getNextUnsignedLongs(0, 1, values));
+    }
+
+    fo::QueryResult result = manager.queryPrintf("SELECT count(*) FROM tbl");
+    CPPUNIT_ASSERT(result);
+    CPPUNIT_ASSERT_EQUAL(10, result.getSimpleResults(0, atoi)[0]);
+  }
+
   /**
    * Test to check bad query
    * \test
@@ -16,6 +16,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <limits.h>
 #include <math.h>
 #include <stdio.h>
 #include <glib.h>
@@ -98,6 +99,37 @@ int writeVisitorToSourceFiles(GArray* visitor) {
   }
   fprintf(fc, "};\n");
 
+  /* squareVisitorReach[i] is the side of the smallest square containing the points visited up to i */
+  fprintf(fc, "unsigned short squareVisitorReach[] = ");
+  unsigned int reach = MAX(p0.x, p0.y) + 1;
+  fprintf(fc, "{%u", reach);
+  for (size_t i = 1; i < visitor->len; i++) {
+    point p = g_array_index(visitor, point, i);
+    reach = MAX(reach, MAX(p.x, p.y) + 1);
+    fprintf(fc, ",\n\t%u", reach);
+  }
+  fprintf(fc, "};\n");
+
+  /* inverse of the visitor: squareVisitorOrder[x][y] is 1 + the position of {x,y} in the visitor,
+   * or 0 if it is never visited */
+  unsigned int order[SIZE][SIZE];
+  for (unsigned int i = 0; i < SIZE; i++)
+    for (unsigned int j = 0; j < SIZE; j++)
+      order[i][j] = 0;
+  for (size_t i = 0; i < visitor->len; i++) {
+    point p = g_array_index(visitor, point, i);
+    order[p.x][p.y] = i + 1;
+  }
+
+  fprintf(fc, "unsigned short squareVisitorOrder[%u][%u] = {", SIZE, SIZE);
+  for (unsigned int i = 0; i < SIZE; i++) {
+    fprintf(fc, "%s\n\t{%u", (i > 0) ? "," : "", order[i][0]);
+    for (unsigned int j = 1; j < SIZE; j++)
+      fprintf(fc, ",%u", order[i][j]);
+    fprintf(fc, "}");
+  }
+  fprintf(fc, "};\n");
+
   fclose(fc);
 
   FILE* fh = fopen("_squareVisitor.h.gen", "w");
@@ -107,6 +139,7 @@ int writeVisitorToSourceFiles(GArray* visitor) {
   }
 
   fprintf(fh, "#define SQUARE_VISITOR_LENGTH %u\n", visitor->len);
+  fprintf(fh, "#define SQUARE_VISITOR_SIZE %u\n", SIZE);
 
   fclose(fh);
   return 0;
@@ -142,7 +175,7 @@ int main() {
 
   GArray* visitor = generateTimeOrderedVisitor(timeOfVisit);
 
-  if (visitor->len == 0)
+  if ((visitor->len == 0) || (visitor->len >= USHRT_MAX))
     return 1;
 
 #ifdef SQUARE_BUILDER_DEBUG
@@ -24,6 +24,12 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #define LICENSE_REF_TABLE "ONLY license_ref"
 #define DECISION_TYPE_FOR_IRRELEVANT 4
 
+#define RESULT_BUFFER_FLUSH_ROWS 2048
+#define RESULT_BUFFER_ID_BLOCK 256
+#define RESULT_BUFFER_COPY_SIZE (64 * 1024)
+/* longer than any row we format: numbers and a diff type */
+#define RESULT_BUFFER_ROW_MAX 256
+
 PGresult* queryFileIdsForUploadAndLimits(fo_dbManager* dbManager, int uploadId, long left, long right, long groupId) {
   return fo_dbManager_ExecPrepared(
     fo_dbManager_PrepareStamement(
@@ -47,8 +53,26 @@ PGresult* queryFileIdsForUploadAndLimits(fo_dbManager* dbManager, int uploadId,
 PGresult* queryAllLicenses(fo_dbManager* dbManager) {
   return fo_dbManager_Exec_printf(
     dbManager,
-    "select rf_pk, rf_shortname from " LICENSE_REF_TABLE " where rf_detector_type = 1 and rf_active = 'true'"
+    "select rf_pk, rf_shortname, coalesce(rf_text, '') from " LICENSE_REF_TABLE " where rf_detector_type = 1 and rf_active = 'true'"
+  );
+}
+
+char* getLicenseRefChecksum(fo_dbManager* dbManager) {
+  PGresult* checksumResult = fo_dbManager_Exec_printf(
+    dbManager,
+    "select md5(string_agg(rf_pk || ' ' || md5(rf_shortname) || ' ' || md5(coalesce(rf_text, '')), ' ' order by rf_pk))"
+    " from " LICENSE_REF_TABLE " where rf_detector_type = 1 and rf_active = 'true'"
   );
+
+  if (!checksumResult)
+    return NULL;
+
+  char* result = NULL;
+  if (PQntuples(checksumResult) == 1 && !PQgetisnull(checksumResult, 0, 0)) {
+    result = g_strdup(PQgetvalue(checksumResult, 0, 0));
+  }
+  PQclear(checksumResult);
+  return result;
 }
 
 char* getLicenseTextForLicenseRefId(fo_dbManager* dbManager, long refId) {
@@ -164,3 +188,168 @@ int saveDiffHighlightsToDb(fo_dbManager* dbManager, const GArray* matchedInfo, l
 
   return 1;
 }
+
+ResultBuffer* resultBuffer_new(fo_dbManager* dbManager, int agentId) {
+  PGconn* connection = fo_dbManager_getWrappedConnection(dbManager);
+
+  ResultBuffer* buffer = malloc(sizeof(ResultBuffer));
+  buffer->dbManager = dbManager;
+  buffer->agentId = agentId;
+  buffer->licenseFiles = fo_sqlCopyCreate(connection, "license_file", RESULT_BUFFER_COPY_SIZE, 5,
+                                          "fl_pk", "rf_fk", "agent_fk", "pfile_fk", "rf_match_pct");
+  buffer->noResults = fo_sqlCopyCreate(connection, "license_file", RESULT_BUFFER_COPY_SIZE, 2,
+                                       "agent_fk", "pfile_fk");
+  buffer->highlights = fo_sqlCopyCreate(connection, "highlight", RESULT_BUFFER_COPY_SIZE, 6,
+                                        "fl_fk", "type", "start", "len", "rf_start", "rf_len");
+  buffer->reservedIds = g_array_new(FALSE, FALSE, sizeof(long));
+  buffer->nextReservedId = 0;
+  buffer->bufferedRows = 0;
+  buffer->inTransaction = 0;
+
+  if (!buffer->licenseFiles || !buffer->noResults || !buffer->highlights) {
+    resultBuffer_free(buffer);
+    return NULL;
+  }
+
+  return buffer;
+}
+
+void resultBuffer_free(ResultBuffer* buffer) {
+  if (buffer->inTransaction)
+    fo_dbManager_rollback(buffer->dbManager);
+
+  fo_sqlCopyDestroy(buffer->licenseFiles, 0);
+  fo_sqlCopyDestroy(buffer->noResults, 0);
+  fo_sqlCopyDestroy(buffer->highlights, 0);
+  g_array_free(buffer->reservedIds, TRUE);
+  free(buffer);
+}
+
+static int resultBuffer_fail(ResultBuffer* buffer) {
+  if (buffer->inTransaction) {
+    fo_dbManager_rollback(buffer->dbManager);
+    buffer->inTransaction = 0;
+  }
+  return 0;
+}
+
+/* highlights reference license_file rows: always copy them in this order */
+static int resultBuffer_copy(ResultBuffer* buffer) {
+  if (!buffer->inTransaction) {
+    if (!fo_dbManager_begin(buffer->dbManager))
+      return 0;
+    buffer->inTransaction = 1;
+  }
+
+  if (!fo_sqlCopyExecute(buffer->licenseFiles) ||
+      !fo_sqlCopyExecute(buffer->noResults) ||
+      !fo_sqlCopyExecute(buffer->highlights))
+    return resultBuffer_fail(buffer);
+
+  return 1;
+}
+
+/* fo_sqlCopyAdd() would execute a full copy on its own, possibly before the license_file rows */
+static int resultBuffer_addRow(ResultBuffer* buffer, psqlCopy_t copy, char* row) {
+  if (copy->BufSize - copy->DataIdx <= RESULT_BUFFER_ROW_MAX) {
+    if (!resultBuffer_copy(buffer))
+      return 0;
+  }
+
+  if (!fo_sqlCopyAdd(copy, row))
+    return resultBuffer_fail(buffer);
+
+  buffer->bufferedRows++;
+  return 1;
+}
+
+static long resultBuffer_nextId(ResultBuffer* buffer) {
+  if (buffer->nextReservedId >= buffer->reservedIds->len) {
+    PGresult* idsResult = fo_dbManager_ExecPrepared(
+      fo_dbManager_PrepareStamement(
+        buffer->dbManager,
+        "resultBuffer_reserveIds",
+        "SELECT nextval('license_file_fl_pk_seq') FROM generate_series(1, $1)",
+        int),
+      RESULT_BUFFER_ID_BLOCK
+    );
+
+    if (!idsResult)
+      return -1;
+
+    g_array_set_size(buffer->reservedIds, 0);
+    buffer->nextReservedId = 0;
+    for (int i = 0; i < PQntuples(idsResult); i++) {
+      long id = atol(PQgetvalue(idsResult, i, 0));
+      g_array_append_val(buffer->reservedIds, id);
+    }
+    PQclear(idsResult);
+
+    if (buffer->reservedIds->len == 0)
+      return -1;
+  }
+
+  return g_array_index(buffer->reservedIds, long, buffer->nextReservedId++);
+}
+
+int resultBuffer_addNoResult(ResultBuffer* buffer, long pFileId) {
+  char row[RESULT_BUFFER_ROW_MAX];
+  snprintf(row, sizeof(row), "%d\t%ld\n", buffer->agentId, pFileId);
+
+  return resultBuffer_addRow(buffer, buffer->noResults, row);
+}
+
+long resultBuffer_addLicenseFile(ResultBuffer* buffer, long refId, long pFileId, unsigned percent) {
+  long licenseFileId = resultBuffer_nextId(buffer);
+  if (licenseFileId <= 0)
+    return -1;
+
+  char row[RESULT_BUFFER_ROW_MAX];
+  snprintf(row, sizeof(row), "%ld\t%ld\t%d\t%ld\t%u\n", licenseFileId, refId, buffer->agentId, pFileId, percent);
+
+  if (!resultBuffer_addRow(buffer, buffer->licenseFiles, row))
+    return -1;
+
+  return licenseFileId;
+}
+
+int resultBuffer_addHighlight(ResultBuffer* buffer, const DiffMatchInfo* diffInfo, long licenseFileId) {
+  char row[RESULT_BUFFER_ROW_MAX];
+  snprintf(row, sizeof(row), "%ld\t%s\t%zu\t%zu\t%zu\t%zu\n",
+           licenseFileId,
+           diffInfo->diffType,
+           diffInfo->text.start, diffInfo->text.length,
+           diffInfo->search.start, diffInfo->search.length);
+
+  return resultBuffer_addRow(buffer, buffer->highlights, row);
+}
+
+int resultBuffer_addHighlights(ResultBuffer* buffer, const GArray* matchedInfo, long licenseFileId) {
+  size_t matchedInfoLen = matchedInfo->len;
+  for (size_t i = 0; i < matchedInfoLen; i++) {
+    DiffMatchInfo* diffMatchInfo = &g_array_index(matchedInfo, DiffMatchInfo, i);
+    if (!resultBuffer_addHighlight(buffer, diffMatchInfo, licenseFileId))
+      return 0;
+  }
+
+  return 1;
+}
+
+int resultBuffer_flush(ResultBuffer* buffer) {
+  if (buffer->bufferedRows == 0 && !buffer->inTransaction)
+    return 1;
+
+  if (!resultBuffer_copy(buffer))
+    return 0;
+
+  buffer->inTransaction = 0;
+  buffer->bufferedRows = 0;
+  return fo_dbManager_commit(buffer->dbManager);
+}
+
+int resultBuffer_flushIfFull(ResultBuffer* buffer) {
+  if (buffer->bufferedRows < RESULT_BUFFER_FLUSH_ROWS)
+    return 1;
+
+  return resultBuffer_flush(buffer);
+}
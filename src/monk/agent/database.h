@@ -24,6 +24,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 PGresult* queryFileIdsForUploadAndLimits(fo_dbManager* dbManager, int uploadId, long left, long right, long groupId);
 PGresult* queryAllLicenses(fo_dbManager* dbManager);
+char* getLicenseRefChecksum(fo_dbManager* dbManager);
 char* getLicenseTextForLicenseRefId(fo_dbManager* dbManager, long refId);
 int hasAlreadyResultsFor(fo_dbManager* dbManager, int agentId, long pFileId);
 long saveToDb(fo_dbManager* dbManager, int agentId, long int refId, long int pFileId, unsigned int percent);
@@ -31,4 +32,31 @@ int saveNoResultToDb(fo_dbManager* dbManager, int agentId, long pFileId);
 int saveDiffHighlightToDb(fo_dbManager* dbManager, const DiffMatchInfo* diffInfo, long licenseFileId);
 int saveDiffHighlightsToDb(fo_dbManager* dbManager, const GArray* matchedInfo, long licenseFileId);
 
+/* license_file and highlight rows of many files, written with COPY in one transaction per flush.
+ * fl_pk values are reserved in blocks from license_file_fl_pk_seq, so that highlights can reference
+ * their license_file row before it is written */
+typedef struct {
+  fo_dbManager* dbManager;
+  int agentId;
+  psqlCopy_t licenseFiles;
+  psqlCopy_t noResults;
+  psqlCopy_t highlights;
+  GArray* reservedIds;
+  guint nextReservedId;
+  unsigned bufferedRows;
+  int inTransaction;
+} ResultBuffer;
+
+ResultBuffer* resultBuffer_new(fo_dbManager* dbManager, int agentId);
+/* rows not yet flushed are discarded */
+void resultBuffer_free(ResultBuffer* buffer);
+int resultBuffer_addNoResult(ResultBuffer* buffer, long pFileId);
+long resultBuffer_addLicenseFile(ResultBuffer* buffer, long refId, long pFileId, unsigned percent);
+int resultBuffer_addHighlight(ResultBuffer* buffer, const DiffMatchInfo* diffInfo, long licenseFileId);
+int resultBuffer_addHighlights(ResultBuffer* buffer, const GArray* matchedInfo, long licenseFileId);
+/* write and commit the buffered rows, on failure everything since the last flush is rolled back */
+int resultBuffer_flush(ResultBuffer* buffer);
+/* flush only if enough rows are buffered, to be called between files */
+int resultBuffer_flushIfFull(ResultBuffer* buffer);
+
 #endif // MONK_AGENT_DATABASE_H
@@ -19,7 +19,14 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "diff.h"
 
 #include "_squareVisitor.h"
+#include "token_compare.h"
 #include <stdlib.h>
+#include <string.h>
+
+/* number of points of the squareVisitor looked at one by one before comparing blocks of tokens */
+#define DIFF_VISITED_FIRST 1024
+/* each scan of blocks of tokens covers this many times the points of the visitor of the previous one */
+#define DIFF_SQUARE_GROWTH 4
 
 int matchNTokens(const GArray* textTokens, size_t textStart, size_t textLength,
                  const GArray* searchTokens, size_t searchStart, size_t searchLength,
@@ -50,10 +57,10 @@ int matchNTokens(const GArray* textTokens, size_t textStart, size_t textLength,
   return 0;
 }
 
-int lookForDiff(const GArray* textTokens, const GArray* searchTokens,
-                       size_t iText, size_t iSearch,
-                       unsigned int maxAllowedDiff, unsigned int minAdjacentMatches,
-                       DiffMatchInfo* result) {
+static int lookForDiffVisiting(const GArray* textTokens, const GArray* searchTokens,
+                               size_t iText, size_t iSearch,
+                               unsigned int maxAllowedDiff, unsigned int minAdjacentMatches,
+                               unsigned int visits, DiffMatchInfo* result) {
   size_t searchLength = searchTokens->len;
   size_t textLength = textTokens->len;
 
@@ -62,11 +69,13 @@ int lookForDiff(const GArray* textTokens, const GArray* searchTokens,
 
   size_t textPos;
   size_t searchPos;
-  for (unsigned int i = 0; i < SQUARE_VISITOR_LENGTH; i++) {
+  for (unsigned int i = 0; i < visits; i++) {
     textPos = iText + squareVisitorX[i];
     searchPos = iSearch + squareVisitorY[i];
 
-    if ((textPos < textStopAt) && (searchPos < searchStopAt))
+    if ((textPos < textStopAt) && (searchPos < searchStopAt) &&
+        (g_array_index(textTokens, Token, textPos).hashedContent ==
+         g_array_index(searchTokens, Token, searchPos).hashedContent))
       if (matchNTokens(textTokens, textPos, textLength,
                        searchTokens, searchPos, searchLength,
                        minAdjacentMatches))
@@ -82,6 +91,166 @@ int lookForDiff(const GArray* textTokens, const GArray* searchTokens,
   return 0;
 }
 
+/* copy the hashes of tokens[start..start+length] in window, zero padded to a whole block */
+static void fillHashWindow(uint32_t* window, const GArray* tokens, const uint32_t* hashes,
+                           size_t start, size_t length) {
+  if (hashes) {
+    memcpy(window, hashes + start, length * sizeof(uint32_t));
+  } else {
+    for (size_t i = 0; i < length; i++)
+      window[i] = g_array_index(tokens, Token, start + i).hashedContent;
+  }
+  for (size_t i = length; i % TOKEN_COMPARE_BLOCK != 0; i++)
+    window[i] = 0;
+}
+
+typedef struct {
+  const GArray* textTokens;
+  const GArray* searchTokens;
+  size_t iText;
+  size_t iSearch;
+  unsigned int minAdjacentMatches;
+  size_t textWidth;
+  size_t searchWidth;
+  uint32_t textWindow[SQUARE_VISITOR_SIZE + TOKEN_COMPARE_BLOCK];
+  uint32_t searchWindow[SQUARE_VISITOR_SIZE + TOKEN_COMPARE_BLOCK];
+  unsigned int bestOrder;
+  size_t bestX;
+  size_t bestY;
+} DiffSquare;
+
+/* compare the points of the diff square with x, y < side but not both < scanned,
+ * one search token with a block of text tokens at a time,
+ * and keep the matching point which comes first in the squareVisitor order */
+static void scanDiffSquare(DiffSquare* square, size_t scanned, size_t side) {
+  size_t textWidth = MIN(side, square->textWidth);
+  size_t searchWidth = MIN(side, square->searchWidth);
+  size_t blocks = (textWidth + TOKEN_COMPARE_BLOCK - 1) / TOKEN_COMPARE_BLOCK;
+  uint8_t masks[(SQUARE_VISITOR_SIZE + TOKEN_COMPARE_BLOCK - 1) / TOKEN_COMPARE_BLOCK];
+
+  /* the window is zero padded after textWidth: do not match the padding */
+  uint8_t lastMask = 0xFF;
+  if (blocks * TOKEN_COMPARE_BLOCK > square->textWidth)
+    lastMask = (uint8_t) ((1u << (square->textWidth % TOKEN_COMPARE_BLOCK)) - 1);
+
+  for (size_t y = 0; y < searchWidth; y++) {
+    size_t firstBlock = (y < scanned) ? scanned / TOKEN_COMPARE_BLOCK : 0;
+    if (firstBlock >= blocks)
+      continue;
+
+    hashEqualMasks(square->textWindow + firstBlock * TOKEN_COMPARE_BLOCK, blocks - firstBlock,
+                   square->searchWindow[y], masks + firstBlock);
+    masks[blocks - 1] &= lastMask;
+
+    for (size_t b = firstBlock; b < blocks; b++) {
+      for (unsigned int mask = masks[b]; mask; mask &= mask - 1) {
+        size_t x = b * TOKEN_COMPARE_BLOCK + __builtin_ctz(mask);
+        unsigned int order = squareVisitorOrder[x][y];
+
+        if ((order > 0) && ((square->bestOrder == 0) || (order < square->bestOrder)) &&
+            matchNTokens(square->textTokens, square->iText + x, square->textTokens->len,
+                         square->searchTokens, square->iSearch + y, square->searchTokens->len,
+                         square->minAdjacentMatches))
+        {
+          square->bestOrder = order;
+          square->bestX = x;
+          square->bestY = y;
+        }
+      }
+    }
+  }
+}
+
+static int lookForDiffHashed(const GArray* textTokens, const uint32_t* textHashes,
+                             const GArray* searchTokens, const uint32_t* searchHashes,
+                             size_t iText, size_t iSearch,
+                             unsigned int maxAllowedDiff, unsigned int minAdjacentMatches,
+                             DiffMatchInfo* result) {
+  size_t searchLength = searchTokens->len;
+  size_t textLength = textTokens->len;
+
+  size_t searchStopAt = MIN(iSearch + maxAllowedDiff, searchLength);
+  size_t textStopAt = MIN(iText + maxAllowedDiff, textLength);
+
+  if ((textStopAt <= iText) || (searchStopAt <= iSearch))
+    return 0;
+
+  /* most differences are short: visit the closest points one by one before comparing blocks of tokens,
+   * without vector instructions the blocks are not worth it and the whole visitor is walked */
+  if (tokenCompare_getLevel() == TOKEN_COMPARE_SCALAR)
+    return lookForDiffVisiting(textTokens, searchTokens, iText, iSearch, maxAllowedDiff, minAdjacentMatches,
+                               SQUARE_VISITOR_LENGTH, result);
+
+  unsigned int visited = MIN(DIFF_VISITED_FIRST, SQUARE_VISITOR_LENGTH);
+  if (lookForDiffVisiting(textTokens, searchTokens, iText, iSearch, maxAllowedDiff, minAdjacentMatches,
+                          visited, result))
+    return 1;
+
+  DiffSquare square;
+  square.textTokens = textTokens;
+  square.searchTokens = searchTokens;
+  square.iText = iText;
+  square.iSearch = iSearch;
+  square.minAdjacentMatches = minAdjacentMatches;
+  /* points outside of the visitor square are never visited */
+  square.textWidth = MIN(textStopAt - iText, SQUARE_VISITOR_SIZE);
+  square.searchWidth = MIN(searchStopAt - iSearch, SQUARE_VISITOR_SIZE);
+  square.bestOrder = 0;
+  fillHashWindow(square.textWindow, textTokens, textHashes, iText, square.textWidth);
+  fillHashWindow(square.searchWindow, searchTokens, searchHashes, iSearch, square.searchWidth);
+
+  /* scan growing squares containing the next points of the visitor,
+   * until the best match found is one of them */
+  size_t scanned = 0;
+  while (visited < SQUARE_VISITOR_LENGTH) {
+    visited = MIN(visited * DIFF_SQUARE_GROWTH, SQUARE_VISITOR_LENGTH);
+    size_t side = squareVisitorReach[visited - 1];
+    scanDiffSquare(&square, scanned, side);
+    scanned = side;
+
+    if ((square.bestOrder > 0) && (square.bestOrder <= visited))
+      break;
+  }
+
+  if (square.bestOrder == 0)
+    return 0;
+
+  result->search.start = iSearch + square.bestY;
+  result->search.length = square.bestY;
+  result->text.start = iText + square.bestX;
+  result->text.length = square.bestX;
+  return 1;
+}
+
+int lookForDiff(const GArray* textTokens, const GArray* searchTokens,
+                       size_t iText, size_t iSearch,
+                       unsigned int maxAllowedDiff, unsigned int minAdjacentMatches,
+                       DiffMatchInfo* result) {
+  return lookForDiffHashed(textTokens, NULL, searchTokens, NULL,
+                           iText, iSearch, maxAllowedDiff, minAdjacentMatches, result);
+}
+
+/* number of equal tokens starting at textTokens[iText] and searchTokens[iSearch], at most n */
+static size_t equalTokensRun(const GArray* textTokens, const uint32_t* textHashes, size_t iText,
+                             const GArray* searchTokens, const uint32_t* searchHashes, size_t iSearch,
+                             size_t n) {
+  if (textHashes && searchHashes) {
+    size_t run = hashCommonPrefix(textHashes + iText, searchHashes + iSearch, n);
+    /* tokens with the same hash are equal only if they also have the same length */
+    for (size_t i = 0; i < run; i++) {
+      if (g_array_index(textTokens, Token, iText + i).length != g_array_index(searchTokens, Token, iSearch + i).length)
+        return i;
+    }
+    return run;
+  }
+
+  size_t run = 0;
+  while ((run < n) &&
+         tokenEquals(tokens_index(textTokens, iText + run), tokens_index(searchTokens, iSearch + run)))
+    run++;
+  return run;
+}
+
 static int applyDiff(const DiffMatchInfo* diff,
               GArray* matchedInfo,
               size_t* additionsCounter, size_t* removedCounter,
@@ -140,7 +309,9 @@ static void initSimpleMatch(DiffMatchInfo* simpleMatch, size_t iText, size_t iSe
  @brief perform a diff match search between two tokenized texts
 
  @param textTokens   array containing the Tokens of the text in which we are searching
+ @param textHashes   hashedContent of the textTokens packed in an array, or NULL
  @param searchTokens array containing the Tokens of the reference text to be searched
+ @param searchHashes hashedContent of the searchTokens packed in an array, or NULL
  @param textStartPosition position in the text where the search starts,
                           it will be updated to a value for a successive search
  @param maxAllowedDiff maximum number of Tokens that can be avoided
@@ -148,9 +319,10 @@ static void initSimpleMatch(DiffMatchInfo* simpleMatch, size_t iText, size_t iSe
 
  @return pointer to the result, or NULL on negative match. To be freed with diffResult_free
  ****************************************************/
-DiffResult* findMatchAsDiffs(const GArray* textTokens, const GArray* searchTokens,
-                             size_t textStartPosition, size_t searchStartPosition,
-                             unsigned int maxAllowedDiff, unsigned int minAdjacentMatches) {
+DiffResult* findMatchAsDiffsHashed(const GArray* textTokens, const uint32_t* textHashes,
+                                   const GArray* searchTokens, const uint32_t* searchHashes,
+                                   size_t textStartPosition, size_t searchStartPosition,
+                                   unsigned int maxAllowedDiff, unsigned int minAdjacentMatches) {
   size_t textLength = textTokens->len;
   size_t searchLength = searchTokens->len;
 
@@ -200,25 +372,26 @@ DiffResult* findMatchAsDiffs(const GArray* textTokens, const GArray* searchToken
     initSimpleMatch(&simpleMatch, iText, iSearch);
 
     while ((iText < textLength) && (iSearch < searchLength)) {
-      Token* textToken = tokens_index(textTokens, iText);
-      Token* searchToken = tokens_index(searchTokens, iSearch);
-
-      if (tokenEquals(textToken, searchToken)) {
-        simpleMatch.text.length++;
-        simpleMatch.search.length++;
-        matchedCounter++;
-        iSearch++;
-        iText++;
+      size_t matched = equalTokensRun(textTokens, textHashes, iText,
+                                      searchTokens, searchHashes, iSearch,
+                                      MIN(textLength - iText, searchLength - iSearch));
+
+      if (matched > 0) {
+        simpleMatch.text.length += matched;
+        simpleMatch.search.length += matched;
+        matchedCounter += matched;
+        iSearch += matched;
+        iText += matched;
       } else {
         /* the previous tokens matched, here starts a difference */
         g_array_append_val(matchedInfo, simpleMatch);
         initSimpleMatch(&simpleMatch, iText, iSearch);
 
         DiffMatchInfo diff;
-        if (lookForDiff(textTokens, searchTokens,
-                        iText, iSearch,
-                        maxAllowedDiff, minAdjacentMatches,
-                        &diff)) {
+        if (lookForDiffHashed(textTokens, textHashes, searchTokens, searchHashes,
+                              iText, iSearch,
+                              maxAllowedDiff, minAdjacentMatches,
+                              &diff)) {
           applyDiff(&diff,
                     matchedInfo,
                     &additionsCounter, &removedCounter,
@@ -268,6 +441,14 @@ DiffResult* findMatchAsDiffs(const GArray* textTokens, const GArray* searchToken
   }
 }
 
+DiffResult* findMatchAsDiffs(const GArray* textTokens, const GArray* searchTokens,
+                             size_t textStartPosition, size_t searchStartPosition,
+                             unsigned int maxAllowedDiff, unsigned int minAdjacentMatches) {
+  return findMatchAsDiffsHashed(textTokens, NULL, searchTokens, NULL,
+                                textStartPosition, searchStartPosition,
+                                maxAllowedDiff, minAdjacentMatches);
+}
+
 void diffResult_free(DiffResult* diffResult) {
   g_array_free(diffResult->matchedInfo, TRUE);
   free(diffResult);
@@ -55,6 +55,11 @@ DiffResult* findMatchAsDiffs(const GArray* textTokens, const GArray* searchToken
                              size_t textStartPosition, size_t searchStartPosition,
                              unsigned int maxAllowedDiff, unsigned int minAdjacentMatches);
 
+DiffResult* findMatchAsDiffsHashed(const GArray* textTokens, const uint32_t* textHashes,
+                                   const GArray* searchTokens, const uint32_t* searchHashes,
+                                   size_t textStartPosition, size_t searchStartPosition,
+                                   unsigned int maxAllowedDiff, unsigned int minAdjacentMatches);
+
 void diffResult_free(DiffResult* diffResult);
 
 #endif // MONK_AGENT_DIFF_H
@@ -33,12 +33,21 @@ iconv_t guessConverter(const char* buffer, size_t len)
 
   iconv_t iconvCookie = NULL;
 
+  /* the common case: ASCII and UTF-8 need no conversion, and no guessing */
+  if (g_utf8_validate(buffer, len, NULL))
+    return NULL;
+
   gchar* encoding = guessEncoding(buffer, len);
   if (encoding && (strcmp(encoding, target) != 0))
   {
     iconvCookie = iconv_open(target, encoding);
-    g_free(encoding);
+    if (iconvCookie == (iconv_t) -1)
+    {
+      // e.g. "binary": the content is used as it is
+      iconvCookie = NULL;
+    }
   }
+  g_free(encoding);
 
   return iconvCookie;
 }
@@ -16,9 +16,12 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#define _GNU_SOURCE
 #include "file_operations.h"
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -29,6 +32,95 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "encoding.h"
 
 #define BUFFSIZE 4096
+#define CONVERTED_BUFFSIZE (1024 * 1024)
+
+/* whole content of fd: mapped if possible, otherwise read in memory */
+static char* loadFile(int fd, size_t* size, int* mapped)
+{
+  struct stat statBuf;
+  *size = 0;
+  *mapped = 0;
+
+  if ((fstat(fd, &statBuf) == 0) && S_ISREG(statBuf.st_mode))
+  {
+    if (statBuf.st_size == 0)
+      return NULL;
+
+    void* mapping = mmap(NULL, statBuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED)
+    {
+      madvise(mapping, statBuf.st_size, MADV_SEQUENTIAL);
+      *size = statBuf.st_size;
+      *mapped = 1;
+      return mapping;
+    }
+  }
+
+  size_t allocated = BUFFSIZE;
+  char* content = malloc(allocated);
+  ssize_t n;
+  while ((n = read(fd, content + *size, allocated - *size)) > 0)
+  {
+    *size += n;
+    if (*size == allocated)
+    {
+      allocated *= 2;
+      content = realloc(content, allocated);
+    }
+  }
+
+  return content;
+}
+
+/* N.B. the tokenizer sees the same BUFFSIZE chunks as when the file was read a buffer at a time */
+static int tokenizeChunks(const char* fileName, const char* content, size_t size, const char* delimiters,
+                          GArray** tokens, Token** remainder)
+{
+  for (size_t done = 0; done < size; done += BUFFSIZE)
+  {
+    int addedTokens = streamTokenize(content + done, MIN(BUFFSIZE, size - done), delimiters, tokens, remainder);
+    if (addedTokens < 0)
+    {
+      printf("WARNING: can not complete tokenizing of '%s'\n", fileName);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void tokenizeConverted(const char* fileName, iconv_t converter, const char* content, size_t size,
+                              const char* delimiters, GArray** tokens, Token** remainder)
+{
+  char* convertedBuffer = malloc(CONVERTED_BUFFSIZE);
+
+  char* input = (char*) content;
+  size_t inputLeft = size;
+  while (inputLeft > 0)
+  {
+    char* output = convertedBuffer;
+    size_t outputLength = CONVERTED_BUFFSIZE;
+    int conversionError = 0;
+    if (iconv(converter, &input, &inputLeft, &output, &outputLength) == (size_t) -1)
+      conversionError = (errno == E2BIG) ? 0 : errno;
+
+    /* N.B. this tokenizes inside the re-encoded buffer:
+     * the offsets found are byte positions in the UTF-8 stream, not file positions
+     **/
+    if (!tokenizeChunks(fileName, convertedBuffer, CONVERTED_BUFFSIZE - outputLength, delimiters, tokens, remainder))
+      break;
+
+    if (conversionError)
+    {
+      // an invalid or truncated sequence: what is left can only be used as it is
+      if (conversionError == EILSEQ)
+        printf("WARNING: cannot re-encode '%s', going binary from now on\n", fileName);
+      tokenizeChunks(fileName, input, inputLeft, delimiters, tokens, remainder);
+      break;
+    }
+  }
+
+  free(convertedBuffer);
+}
 
 int readTokensFromFile(const char* fileName, GArray** tokens, const char* delimiters)
 {
@@ -39,75 +131,40 @@ int readTokensFromFile(const char* fileName, GArray** tokens, const char* delimi
     return 0;
   }
 
-  *tokens = tokens_new();
+  size_t size;
+  int mapped;
+  char* content = loadFile(fd, &size, &mapped);
+  close(fd);
 
-  int needConverter = 1;
-  iconv_t converter = NULL;
+  *tokens = tokens_new();
 
   Token* remainder = NULL;
 
-  char buffer[BUFFSIZE];
-  char convertedBuffer[BUFFSIZE];
-
-  ssize_t n;
-  size_t leftFromLast = 0;
-  while ((n = read(fd, buffer + leftFromLast, sizeof(buffer) - leftFromLast)) > 0)
+  if (size > 0)
   {
-    size_t len = (size_t) n + leftFromLast;
-    char* chunk = buffer;
-    leftFromLast = 0;
-
-    if (needConverter)
-    {
-      needConverter = 0;
-      converter = guessConverter(buffer, len);
-    }
+    /* files already in UTF-8 or ASCII are tokenized where they are mapped */
+    iconv_t converter = guessConverter(content, MIN(size, BUFFSIZE));
 
     if (converter)
     {
-      char* input = buffer;
-      size_t inputLeft = len;
-
-      char* output = convertedBuffer;
-      size_t outputLength = sizeof(convertedBuffer);
-      iconv(converter, &input, &inputLeft, &output, &outputLength);
-
-      if (outputLength != sizeof(convertedBuffer)) {
-        chunk = convertedBuffer;
-        len = sizeof(convertedBuffer) - outputLength;
-
-        leftFromLast = inputLeft;
-        for (size_t i = 0; i < leftFromLast; i++)
-        {
-          buffer[i] = *input++;
-        }
-      } else {
-        // the raw buffer is full and we could not write to the converted buffer
-        printf("WARNING: cannot re-encode '%s', going binary from now on\n", fileName);
-        iconv_close(converter);
-        converter = NULL;
-      }
+      tokenizeConverted(fileName, converter, content, size, delimiters, tokens, &remainder);
+      iconv_close(converter);
     }
-
-    /* N.B. this tokenizes inside the re-encoded buffer:
-     * the offsets found are byte positions in the UTF-8 stream, not file positions
-     **/
-    int addedTokens = streamTokenize(chunk, len, delimiters, tokens, &remainder);
-    if (addedTokens < 0)
+    else
     {
-      printf("WARNING: can not complete tokenizing of '%s'\n", fileName);
-      break;
+      tokenizeChunks(fileName, content, size, delimiters, tokens, &remainder);
     }
   }
 
-  streamTokenize(buffer, leftFromLast, delimiters, tokens, &remainder);
   streamTokenize(NULL, 0, NULL, tokens, &remainder);
 
-  close(fd);
-
-  if (converter)
+  if (mapped)
+  {
+    munmap(content, size);
+  }
+  else
   {
-    iconv_close(converter);
+    free(content);
   }
 
   return 1;
@@ -32,11 +32,3 @@ uint32_t hash(const char* string) {
 
   return result;
 }
-
-uint32_t hash_init() {
-  return 5231;
-}
-
-void hash_add(const char* value, uint32_t* currentHash) {
-  *currentHash = ((*currentHash << 6) + *currentHash) + *value;
-}
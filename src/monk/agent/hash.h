@@ -23,8 +23,12 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 uint32_t hash(const char* string);
 
-uint32_t hash_init();
+static inline uint32_t hash_init() {
+  return 5231;
+}
 
-void hash_add(const char* value, uint32_t* currentHash);
+static inline void hash_add(const char* value, uint32_t* currentHash) {
+  *currentHash = ((*currentHash << 6) + *currentHash) + *value;
+}
 
 #endif // MONK_AGENT_HASH_H
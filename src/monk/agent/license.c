@@ -17,6 +17,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 */
 
 #include <glib.h>
+#include <sys/mman.h>
 
 #include "license.h"
 #include "string_operations.h"
@@ -25,7 +26,21 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 static char* ignoredLicenseNames[] = {"Void", "No_license_found"};
 static char* ignoredLicenseTexts[] = {"License by Nomos.", "License by Ninka."};
 
-int isIgnoredLicense(const License* license) {
+#define IGNORED_LICENSE_TEXTS_COUNT (sizeof(ignoredLicenseTexts)/sizeof(char*))
+
+static void tokenizeIgnoredLicenseTexts(GArray** ignoredTokens) {
+  for (guint i = 0; i < IGNORED_LICENSE_TEXTS_COUNT; i++) {
+    ignoredTokens[i] = tokenize(ignoredLicenseTexts[i], DELIMITERS);
+  }
+}
+
+static void freeIgnoredLicenseTexts(GArray** ignoredTokens) {
+  for (guint i = 0; i < IGNORED_LICENSE_TEXTS_COUNT; i++) {
+    tokens_free(ignoredTokens[i]);
+  }
+}
+
+static int isIgnoredLicenseWith(const License* license, GArray** ignoredTokens) {
 
   int ignoredLicenseNamesCount = sizeof(ignoredLicenseNames)/sizeof(char*);
   for (int i = 0; i < ignoredLicenseNamesCount; i++) {
@@ -33,44 +48,72 @@ int isIgnoredLicense(const License* license) {
       return 1;
   }
 
-  int ignoredLicenseTextsCount = sizeof(ignoredLicenseTexts)/sizeof(char*);
-  for (int i = 0; i < ignoredLicenseTextsCount; i++) {
-    GArray* ignoredTokens = tokenize(ignoredLicenseTexts[i], DELIMITERS);
-    if (tokensEquals(license->tokens, ignoredTokens)) {
-      tokens_free(ignoredTokens);
+  for (guint i = 0; i < IGNORED_LICENSE_TEXTS_COUNT; i++) {
+    if (tokensEquals(license->tokens, ignoredTokens[i]))
       return 1;
-    }
-    tokens_free(ignoredTokens);
   }
 
   return 0;
 }
 
-Licenses* extractLicenses(fo_dbManager* dbManager, PGresult* licensesResult, unsigned minAdjacentMatches, unsigned maxLeadingDiff) {
-  GArray* licenses = g_array_new(TRUE, FALSE, sizeof (License));
+int isIgnoredLicense(const License* license) {
+  GArray* ignoredTokens[IGNORED_LICENSE_TEXTS_COUNT];
+  tokenizeIgnoredLicenseTexts(ignoredTokens);
 
-  for (int j = 0; j < PQntuples(licensesResult); j++) {
-    long refId = atol(PQgetvalue(licensesResult, j, 0));
-    char* licShortName = PQgetvalue(licensesResult, j, 1);
+  int result = isIgnoredLicenseWith(license, ignoredTokens);
 
-    License license;
-    license.refId = refId;
-    license.shortname = g_strdup(licShortName);
+  freeIgnoredLicenseTexts(ignoredTokens);
+  return result;
+}
 
-    char* licenseText = getLicenseTextForLicenseRefId(dbManager, refId);
-    GArray* licenseTokens = tokenize(licenseText, DELIMITERS);
+Licenses* extractLicenses(fo_dbManager* dbManager, PGresult* licensesResult, unsigned minAdjacentMatches, unsigned maxLeadingDiff) {
+  int licenseCount = PQntuples(licensesResult);
+  License* extracted = calloc(licenseCount + 1, sizeof(License));
+
+  /* queryAllLicenses() brings the texts along, for results without them
+   * fetch the texts one by one: the db connection is not shared by threads */
+  char** fetchedTexts = NULL;
+  if (PQnfields(licensesResult) < 3) {
+    fetchedTexts = calloc(licenseCount + 1, sizeof(char*));
+    for (int j = 0; j < licenseCount; j++) {
+      fetchedTexts[j] = getLicenseTextForLicenseRefId(dbManager, atol(PQgetvalue(licensesResult, j, 0)));
+    }
+  }
+
+#ifdef MONK_MULTI_THREAD
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int j = 0; j < licenseCount; j++) {
+    const char* licenseText = fetchedTexts ? fetchedTexts[j] : PQgetvalue(licensesResult, j, 2);
+    extracted[j].tokens = tokenize(licenseText, DELIMITERS);
+  }
 
-    free(licenseText);
-    license.tokens = licenseTokens;
+  GArray* ignoredTokens[IGNORED_LICENSE_TEXTS_COUNT];
+  tokenizeIgnoredLicenseTexts(ignoredTokens);
 
-    if (!isIgnoredLicense(&license))
-      g_array_append_val(licenses, license);
+  GArray* licenses = g_array_sized_new(TRUE, FALSE, sizeof (License), licenseCount);
+  for (int j = 0; j < licenseCount; j++) {
+    License* license = &extracted[j];
+    license->refId = atol(PQgetvalue(licensesResult, j, 0));
+    license->shortname = g_strdup(PQgetvalue(licensesResult, j, 1));
+
+    if (!isIgnoredLicenseWith(license, ignoredTokens))
+      g_array_append_val(licenses, *license);
     else {
-      tokens_free(license.tokens);
-      g_free(license.shortname);
+      tokens_free(license->tokens);
+      g_free(license->shortname);
     }
   }
 
+  freeIgnoredLicenseTexts(ignoredTokens);
+  if (fetchedTexts) {
+    for (int j = 0; j < licenseCount; j++) {
+      g_free(fetchedTexts[j]);
+    }
+    free(fetchedTexts);
+  }
+  free(extracted);
+
   return buildLicenseIndexes(licenses, minAdjacentMatches, maxLeadingDiff);
 }
 
@@ -80,7 +123,7 @@ void licenses_free(Licenses* licenses) {
     for (guint i = 0; i < licenseArray->len; i++) {
       License* license = license_index(licenseArray, i);
       tokens_free(license->tokens);
-      if (license->shortname) {
+      if (license->shortname && !licenses->mapping) {
         g_free(license->shortname);
       }
     }
@@ -88,34 +131,20 @@ void licenses_free(Licenses* licenses) {
     g_array_free(licenseArray, TRUE);
 
     g_array_free(licenses->shortLicenses, TRUE);
-
-    GArray* indexes = licenses->indexes;
-    for (guint i = 0; i < indexes->len; i++) {
-      GHashTable* index = g_array_index(indexes, GHashTable*, i);
-      g_hash_table_unref(index);
+    free(licenses->tokenHashesStart);
+
+    if (licenses->mapping) {
+      munmap(licenses->mapping, licenses->mappingSize);
+    } else {
+      free(licenses->germs);
+      free(licenses->germLicenses);
+      free(licenses->tokenHashes);
     }
-    g_array_free(indexes, TRUE);
 
     free(licenses);
   }
 }
 
-guint uint32_hash (gconstpointer v) {
-  uint32_t u = *(uint32_t*)v;
-  return u;
-}
-
-gboolean uint32_equal (gconstpointer  v1, gconstpointer  v2) {
-  uint32_t u1 = *(uint32_t*)v1;
-  uint32_t u2 = *(uint32_t*)v2;
-
-  return u1 == u2;
-}
-
-static void g_array_free_true(void* ptr) {
-  g_array_free(ptr, TRUE);
-}
-
 uint32_t getKey(const GArray* tokens, unsigned minAdjacentMatches, unsigned searchedStart) {
   uint32_t result = 1;
   for (guint i = 0; (i < minAdjacentMatches) && (i+searchedStart < tokens->len); i++)
@@ -127,50 +156,113 @@ uint32_t getKey(const GArray* tokens, unsigned minAdjacentMatches, unsigned sear
   return result;
 }
 
+guint* buildTokenHashesStart(const GArray* licenses) {
+  guint* tokenHashesStart = malloc(sizeof(guint) * (licenses->len + 1));
+  tokenHashesStart[0] = 0;
+  for (guint i = 0; i < licenses->len; i++) {
+    tokenHashesStart[i + 1] = tokenHashesStart[i] + license_index(licenses, i)->tokens->len;
+  }
+  return tokenHashesStart;
+}
+
+typedef struct {
+  uint32_t germ;
+  GermLicense license;
+} GermEntry;
+
+static int compareGermEntries(const void* a, const void* b) {
+  const GermEntry* entryA = a;
+  const GermEntry* entryB = b;
+
+  if (entryA->germ != entryB->germ)
+    return entryA->germ < entryB->germ ? -1 : 1;
+  if (entryA->license.sPos != entryB->license.sPos)
+    return entryA->license.sPos < entryB->license.sPos ? -1 : 1;
+  return (entryA->license.license > entryB->license.license) - (entryA->license.license < entryB->license.license);
+}
+
 Licenses* buildLicenseIndexes(GArray* licenses, unsigned minAdjacentMatches, unsigned maxLeadingDiff) {
   Licenses* result = malloc(sizeof(Licenses));
   if (!result)
     return NULL;
 
 #define is_short(license) ( (license)->tokens->len <= minAdjacentMatches )
-  GArray* shortLicenses = g_array_new(FALSE, FALSE, sizeof(License));
+  GArray* shortLicenses = g_array_new(FALSE, FALSE, sizeof(guint));
+  guint indexedCount = 0;
   for (guint i = 0; i < licenses->len; i++) {
     License* license = license_index(licenses, i);
     if (is_short(license)) {
-      g_array_append_val(shortLicenses, *license);
+      g_array_append_val(shortLicenses, i);
+    } else {
+      indexedCount++;
     }
   }
 
-  GArray* indexes = g_array_new(FALSE, FALSE, sizeof(GHashTable*));
-
+  /* collect (germ, #skippedTokens, license) and group them by germ */
+  size_t entryCount = (size_t) indexedCount * (maxLeadingDiff + 1);
+  GermEntry* entries = malloc(sizeof(GermEntry) * (entryCount + 1));
+  size_t e = 0;
   for (unsigned sPos = 0; sPos <= maxLeadingDiff; sPos++) {
-    GHashTable* index = g_hash_table_new_full(uint32_hash, uint32_equal, free, g_array_free_true);
-    g_array_append_val(indexes, index);
-
     for (guint i = 0; i < licenses->len; i++) {
       License* license = license_index(licenses, i);
       if (!is_short(license)) {
-        uint32_t* key = malloc(sizeof(uint32_t));
-        *key = getKey(license->tokens, minAdjacentMatches, sPos);
-
-        GArray* indexedLicenses = g_hash_table_lookup(index, key);
-        if (!indexedLicenses)
-        {
-          indexedLicenses = g_array_new(FALSE, FALSE, sizeof(License));
-          g_hash_table_replace(index, key, indexedLicenses);
-        } else {
-          free(key);
-        }
-        g_array_append_val(indexedLicenses, *license);
+        entries[e].germ = getKey(license->tokens, minAdjacentMatches, sPos);
+        entries[e].license.license = i;
+        entries[e].license.sPos = sPos;
+        e++;
       }
     }
   }
 #undef is_short
+  qsort(entries, entryCount, sizeof(GermEntry), compareGermEntries);
+
+  guint germCount = 0;
+  for (size_t i = 0; i < entryCount; i++) {
+    if (i == 0 || entries[i].germ != entries[i - 1].germ)
+      germCount++;
+  }
+
+  /* keep the table at most half full */
+  uint32_t germsSize = 2;
+  while (germsSize < 2 * germCount)
+    germsSize <<= 1;
+
+  GermSlot* germs = calloc(germsSize, sizeof(GermSlot));
+  GermLicense* germLicenses = malloc(sizeof(GermLicense) * (entryCount + 1));
+  for (size_t first = 0, next; first < entryCount; first = next) {
+    for (next = first; next < entryCount && entries[next].germ == entries[first].germ; next++) {
+      germLicenses[next] = entries[next].license;
+    }
+
+    uint32_t slot = germ_slot(entries[first].germ, germsSize - 1);
+    while (germs[slot].count > 0)
+      slot = (slot + 1) & (germsSize - 1);
+    germs[slot].germ = entries[first].germ;
+    germs[slot].first = first;
+    germs[slot].count = next - first;
+  }
+  free(entries);
+
+  guint* tokenHashesStart = buildTokenHashesStart(licenses);
+  uint32_t* tokenHashes = malloc(sizeof(uint32_t) * (tokenHashesStart[licenses->len] + 1));
+  for (guint i = 0; i < licenses->len; i++) {
+    GArray* tokens = license_index(licenses, i)->tokens;
+    for (guint j = 0; j < tokens->len; j++) {
+      tokenHashes[tokenHashesStart[i] + j] = g_array_index(tokens, Token, j).hashedContent;
+    }
+  }
 
   result->licenses = licenses;
   result->shortLicenses = shortLicenses;
-  result->indexes = indexes;
+  result->germs = germs;
+  result->germsMask = germsSize - 1;
+  result->germLicenses = germLicenses;
   result->minAdjacentMatches = minAdjacentMatches;
+  result->maxLeadingDiff = maxLeadingDiff;
+  result->tokenHashes = tokenHashes;
+  result->tokenHashesStart = tokenHashesStart;
+  result->mapping = NULL;
+  result->mappingSize = 0;
 
   return result;
 }
@@ -179,17 +271,30 @@ const GArray* getShortLicenseArray(const Licenses* licenses) {
   return licenses->shortLicenses;
 }
 
-const GArray* getLicenseArrayFor(const Licenses* licenses, unsigned searchPos, const GArray* searchedTokens, unsigned searchedStart) {
-  const GArray* indexes = licenses->indexes;
-
-  guint minAdjacentMatches = licenses->minAdjacentMatches;
-
-  if (indexes->len <= searchPos) {
-    return licenses->licenses;
+/* sha1 of what the results depend on besides the scanned file: the matching
+ * parameters and the tokens of the licenses */
+gchar* licenses_fingerprint(const Licenses* licenses) {
+  GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA1);
+
+  const guint32 parameters[] = {
+    MONK_FINGERPRINT_REVISION,
+    licenses->minAdjacentMatches,
+    licenses->maxLeadingDiff,
+    MAX_ALLOWED_DIFF_LENGTH,
+    MIN_ALLOWED_RANK
+  };
+  g_checksum_update(checksum, (const guchar*) parameters, sizeof(parameters));
+
+  const GArray* licenseArray = licenses->licenses;
+  for (guint i = 0; i < licenseArray->len; i++) {
+    const License* license = license_index(licenseArray, i);
+    const gint64 refId = license->refId;
+    g_checksum_update(checksum, (const guchar*) &refId, sizeof(refId));
+    g_checksum_update(checksum, (const guchar*) license->tokens->data,
+                      license->tokens->len * sizeof(Token));
   }
 
-  GHashTable* index = g_array_index(indexes, GHashTable*, searchPos);
-  uint32_t key = getKey(searchedTokens, minAdjacentMatches, searchedStart);
-  GArray* result = g_hash_table_lookup(index, &key);
+  gchar* result = g_strdup(g_checksum_get_string(checksum));
+  g_checksum_free(checksum);
   return result;
 }
@@ -27,11 +27,37 @@ int isIgnoredLicense(const License* license);
 /** @return License* */
 #define license_index(licenses, index) (&g_array_index((licenses), License, (index)))
 
+/* first slot to probe for a germ in a table of mask+1 slots */
+#define germ_slot(germ, mask) ((((uint32_t) (germ) * 0x9E3779B1u) >> 7) & (mask))
+
 Licenses* extractLicenses(fo_dbManager* dbManager, PGresult* licensesResult, unsigned minAdjacentMatches, unsigned maxLeadingDiff);
 Licenses* buildLicenseIndexes(GArray* licenses, unsigned minAdjacentMatches, unsigned maxLeadingDiff);
 void licenses_free(Licenses* licenses);
-const GArray* getLicenseArrayFor(const Licenses* licenses, unsigned searchPos, const GArray* textTokens, unsigned textStart);
+uint32_t getKey(const GArray* tokens, unsigned minAdjacentMatches, unsigned searchedStart);
+guint* buildTokenHashesStart(const GArray* licenses);
 const GArray* getShortLicenseArray(const Licenses* licenses);
+gchar* licenses_fingerprint(const Licenses* licenses);
+
+/**
+ * @brief licenses whose tokens, after skipping some leading tokens, start with germ
+ * @param count set to the number of returned licenses
+ * @return GermLicense[count] sorted by skipped tokens and position, NULL if there is none
+ */
+static inline const GermLicense* getGermLicenses(const Licenses* licenses, uint32_t germ, guint* count) {
+  const uint32_t mask = licenses->germsMask;
+  for (uint32_t slot = germ_slot(germ, mask); ; slot = (slot + 1) & mask) {
+    const GermSlot* germSlot = &licenses->germs[slot];
+    if (germSlot->count == 0) {
+      /* we hope to get here very often */
+      *count = 0;
+      return NULL;
+    }
+    if (germSlot->germ == germ) {
+      *count = germSlot->count;
+      return licenses->germLicenses + germSlot->first;
+    }
+  }
+}
 
 
 #endif // MONK_AGENT_LICENSE_H
@@ -21,19 +21,27 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "license.h"
 #include "file_operations.h"
 
-static inline void doFindAllMatches(const File* file, const GArray* licenseArray,
-                                    guint tPos, guint sPos,
-                                    unsigned maxAllowedDiff, unsigned minAdjacentMatches,
-                                    GArray* matches) {
-  if (!licenseArray) {
-    /* we hope to get here very often */
+static inline void doFindMatch(const File* file, const Licenses* licenses, const uint32_t* textHashes,
+                               guint license, guint tPos, guint sPos,
+                               unsigned maxAllowedDiff, unsigned minAdjacentMatches,
+                               GArray* matches) {
+  const guint licenseStart = licenses->tokenHashesStart[license];
+  const guint licenseLength = licenses->tokenHashesStart[license + 1] - licenseStart;
+  const guint textLength = file->tokens->len;
+
+  /* the first tokens must match anyway: compare their packed hashes before looking at the tokens */
+  if (sPos >= licenseLength)
     return;
-  }
 
-  for (guint i = 0; i < licenseArray->len; i++) {
-    License* license = license_index(licenseArray, i);
-    findDiffMatches(file, license, tPos, sPos, matches, maxAllowedDiff, minAdjacentMatches);
+  const uint32_t* licenseHashes = licenses->tokenHashes + licenseStart;
+  const guint shouldMatch = MIN(minAdjacentMatches, MIN(textLength - tPos, licenseLength - sPos));
+  for (guint i = 0; i < shouldMatch; i++) {
+    if (textHashes[tPos + i] != licenseHashes[sPos + i])
+      return;
   }
+
+  findDiffMatches(file, textHashes, license_index(licenses->licenses, license), licenseHashes,
+                  tPos, sPos, matches, maxAllowedDiff, minAdjacentMatches);
 }
 
 GArray* findAllMatchesBetween(const File* file, const Licenses* licenses,
@@ -42,18 +50,55 @@ GArray* findAllMatchesBetween(const File* file, const Licenses* licenses,
 
   const GArray* textTokens = file->tokens;
   const guint textLength = textTokens->len;
+  const guint licenseCount = licenses->licenses->len;
+  const GArray* shortLicenses = getShortLicenseArray(licenses);
 
+  uint32_t* textHashes = malloc(sizeof(uint32_t) * (textLength + 1));
   for (guint tPos = 0; tPos < textLength; tPos++) {
-    for (guint sPos = 0; sPos <= maxLeadingDiff; sPos++) {
-      const GArray* availableLicenses = getLicenseArrayFor(licenses, sPos, textTokens, tPos);
-      doFindAllMatches(file, availableLicenses, tPos, sPos, maxAllowedDiff, minAdjacentMatches, matches);
+    textHashes[tPos] = g_array_index(textTokens, Token, tPos).hashedContent;
+  }
+
+  /* the germ of getKey() is leadWeight + sum(hash[i] * firstWeight / 2^i),
+   * so it can be rolled along the text while it covers a whole window */
+  const unsigned germLength = licenses->minAdjacentMatches;
+  uint32_t leadWeight = 1;
+  uint32_t firstWeight = 0;
+  for (unsigned i = 0; i < germLength; i++) {
+    firstWeight = leadWeight;
+    leadWeight <<= 1;
+  }
+
+  uint32_t germ = 0;
+  for (guint tPos = 0; tPos < textLength; tPos++) {
+    if (tPos > 0 && germLength > 0 && tPos + germLength <= textLength) {
+      germ = ((germ - leadWeight - textHashes[tPos - 1] * firstWeight) << 1)
+             + textHashes[tPos + germLength - 1] + leadWeight;
+    } else {
+      germ = getKey(textTokens, germLength, tPos);
+    }
+
+    guint germCount;
+    const GermLicense* germLicenses = getGermLicenses(licenses, germ, &germCount);
+    for (guint i = 0; i < germCount && germLicenses[i].sPos <= maxLeadingDiff; i++) {
+      doFindMatch(file, licenses, textHashes, germLicenses[i].license, tPos, germLicenses[i].sPos,
+                  maxAllowedDiff, minAdjacentMatches, matches);
+    }
+
+    /* the index does not skip that many leading tokens: try all licenses */
+    for (guint sPos = licenses->maxLeadingDiff + 1; sPos <= maxLeadingDiff; sPos++) {
+      for (guint i = 0; i < licenseCount; i++) {
+        doFindMatch(file, licenses, textHashes, i, tPos, sPos, maxAllowedDiff, minAdjacentMatches, matches);
+      }
     }
 
     /* now search short licenses only fully (i.e. maxAllowedDiff = 0, minAdjacentMatches = 1) */
-    const GArray* shortLicenses = getShortLicenseArray(licenses);
-    doFindAllMatches(file, shortLicenses, tPos, 0, 0, 1, matches);
+    for (guint i = 0; i < shortLicenses->len; i++) {
+      doFindMatch(file, licenses, textHashes, g_array_index(shortLicenses, guint, i), tPos, 0, 0, 1, matches);
+    }
   }
 
+  free(textHashes);
+
   return filterNonOverlappingMatches(matches);
 }
 
@@ -87,14 +132,7 @@ static char* getFileName(MonkState* state, long pFileId) {
     printf("file not found for pFileId=%ld\n", pFileId);
     return NULL;
   }
-  char* pFileName;
-
-#ifdef MONK_MULTI_THREAD
-#pragma omp critical(getFileName)
-#endif
-  {
-    pFileName = fo_RepMkPath("files", pFile);
-  }
+  char* pFileName = fo_RepMkPath("files", pFile);
 
   if (!pFileName) {
     printf("file '%s' not found\n", pFile);
@@ -434,7 +472,8 @@ Match* diffResult2Match(DiffResult* diffResult, const License* license) {
   return newMatch;
 }
 
-void findDiffMatches(const File* file, const License* license,
+void findDiffMatches(const File* file, const uint32_t* textHashes,
+        const License* license, const uint32_t* licenseHashes,
         size_t textStartPosition, size_t searchStartPosition,
         GArray* matches,
         unsigned int maxAllowedDiff, unsigned int minAdjacentMatches) {
@@ -445,7 +484,7 @@ void findDiffMatches(const File* file, const License* license,
     return;
   }
 
-  DiffResult* diffResult = findMatchAsDiffs(file->tokens, license->tokens,
+  DiffResult* diffResult = findMatchAsDiffsHashed(file->tokens, textHashes, license->tokens, licenseHashes,
           textStartPosition, searchStartPosition,
           maxAllowedDiff, minAdjacentMatches);
 
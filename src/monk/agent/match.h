@@ -65,7 +65,8 @@ GArray* findAllMatchesBetween(const File* file, const Licenses* licenses, unsign
 int matchPFileWithLicenses(MonkState* state, long pFileId, const Licenses* licenses, const MatchCallbacks* callbacks);
 int matchFileWithLicenses(MonkState* state, const File* file, const Licenses* licenses, const MatchCallbacks* callbacks);
 
-void findDiffMatches(const File* file, const License* license,
+void findDiffMatches(const File* file, const uint32_t* textHashes,
+                     const License* license, const uint32_t* licenseHashes,
                      size_t textStartPosition, size_t searchStartPosition,
                      GArray* matches,
                      unsigned maxAllowedDiff, unsigned minAdjacentMatches);
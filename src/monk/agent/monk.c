@@ -133,10 +133,12 @@ int main(int argc, char** argv) {
     int oldArgc = argc;
     fo_scheduler_connect_dbMan(&argc, argv, &(state->dbManager));
     fileOptInd = fileOptInd - oldArgc + argc;
+#ifdef MONK_MULTI_THREAD
+    /* keep the connection of every thread for the next uploads */
+    fo_dbManager_setPoolSize(state->dbManager, omp_get_max_threads());
+#endif
 
-    PGresult* licensesResult = queryAllLicenses(state->dbManager);
-    licenses = extractLicenses(state->dbManager, licensesResult, MIN_ADJACENT_MATCHES, MAX_LEADING_DIFF);
-    PQclear(licensesResult);
+    licenses = loadKnowledgebase(state->dbManager, CACHEDIR, MIN_ADJACENT_MATCHES, MAX_LEADING_DIFF);
   } else {
     licenses = deserializeFromFile(state->knowledgebaseFile, MIN_ADJACENT_MATCHES, MAX_LEADING_DIFF);
   }
@@ -155,7 +157,9 @@ int main(int argc, char** argv) {
     wasSuccessful = handleCliMode(state, licenses, argc, argv, fileOptInd);
   } else if (state->scanMode == MODE_EXPORT_KOWLEDGEBASE) {
     printf("Write knowledgebase to %s\n", state->knowledgebaseFile);
-    wasSuccessful = serializeToFile(licenses, state->knowledgebaseFile);
+    char* checksum = getLicenseRefChecksum(state->dbManager);
+    wasSuccessful = writeKnowledgebase(licenses, checksum, state->knowledgebaseFile);
+    g_free(checksum);
   }
 
   licenses_free(licenses);
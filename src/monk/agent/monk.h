@@ -43,11 +43,17 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #define MAX_LEADING_DIFF 10
 #define MIN_ALLOWED_RANK 66
 
+/* change it when the matching changes: the results of monk versions with
+ * the same licenses and revision are reused, see licenses_fingerprint() */
+#define MONK_FINGERPRINT_REVISION 1
+
 #include <glib.h>
+#include <stdint.h>
 #include "libfossdbmanager.h"
 
 #if GLIB_CHECK_VERSION(2,32,0)
 #define MONK_MULTI_THREAD
+#include <omp.h>
 #endif
 
 
@@ -73,17 +79,42 @@ typedef struct {
   GArray* tokens;
 } File;
 
+typedef struct {
+  uint32_t germ;
+  uint32_t first; /* position of the first GermLicense with this germ */
+  uint32_t count; /* number of licenses with this germ, 0 for empty slots */
+} GermSlot;
+
+typedef struct {
+  uint32_t license; /* position in Licenses.licenses */
+  uint32_t sPos;    /* number of skipped leading tokens of the license */
+} GermLicense;
+
 typedef struct {
   GArray* licenses;
 
-  /* germ of licenses with the same starting tokens
-   *   GArray<GHash<Germ, GArray<License>>> :  { [#skippedTokens]{ germ -> [License] } }  */
-  GArray* indexes;
+  /* germ of licenses with the same starting tokens, open addressing hash table on the germ
+   *   GermSlot[germsMask + 1] : { germ -> [(#skippedTokens, license)] } sorted by #skippedTokens */
+  GermSlot* germs;
+  uint32_t germsMask;
+  GermLicense* germLicenses;
   /* number of tokens used as germ when the index was built */
   unsigned minAdjacentMatches;
+  /* maximum #skippedTokens in the index */
+  unsigned maxLeadingDiff;
 
-  /* licenses shorter than what is needed to compute the germ are in this class */
+  /* licenses shorter than what is needed to compute the germ are in this class
+   *   GArray<guint> : positions in licenses */
   GArray* shortLicenses;
+
+  /* hashes of the tokens of all the licenses, contiguous for each license:
+   *   tokenHashes[tokenHashesStart[i]..tokenHashesStart[i+1]] are the hashes of license i */
+  uint32_t* tokenHashes;
+  guint* tokenHashesStart;
+
+  /* knowledge base file the index and shortnames point into, NULL if they are allocated */
+  void* mapping;
+  size_t mappingSize;
 } Licenses;
 
 #endif // MONK_AGENT_MONK_H
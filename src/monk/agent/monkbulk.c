@@ -239,6 +239,10 @@ int main(int argc, char** argv) {
   MonkState* state = &stateStore;
 
   fo_scheduler_connect_dbMan(&argc, argv, &(state->dbManager));
+#ifdef MONK_MULTI_THREAD
+  /* keep the connection of every thread for the next bulk scans */
+  fo_dbManager_setPoolSize(state->dbManager, omp_get_max_threads());
+#endif
 
   queryAgentId(state, AGENT_BULK_NAME, AGENT_BULK_DESC);
 
@@ -20,6 +20,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 
 #include "common.h"
 #include "database.h"
+#include "license.h"
 
 MatchCallbacks schedulerCallbacks =
   { .onNo = sched_onNoMatch,
@@ -52,7 +53,13 @@ int processUploadId(MonkState* state, int uploadId, const Licenses* licenses) {
     MonkState* threadLocalState = &threadLocalStateStore;
 
     threadLocalState->dbManager = fo_dbManager_fork(state->dbManager);
+    ResultBuffer* resultBuffer = NULL;
     if (threadLocalState->dbManager) {
+      resultBuffer = resultBuffer_new(threadLocalState->dbManager, threadLocalState->agentId);
+    }
+    threadLocalState->ptr = resultBuffer;
+
+    if (resultBuffer) {
       int count = PQntuples(fileIdResult);
 #ifdef MONK_MULTI_THREAD
       #pragma omp for schedule(dynamic)
@@ -69,17 +76,24 @@ int processUploadId(MonkState* state, int uploadId, const Licenses* licenses) {
           continue;
         }
 
-        if (matchPFileWithLicenses(threadLocalState, pFileId, licenses, &schedulerCallbacks)) {
+        if (matchPFileWithLicenses(threadLocalState, pFileId, licenses, &schedulerCallbacks)
+            && resultBuffer_flushIfFull(resultBuffer)) {
           fo_scheduler_heart(1);
         } else {
           fo_scheduler_heart(0);
           threadError = 1;
         }
       }
-      fo_dbManager_finish(threadLocalState->dbManager);
+
+      if (!threadError && !resultBuffer_flush(resultBuffer))
+        threadError = 1;
+      resultBuffer_free(resultBuffer);
     } else {
       threadError = 1;
     }
+
+    if (threadLocalState->dbManager)
+      fo_dbManager_finish(threadLocalState->dbManager);
   }
   PQclear(fileIdResult);
 
@@ -91,6 +105,16 @@ int handleSchedulerMode(MonkState* state, const Licenses* licenses) {
   state->scanMode = MODE_SCHEDULER;
   queryAgentId(state, AGENT_NAME, AGENT_DESC);
 
+  /* results of other monk versions are copied instead of scanning again */
+  gchar* fingerprint = NULL;
+  if (fo_ResultReuseEnabled()) {
+    fingerprint = licenses_fingerprint(licenses);
+    if (!fo_SetAgentFingerprint(state->dbManager, state->agentId, fingerprint)) {
+      g_free(fingerprint);
+      fingerprint = NULL;
+    }
+  }
+
   while (fo_scheduler_next() != NULL) {
     int uploadId = atoi(fo_scheduler_current());
 
@@ -102,6 +126,12 @@ int handleSchedulerMode(MonkState* state, const Licenses* licenses) {
     if (arsId<=0)
       bail(state, 1);
 
+    if (fingerprint) {
+      long copied = fo_CopyLicenseFileResults(state->dbManager, uploadId, state->agentId, fingerprint);
+      if (copied > 0)
+        fo_scheduler_heart(copied);
+    }
+
     if (!processUploadId(state, uploadId, licenses))
       bail(state, 2);
 
@@ -109,42 +139,33 @@ int handleSchedulerMode(MonkState* state, const Licenses* licenses) {
                 arsId, uploadId, state->agentId, AGENT_ARS, NULL, 1);
   }
   fo_scheduler_heart(0);
+  g_free(fingerprint);
 
   return 1;
 }
 
 int sched_onNoMatch(MonkState* state, const File* file) {
-  return saveNoResultToDb(state->dbManager, state->agentId, file->id);
+  ResultBuffer* resultBuffer = state->ptr;
+  return resultBuffer_addNoResult(resultBuffer, file->id);
 }
 
 int sched_onFullMatch(MonkState* state, const File* file, const License* license, const DiffMatchInfo* matchInfo) {
-  fo_dbManager* dbManager = state->dbManager;
-  const int agentId = state->agentId;
+  ResultBuffer* resultBuffer = state->ptr;
   const long fileId = file->id;
 
 #ifdef DEBUG
     printf("found full match between (pFile=%ld) and \"%s\" (rf_pk=%ld)\n", file->id, license->shortname, license->refId);
 #endif //DEBUG
 
-  fo_dbManager_begin(dbManager);
-
-  int success = 0;
-  long licenseFileId = saveToDb(dbManager, agentId, license->refId, fileId, 100);
-  if (licenseFileId > 0) {
-    success = saveDiffHighlightToDb(dbManager, matchInfo, licenseFileId);
-  }
+  long licenseFileId = resultBuffer_addLicenseFile(resultBuffer, license->refId, fileId, 100);
+  if (licenseFileId <= 0)
+    return 0;
 
-  if (success) {
-    fo_dbManager_commit(dbManager);
-  } else {
-    fo_dbManager_rollback(dbManager);
-  }
-  return success;
+  return resultBuffer_addHighlight(resultBuffer, matchInfo, licenseFileId);
 }
 
 int sched_onDiffMatch(MonkState* state, const File* file, const License* license, const DiffResult* diffResult) {
-  fo_dbManager* dbManager = state->dbManager;
-  const int agentId = state->agentId;
+  ResultBuffer* resultBuffer = state->ptr;
   const long fileId = file->id;
 
   unsigned short matchPercent = diffResult->percentual;
@@ -158,21 +179,11 @@ int sched_onDiffMatch(MonkState* state, const File* file, const License* license
     free(formattedMatchArray);
 #endif //DEBUG
 
-  fo_dbManager_begin(dbManager);
-
-  int success = 0;
-  long licenseFileId = saveToDb(dbManager, agentId, license->refId, fileId, matchPercent);
-  if (licenseFileId > 0) {
-    success = saveDiffHighlightsToDb(dbManager, diffResult->matchedInfo, licenseFileId);
-  }
-
-  if (success) {
-    fo_dbManager_commit(dbManager);
-  } else {
-    fo_dbManager_rollback(dbManager);
-  }
+  long licenseFileId = resultBuffer_addLicenseFile(resultBuffer, license->refId, fileId, matchPercent);
+  if (licenseFileId <= 0)
+    return 0;
 
-  return success;
+  return resultBuffer_addHighlights(resultBuffer, diffResult->matchedInfo, licenseFileId);
 }
 
 /* check if we have other results for this file.
@@ -16,13 +16,19 @@ Copyright (C) 2018, TNG Technology Consulting GmbH
  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#define _GNU_SOURCE
 #include "serialize.h"
 
 #include "monk.h"
 #include "license.h"
+#include "database.h"
 #include "string_operations.h"
 #include <stdio.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /*
  * serialization
@@ -89,6 +95,20 @@ Licenses* deserializeFromFile(char* filename, unsigned minAdjacentMatches, unsig
   if(fp == NULL) {
     exit(3);
   }
+
+  char magic[sizeof(KNOWLEDGEBASE_MAGIC)];
+  if (fread(magic, sizeof(magic), 1, fp) == 1 &&
+      memcmp(magic, KNOWLEDGEBASE_MAGIC, sizeof(magic)) == 0) {
+    fclose(fp);
+    Licenses* result = mapKnowledgebase(filename, NULL, minAdjacentMatches, maxLeadingDiff);
+    if (result == NULL) {
+      fprintf(stderr, "knowledgebase %s is corrupted or from another monk version\n", filename);
+      exit(3);
+    }
+    return result;
+  }
+  rewind(fp);
+
   Licenses* result = deserialize(fp, minAdjacentMatches, maxLeadingDiff);
   fclose(fp);
   return result;
@@ -128,3 +148,256 @@ GArray* deserializeTokens(FILE* fp, guint tokensLen) {
 
   return tokens;
 }
+
+/*
+ * knowledge base
+ */
+
+#define kb_align(offset) (((offset) + 7) & ~((uint64_t) 7))
+
+static int writeSection(FILE* fp, uint64_t offset, const void* data, size_t size) {
+  long position = ftell(fp);
+  if (position < 0)
+    return 0;
+  for (uint64_t i = position; i < offset; i++) {
+    if (fputc(0, fp) == EOF)
+      return 0;
+  }
+  return size == 0 || fwrite(data, size, 1, fp) == 1;
+}
+
+int writeKnowledgebase(const Licenses* licenses, const char* checksum, const char* filename) {
+  const GArray* licenseArray = licenses->licenses;
+
+  KnowledgebaseHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, KNOWLEDGEBASE_MAGIC, sizeof(header.magic));
+  header.version = KNOWLEDGEBASE_VERSION;
+  header.tokenSize = sizeof(Token);
+  if (checksum) {
+    g_strlcpy(header.checksum, checksum, sizeof(header.checksum));
+  }
+  header.minAdjacentMatches = licenses->minAdjacentMatches;
+  header.maxLeadingDiff = licenses->maxLeadingDiff;
+
+  KnowledgebaseLicense* records = calloc(licenseArray->len + 1, sizeof(KnowledgebaseLicense));
+  for (guint i = 0; i < licenseArray->len; i++) {
+    License* license = license_index(licenseArray, i);
+    records[i].refId = license->refId;
+    records[i].shortname = header.shortnamesSize;
+    records[i].tokens = licenses->tokenHashesStart[i];
+    records[i].tokensLen = license->tokens->len;
+    header.shortnamesSize += strlen(license->shortname) + 1;
+  }
+
+  uint64_t germLicenseCount = 0;
+  for (uint64_t i = 0; i <= licenses->germsMask; i++) {
+    germLicenseCount += licenses->germs[i].count;
+  }
+
+  header.licenseCount = licenseArray->len;
+  header.licensesOffset = kb_align(sizeof(KnowledgebaseHeader));
+  header.tokenCount = licenses->tokenHashesStart[licenseArray->len];
+  header.tokensOffset = kb_align(header.licensesOffset + header.licenseCount * sizeof(KnowledgebaseLicense));
+  header.tokenHashesOffset = kb_align(header.tokensOffset + header.tokenCount * sizeof(Token));
+  header.germSlotCount = (uint64_t) licenses->germsMask + 1;
+  header.germsOffset = kb_align(header.tokenHashesOffset + header.tokenCount * sizeof(uint32_t));
+  header.germLicenseCount = germLicenseCount;
+  header.germLicensesOffset = kb_align(header.germsOffset + header.germSlotCount * sizeof(GermSlot));
+  header.shortnamesOffset = kb_align(header.germLicensesOffset + header.germLicenseCount * sizeof(GermLicense));
+  header.fileSize = header.shortnamesOffset + header.shortnamesSize;
+
+  /* write to a temporary file and move it in place, processes already
+   * mapping the old file keep their consistent copy */
+  char* tmpFilename = g_strdup_printf("%s.XXXXXX", filename);
+  int fd = mkstemp(tmpFilename);
+  FILE* fp = fd < 0 ? NULL : fdopen(fd, "w");
+  int result = fp != NULL;
+
+  result = result && writeSection(fp, 0, &header, sizeof(header));
+  result = result && writeSection(fp, header.licensesOffset, records, header.licenseCount * sizeof(KnowledgebaseLicense));
+  for (guint i = 0; result && i < licenseArray->len; i++) {
+    GArray* tokens = license_index(licenseArray, i)->tokens;
+    result = writeSection(fp, header.tokensOffset + records[i].tokens * sizeof(Token),
+                          tokens->data, tokens->len * sizeof(Token));
+  }
+  result = result && writeSection(fp, header.tokenHashesOffset, licenses->tokenHashes, header.tokenCount * sizeof(uint32_t));
+  result = result && writeSection(fp, header.germsOffset, licenses->germs, header.germSlotCount * sizeof(GermSlot));
+  result = result && writeSection(fp, header.germLicensesOffset, licenses->germLicenses, header.germLicenseCount * sizeof(GermLicense));
+  for (guint i = 0; result && i < licenseArray->len; i++) {
+    char* shortname = license_index(licenseArray, i)->shortname;
+    result = writeSection(fp, header.shortnamesOffset + records[i].shortname, shortname, strlen(shortname) + 1);
+  }
+  result = result && (fchmod(fd, 0644) == 0);
+
+  if (fp != NULL) {
+    result = (fclose(fp) == 0) && result;
+  } else if (fd >= 0) {
+    close(fd);
+  }
+  result = result && (rename(tmpFilename, filename) == 0);
+  if (!result && fd >= 0) {
+    unlink(tmpFilename);
+  }
+
+  g_free(tmpFilename);
+  free(records);
+
+  return result;
+}
+
+static int sectionFits(uint64_t offset, uint64_t count, size_t elementSize, uint64_t fileSize) {
+  return offset % 8 == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+static int isValidKnowledgebase(const void* mapping, uint64_t size, const char* checksum,
+                                unsigned minAdjacentMatches, unsigned maxLeadingDiff) {
+  const KnowledgebaseHeader* header = mapping;
+
+  if (memcmp(header->magic, KNOWLEDGEBASE_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != KNOWLEDGEBASE_VERSION ||
+      header->tokenSize != sizeof(Token) ||
+      header->fileSize != size ||
+      header->minAdjacentMatches != minAdjacentMatches ||
+      header->maxLeadingDiff != maxLeadingDiff ||
+      header->checksum[sizeof(header->checksum) - 1] != '\0')
+    return 0;
+
+  if (checksum && strcmp(header->checksum, checksum) != 0)
+    return 0;
+
+  if (!sectionFits(header->licensesOffset, header->licenseCount, sizeof(KnowledgebaseLicense), size) ||
+      !sectionFits(header->tokensOffset, header->tokenCount, sizeof(Token), size) ||
+      !sectionFits(header->tokenHashesOffset, header->tokenCount, sizeof(uint32_t), size) ||
+      !sectionFits(header->germsOffset, header->germSlotCount, sizeof(GermSlot), size) ||
+      !sectionFits(header->germLicensesOffset, header->germLicenseCount, sizeof(GermLicense), size) ||
+      !sectionFits(header->shortnamesOffset, header->shortnamesSize, 1, size))
+    return 0;
+
+  const char* shortnames = (const char*) mapping + header->shortnamesOffset;
+  if (header->shortnamesSize > 0 && shortnames[header->shortnamesSize - 1] != '\0')
+    return 0;
+
+  /* the tokens of the licenses are contiguous */
+  const KnowledgebaseLicense* records = (const void*) ((const char*) mapping + header->licensesOffset);
+  uint64_t tokens = 0;
+  for (uint64_t i = 0; i < header->licenseCount; i++) {
+    if (records[i].shortname >= header->shortnamesSize ||
+        records[i].tokens != tokens ||
+        records[i].tokensLen > header->tokenCount - tokens)
+      return 0;
+    tokens += records[i].tokensLen;
+  }
+  if (tokens != header->tokenCount)
+    return 0;
+
+  /* the germ table has a power of two size and at least one empty slot */
+  const GermSlot* germs = (const void*) ((const char*) mapping + header->germsOffset);
+  const GermLicense* germLicenses = (const void*) ((const char*) mapping + header->germLicensesOffset);
+  if (header->germSlotCount == 0 || header->germSlotCount > ((uint64_t) 1 << 32) ||
+      (header->germSlotCount & (header->germSlotCount - 1)) != 0)
+    return 0;
+  uint64_t emptySlots = 0;
+  for (uint64_t i = 0; i < header->germSlotCount; i++) {
+    if (germs[i].count == 0)
+      emptySlots++;
+    else if (germs[i].first > header->germLicenseCount ||
+             germs[i].count > header->germLicenseCount - germs[i].first)
+      return 0;
+  }
+  if (emptySlots == 0)
+    return 0;
+  for (uint64_t i = 0; i < header->germLicenseCount; i++) {
+    if (germLicenses[i].license >= header->licenseCount ||
+        germLicenses[i].sPos > maxLeadingDiff)
+      return 0;
+  }
+
+  return 1;
+}
+
+Licenses* mapKnowledgebase(const char* filename, const char* checksum, unsigned minAdjacentMatches, unsigned maxLeadingDiff) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || (size_t) fileStat.st_size < sizeof(KnowledgebaseHeader)) {
+    close(fd);
+    return NULL;
+  }
+
+  size_t size = fileStat.st_size;
+  void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+    return NULL;
+
+  if (!isValidKnowledgebase(mapping, size, checksum, minAdjacentMatches, maxLeadingDiff)) {
+    munmap(mapping, size);
+    return NULL;
+  }
+
+  const KnowledgebaseHeader* header = mapping;
+  const KnowledgebaseLicense* records = (const void*) ((const char*) mapping + header->licensesOffset);
+  const Token* tokens = (const void*) ((const char*) mapping + header->tokensOffset);
+  char* shortnames = (char*) mapping + header->shortnamesOffset;
+
+  /* diff works on GArrays of tokens: these are copied, everything else stays in the mapping */
+  GArray* licenseArray = g_array_sized_new(TRUE, FALSE, sizeof(License), header->licenseCount);
+  GArray* shortLicenses = g_array_new(FALSE, FALSE, sizeof(guint));
+  for (guint i = 0; i < header->licenseCount; i++) {
+    License license = { .refId = records[i].refId,
+                        .shortname = shortnames + records[i].shortname,
+                        .tokens = g_array_sized_new(FALSE, FALSE, sizeof(Token), records[i].tokensLen) };
+    g_array_append_vals(license.tokens, tokens + records[i].tokens, records[i].tokensLen);
+    g_array_append_val(licenseArray, license);
+
+    if (license.tokens->len <= minAdjacentMatches) {
+      g_array_append_val(shortLicenses, i);
+    }
+  }
+
+  Licenses* result = malloc(sizeof(Licenses));
+  result->licenses = licenseArray;
+  result->shortLicenses = shortLicenses;
+  result->germs = (GermSlot*) ((char*) mapping + header->germsOffset);
+  result->germsMask = header->germSlotCount - 1;
+  result->germLicenses = (GermLicense*) ((char*) mapping + header->germLicensesOffset);
+  result->minAdjacentMatches = minAdjacentMatches;
+  result->maxLeadingDiff = maxLeadingDiff;
+  result->tokenHashes = (uint32_t*) ((char*) mapping + header->tokenHashesOffset);
+  result->tokenHashesStart = buildTokenHashesStart(licenseArray);
+  result->mapping = mapping;
+  result->mappingSize = size;
+
+  return result;
+}
+
+Licenses* loadKnowledgebase(fo_dbManager* dbManager, const char* cacheDir, unsigned minAdjacentMatches, unsigned maxLeadingDiff) {
+  /* the checksum is taken before the licenses are read: a concurrent change
+   * of license_ref can only make the next start rebuild the file once more */
+  char* checksum = getLicenseRefChecksum(dbManager);
+  char* filename = g_strdup_printf("%s/" KNOWLEDGEBASE_FILE, cacheDir);
+
+  Licenses* licenses = NULL;
+  if (checksum) {
+    licenses = mapKnowledgebase(filename, checksum, minAdjacentMatches, maxLeadingDiff);
+  }
+
+  if (!licenses) {
+    PGresult* licensesResult = queryAllLicenses(dbManager);
+    licenses = extractLicenses(dbManager, licensesResult, minAdjacentMatches, maxLeadingDiff);
+    PQclear(licensesResult);
+
+    /* without a writable cache directory every start reads the licenses from the db */
+    if (checksum && licenses) {
+      writeKnowledgebase(licenses, checksum, filename);
+    }
+  }
+
+  g_free(filename);
+  g_free(checksum);
+
+  return licenses;
+}
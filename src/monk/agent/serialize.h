@@ -20,6 +20,7 @@ Copyright (C) 2018, TNG Technology Consulting GmbH
 #define MONK_AGENT_SERIALIZE_H
 
 #include "monk.h"
+#include <stdint.h>
 
 typedef struct {
   long refId;
@@ -27,6 +28,43 @@ typedef struct {
   guint tokensLen;
 } SerializingMeta;
 
+/* knowledge base file: a header followed by flat arrays, which can be mapped
+ * into memory and shared read-only by all the monk processes.
+ * Bump KNOWLEDGEBASE_VERSION on any change of the layout or of the tokenizer */
+#define KNOWLEDGEBASE_MAGIC "MONKKB\n"
+#define KNOWLEDGEBASE_VERSION 2
+#define KNOWLEDGEBASE_FILE "monk.kb"
+
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t tokenSize;
+  /* md5 of the active license_ref rows, empty if not known */
+  char checksum[40];
+  uint32_t minAdjacentMatches;
+  uint32_t maxLeadingDiff;
+  uint64_t fileSize;
+
+  uint64_t licenseCount;
+  uint64_t licensesOffset;     /* KnowledgebaseLicense[licenseCount] */
+  uint64_t tokenCount;
+  uint64_t tokensOffset;       /* Token[tokenCount] */
+  uint64_t tokenHashesOffset;  /* uint32_t[tokenCount] */
+  uint64_t germSlotCount;
+  uint64_t germsOffset;        /* GermSlot[germSlotCount] */
+  uint64_t germLicenseCount;
+  uint64_t germLicensesOffset; /* GermLicense[germLicenseCount] */
+  uint64_t shortnamesSize;
+  uint64_t shortnamesOffset;   /* '\0' terminated shortnames */
+} KnowledgebaseHeader;
+
+typedef struct {
+  int64_t refId;
+  uint64_t shortname;
+  uint64_t tokens;
+  uint64_t tokensLen;
+} KnowledgebaseLicense;
+
 int serializeToFile(Licenses* licenses, char* filename);
 int serialize(Licenses* licenses, FILE* fp);
 int serializeGArray(GArray* licenses, FILE* fp);
@@ -39,4 +77,8 @@ Licenses* deserializeFromFile(char* filename, unsigned minAdjacentMatches, unsig
 Licenses* deserialize(FILE* fp, unsigned minAdjacentMatches, unsigned maxLeadingDiff);
 GArray* deserializeTokens(FILE* fp, guint tokensLen);
 
+int writeKnowledgebase(const Licenses* licenses, const char* checksum, const char* filename);
+Licenses* mapKnowledgebase(const char* filename, const char* checksum, unsigned minAdjacentMatches, unsigned maxLeadingDiff);
+Licenses* loadKnowledgebase(fo_dbManager* dbManager, const char* cacheDir, unsigned minAdjacentMatches, unsigned maxLeadingDiff);
+
 #endif // MONK_AGENT_SERIALIZE_H
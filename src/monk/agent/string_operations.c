@@ -61,6 +61,21 @@ unsigned specialDelim(const char* z){
   return 0;
 }
 
+#define DELIM_SPLITTING 1 /* the character is one of the delimiters */
+#define DELIM_SPECIAL 2   /* the character can start a delimiter of specialDelim() */
+
+/* delimiterTable[c] tells at once what the linear scan of splittingDelim() would */
+static void initDelimiterTable(unsigned char delimiterTable[256], const char* delimiters) {
+  memset(delimiterTable, 0, 256);
+  delimiterTable[0] = DELIM_SPLITTING;
+  for (const char* ptr = delimiters; *ptr; ptr++)
+    delimiterTable[(unsigned char) *ptr] |= DELIM_SPLITTING;
+
+  delimiterTable['/'] |= DELIM_SPECIAL;
+  delimiterTable['*'] |= DELIM_SPECIAL;
+  delimiterTable[':'] |= DELIM_SPECIAL;
+}
+
 static inline void initStateToken(Token* stateToken) {
   stateToken->hashedContent = hash_init();
   stateToken->length = 0;
@@ -112,16 +127,22 @@ int streamTokenize(const char* inputChunk, size_t inputSize, const char* delimit
     return -1;
   }
 
+  unsigned char delimiterTable[256];
+  initDelimiterTable(delimiterTable, delimiters);
+
   const char* ptr = inputChunk;
 
   size_t readBytes = 0;
   while (readBytes < inputSize) {
+    unsigned char delimKind = delimiterTable[(unsigned char) *ptr];
     unsigned delimLen = 0;
-    if (inputSize - readBytes >= 2) {
-      delimLen = specialDelim(ptr);
-    }
-    if (!delimLen) {
-      delimLen = splittingDelim(*ptr, delimiters);
+    if (delimKind) {
+      if ((delimKind & DELIM_SPECIAL) && (inputSize - readBytes >= 2)) {
+        delimLen = specialDelim(ptr);
+      }
+      if (!delimLen) {
+        delimLen = delimKind & DELIM_SPLITTING;
+      }
     }
 
     if (delimLen > 0) {
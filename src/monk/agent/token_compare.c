@@ -0,0 +1,143 @@
+/*
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include "token_compare.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TOKEN_COMPARE_X86
+#include <immintrin.h>
+#endif
+
+typedef struct {
+  void (*equalMasks)(const uint32_t* hashes, size_t blocks, uint32_t hash, uint8_t* masks);
+  size_t (*commonPrefix)(const uint32_t* a, const uint32_t* b, size_t n);
+} TokenCompareOps;
+
+static void equalMasks_scalar(const uint32_t* hashes, size_t blocks, uint32_t hash, uint8_t* masks) {
+  for (size_t b = 0; b < blocks; b++) {
+    const uint32_t* block = hashes + b * TOKEN_COMPARE_BLOCK;
+    uint8_t mask = 0;
+    for (unsigned k = 0; k < TOKEN_COMPARE_BLOCK; k++) {
+      mask |= (uint8_t) ((block[k] == hash) << k);
+    }
+    masks[b] = mask;
+  }
+}
+
+static size_t commonPrefix_scalar(const uint32_t* a, const uint32_t* b, size_t n) {
+  size_t i = 0;
+  while ((i < n) && (a[i] == b[i]))
+    i++;
+  return i;
+}
+
+#ifdef TOKEN_COMPARE_X86
+
+__attribute__((target("sse2")))
+static void equalMasks_sse2(const uint32_t* hashes, size_t blocks, uint32_t hash, uint8_t* masks) {
+  const __m128i needle = _mm_set1_epi32((int) hash);
+  for (size_t b = 0; b < blocks; b++) {
+    const uint32_t* block = hashes + b * TOKEN_COMPARE_BLOCK;
+    __m128i low = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) block), needle);
+    __m128i high = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) (block + 4)), needle);
+    masks[b] = (uint8_t) (_mm_movemask_ps(_mm_castsi128_ps(low)) |
+                          (_mm_movemask_ps(_mm_castsi128_ps(high)) << 4));
+  }
+}
+
+__attribute__((target("sse2")))
+static size_t commonPrefix_sse2(const uint32_t* a, const uint32_t* b, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*) (a + i)),
+                                    _mm_loadu_si128((const __m128i*) (b + i)));
+    unsigned mask = (unsigned) _mm_movemask_ps(_mm_castsi128_ps(equal));
+    if (mask != 0xF)
+      return i + __builtin_ctz(~mask);
+  }
+  return i + commonPrefix_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void equalMasks_avx2(const uint32_t* hashes, size_t blocks, uint32_t hash, uint8_t* masks) {
+  const __m256i needle = _mm256_set1_epi32((int) hash);
+  for (size_t b = 0; b < blocks; b++) {
+    __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (hashes + b * TOKEN_COMPARE_BLOCK)),
+                                       needle);
+    masks[b] = (uint8_t) _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+  }
+}
+
+__attribute__((target("avx2")))
+static size_t commonPrefix_avx2(const uint32_t* a, const uint32_t* b, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*) (a + i)),
+                                       _mm256_loadu_si256((const __m256i*) (b + i)));
+    unsigned mask = (unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+    if (mask != 0xFF)
+      return i + __builtin_ctz(~mask);
+  }
+  return i + commonPrefix_sse2(a + i, b + i, n - i);
+}
+
+#endif
+
+static const TokenCompareOps tokenCompareOps[] = {
+  [TOKEN_COMPARE_SCALAR] = {equalMasks_scalar, commonPrefix_scalar},
+#ifdef TOKEN_COMPARE_X86
+  [TOKEN_COMPARE_SSE2] = {equalMasks_sse2, commonPrefix_sse2},
+  [TOKEN_COMPARE_AVX2] = {equalMasks_avx2, commonPrefix_avx2},
+#endif
+};
+
+static TokenCompareLevel currentLevel = TOKEN_COMPARE_SCALAR;
+
+TokenCompareLevel tokenCompare_supportedLevel() {
+#ifdef TOKEN_COMPARE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return TOKEN_COMPARE_AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return TOKEN_COMPARE_SSE2;
+#endif
+  return TOKEN_COMPARE_SCALAR;
+}
+
+/* select the implementation once, before any thread can compare tokens */
+__attribute__((constructor))
+static void tokenCompare_init() {
+  currentLevel = tokenCompare_supportedLevel();
+}
+
+TokenCompareLevel tokenCompare_setLevel(TokenCompareLevel level) {
+  TokenCompareLevel supported = tokenCompare_supportedLevel();
+  currentLevel = (level < supported) ? level : supported;
+  return currentLevel;
+}
+
+TokenCompareLevel tokenCompare_getLevel() {
+  return currentLevel;
+}
+
+void hashEqualMasks(const uint32_t* hashes, size_t blocks, uint32_t hash, uint8_t* masks) {
+  tokenCompareOps[currentLevel].equalMasks(hashes, blocks, hash, masks);
+}
+
+size_t hashCommonPrefix(const uint32_t* a, const uint32_t* b, size_t n) {
+  return tokenCompareOps[currentLevel].commonPrefix(a, b, n);
+}
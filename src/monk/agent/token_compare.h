@@ -0,0 +1,47 @@
+/*
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef MONK_AGENT_TOKEN_COMPARE_H
+#define MONK_AGENT_TOKEN_COMPARE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* number of hashes compared by hashEqualMasks() for each mask */
+#define TOKEN_COMPARE_BLOCK 8
+
+typedef enum {
+  TOKEN_COMPARE_SCALAR = 0,
+  TOKEN_COMPARE_SSE2,
+  TOKEN_COMPARE_AVX2
+} TokenCompareLevel;
+
+/* best level supported by the running cpu, the one used unless tokenCompare_setLevel() is called */
+TokenCompareLevel tokenCompare_supportedLevel();
+
+/* use at most level for the following comparisons, returns the level actually used */
+TokenCompareLevel tokenCompare_setLevel(TokenCompareLevel level);
+
+TokenCompareLevel tokenCompare_getLevel();
+
+/* masks[b] has bit k set iff hashes[b * TOKEN_COMPARE_BLOCK + k] == hash, for b < blocks */
+void hashEqualMasks(const uint32_t* hashes, size_t blocks, uint32_t hash, uint8_t* masks);
+
+/* number of leading equal hashes of a[0..n] and b[0..n] */
+size_t hashCommonPrefix(const uint32_t* a, const uint32_t* b, size_t n);
+
+#endif // MONK_AGENT_TOKEN_COMPARE_H
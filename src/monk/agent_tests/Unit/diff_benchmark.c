@@ -0,0 +1,127 @@
+/*
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+/* diff throughput on license/file pairs, for each supported token comparison level
+ *
+ *   diff_benchmark [-r repetitions] licenseFile file [licenseFile file ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glib.h>
+
+#include "monk.h"
+#include "diff.h"
+#include "file_operations.h"
+#include "token_compare.h"
+
+static const char* levelNames[] = {"scalar", "sse2", "avx2"};
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t* packHashes(const GArray* tokens) {
+  uint32_t* hashes = malloc(sizeof(uint32_t) * (tokens->len + 1));
+  for (guint i = 0; i < tokens->len; i++)
+    hashes[i] = g_array_index(tokens, Token, i).hashedContent;
+  return hashes;
+}
+
+/* diff the license at every text position where it can start, as findDiffMatches() does */
+static size_t diffAll(const GArray* textTokens, const uint32_t* textHashes,
+                      const GArray* licenseTokens, const uint32_t* licenseHashes,
+                      size_t* matched) {
+  size_t diffs = 0;
+  for (guint tPos = 0; tPos < textTokens->len; tPos++) {
+    if (!matchNTokens(textTokens, tPos, textTokens->len, licenseTokens, 0, licenseTokens->len,
+                      MIN_ADJACENT_MATCHES))
+      continue;
+
+    DiffResult* diffResult = findMatchAsDiffsHashed(textTokens, textHashes, licenseTokens, licenseHashes,
+                                                    tPos, 0, MAX_ALLOWED_DIFF_LENGTH, MIN_ADJACENT_MATCHES);
+    diffs++;
+    if (diffResult) {
+      *matched += diffResult->matched;
+      diffResult_free(diffResult);
+    }
+  }
+  return diffs;
+}
+
+int main(int argc, char** argv) {
+  int repetitions = 100;
+  int first = 1;
+  if ((argc > 2) && (strcmp(argv[1], "-r") == 0)) {
+    repetitions = atoi(argv[2]);
+    first = 3;
+  }
+  if ((argc - first < 2) || ((argc - first) % 2 != 0) || (repetitions <= 0)) {
+    fprintf(stderr, "usage: %s [-r repetitions] licenseFile file [licenseFile file ...]\n", argv[0]);
+    return 1;
+  }
+
+  TokenCompareLevel supported = tokenCompare_supportedLevel();
+  double totalTime[TOKEN_COMPARE_AVX2 + 1] = {0};
+  size_t totalTokens = 0;
+
+  for (int i = first; i + 1 < argc; i += 2) {
+    GArray* licenseTokens;
+    GArray* textTokens;
+    if (!readTokensFromFile(argv[i], &licenseTokens, DELIMITERS))
+      return 2;
+    if (!readTokensFromFile(argv[i + 1], &textTokens, DELIMITERS))
+      return 2;
+    uint32_t* licenseHashes = packHashes(licenseTokens);
+    uint32_t* textHashes = packHashes(textTokens);
+
+    printf("%s vs %s (%u/%u tokens):", argv[i + 1], argv[i], textTokens->len, licenseTokens->len);
+    for (int level = TOKEN_COMPARE_SCALAR; level <= (int) supported; level++) {
+      tokenCompare_setLevel((TokenCompareLevel) level);
+
+      size_t diffs = 0;
+      size_t matched = 0;
+      double start = now();
+      for (int r = 0; r < repetitions; r++)
+        diffs = diffAll(textTokens, textHashes, licenseTokens, licenseHashes, &matched);
+      double elapsed = now() - start;
+
+      totalTime[level] += elapsed;
+      printf(" %s %.1fus/diff (%zu diffs, %zu matched)", levelNames[level],
+             1e6 * elapsed / (repetitions * (diffs ? diffs : 1)), diffs, matched / repetitions);
+    }
+    printf("\n");
+    totalTokens += (size_t) repetitions * textTokens->len;
+
+    free(licenseHashes);
+    free(textHashes);
+    tokens_free(licenseTokens);
+    tokens_free(textTokens);
+  }
+
+  for (int level = TOKEN_COMPARE_SCALAR; level <= (int) supported; level++) {
+    printf("%s: %.3fs, %.2f Mtokens/s\n", levelNames[level], totalTime[level],
+           totalTokens / totalTime[level] / 1e6);
+  }
+
+  tokenCompare_setLevel(supported);
+  return 0;
+}
@@ -40,6 +40,7 @@ extern CU_TestInfo match_testcases[];
 extern CU_TestInfo database_testcases[];
 extern CU_TestInfo encoding_testcases[];
 extern CU_TestInfo serialize_testcases[];
+extern CU_TestInfo token_compare_testcases[];
 
 extern int license_setUpFunc();
 extern int license_tearDownFunc();
@@ -63,6 +64,7 @@ CU_SuiteInfo suites[] = {
     {"Testing database:", NULL, NULL, (CU_SetUpFunc)database_setUpFunc, (CU_TearDownFunc)database_tearDownFunc, database_testcases},
     {"Testing encoding:", NULL, NULL, NULL, NULL, encoding_testcases},
     {"Testing serialize:", NULL, NULL, NULL, NULL, serialize_testcases},
+    {"Testing token compare:", NULL, NULL, NULL, NULL, token_compare_testcases},
     CU_SUITE_INFO_NULL
 };
 #else
@@ -77,6 +79,7 @@ CU_SuiteInfo suites[] = {
     {"Testing database:", database_setUpFunc, database_tearDownFunc, database_testcases},
     {"Testing encoding:", NULL, NULL, encoding_testcases},
     {"Testing serialize:", NULL, NULL, serialize_testcases},
+    {"Testing token compare:", NULL, NULL, token_compare_testcases},
     CU_SUITE_INFO_NULL
 };
 #endif
@@ -19,6 +19,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <libfocunit.h>
 
 #include "database.h"
+#include "monk.h"
 
 extern fo_dbManager* dbManager;
 
@@ -28,6 +29,7 @@ void test_queryAllLicenses() {
   CU_ASSERT_PTR_NOT_NULL_FATAL(licenses);
 
   FO_ASSERT_EQUAL_FATAL(PQntuples(licenses), 2);
+  FO_ASSERT_EQUAL(PQnfields(licenses), 3);
 
   PQclear(licenses);
 }
@@ -46,6 +48,57 @@ void test_getTextFromBadId() {
   g_free(notExistingText);
 }
 
+static long countRows(const char* query) {
+  PGresult* result = fo_dbManager_Exec_printf(dbManager, query);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(result);
+  long count = atol(PQgetvalue(result, 0, 0));
+  PQclear(result);
+  return count;
+}
+
+void test_resultBuffer() {
+  ResultBuffer* buffer = resultBuffer_new(dbManager, 7);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(buffer);
+
+  DiffMatchInfo matchInfo;
+  matchInfo.diffType = FULL_MATCH;
+  matchInfo.text.start = 3;
+  matchInfo.text.length = 10;
+  matchInfo.search.start = 0;
+  matchInfo.search.length = 12;
+
+  CU_ASSERT_TRUE(resultBuffer_addNoResult(buffer, 41));
+  long licenseFileId = resultBuffer_addLicenseFile(buffer, 1, 42, 100);
+  CU_ASSERT_TRUE_FATAL(licenseFileId > 0);
+  CU_ASSERT_TRUE(resultBuffer_addHighlight(buffer, &matchInfo, licenseFileId));
+
+  /* nothing is written before flushing */
+  CU_ASSERT_EQUAL(countRows("SELECT count(*) FROM license_file WHERE agent_fk = 7"), 0);
+
+  CU_ASSERT_TRUE(resultBuffer_flush(buffer));
+  CU_ASSERT_EQUAL(countRows("SELECT count(*) FROM license_file WHERE agent_fk = 7"), 2);
+  CU_ASSERT_EQUAL(countRows("SELECT count(*) FROM license_file WHERE agent_fk = 7 AND rf_fk IS NULL AND pfile_fk = 41"), 1);
+  CU_ASSERT_EQUAL(countRows("SELECT count(*) FROM license_file lf JOIN highlight h ON h.fl_fk = lf.fl_pk"
+                            " WHERE lf.agent_fk = 7 AND lf.pfile_fk = 42 AND lf.rf_match_pct = 100"
+                            " AND h.type = 'M' AND h.start = 3 AND h.len = 10 AND h.rf_start = 0 AND h.rf_len = 12"), 1);
+
+  /* more rows than fit in one copy */
+  for (long pFileId = 100; pFileId < 3100; pFileId++) {
+    licenseFileId = resultBuffer_addLicenseFile(buffer, 2, pFileId, 50);
+    CU_ASSERT_TRUE_FATAL(licenseFileId > 0);
+    CU_ASSERT_TRUE_FATAL(resultBuffer_addHighlight(buffer, &matchInfo, licenseFileId));
+    CU_ASSERT_TRUE_FATAL(resultBuffer_flushIfFull(buffer));
+  }
+  CU_ASSERT_TRUE(resultBuffer_flush(buffer));
+  CU_ASSERT_EQUAL(countRows("SELECT count(*) FROM license_file lf JOIN highlight h ON h.fl_fk = lf.fl_pk"
+                            " WHERE lf.agent_fk = 7 AND lf.rf_fk = 2"), 3000);
+
+  /* not flushed rows are discarded */
+  CU_ASSERT_TRUE(resultBuffer_addNoResult(buffer, 43));
+  resultBuffer_free(buffer);
+  CU_ASSERT_EQUAL(countRows("SELECT count(*) FROM license_file WHERE agent_fk = 7 AND pfile_fk = 43"), 0);
+}
+
 #define doOrReturnError(fmt, ...) do {\
   PGresult* copy = fo_dbManager_Exec_printf(dbManager, fmt, #__VA_ARGS__); \
   if (!copy) {\
@@ -69,6 +122,14 @@ int database_setUpFunc() {
   doOrReturnError("INSERT INTO license_ref(rf_pk, rf_shortname, rf_text, rf_active ,rf_detector_type) "
                     "VALUES (2, 'GPL-2.0', 'gnu general public license, version 2', true, 1)",);
 
+  if (!fo_dbManager_tableExists(dbManager, "license_file")) {
+    doOrReturnError("CREATE SEQUENCE license_file_fl_pk_seq",);
+    doOrReturnError("CREATE TABLE license_file(fl_pk bigint DEFAULT nextval('license_file_fl_pk_seq'), rf_fk int, agent_fk int, pfile_fk int, rf_match_pct int)",);
+  }
+  if (!fo_dbManager_tableExists(dbManager, "highlight")) {
+    doOrReturnError("CREATE TABLE highlight(fl_fk bigint, type text, start int, len int, rf_start int, rf_len int)",);
+  }
+
   return 0;
 }
 
@@ -78,6 +139,9 @@ int database_tearDownFunc() {
   }
 
   doOrReturnError("DROP TABLE license_ref",);
+  doOrReturnError("DROP TABLE highlight",);
+  doOrReturnError("DROP TABLE license_file",);
+  doOrReturnError("DROP SEQUENCE license_file_fl_pk_seq",);
 
   return 0;
 }
@@ -86,5 +150,6 @@ CU_TestInfo database_testcases[] = {
   {"Testing get lla licenses:", test_queryAllLicenses},
   {"Testing get text from id:", test_getTextFromId},
   {"Testing get text from bad id:", test_getTextFromBadId},
+  {"Testing buffered results:", test_resultBuffer},
   CU_TEST_INFO_NULL
 };
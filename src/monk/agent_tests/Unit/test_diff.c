@@ -26,6 +26,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include "diff.h"
 #include "match.h"
 #include "monk.h"
+#include "token_compare.h"
 
 int token_search_diff(char* text, char* search, unsigned int maxAllowedDiff,
         size_t expectedMatchCount, size_t expectedAdditionsCount, size_t expectedRemovalsCount, ...) {
@@ -693,6 +694,99 @@ void test_lookForReplaces2() {
           0, 0, 0));
 }
 
+/* random text on a small vocabulary, so that many tokens are equal */
+static GArray* randomTokens(size_t length, unsigned int vocabulary) {
+  GString* text = g_string_new("");
+  for (size_t i = 0; i < length; i++)
+    g_string_append_printf(text, "%c^", 'a' + rand() % vocabulary);
+
+  GArray* tokens = tokenize(text->str, "^");
+  g_string_free(text, TRUE);
+  return tokens;
+}
+
+static uint32_t* packHashes(const GArray* tokens) {
+  uint32_t* hashes = malloc(sizeof(uint32_t) * (tokens->len + 1));
+  for (size_t i = 0; i < tokens->len; i++)
+    hashes[i] = g_array_index(tokens, Token, i).hashedContent;
+  return hashes;
+}
+
+void test_lookForDiffAtAllLevels() {
+  TokenCompareLevel supported = tokenCompare_supportedLevel();
+
+  srand(42);
+  for (int round = 0; round < 50; round++) {
+    GArray* textTokens = randomTokens(300 + rand() % 200, 4 + round % 8);
+    GArray* searchTokens = randomTokens(300 + rand() % 200, 4 + round % 8);
+    size_t iText = rand() % 20;
+    size_t iSearch = rand() % 20;
+    unsigned int minAdjacentMatches = 2 + round % 4;
+
+    tokenCompare_setLevel(TOKEN_COMPARE_SCALAR);
+    DiffMatchInfo expected;
+    int expectedFound = lookForDiff(textTokens, searchTokens, iText, iSearch,
+                                    MAX_ALLOWED_DIFF_LENGTH, minAdjacentMatches, &expected);
+
+    for (int level = TOKEN_COMPARE_SCALAR + 1; level <= (int) supported; level++) {
+      tokenCompare_setLevel((TokenCompareLevel) level);
+      DiffMatchInfo result;
+      int found = lookForDiff(textTokens, searchTokens, iText, iSearch,
+                              MAX_ALLOWED_DIFF_LENGTH, minAdjacentMatches, &result);
+
+      CU_ASSERT_EQUAL(found, expectedFound);
+      if (found && expectedFound) {
+        CU_ASSERT_EQUAL(result.text.start, expected.text.start);
+        CU_ASSERT_EQUAL(result.search.start, expected.search.start);
+        CU_ASSERT_EQUAL(result.text.length, expected.text.length);
+        CU_ASSERT_EQUAL(result.search.length, expected.search.length);
+      }
+    }
+
+    g_array_free(textTokens, TRUE);
+    g_array_free(searchTokens, TRUE);
+  }
+
+  tokenCompare_setLevel(supported);
+}
+
+void test_findMatchAsDiffsHashed() {
+  char* text = g_strdup("a^b^c^d^e^x^y^f^g^h^i^j^k^l^m^n^o^p^q");
+  char* search = g_strdup("a^b^c^d^e^f^g^h^z^i^j^k^l^m^n^o^p^q");
+  GArray* textTokens = tokenize(text, "^");
+  GArray* searchTokens = tokenize(search, "^");
+  uint32_t* textHashes = packHashes(textTokens);
+  uint32_t* searchHashes = packHashes(searchTokens);
+
+  DiffResult* expected = findMatchAsDiffs(textTokens, searchTokens, 0, 0, 5, 2);
+  DiffResult* result = findMatchAsDiffsHashed(textTokens, textHashes, searchTokens, searchHashes, 0, 0, 5, 2);
+
+  CU_ASSERT_PTR_NOT_NULL_FATAL(expected);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(result);
+  CU_ASSERT_EQUAL(result->matched, expected->matched);
+  CU_ASSERT_EQUAL(result->added, 2);
+  CU_ASSERT_EQUAL(result->removed, 1);
+  CU_ASSERT_EQUAL(result->matchedInfo->len, expected->matchedInfo->len);
+  for (size_t i = 0; i < MIN(result->matchedInfo->len, expected->matchedInfo->len); i++) {
+    DiffMatchInfo resultInfo = g_array_index(result->matchedInfo, DiffMatchInfo, i);
+    DiffMatchInfo expectedInfo = g_array_index(expected->matchedInfo, DiffMatchInfo, i);
+    CU_ASSERT_EQUAL(resultInfo.text.start, expectedInfo.text.start);
+    CU_ASSERT_EQUAL(resultInfo.text.length, expectedInfo.text.length);
+    CU_ASSERT_EQUAL(resultInfo.search.start, expectedInfo.search.start);
+    CU_ASSERT_EQUAL(resultInfo.search.length, expectedInfo.search.length);
+    CU_ASSERT_STRING_EQUAL(resultInfo.diffType, expectedInfo.diffType);
+  }
+
+  diffResult_free(expected);
+  diffResult_free(result);
+  free(textHashes);
+  free(searchHashes);
+  g_array_free(textTokens, TRUE);
+  g_array_free(searchTokens, TRUE);
+  g_free(text);
+  g_free(search);
+}
+
 CU_TestInfo diff_testcases[] = {
   {"Testing token search:", test_token_search},
   {"Testing token diff functions, additions:", test_lookForAdditions},
@@ -703,5 +797,7 @@ CU_TestInfo diff_testcases[] = {
   {"Testing token diff functions, matchNTokens:", test_matchNTokens},
   {"Testing token diff functions, matchNTokens corner cases:", test_matchNTokensCorners},
   {"Testing token search_diffs:", test_token_search_diffs},
+  {"Testing token diff functions, same diffs with all comparison levels:", test_lookForDiffAtAllLevels},
+  {"Testing token search with packed hashes:", test_findMatchAsDiffsHashed},
   CU_TEST_INFO_NULL
 };
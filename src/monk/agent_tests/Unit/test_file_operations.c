@@ -156,11 +156,77 @@ void test_read_file_tokens_encodingConversion() {
 
 }
 
+static void assertSameTokens(const GArray* tokens, const GArray* expected) {
+  FO_ASSERT_EQUAL_FATAL(tokens->len, expected->len);
+  CU_ASSERT_TRUE(tokensEquals(tokens, expected));
+  for (guint i = 0; i < tokens->len; i++) {
+    CU_ASSERT_EQUAL(g_array_index(tokens, Token, i).removedBefore,
+                    g_array_index(expected, Token, i).removedBefore);
+  }
+}
+
+void test_read_file_tokens_manyChunks() {
+  char* testfile = "/tmp/monkftest";
+
+  GString* content = g_string_new("");
+  for (int i = 0; content->len < 5 * 4096; i++) {
+    g_string_append_printf(content, "word%d /* comment */ a::b c:d\n", i);
+  }
+  binaryWrite(testfile, content->str);
+
+  GArray* tokens;
+  CU_ASSERT_TRUE_FATAL(readTokensFromFile(testfile, &tokens, "\n\t\r^ "));
+  GArray* expected = tokenize(content->str, "\n\t\r^ ");
+
+  assertSameTokens(tokens, expected);
+
+  g_array_free(tokens, TRUE);
+  g_array_free(expected, TRUE);
+  g_string_free(content, TRUE);
+}
+
+void test_read_file_tokens_encodingConversionManyChunks() {
+  char* testfile = "/tmp/monkftest";
+
+  GString* latin1 = g_string_new("");
+  GString* utf8 = g_string_new("");
+  for (int i = 0; i < 2000; i++) {
+    g_string_append(latin1, "caf\xe9 na\xefve\n");
+    g_string_append(utf8, "caf\xc3\xa9 na\xc3\xafve\n");
+  }
+  binaryWrite(testfile, latin1->str);
+
+  GArray* tokens;
+  CU_ASSERT_TRUE_FATAL(readTokensFromFile(testfile, &tokens, "\n\t\r^ "));
+  GArray* expected = tokenize(utf8->str, "\n\t\r^ ");
+
+  assertSameTokens(tokens, expected);
+
+  g_array_free(tokens, TRUE);
+  g_array_free(expected, TRUE);
+  g_string_free(latin1, TRUE);
+  g_string_free(utf8, TRUE);
+}
+
+void test_read_file_tokens_empty() {
+  char* testfile = "/tmp/monkftest";
+  binaryWrite(testfile, "");
+
+  GArray* tokens;
+  CU_ASSERT_TRUE_FATAL(readTokensFromFile(testfile, &tokens, "\n\t\r^ "));
+  CU_ASSERT_EQUAL(tokens->len, 0);
+
+  g_array_free(tokens, TRUE);
+}
+
 CU_TestInfo file_operations_testcases[] = {
   {"Testing reading file tokens:", test_read_file_tokens},
   {"Testing reading file tokens2:", test_read_file_tokens2},
   {"Testing reading file tokens with a binary file:", test_read_file_tokens_binaries},
   {"Testing reading file tokens with two different encodings return same token contents:", test_read_file_tokens_encodingConversion},
   {"Testing reading file tokens from wrong file:", test_read_file_tokens_error},
+  {"Testing reading file tokens across many chunks:", test_read_file_tokens_manyChunks},
+  {"Testing reading file tokens with encoding conversion across many chunks:", test_read_file_tokens_encodingConversionManyChunks},
+  {"Testing reading file tokens from an empty file:", test_read_file_tokens_empty},
   CU_TEST_INFO_NULL
 };
@@ -17,6 +17,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 */
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 #include <libfocunit.h>
 
 #include "license.h"
@@ -80,7 +81,7 @@ void test_ignoreLicense_withIgnoredName() {
   g_free(text_ptr);
 }
 
-void _assertLicIds(const GArray* lics, unsigned int n, ...) {
+void _assertLicIds(const Licenses* licenses, const GArray* lics, unsigned int n, ...) {
   CU_ASSERT_PTR_NOT_NULL_FATAL(lics);
   CU_ASSERT_EQUAL_FATAL(lics->len, n);
   va_list args;
@@ -89,12 +90,30 @@ void _assertLicIds(const GArray* lics, unsigned int n, ...) {
 
   for (int i=0; i<n; i++) {
     int expectedLicId = va_arg(args, int);
-    CU_ASSERT_EQUAL(license_index(lics, i)->refId, expectedLicId);
+    guint position = g_array_index(lics, guint, i);
+    CU_ASSERT_EQUAL(license_index(licenses->licenses, position)->refId, expectedLicId);
   }
 
   va_end(args);
 }
 
+/* positions of the licenses matching the germ of text at tPos after skipping sPos tokens, NULL if none */
+GArray* _germLicensesFor(const Licenses* licenses, unsigned sPos, const GArray* textTokens, unsigned tPos) {
+  guint count;
+  const GermLicense* germLicenses = getGermLicenses(licenses,
+          getKey(textTokens, licenses->minAdjacentMatches, tPos), &count);
+
+  GArray* result = NULL;
+  for (guint i = 0; i < count; i++) {
+    if (germLicenses[i].sPos == sPos) {
+      if (!result)
+        result = g_array_new(FALSE, FALSE, sizeof(guint));
+      g_array_append_val(result, germLicenses[i].license);
+    }
+  }
+  return result;
+}
+
 void _addLic(GArray* lics, int id, const char* text) {
   License toAdd = (License) {
     .refId = id,
@@ -117,18 +136,56 @@ void test_indexLicenses() {
 
   CU_ASSERT_EQUAL(licenseArray, indexedLicenses->licenses);
 
-  _assertLicIds(getShortLicenseArray(indexedLicenses), 1, 17); // lic 17 is a short lic
+  _assertLicIds(indexedLicenses, getShortLicenseArray(indexedLicenses), 1, 17); // lic 17 is a short lic
 
-  CU_ASSERT_PTR_NULL(getLicenseArrayFor(indexedLicenses, 0, textTokens, 0)); // no lic matches the first 4 tokens of text
+  CU_ASSERT_PTR_NULL(_germLicensesFor(indexedLicenses, 0, textTokens, 0)); // no lic matches the first 4 tokens of text
 
-  _assertLicIds(getLicenseArrayFor(indexedLicenses, 0, textTokens, 1), 1, 18); // lic 18 matches tokens 1-5 of text
-  _assertLicIds(getLicenseArrayFor(indexedLicenses, 1, textTokens, 1), 2, 19, 20); // lic 19 and 20 matche tokens 1-5 of text with a 1 token head diff
+  GArray* germLicenses = _germLicensesFor(indexedLicenses, 0, textTokens, 1);
+  _assertLicIds(indexedLicenses, germLicenses, 1, 18); // lic 18 matches tokens 1-5 of text
+  g_array_free(germLicenses, TRUE);
+  germLicenses = _germLicensesFor(indexedLicenses, 1, textTokens, 1);
+  _assertLicIds(indexedLicenses, germLicenses, 2, 19, 20); // lic 19 and 20 matche tokens 1-5 of text with a 1 token head diff
+  g_array_free(germLicenses, TRUE);
 
   licenses_free(indexedLicenses);
 
   tokens_free(textTokens);
 }
 
+Licenses* _licensesFor(int id, const char* text, int otherId, const char* otherText) {
+  GArray* licenseArray = g_array_new(FALSE, FALSE, sizeof(License));
+  _addLic(licenseArray, id, text);
+  _addLic(licenseArray, otherId, otherText);
+  return buildLicenseIndexes(licenseArray, 4, 2);
+}
+
+void test_licensesFingerprint() {
+  Licenses* licenses = _licensesFor(17, "a^b^c^d^e", 18, "f^g^h^i^j");
+  gchar* fingerprint = licenses_fingerprint(licenses);
+  CU_ASSERT_EQUAL(strlen(fingerprint), 40);
+
+  Licenses* same = _licensesFor(17, "a^b^c^d^e", 18, "f^g^h^i^j");
+  gchar* sameFingerprint = licenses_fingerprint(same);
+  CU_ASSERT_STRING_EQUAL(sameFingerprint, fingerprint);
+
+  Licenses* otherText = _licensesFor(17, "a^b^c^d^e", 18, "f^g^h^i^k");
+  gchar* otherTextFingerprint = licenses_fingerprint(otherText);
+  CU_ASSERT_STRING_NOT_EQUAL(otherTextFingerprint, fingerprint);
+
+  Licenses* otherId = _licensesFor(17, "a^b^c^d^e", 19, "f^g^h^i^j");
+  gchar* otherIdFingerprint = licenses_fingerprint(otherId);
+  CU_ASSERT_STRING_NOT_EQUAL(otherIdFingerprint, fingerprint);
+
+  g_free(fingerprint);
+  g_free(sameFingerprint);
+  g_free(otherTextFingerprint);
+  g_free(otherIdFingerprint);
+  licenses_free(licenses);
+  licenses_free(same);
+  licenses_free(otherText);
+  licenses_free(otherId);
+}
+
 void assertTokens(GArray* tokens, ...) {
   va_list expptr;
   va_start(expptr, tokens);
@@ -284,5 +341,6 @@ CU_TestInfo license_testcases[] = {
   {"Testing extracting two licenses from DB:", test_extractLicenses_Two},
   {"Testing extracting an ignored license from DB:", test_extractLicenses_Ignored},
   {"Testing indexing of licenses:", test_indexLicenses},
+  {"Testing fingerprint of licenses:", test_licensesFingerprint},
   CU_TEST_INFO_NULL
 };
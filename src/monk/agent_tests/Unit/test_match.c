@@ -101,6 +101,33 @@ void test_findAllMatchesDisjoint() {
   licenses_free(licenses);
 }
 
+void test_findAllMatchesWithLongGerms() {
+  File* file = getFileWithText("x^y^a^b^c^d^z^q^r^b^c^d^e^s");
+  GArray* licenseArray = g_array_new(TRUE, FALSE, sizeof(License));
+  char* texts[] = {"a^b^c^d", "w^b^c^d^e", "q^r"};
+  for (int i = 0; i < 3; i++) {
+    License license;
+    license.refId = i;
+    license.shortname = g_strdup_printf("%d-testLic", i);
+    license.tokens = tokenize(texts[i], "^");
+    g_array_append_val(licenseArray, license);
+  }
+  Licenses* licenses = buildLicenseIndexes(licenseArray, 3, 1);
+
+  GArray* matches = findAllMatchesBetween(file, licenses, 20, 3, 1);
+
+  FO_ASSERT_EQUAL(matches->len, 3);
+  if (matches->len == 3) {
+    FO_ASSERT_TRUE(_matchEquals(g_array_index(matches, Match*, 0), 0, 2, 6))
+    FO_ASSERT_TRUE(_matchEquals(g_array_index(matches, Match*, 1), 2, 7, 9))
+    FO_ASSERT_TRUE(_matchEquals(g_array_index(matches, Match*, 2), 1, 9, 13))
+  }
+
+  matchesArray_free(matches);
+  file_free(file);
+  licenses_free(licenses);
+}
+
 void test_findDiffsAtBeginning() {
   File* file = getFileWithText("^e^a^b^c^d^e");
   Licenses* licenses = getNLicensesWithText(2, "a", "e^b^c^d^e");
@@ -645,6 +672,7 @@ void test_matchComparatorIncludedSameLicenseBiggerMatch() {
 CU_TestInfo match_testcases[] = {
   {"Testing match of all licenses with disjoint full matches:", test_findAllMatchesDisjoint},
   {"Testing match of all licenses with diff at beginning", test_findDiffsAtBeginning},
+  {"Testing match of all licenses with germs of more tokens:", test_findAllMatchesWithLongGerms},
   {"Testing match of all licenses with diffs:", test_findAllMatchesWithDiff},
   {"Testing match of all licenses with included full matches:", test_findAllMatchesAllIncluded},
   {"Testing match of all licenses with two included group:", test_findAllMatchesTwoGroups},
@@ -18,6 +18,9 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #define _GNU_SOURCE
 #include <stdlib.h>
 #include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
 #include <libfocunit.h>
 
 #include "serialize.h"
@@ -109,8 +112,114 @@ void test_roundtrip() {
   assert_Licenses(licenses, returnedLicenses);
 }
 
+Licenses* getIndexedLicenses() {
+  GArray* licenseArray = g_array_new(TRUE, FALSE, sizeof(License));
+  char* texts[] = {"a^b", "b^c^d^e^f", "1^b^c^d^e^f", "2^b^c^d^e^f", "x^y^z^w"};
+  for (guint i = 0; i < sizeof(texts) / sizeof(char*); i++) {
+    License license;
+    license.refId = 17 + i;
+    license.shortname = g_strdup_printf("%u-testLic", i);
+    license.tokens = tokenize(texts[i], "^");
+    g_array_append_val(licenseArray, license);
+  }
+
+  return buildLicenseIndexes(licenseArray, 3, 2);
+}
+
+void assert_Indexes(const Licenses* lics1, const Licenses* lics2, const GArray* textTokens) {
+  CU_ASSERT_EQUAL_FATAL(lics1->shortLicenses->len, lics2->shortLicenses->len);
+  for (guint i = 0; i < lics1->shortLicenses->len; i++) {
+    CU_ASSERT_EQUAL(g_array_index(lics1->shortLicenses, guint, i), g_array_index(lics2->shortLicenses, guint, i));
+  }
+
+  for (guint tPos = 0; tPos < textTokens->len; tPos++) {
+    uint32_t germ = getKey(textTokens, lics1->minAdjacentMatches, tPos);
+    guint count1, count2;
+    const GermLicense* germLicenses1 = getGermLicenses(lics1, germ, &count1);
+    const GermLicense* germLicenses2 = getGermLicenses(lics2, germ, &count2);
+
+    CU_ASSERT_EQUAL_FATAL(count1, count2);
+    for (guint i = 0; i < count1; i++) {
+      CU_ASSERT_EQUAL(germLicenses1[i].license, germLicenses2[i].license);
+      CU_ASSERT_EQUAL(germLicenses1[i].sPos, germLicenses2[i].sPos);
+    }
+  }
+
+  guint tokenCount = lics1->tokenHashesStart[lics1->licenses->len];
+  CU_ASSERT_EQUAL_FATAL(tokenCount, lics2->tokenHashesStart[lics2->licenses->len]);
+  CU_ASSERT_EQUAL(memcmp(lics1->tokenHashes, lics2->tokenHashes, tokenCount * sizeof(uint32_t)), 0);
+}
+
+char* writeTempKnowledgebase(Licenses* licenses, const char* checksum) {
+  char* filename = g_strdup("/tmp/monk_kb_test_XXXXXX");
+  int fd = mkstemp(filename);
+  close(fd);
+
+  CU_ASSERT_TRUE(writeKnowledgebase(licenses, checksum, filename));
+  return filename;
+}
+
+void test_knowledgebase_roundtrip() {
+  Licenses* licenses = getIndexedLicenses();
+  char* filename = writeTempKnowledgebase(licenses, "0123456789abcdef");
+
+  Licenses* mapped = mapKnowledgebase(filename, "0123456789abcdef", 3, 2);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(mapped);
+
+  assert_Licenses(licenses, mapped);
+
+  GArray* textTokens = tokenize("a^b^c^d^e^f^x^y^z^w", "^");
+  assert_Indexes(licenses, mapped, textTokens);
+  tokens_free(textTokens);
+
+  licenses_free(mapped);
+  licenses_free(licenses);
+  unlink(filename);
+  g_free(filename);
+}
+
+void test_knowledgebase_invalidated() {
+  Licenses* licenses = getIndexedLicenses();
+  char* filename = writeTempKnowledgebase(licenses, "0123456789abcdef");
+
+  CU_ASSERT_PTR_NULL(mapKnowledgebase(filename, "fedcba9876543210", 3, 2));
+  CU_ASSERT_PTR_NULL(mapKnowledgebase(filename, "0123456789abcdef", 2, 2));
+  CU_ASSERT_PTR_NULL(mapKnowledgebase(filename, "0123456789abcdef", 3, 1));
+
+  FILE* fp = fopen(filename, "r+");
+  uint32_t version = KNOWLEDGEBASE_VERSION + 1;
+  fseek(fp, offsetof(KnowledgebaseHeader, version), SEEK_SET);
+  fwrite(&version, sizeof(version), 1, fp);
+  fclose(fp);
+  CU_ASSERT_PTR_NULL(mapKnowledgebase(filename, "0123456789abcdef", 3, 2));
+
+  CU_ASSERT_PTR_NULL(mapKnowledgebase("/tmp/monk_kb_test_missing", NULL, 3, 2));
+
+  licenses_free(licenses);
+  unlink(filename);
+  g_free(filename);
+}
+
+void test_knowledgebase_deserializeFromFile() {
+  Licenses* licenses = getIndexedLicenses();
+  char* filename = writeTempKnowledgebase(licenses, NULL);
+
+  Licenses* loaded = deserializeFromFile(filename, 3, 2);
+  CU_ASSERT_PTR_NOT_NULL_FATAL(loaded);
+  CU_ASSERT_PTR_NOT_NULL(loaded->mapping);
+  assert_Licenses(licenses, loaded);
+
+  licenses_free(loaded);
+  licenses_free(licenses);
+  unlink(filename);
+  g_free(filename);
+}
+
 CU_TestInfo serialize_testcases[] = {
   {"Test roundtrip with empty:", test_roundtrip_one},
   {"Test roundtrip with some licenses with tokens:", test_roundtrip},
+  {"Test knowledgebase roundtrip through mmap:", test_knowledgebase_roundtrip},
+  {"Test knowledgebase invalidated by checksum and version:", test_knowledgebase_invalidated},
+  {"Test knowledgebase loaded as offline knowledgebase:", test_knowledgebase_deserializeFromFile},
   CU_TEST_INFO_NULL
 };
@@ -65,6 +65,39 @@ void test_tokenizeWithSpecialDelims() {
   g_array_free(token, TRUE);
   g_free(test);
 }
+void test_tokenizeWithSpecialDelimsInDelimiters() {
+  char* test = g_strdup("a/b//c*d:e::f");
+
+  GArray* token = tokenize(test, "/*:");
+  CU_ASSERT_EQUAL_FATAL(token->len, 6);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 0).hashedContent, hash("a"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 0).removedBefore, 0);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 1).hashedContent, hash("b"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 1).removedBefore, 1);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 2).hashedContent, hash("c"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 2).removedBefore, 2);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 3).hashedContent, hash("d"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 3).removedBefore, 1);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 4).hashedContent, hash("e"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 4).removedBefore, 1);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 5).hashedContent, hash("f"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 5).removedBefore, 2);
+  g_array_free(token, TRUE);
+
+  token = tokenize(test, " ");
+  CU_ASSERT_EQUAL_FATAL(token->len, 4);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 0).hashedContent, hash("a/b"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 0).removedBefore, 0);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 1).hashedContent, hash("c"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 1).removedBefore, 2);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 2).hashedContent, hash("d:e"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 2).removedBefore, 1);
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 3).hashedContent, hash("f"));
+  CU_ASSERT_EQUAL(g_array_index(token, Token, 3).removedBefore, 2);
+  g_array_free(token, TRUE);
+
+  g_free(test);
+}
 
 void test_streamTokenize() {
   char* test = g_strdup("^foo^^ba^REM^boooREM^REM^");
@@ -232,6 +265,7 @@ void test_token_equal() {
 CU_TestInfo string_operations_testcases[] = {
   {"Testing tokenize:", test_tokenize},
   {"Testing tokenize with special delimiters:", test_tokenizeWithSpecialDelims},
+  {"Testing tokenize with special delimiters also in the delimiters:", test_tokenizeWithSpecialDelimsInDelimiters},
   {"Testing stream tokenize:", test_streamTokenize},
   {"Testing stream tokenize with too long stream:",test_streamTokenizeEventuallyGivesUp},
   {"Testing find token position in string:", test_tokenPosition},
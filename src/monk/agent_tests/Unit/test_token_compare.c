@@ -0,0 +1,98 @@
+/*
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+
+#include "token_compare.h"
+
+#define HASHES_LENGTH (TOKEN_COMPARE_BLOCK * 5)
+
+static void fillHashes(uint32_t* hashes, size_t length, unsigned int distinct) {
+  for (size_t i = 0; i < length; i++)
+    hashes[i] = 0x9E3779B1u * (uint32_t) (rand() % distinct);
+}
+
+void test_hashEqualMasks() {
+  TokenCompareLevel supported = tokenCompare_supportedLevel();
+  uint32_t hashes[HASHES_LENGTH];
+  uint8_t masks[HASHES_LENGTH / TOKEN_COMPARE_BLOCK];
+
+  srand(42);
+  for (int level = TOKEN_COMPARE_SCALAR; level <= (int) supported; level++) {
+    CU_ASSERT_EQUAL((int) tokenCompare_setLevel((TokenCompareLevel) level), level);
+
+    for (int round = 0; round < 100; round++) {
+      fillHashes(hashes, HASHES_LENGTH, 3);
+      uint32_t needle = hashes[rand() % HASHES_LENGTH];
+      hashEqualMasks(hashes, HASHES_LENGTH / TOKEN_COMPARE_BLOCK, needle, masks);
+
+      for (size_t i = 0; i < HASHES_LENGTH; i++) {
+        int bit = (masks[i / TOKEN_COMPARE_BLOCK] >> (i % TOKEN_COMPARE_BLOCK)) & 1;
+        CU_ASSERT_EQUAL(bit, hashes[i] == needle);
+      }
+    }
+  }
+
+  tokenCompare_setLevel(supported);
+}
+
+void test_hashCommonPrefix() {
+  TokenCompareLevel supported = tokenCompare_supportedLevel();
+  uint32_t a[HASHES_LENGTH];
+  uint32_t b[HASHES_LENGTH];
+
+  srand(42);
+  for (int level = TOKEN_COMPARE_SCALAR; level <= (int) supported; level++) {
+    tokenCompare_setLevel((TokenCompareLevel) level);
+
+    for (size_t differentAt = 0; differentAt <= HASHES_LENGTH; differentAt++) {
+      fillHashes(a, HASHES_LENGTH, 1000);
+      for (size_t i = 0; i < HASHES_LENGTH; i++)
+        b[i] = a[i];
+      if (differentAt < HASHES_LENGTH)
+        b[differentAt] = a[differentAt] + 1;
+
+      for (size_t n = 0; n <= HASHES_LENGTH; n++) {
+        size_t expected = (differentAt < n) ? differentAt : n;
+        CU_ASSERT_EQUAL(hashCommonPrefix(a, b, n), expected);
+      }
+      /* unaligned starts */
+      CU_ASSERT_EQUAL(hashCommonPrefix(a + 1, b + 1, HASHES_LENGTH - 1),
+                      (differentAt > 0) ? differentAt - 1 : HASHES_LENGTH - 1);
+    }
+  }
+
+  tokenCompare_setLevel(supported);
+}
+
+void test_tokenCompareLevels() {
+  TokenCompareLevel supported = tokenCompare_supportedLevel();
+
+  CU_ASSERT_EQUAL(tokenCompare_getLevel(), supported);
+  CU_ASSERT_EQUAL(tokenCompare_setLevel(TOKEN_COMPARE_SCALAR), TOKEN_COMPARE_SCALAR);
+  CU_ASSERT_EQUAL(tokenCompare_getLevel(), TOKEN_COMPARE_SCALAR);
+  CU_ASSERT_EQUAL(tokenCompare_setLevel(TOKEN_COMPARE_AVX2), supported);
+  CU_ASSERT_EQUAL(tokenCompare_getLevel(), supported);
+}
+
+CU_TestInfo token_compare_testcases[] = {
+  {"Testing comparison levels:", test_tokenCompareLevels},
+  {"Testing equal masks of hashes:", test_hashEqualMasks},
+  {"Testing common prefix of hashes:", test_hashCommonPrefix},
+  CU_TEST_INFO_NULL
+};
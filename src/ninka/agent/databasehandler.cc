@@ -28,11 +28,6 @@ NinkaDatabaseHandler::NinkaDatabaseHandler(DbManager dbManager) :
 {
 }
 
-vector<unsigned long> NinkaDatabaseHandler::queryFileIdsForUpload(int uploadId)
-{
-  return queryFileIdsVectorForUpload(uploadId);
-}
-
 // TODO: see function saveToDb() from src/monk/agent/database.c
 bool NinkaDatabaseHandler::saveLicenseMatch(int agentId, long pFileId, long licenseId, unsigned percentMatch)
 {
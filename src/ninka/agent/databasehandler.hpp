@@ -31,7 +31,6 @@ public:
   NinkaDatabaseHandler(NinkaDatabaseHandler&& other) : fo::AgentDatabaseHandler(std::move(other)) {};
   NinkaDatabaseHandler spawn() const;
 
-  std::vector<unsigned long> queryFileIdsForUpload(int uploadId);
   bool saveLicenseMatch(int agentId, long pFileId, long licenseId, unsigned percentMatch);
 
   void insertOrCacheLicenseIdForName(std::string const& rfShortName);
@@ -15,6 +15,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
  */
 
+#include <omp.h>
+
 #include "ninka.hpp"
 
 using namespace fo;
@@ -25,6 +27,8 @@ int main(int argc, char** argv)
   /* to initialize the scheduler connection */
 
   DbManager dbManager(&argc, argv);
+  // keep the connection of every thread for the next uploads
+  dbManager.setPoolSize(omp_get_max_threads());
   NinkaDatabaseHandler databaseHandler(dbManager);
 
   State state = getState(dbManager);
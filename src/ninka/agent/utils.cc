@@ -61,35 +61,35 @@ void bail(int exitval)
 
 bool processUploadId(const State& state, int uploadId, NinkaDatabaseHandler& databaseHandler)
 {
-  vector<unsigned long> fileIds = databaseHandler.queryFileIdsForUpload(uploadId);
+  StreamedQueryResult fileIds = databaseHandler.streamFileIdsForUpload(uploadId);
 
   bool errors = false;
 #pragma omp parallel
   {
     NinkaDatabaseHandler threadLocalDatabaseHandler(databaseHandler.spawn());
 
-    size_t pFileCount = fileIds.size();
-#pragma omp for
-    for (size_t it = 0; it < pFileCount; ++it)
+    vector<unsigned long> batch;
+    while (!errors && fileIds.getNextUnsignedLongs(0, FILE_ID_BATCH_SIZE, batch) > 0)
     {
-      if (errors)
-        continue;
+      for (size_t it = 0; it < batch.size() && !errors; ++it)
+      {
+        unsigned long pFileId = batch[it];
 
-      unsigned long pFileId = fileIds[it];
+        if (pFileId == 0)
+          continue;
 
-      if (pFileId == 0)
-        continue;
+        if (!matchPFileWithLicenses(state, pFileId, threadLocalDatabaseHandler))
+        {
+          errors = true;
+        }
 
-      if (!matchPFileWithLicenses(state, pFileId, threadLocalDatabaseHandler))
-      {
-        errors = true;
+        fo_scheduler_heart(1);
       }
-
-      fo_scheduler_heart(1);
+      batch.clear();
     }
   }
 
-  return !errors;
+  return !errors && !fileIds.isFailed();
 }
 
 bool matchPFileWithLicenses(const State& state, unsigned long pFileId, NinkaDatabaseHandler& databaseHandler)
@@ -102,11 +102,7 @@ bool matchPFileWithLicenses(const State& state, unsigned long pFileId, NinkaData
     bail(8);
   }
 
-  char* fileName = NULL;
-  {
-#pragma omp critical (repo_mk_path)
-    fileName = fo_RepMkPath("files", pFile);
-  }
+  char* fileName = fo_RepMkPath("files", pFile);
   if (fileName)
   {
     fo::File file(pFileId, fileName);
@@ -251,6 +251,10 @@ void licenseInit() {
       continue;
     }
   }
+  /**
+   * Last, build the literal prefilter from the final regexes
+   */
+  prefilterInit();
   return;
 }
 
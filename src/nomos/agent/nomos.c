@@ -52,6 +52,178 @@ char BuildVersion[] = "nomos build version: NULL.\n";
 /* nomos agent starting up in scheduler mode... */
 /* \ref http://www.fossology.org/projects/fossology/wiki/Nomos_Test_Cases*/
 
+/**
+ * \brief Progress of the scan of an upload, shared by all scanning processes
+ */
+typedef struct {
+  int next;     ///< Index of the next file to scan
+  int scanned;  ///< Number of files scanned and not yet sent as heart beats
+} uploadProgress_t;
+
+/**
+ * \brief Scan a file of an upload and record its licenses
+ *
+ * \param cacheroot Root for hash table
+ * \param files     pfile_pk and pfilename of the files of the upload
+ * \param i         Row of the file to scan
+ * \return 1 if the file was scanned, 0 if it is not a regular file, -1 on
+ *         failure
+ */
+static int scanUploadFile(cacheroot_t* cacheroot, PGresult* files, int i)
+{
+  char *repFile;
+
+  initializeCurScan(&cur);
+  strcpy(cur.pFile, PQgetvalue(files, i, 1));
+  cur.pFileFk = atoi(PQgetvalue(files, i, 0));
+  repFile = fo_RepMkPath("files", cur.pFile);
+  if (!repFile)
+  {
+    LOG_FATAL("Nomos unable to open pfile_pk: %ld, file: %s", cur.pFileFk, cur.pFile);
+    return -1;
+  }
+  /* make sure this is a regular file, ignore if not */
+  if (!isFILE(repFile))
+    return 0;
+  processFile(repFile);
+  if (recordScanToDB(cacheroot, &cur))
+    return -1;
+  freeAndClearScan(&cur);
+  return 1;
+}
+
+/**
+ * \brief Scan the files of an upload in a forked process
+ *
+ * The process takes the next file through the shared progress until all are
+ * scanned. The database connection of the parent can't be used by an other
+ * process, so the worker opens its own. The parent reports the files scanned
+ * to the scheduler, the worker never writes to it but for logging, and
+ * Bail() doesn't disconnect it from the scheduler.
+ *
+ * \param cacheroot Root for hash table
+ * \param files     pfile_pk and pfilename of the files of the upload
+ * \param progress  Progress of the scan, in shared memory
+ * \param label     Label of the regex statistics of the worker
+ */
+static void scanUploadWorker(cacheroot_t* cacheroot, PGresult* files,
+    uploadProgress_t* progress, char* label)
+{
+  char *dbConf = g_strdup_printf("%s/Db.conf", sysconfigdir);
+  char *dbError = NULL;
+  int numrows = PQntuples(files);
+  int status = 0;
+  int i;
+
+  gl.uploadWorker = 1;
+  gl.pgConn = fo_dbconnect(dbConf, &dbError);
+  g_free(dbConf);
+  if (!gl.pgConn)
+  {
+    LOG_FATAL("Nomos worker unable to connect to the database: %s", dbError);
+    free(dbError);
+    _exit(1);
+  }
+  gl.dbManager = fo_dbManager_new(gl.pgConn);
+
+  resetRegexStats();
+  while ((i = __sync_fetch_and_add(&progress->next, 1)) < numrows)
+  {
+    if ((status = scanUploadFile(cacheroot, files, i)) < 0)
+    {
+      /* the other workers stop after their current file */
+      __sync_fetch_and_add(&progress->next, numrows);
+      break;
+    }
+    if (status > 0)
+      __sync_fetch_and_add(&progress->scanned, 1);
+  }
+  logRegexStats(label);
+
+  fo_dbManager_finish(gl.dbManager);
+  _exit(status < 0 ? 1 : 0);
+}
+
+/**
+ * \brief Scan the files of an upload with several processes
+ *
+ * The files are taken by the forked workers as soon as they are idle, so a
+ * few large files don't leave the other workers waiting. The parent only
+ * sends a heart beat for the files scanned by the workers until they are all
+ * done.
+ *
+ * \param cacheroot     Root for hash table
+ * \param files         pfile_pk and pfilename of the files of the upload
+ * \param upload_pk     Upload being scanned
+ * \param process_count Number of workers
+ * \return 0 on success, -1 if a worker failed
+ */
+static int scanUploadParallel(cacheroot_t* cacheroot, PGresult* files,
+    int upload_pk, int process_count)
+{
+  uploadProgress_t *progress;
+  char label[64];
+  int running = 0;
+  int failed = 0;
+  int scanned;
+  int status;
+  int w;
+  pid_t pid;
+
+  progress = mmap(NULL, sizeof(uploadProgress_t), PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (progress == MAP_FAILED)
+  {
+    LOG_FATAL("failed to map the progress of upload %d, %s", upload_pk, strerror(errno));
+    return -1;
+  }
+  progress->next = 0;
+  progress->scanned = 0;
+
+  /* the workers must not write again what is left in the buffer */
+  fflush(stdout);
+  for (w = 0; w < process_count; w++)
+  {
+    snprintf(label, sizeof(label), "nomos upload %d worker %d", upload_pk, w);
+    pid = fork();
+    if (pid < 0)
+    {
+      LOG_ERROR("fork failed, scanning upload %d with %d processes", upload_pk, running);
+      break;
+    }
+    if (pid == 0)
+      scanUploadWorker(cacheroot, files, progress, label);
+    running++;
+  }
+  if (running == 0)
+    failed = 1;
+
+  while (running > 0)
+  {
+    pid = waitpid(-1, &status, WNOHANG);
+    if (pid > 0)
+    {
+      running--;
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        failed = 1;
+    }
+    else if (pid == 0)
+    {
+      sleep(1);
+    }
+    else if (errno != EINTR)
+    {
+      break;
+    }
+
+    if ((scanned = __sync_fetch_and_and(&progress->scanned, 0)) > 0)
+      fo_scheduler_heart(scanned);
+  }
+
+  munmap(progress, sizeof(uploadProgress_t));
+  return failed ? -1 : 0;
+}
+
 /**
  * \brief Make entry in ars table for audit
  *
@@ -60,30 +232,33 @@ char BuildVersion[] = "nomos build version: NULL.\n";
  * the upload and processes them. Nomos sends a heart beat at every file scan
  * completion.
  *
+ * With more than one process, the files are scanned by forked workers, see
+ * scanUploadParallel(), the biggest files first.
+ *
  * At the end, make an entry in the ars using fo_WriteARS().
- * \param cacheroot Root for hash table
+ * \param cacheroot     Root for hash table
+ * \param process_count Number of processes scanning the files of an upload
  */
-void arsNomos(cacheroot_t* cacheroot){
+void arsNomos(cacheroot_t* cacheroot, int process_count){
   int i;
   int upload_pk = 0;
   int numrows;
   int ars_pk = 0;
   int user_pk = 0;
+  int scanned;
   char *AgentARSName = "nomos_ars";
   char sqlbuf[1024];
   PGresult *result;
 
-  char *repFile;
-
   schedulerMode = 1;
-  /* get user_pk for user who queued the agent */
-  user_pk = fo_scheduler_userID();
   /* read upload_pk from scheduler */
   while (fo_scheduler_next())
   {
     upload_pk = atoi(fo_scheduler_current());
     if (upload_pk == 0)
       continue;
+    /* get user_pk for user who queued the agent, it changes with the job */
+    user_pk = fo_scheduler_userID();
     /* Check Permissions */
     if (GetUploadPerm(gl.pgConn, upload_pk, user_pk) < PERM_WRITE)
     {
@@ -108,40 +283,42 @@ void arsNomos(cacheroot_t* cacheroot){
     PQclear(result);
     /* Record analysis start in nomos_ars, the nomos audit trail. */
     ars_pk = fo_WriteARS(gl.pgConn, ars_pk, upload_pk, gl.agentPk, AgentARSName, 0, 0);
-    /* retrieve the records to process */
+    resetRegexStats();
+    /* retrieve the records to process, the biggest first */
     snprintf(sqlbuf, sizeof(sqlbuf),
         "SELECT pfile_pk, pfile_sha1 || '.' || pfile_md5 || '.' || pfile_size AS pfilename \
          FROM (SELECT distinct(pfile_fk) AS PF FROM uploadtree WHERE upload_fk='%d' and (ufile_mode&x'3C000000'::int)=0) as SS \
               left outer join license_file on (PF=pfile_fk and agent_fk='%d') inner join pfile on PF=pfile_pk\
-         WHERE fl_pk IS null or agent_fk <>'%d'",
+         WHERE fl_pk IS null or agent_fk <>'%d' ORDER BY pfile_size DESC",
         upload_pk, gl.agentPk, gl.agentPk);
     result = PQexec(gl.pgConn, sqlbuf);
     if (fo_checkPQresult(gl.pgConn, result, sqlbuf, __FILE__, __LINE__))
       Bail(-__LINE__);
     numrows = PQntuples(result);
     /* process all files in this upload */
-    for (i = 0; i < numrows; i++)
+    if (process_count > 1 && numrows > 1)
     {
-      initializeCurScan(&cur);
-      strcpy(cur.pFile, PQgetvalue(result, i, 1));
-      cur.pFileFk = atoi(PQgetvalue(result, i, 0));
-      repFile = fo_RepMkPath("files", cur.pFile);
-      if (!repFile)
+      if (scanUploadParallel(cacheroot, result,
+          upload_pk, MIN(process_count, numrows)))
       {
-        LOG_FATAL("Nomos unable to open pfile_pk: %ld, file: %s", cur.pFileFk, cur.pFile);
+        LOG_FATAL("nomos terminating upload %d scan due to previous errors.", upload_pk);
         Bail(-__LINE__);
       }
-      /* make sure this is a regular file, ignore if not */
-      if (!isFILE(repFile))
-        continue;
-      processFile(repFile);
-      fo_scheduler_heart(1);
-      if (recordScanToDB(cacheroot, &cur))
+    }
+    else
+    {
+      for (i = 0; i < numrows; i++)
       {
-        LOG_FATAL("nomos terminating upload %d scan due to previous errors.", upload_pk);
-        Bail(-__LINE__);
+        if ((scanned = scanUploadFile(cacheroot, result, i)) < 0)
+        {
+          LOG_FATAL("nomos terminating upload %d scan due to previous errors.", upload_pk);
+          Bail(-__LINE__);
+        }
+        if (scanned > 0)
+          fo_scheduler_heart(1);
       }
-      freeAndClearScan(&cur);
+      snprintf(sqlbuf, sizeof(sqlbuf), "nomos upload %d", upload_pk);
+      logRegexStats(sqlbuf);
     }
     PQclear(result);
     /* Record analysis success in nomos_ars. */
@@ -149,15 +326,44 @@ void arsNomos(cacheroot_t* cacheroot){
   }
 }
 
+/**
+ * A file found in directory mode
+ */
+typedef struct {
+  char *path;   ///< Path of the file
+  off_t size;   ///< Size of the file, bigger files are scanned first
+} queuedFile_t;
+
+/**
+ * \brief Work queue of directory mode, shared by all scanning processes
+ *
+ * The file list is built before the workers are forked and each worker
+ * inherits a copy. Only the index of the next file to scan lives in shared
+ * memory, so every worker takes the next file as soon as it is idle.
+ */
+typedef struct {
+  GArray *files;  ///< Array of queuedFile_t
+  int *next;      ///< Index of the next file to scan, in shared memory
+} fileQueue_t;
+
+/**
+ * \brief Order files by descending size
+ */
+static gint compareFileSize(gconstpointer a, gconstpointer b)
+{
+  off_t sizeA = ((queuedFile_t *) a)->size;
+  off_t sizeB = ((queuedFile_t *) b)->size;
+
+  return (sizeA < sizeB) - (sizeA > sizeB);
+}
+
 /**
  * \brief list all files and store file paths from the specified directory
  *
  * \param dir_name directory
- * \param process_count process count, write file paths into temp files on average process_count
- * \param distribute_count  Track number of files
- * \param pFile file descriptor array
+ * \param files    array of queuedFile_t to append the files to
  */
-void list_dir (const char * dir_name, int process_count, int *distribute_count, FILE **pFile)
+void list_dir (const char * dir_name, GArray *files)
 {
   struct dirent *dirent_handler;
   DIR *dir_handler;
@@ -170,7 +376,7 @@ void list_dir (const char * dir_name, int process_count, int *distribute_count,
 
   char filename_buf[PATH_MAX] = {}; // store one file path
   struct stat stat_buf ;
-  int file_number = 0;
+  queuedFile_t file;
   while ((dirent_handler = readdir(dir_handler)) != NULL)
   {
     /* get the file path, form the file path /dir_name/file_name,
@@ -186,23 +392,18 @@ void list_dir (const char * dir_name, int process_count, int *distribute_count,
 
     /*  1) do not travel '..', '.' directory
         2) when the file type is directory, travel it
-        3) when the file type is reguler file, write it into temp files on average (value from -n) */
+        3) when the file type is reguler file, add it to the work queue */
     if (strcmp (dirent_handler->d_name, "..") != 0 && strcmp (dirent_handler->d_name, ".") != 0)
     {
       /* the file type is a directory (exclude '..' and '.') */
       if ((stat_buf.st_mode & S_IFMT)  == S_IFDIR)
       {
-        list_dir(filename_buf, process_count, distribute_count, pFile); // deep into this directory and travel it
+        list_dir(filename_buf, files); // deep into this directory and travel it
       }
       else {
-        sprintf(filename_buf, "%s\n", filename_buf); // add one new line character by the end of one file path, one line is one file path
-        /* write on average process_count */
-        file_number = *distribute_count%process_count;
-        fwrite (filename_buf, sizeof(char), strlen(filename_buf), pFile[file_number]);
-        (*distribute_count)++; // increase the file count
-
-        if (process_count == *distribute_count) *distribute_count = 0; // reset list_file_count each cycle
-        continue;
+        file.path = g_strdup(filename_buf);
+        file.size = stat_buf.st_size;
+        g_array_append_val(files, file);
       }
     }
   }
@@ -210,42 +411,29 @@ void list_dir (const char * dir_name, int process_count, int *distribute_count,
 }
 
 /**
- * \brief read line by line, then call processFile to grab license line by line
+ * \brief take files from the work queue until it is empty, and grab the
+ * licenses of each
  *
- * \param file_number while temp path file do you want to read and process
- * \param pFile       file descriptor array
+ * \param queue the work queue shared by all processes
  */
-void read_file_grab_license(int file_number, FILE **pFile)
+void read_file_grab_license(fileQueue_t *queue)
 {
-  char *line = NULL;
-  size_t len = 0;
-  int lenth_tmp = 0;
-  ssize_t read = 0;
-
-  /*read line by line, then start to scan licenses */
-  while ((read = getline(&line, &len, pFile[file_number])) != -1) {
-    if (line && line[0]) // line is not empty
-    {
-      lenth_tmp = strlen(line);
-      /* trim the line */
-      while(isspace(line[lenth_tmp - 1])) line[--lenth_tmp] = 0;  // right trim
-      while(isspace(*line)) ++line;  // left trim
-      //printf("line is:%s, getpid() is:%d\n", line, getpid());
-    }
-    initializeCurScan(&cur);
-    processFile(line); // start to scan licenses
-  } // while
+  int i;
 
-  if (line) free(line);
+  while ((i = __sync_fetch_and_add(queue->next, 1)) < (int) queue->files->len)
+  {
+    initializeCurScan(&cur);
+    processFile(g_array_index(queue->files, queuedFile_t, i).path); // start to scan licenses
+  }
 }
 
 /**
  * \brief the recursive create process and process grabbing licenses
  *
  * \param proc_num how many child processes(proc_num - 1) will be created
- * \param pFile temp path file pointers
+ * \param queue    the work queue shared by all processes
  */
-void myFork(int proc_num, FILE **pFile) {
+void myFork(int proc_num, fileQueue_t *queue) {
   pid_t pid;
   pid = fork();
 
@@ -253,19 +441,19 @@ void myFork(int proc_num, FILE **pFile) {
   {
     LOG_FATAL("fork failed\n");
   }
-  else if (pid == 0) { // chile process, every singe process runs on one temp path file
-    read_file_grab_license(proc_num, pFile); // grabbing licenses on /tmp/foss-XXXXXX
+  else if (pid == 0) { // chile process, every process takes files from the queue
+    read_file_grab_license(queue);
     return;
   }
   else if (pid > 0) {
     // if pid != 0, we're in the parent
     // let's call ourself again, decreasing the counter, until it reaches 1.
     if (proc_num > 1) {
-      myFork(proc_num - 1, pFile);
+      myFork(proc_num - 1, queue);
     }
     else
     {
-      read_file_grab_license(0, pFile); // main(parent) process run on /tmp/foss-XXXXXX
+      read_file_grab_license(queue); // main(parent) process works on the queue as well
     }
   }
 }
@@ -415,12 +603,11 @@ int main(int argc, char **argv)
 
   if (file_count == 0 && !scanning_directory)
   {
-    arsNomos(&cacheroot);
+    arsNomos(&cacheroot, process_count);
   }
   else
   { /******** Files on the command line ********/
-    FILE **pFile = NULL; // store temp file descriptors
-    char (*pTempFileName)[50] = NULL; // store temp file names, they are looking like /tmp/foss-XXXXXX
+    fileQueue_t queue; // files to scan, shared by all processes
     pid_t mainPid = 0; // main process id
     cur.cliMode = 1;
 
@@ -440,41 +627,26 @@ int main(int argc, char **argv)
         }
         sem_init(&cur.mutexTempJson, 1, 1);
       }
-      pFile = malloc(process_count*(sizeof(FILE*)));
-      pTempFileName = malloc(process_count*sizeof(char[50]));
-      int i = 0;
-      int file_descriptor = 0;
-      for(i = 0; i < process_count; i++)
-      {
-        /* create temp file */
-        char file_template[] = "/tmp/foss-XXXXXX"; // 'XXXXXX' will be replaced after mkstemp
-        file_descriptor = mkstemp(file_template);
 
-        /* get the temp path file distriptors */
-        pFile[i] = fdopen(file_descriptor, "w");  // open the files to write later
-        if (!pFile[i])
-        {
-          LOG_FATAL("failed to open %s, %s\n", file_template, strerror(errno));
-        }
-        strcpy(pTempFileName[i], file_template); // store temp file names
-      }
-
-      /* walk through the specified directory to get all the file(file path) and
-          store into mutiple files - /tmp/foss-XXXXXX */
-      int distribute_count = 0; // record how many files are found in one directory
-      list_dir(scanning_directory, process_count, &distribute_count, pFile); // list and store files into /tmp/foss-XXXXXX in one directory
-
-      /* after the walking through and writing job is done, close all the temp path file distriptors.
-          then open the temp path files to read */
-      for(i = 0; i < process_count; i++)
+      /* walk through the specified directory to get all the files, then
+          sort them to scan the biggest files first: the processes take the
+          next file when they are done with the previous one, so the small
+          files at the end even out the load */
+      queue.files = g_array_new(FALSE, FALSE, sizeof(queuedFile_t));
+      list_dir(scanning_directory, queue.files);
+      g_array_sort(queue.files, compareFileSize);
+      queue.next = mmap(NULL, sizeof(int), PROT_READ | PROT_WRITE,
+          MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+      if (queue.next == MAP_FAILED)
       {
-        if (pFile[i]) fclose(pFile[i]);  //  write all the paths
-        pFile[i] = fopen(pTempFileName[i], "r"); // open the temp files to read
+        LOG_FATAL("failed to map the work queue, %s\n", strerror(errno));
+        Bail(-__LINE__);
       }
+      *queue.next = 0;
 
       /* create process_count - 1 child processes(please do not forget we always have the main process) */
       mainPid = getpid(); // get main process id
-      myFork(process_count - 1, pFile); // spawn process_count - 1 chile processes and grab licenses through process_count processes
+      myFork(process_count - 1, &queue); // spawn process_count - 1 chile processes and grab licenses through process_count processes
       int status = 0;
       pid_t wpid = 0;
       if (mainPid == getpid())
@@ -485,16 +657,6 @@ int main(int argc, char **argv)
           if (-1 == wpid) break;
         }
 
-        /* close the opening files, then delete the temp path files */
-        for(i = 0; i < process_count; i++)
-        {
-          if (pFile[i])
-          {
-            fclose(pFile[i]);
-            unlink(pTempFileName[i]);
-          }
-        }
-
         if (optionIsSet(OPTS_JSON_OUTPUT))
         {
           /* Print the JSON output and clean related variables */
@@ -504,14 +666,18 @@ int main(int argc, char **argv)
         }
 
         /* free memeory */
-        free(pFile);
-        free(pTempFileName);
+        munmap(queue.next, sizeof(int));
+        for (i = 0; i < queue.files->len; i++)
+        {
+          g_free(g_array_index(queue.files, queuedFile_t, i).path);
+        }
+        g_array_free(queue.files, TRUE);
       }
     }
     else {
       if (0 != process_count)
       {
-        printf("Warning: -n {nprocs} ONLY works with -d {directory}.\n");
+        printf("Warning: -n {nprocs} ONLY works with -d {directory} or from the scheduler.\n");
       }
       for (i = 0; i < file_count; i++) {
         initializeCurScan(&cur);
@@ -522,6 +688,12 @@ int main(int argc, char **argv)
     }
   }
 
+  if (Verbose && cur.cliMode)
+  {
+    logRegexStats(gl.progName);
+  }
+  regexCacheFree();
+  prefilterFree();
   lrcache_free(&cacheroot);  // for valgrind
 
   /* Normal Exit */
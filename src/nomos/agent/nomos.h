@@ -373,6 +373,7 @@ struct globals {
     int arsPk;              ///< Agent ars id
     PGconn *pgConn;         ///< DB Connection
     fo_dbManager *dbManager;  ///< FOSSology DB manager
+    int uploadWorker;       ///< Non-zero in a process forked to scan an upload
 };
 
 /**
@@ -0,0 +1,502 @@
+/***************************************************************
+ Copyright (C) 2026, Siemens AG
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ version 2 as published by the Free Software Foundation.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ ***************************************************************/
+/**
+ * \file
+ * \brief Literal prefilter for the footprint regexes
+ *
+ * Every footprint regex (see STRINGS.in) needs some literal text to match.
+ * At startup the longest required literal of each top level alternative is
+ * taken as anchor and all anchors are compiled into one Aho-Corasick
+ * automaton. A buffer is then scanned once and the footprints whose anchors
+ * did not show up cannot match anywhere in that buffer, so idxGrep() can
+ * skip them without running the regex.
+ *
+ * The anchors are matched case insensitive, which makes the prefilter a
+ * superset of the regex search whether REG_ICASE is set or not. Footprints
+ * without a usable anchor are always candidates.
+ */
+
+#include "nomos_prefilter.h"
+
+#define BITSET_SIZE ((NFOOTPRINTS + 7) / 8)
+#define BIT_SET(bits, i) ((bits)[(i) >> 3] |= (1 << ((i) & 7)))
+#define BIT_TEST(bits, i) ((bits)[(i) >> 3] & (1 << ((i) & 7)))
+
+/**
+ * Aho-Corasick automaton over all footprint anchors
+ */
+struct prefilter {
+  int nClasses;                ///< Number of input classes
+  unsigned char classOf[256];  ///< Input byte to class, 0 is "no anchor byte"
+  int nStates;                 ///< Number of states, 0 is the root
+  int *delta;                  ///< Transitions, nStates * nClasses
+  int *report;                 ///< First state on the suffix chain with outputs
+  int *dictLink;               ///< Next state on the suffix chain with outputs
+  int *outHead;                ///< First output of a state, -1 if none
+  int *outNext;                ///< Next output of the same state
+  int *outIndex;               ///< Footprint index of the output
+  unsigned char always[BITSET_SIZE]; ///< Footprints which cannot be filtered
+};
+
+static struct prefilter *pf = NULL;
+
+/** Candidate bitsets of the scanned buffers, keyed by buffer address */
+static GHashTable *scannedBuffers = NULL;
+
+/**
+ * \brief ASCII only lower case, the regexes run in the C locale
+ */
+static unsigned char foldCase(unsigned char c)
+{
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+/**
+ * \brief Drop the last character of a literal run
+ *
+ * A multi-byte character is dropped as a whole.
+ */
+static int dropLastChar(char *run, int runLen)
+{
+  while (runLen > 0 && (run[runLen - 1] & 0xC0) == 0x80)
+  {
+    runLen--;
+  }
+  return runLen > 0 ? runLen - 1 : 0;
+}
+
+/**
+ * \brief End the current literal run and remember it if it is the longest
+ */
+static void endRun(char *run, int *runLen, char *best, int *bestLen)
+{
+  if (*runLen > *bestLen)
+  {
+    memcpy(best, run, *runLen);
+    *bestLen = *runLen;
+  }
+  *runLen = 0;
+}
+
+/**
+ * \brief Find the anchor literals of a regex
+ *
+ * A regex is split into its top level alternatives and for each one the
+ * longest run of plain characters outside of any group is taken. The runs
+ * are lower cased and cut to PREFILTER_MAXLIT bytes.
+ *
+ * The regexes are searched both as basic and as extended regex, so every
+ * construct which is special in either syntax is treated as special.
+ *
+ * \param regex         The footprint regex
+ * \param[out] literals One anchor per alternative
+ * \return Number of anchors, 0 if the regex cannot be prefiltered
+ */
+int prefilterRequiredLiterals(char *regex,
+    char literals[][PREFILTER_MAXLIT + 1])
+{
+  char run[myBUFSIZ];
+  char best[myBUFSIZ];
+  int runLen = 0;
+  int bestLen = 0;
+  int depth = 0;
+  int nBranch = 0;
+  char *cp;
+
+  if (regex == NULL_STR || strlen(regex) >= myBUFSIZ)
+  {
+    return 0;
+  }
+
+  for (cp = regex; ; cp++)
+  {
+    if (*cp == NULL_CHAR || (*cp == '|' && depth == 0) ||
+        (*cp == '\\' && *(cp + 1) == '|' && depth == 0))
+    {
+      endRun(run, &runLen, best, &bestLen);
+      if (bestLen < PREFILTER_MINLIT || nBranch == PREFILTER_MAXBRANCH)
+      {
+        return 0;
+      }
+      bestLen = MIN(bestLen, PREFILTER_MAXLIT);
+      memcpy(literals[nBranch], best, bestLen);
+      literals[nBranch][bestLen] = NULL_CHAR;
+      nBranch++;
+      bestLen = 0;
+      if (*cp == NULL_CHAR)
+      {
+        break;
+      }
+      if (*cp == '\\')
+      {
+        cp++;
+      }
+      continue;
+    }
+
+    if (*cp == '\\')
+    {
+      cp++;
+      if (*cp == NULL_CHAR)
+      {
+        return 0;
+      }
+      if (*cp == '(')
+      {
+        depth++;
+      }
+      else if (*cp == ')' && --depth < 0)
+      {
+        return 0;
+      }
+      else if (*cp == '?')
+      {
+        /* GNU BRE makes the previous character optional */
+        runLen = dropLastChar(run, runLen);
+      }
+      else if (*cp == '{')
+      {
+        runLen = dropLastChar(run, runLen);
+        if ((cp = strstr(cp, "\\}")) == NULL_STR)
+        {
+          return 0;
+        }
+        cp++;
+      }
+      endRun(run, &runLen, best, &bestLen);
+      continue;
+    }
+
+    switch (*cp)
+    {
+      case '(':
+        depth++;
+        endRun(run, &runLen, best, &bestLen);
+        break;
+      case ')':
+        if (--depth < 0)
+        {
+          return 0;
+        }
+        endRun(run, &runLen, best, &bestLen);
+        break;
+      case '[':
+        /* skip the bracket expression, a leading ']' is part of the list */
+        cp++;
+        if (*cp == '^')
+        {
+          cp++;
+        }
+        if (*cp == ']')
+        {
+          cp++;
+        }
+        while (*cp && *cp != ']')
+        {
+          if (*cp == '[' && (*(cp + 1) == ':' || *(cp + 1) == '.' ||
+              *(cp + 1) == '='))
+          {
+            char term[3] = { *(cp + 1), ']', NULL_CHAR };
+            if ((cp = strstr(cp + 2, term)) == NULL_STR)
+            {
+              return 0;
+            }
+            cp++;
+          }
+          cp++;
+        }
+        if (*cp == NULL_CHAR)
+        {
+          return 0;
+        }
+        endRun(run, &runLen, best, &bestLen);
+        break;
+      case '*':
+      case '?':
+        runLen = dropLastChar(run, runLen);
+        endRun(run, &runLen, best, &bestLen);
+        break;
+      case '{':
+        runLen = dropLastChar(run, runLen);
+        if ((cp = strchr(cp, '}')) == NULL_STR)
+        {
+          return 0;
+        }
+        endRun(run, &runLen, best, &bestLen);
+        break;
+      case '+':
+      case '.':
+      case '^':
+      case '$':
+      case ']':
+      case '}':
+        endRun(run, &runLen, best, &bestLen);
+        break;
+      default:
+        if (depth == 0)
+        {
+          run[runLen++] = foldCase(*cp);
+        }
+        break;
+    }
+  }
+
+  if (depth != 0)
+  {
+    return 0;
+  }
+  return nBranch;
+}
+
+/**
+ * \brief Build the prefilter automaton from the footprint regexes
+ *
+ * Must be called after licenseInit() prepared licText[]. Calling it again
+ * rebuilds the automaton.
+ */
+void prefilterInit()
+{
+  char (*literals)[PREFILTER_MAXLIT + 1];
+  int *anchorIndex;
+  int nAnchors = 0;
+  int maxStates = 1;
+  int nOutputs = 0;
+  int *fail;
+  int *queue;
+  int head = 0;
+  int tail = 0;
+  int i;
+  int n;
+  int c;
+  int s;
+  char *cp;
+
+#ifdef PROC_TRACE
+  traceFunc("== prefilterInit()\n");
+#endif /* PROC_TRACE */
+
+  prefilterFree();
+  pf = calloc(1, sizeof(struct prefilter));
+  literals = calloc((size_t) NFOOTPRINTS * PREFILTER_MAXBRANCH,
+      PREFILTER_MAXLIT + 1);
+  anchorIndex = calloc((size_t) NFOOTPRINTS * PREFILTER_MAXBRANCH,
+      sizeof(int));
+
+  /* collect the anchors and the alphabet they use */
+  pf->nClasses = 1;
+  for (i = 0; i < NFOOTPRINTS; i++)
+  {
+    n = prefilterRequiredLiterals(licText[i].regex, literals + nAnchors);
+    if (n == 0)
+    {
+      BIT_SET(pf->always, i);
+      continue;
+    }
+    while (n-- > 0)
+    {
+      anchorIndex[nAnchors] = i;
+      for (cp = literals[nAnchors]; *cp; cp++)
+      {
+        unsigned char b = (unsigned char) *cp;
+        if (pf->classOf[b] == 0)
+        {
+          pf->classOf[b] = pf->nClasses++;
+          if (b >= 'a' && b <= 'z')
+          {
+            pf->classOf[b - ('a' - 'A')] = pf->classOf[b];
+          }
+        }
+        maxStates++;
+      }
+      nAnchors++;
+    }
+  }
+
+  /* build the trie, -1 marks a missing transition */
+  pf->delta = malloc(sizeof(int) * maxStates * pf->nClasses);
+  memset(pf->delta, -1, sizeof(int) * maxStates * pf->nClasses);
+  pf->outHead = malloc(sizeof(int) * maxStates);
+  memset(pf->outHead, -1, sizeof(int) * maxStates);
+  pf->outNext = malloc(sizeof(int) * (nAnchors + 1));
+  pf->outIndex = malloc(sizeof(int) * (nAnchors + 1));
+  pf->nStates = 1;
+  for (i = 0; i < nAnchors; i++)
+  {
+    s = 0;
+    for (cp = literals[i]; *cp; cp++)
+    {
+      c = pf->classOf[(unsigned char) *cp];
+      if (pf->delta[s * pf->nClasses + c] < 0)
+      {
+        pf->delta[s * pf->nClasses + c] = pf->nStates++;
+      }
+      s = pf->delta[s * pf->nClasses + c];
+    }
+    pf->outIndex[nOutputs] = anchorIndex[i];
+    pf->outNext[nOutputs] = pf->outHead[s];
+    pf->outHead[s] = nOutputs++;
+  }
+
+  /* breadth first: failure links, suffix output links and the full DFA */
+  fail = calloc(pf->nStates, sizeof(int));
+  queue = calloc(pf->nStates, sizeof(int));
+  pf->report = calloc(pf->nStates, sizeof(int));
+  pf->dictLink = calloc(pf->nStates, sizeof(int));
+  for (c = 0; c < pf->nClasses; c++)
+  {
+    s = pf->delta[c];
+    if (s < 0)
+    {
+      pf->delta[c] = 0;
+    }
+    else
+    {
+      fail[s] = 0;
+      queue[tail++] = s;
+    }
+  }
+  while (head < tail)
+  {
+    int r = queue[head++];
+
+    pf->dictLink[r] = (pf->outHead[fail[r]] >= 0) ? fail[r]
+        : pf->dictLink[fail[r]];
+    pf->report[r] = (pf->outHead[r] >= 0) ? r : pf->dictLink[r];
+    for (c = 0; c < pf->nClasses; c++)
+    {
+      s = pf->delta[r * pf->nClasses + c];
+      if (s < 0)
+      {
+        pf->delta[r * pf->nClasses + c] = pf->delta[fail[r] * pf->nClasses + c];
+      }
+      else
+      {
+        fail[s] = pf->delta[fail[r] * pf->nClasses + c];
+        queue[tail++] = s;
+      }
+    }
+  }
+
+  if (scannedBuffers == NULL)
+  {
+    scannedBuffers = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+        NULL, free);
+  }
+
+  free(queue);
+  free(fail);
+  free(anchorIndex);
+  free(literals);
+}
+
+/**
+ * \brief Release the prefilter automaton and all scan results
+ */
+void prefilterFree()
+{
+  prefilterClear();
+  if (pf == NULL)
+  {
+    return;
+  }
+  free(pf->delta);
+  free(pf->report);
+  free(pf->dictLink);
+  free(pf->outHead);
+  free(pf->outNext);
+  free(pf->outIndex);
+  free(pf);
+  pf = NULL;
+}
+
+/**
+ * \brief Scan a buffer once for all anchors
+ *
+ * The candidate footprints are remembered for the buffer address until
+ * prefilterForgetBuffer() or prefilterClear(). The buffer must not be changed
+ * in a way that adds text while it is registered.
+ * \param buf NULL terminated buffer, as searched by idxGrep()
+ */
+void prefilterScanBuffer(char *buf)
+{
+  unsigned char *bits;
+  unsigned char *cp;
+  int s = 0;
+  int r;
+  int o;
+
+  if (pf == NULL || buf == NULL_STR)
+  {
+    return;
+  }
+  bits = malloc(BITSET_SIZE);
+  memcpy(bits, pf->always, BITSET_SIZE);
+  for (cp = (unsigned char *) buf; *cp; cp++)
+  {
+    s = pf->delta[s * pf->nClasses + pf->classOf[*cp]];
+    for (r = pf->report[s]; r > 0; r = pf->dictLink[r])
+    {
+      for (o = pf->outHead[r]; o >= 0; o = pf->outNext[o])
+      {
+        BIT_SET(bits, pf->outIndex[o]);
+      }
+    }
+  }
+  g_hash_table_replace(scannedBuffers, buf, bits);
+}
+
+/**
+ * \brief Drop the scan result of a buffer, e.g. before it is rewritten
+ * \param buf Buffer passed to prefilterScanBuffer()
+ */
+void prefilterForgetBuffer(char *buf)
+{
+  if (scannedBuffers != NULL)
+  {
+    g_hash_table_remove(scannedBuffers, buf);
+  }
+}
+
+/**
+ * \brief Drop all scan results, must be called before the buffers are freed
+ */
+void prefilterClear()
+{
+  if (scannedBuffers != NULL)
+  {
+    g_hash_table_remove_all(scannedBuffers);
+  }
+}
+
+/**
+ * \brief Check if a footprint can match in a buffer
+ * \param index Index of the footprint (given in STRINGS.in)
+ * \param data  Buffer to be searched
+ * \return 0 if the footprint cannot match, 1 if it can or data was not scanned
+ */
+int prefilterMayMatch(int index, char *data)
+{
+  unsigned char *bits;
+
+  if (scannedBuffers == NULL ||
+      (bits = g_hash_table_lookup(scannedBuffers, data)) == NULL)
+  {
+    return 1;
+  }
+  return BIT_TEST(bits, index) ? 1 : 0;
+}
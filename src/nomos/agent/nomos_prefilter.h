@@ -0,0 +1,37 @@
+/***************************************************************
+ Copyright (C) 2026, Siemens AG
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ version 2 as published by the Free Software Foundation.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License along
+ with this program; if not, write to the Free Software Foundation, Inc.,
+ 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+ ***************************************************************/
+
+#ifndef _NOMOS_PREFILTER_H
+#define _NOMOS_PREFILTER_H
+#include "nomos.h"
+#include "_autodefs.h"
+
+#define PREFILTER_MINLIT    3   ///< Shortest literal worth an anchor
+#define PREFILTER_MAXLIT    12  ///< Anchors are cut to this length
+#define PREFILTER_MAXBRANCH 32  ///< Max top level alternatives of a regex
+
+int prefilterRequiredLiterals(char *regex,
+    char literals[][PREFILTER_MAXLIT + 1]);
+void prefilterInit();
+void prefilterFree();
+void prefilterScanBuffer(char *buf);
+void prefilterForgetBuffer(char *buf);
+void prefilterClear();
+int prefilterMayMatch(int index, char *data);
+
+#endif /* _NOMOS_PREFILTER_H */
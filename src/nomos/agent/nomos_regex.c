@@ -36,7 +36,59 @@
 /** Buffer to hold regex error */
 static char regexErrbuf[myBUFSIZ];
 
-regex_t idx_regc[NFOOTPRINTS];
+/** regcomp() cflags which change the compiled pattern */
+#define REGC_CFLAGS (REG_EXTENDED | REG_ICASE | REG_NEWLINE | REG_NOSUB)
+
+/**
+ * Compiled footprint regexes, indexed by footprint and cflags.
+ *
+ * The same footprint can be searched with different cflags, so every
+ * combination gets its own slot. Slots are compiled on first use and kept
+ * until regexCacheFree().
+ */
+static regex_t *idx_regc[NFOOTPRINTS][REGC_CFLAGS + 1];
+
+/** Time spent compiling and executing regexes */
+static regexStats_t regexStats;
+
+/**
+ * \brief Get a monotonic timestamp in seconds
+ */
+static double regexClock()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 0.000000001;
+}
+
+/**
+ * \brief regcomp() wrapper which accounts the compile time
+ */
+static int timedRegcomp(regex_t *rp, char *regex, int flags)
+{
+  int ret;
+  double start = regexClock();
+
+  ret = regcomp(rp, regex, flags);
+  regexStats.compiled++;
+  regexStats.compileTime += regexClock() - start;
+  return ret;
+}
+
+/**
+ * \brief regexec() wrapper which accounts the match time
+ */
+static int timedRegexec(regex_t *rp, char *data, regmatch_t *regmatch)
+{
+  int ret;
+  double start = regexClock();
+
+  ret = regexec(rp, data, 1, regmatch, 0);
+  regexStats.matched++;
+  regexStats.matchTime += regexClock() - start;
+  return ret;
+}
 
 /**
  * \brief Log an error caused by regex
@@ -165,7 +217,7 @@ int strGrep(char *regex, char *data, int flags)
     return (0);
   }
   /* DO NOT, repeat DO NOT add REG_EXTENDED as a default flag! */
-  if ((ret = regcomp(&regc, regex, flags)) != 0)
+  if ((ret = timedRegcomp(&regc, regex, flags)) != 0)
   {
     regexError(ret, &regc, regex);
     regfree(&regc);
@@ -176,7 +228,7 @@ int strGrep(char *regex, char *data, int flags)
    * regfree after the regexec call, else after a million or so regex
    * searches we'll have lost a LOT of memory. :)
    */
-  ret = regexec(&regc, data, 1, &cur.regm, 0);
+  ret = timedRegexec(&regc, data, &cur.regm);
   regfree(&regc);
   if (ret)
   {
@@ -203,6 +255,88 @@ int strGrep(char *regex, char *data, int flags)
   return (1);
 }
 
+/**
+ * \brief Get the compiled regex of a footprint
+ *
+ * The regex is compiled on the first request for a given footprint and
+ * cflags combination and reused by all later searches.
+ * \param index Index of the footprint (given in STRINGS.in)
+ * \param flags regcomp cflags, other bits are ignored
+ * \return Compiled regex, NULL on compile failure
+ */
+regex_t* getCompiledRegex(int index, int flags)
+{
+  int ret;
+  regex_t **slot = &idx_regc[index][flags & REGC_CFLAGS];
+
+  if (*slot != NULL)
+  {
+    return *slot;
+  }
+
+  *slot = calloc(1, sizeof(regex_t));
+  if ((ret = timedRegcomp(*slot, licText[index].regex, flags & REGC_CFLAGS)))
+  {
+    fprintf(stderr, "Compile failed, regex #%d\n", index);
+    regexError(ret, *slot, licText[index].regex);
+    regfree(*slot);
+    free(*slot);
+    *slot = NULL;
+    printf("Compile error \n");
+  }
+  return *slot;
+}
+
+/**
+ * \brief Release all compiled footprint regexes
+ */
+void regexCacheFree()
+{
+  int i;
+  int j;
+
+  for (i = 0; i < NFOOTPRINTS; i++)
+  {
+    for (j = 0; j <= REGC_CFLAGS; j++)
+    {
+      if (idx_regc[i][j] != NULL)
+      {
+        regfree(idx_regc[i][j]);
+        free(idx_regc[i][j]);
+        idx_regc[i][j] = NULL;
+      }
+    }
+  }
+}
+
+/**
+ * \brief Get the regex compile and match statistics
+ * \return Statistics collected since the last resetRegexStats()
+ */
+regexStats_t* getRegexStats()
+{
+  return &regexStats;
+}
+
+/**
+ * \brief Reset the regex compile and match statistics
+ */
+void resetRegexStats()
+{
+  memset(&regexStats, 0, sizeof(regexStats));
+}
+
+/**
+ * \brief Log the regex compile and match statistics
+ * \param label Prefix for the log line
+ */
+void logRegexStats(char *label)
+{
+  LOG_NOTICE("%s: %lu regex compiles in %.3f s, %lu regex matches in %.3f s, %lu searches skipped by prefilter",
+      label, regexStats.compiled, regexStats.compileTime,
+      regexStats.matched, regexStats.matchTime, regexStats.skipped)
+}
+
 /**
  * \brief compile a regex, and perform the search (on data?)
  *
@@ -297,7 +431,7 @@ int matchOnce(int isPlain, char *data, char* regex, regex_t *rp,
     return !strNbuf_noGlobals(data, regex, regmatch , 0 , cur.matchBase );
   }
 
-  return regexec(rp, data, 1, regmatch, 0);
+  return timedRegexec(rp, data, regmatch);
 }
 
 /**
@@ -339,11 +473,7 @@ int idxGrep_base(int index, char *data, int flags, int mode)
 
   int show = flags & FL_SHOWMATCH;
   licText_t *ltp = licText + index;
-  /**
-   * \todo is idx_regc needed? Here we set the pointer to our array and later
-   * we fill it, but we never reuse the regex_t
-   */
-  regex_t *rp = idx_regc + index;
+  regex_t *rp = NULL;
 
   CALL_IF_DEBUG_MODE(printf(" %i %i \"", index, ltp->plain);)
 
@@ -352,7 +482,7 @@ int idxGrep_base(int index, char *data, int flags, int mode)
       flags, _REGEX(index));
 #endif  /* PROC_TRACE || PHRASE_DEBUG */
 
-  if (index > NFOOTPRINTS)
+  if (index >= NFOOTPRINTS)
   {
     LOG_FATAL("idxGrep: index %d out of range", index)
     Bail(-__LINE__);
@@ -364,6 +494,11 @@ int idxGrep_base(int index, char *data, int flags, int mode)
 #endif  /* PHRASE_DEBUG */
     return (0);
   }
+  if (!prefilterMayMatch(index, data))
+  {
+    regexStats.skipped++;
+    return (0);
+  }
 
   if (ltp->plain )
   {
@@ -371,18 +506,13 @@ int idxGrep_base(int index, char *data, int flags, int mode)
     if(ret == 0) return (ret);
   }
   else {
-    if ((ret = regcomp(rp, ltp->regex, flags)))
+    if ((rp = getCompiledRegex(index, flags)) == NULL)
     {
-      fprintf(stderr, "Compile failed, regex #%d\n", index);
-      regexError(ret, rp, ltp->regex);
-      regfree(rp);
-      printf("Compile error \n");
       return (-1); /* <0 indicates compile failure */
     }
 
-    if (regexec(rp, data, 1, &cur.regm, 0))
+    if (timedRegexec(rp, data, &cur.regm))
     {
-      regfree(rp);
       return (0);
     }
     else ret  =1;
@@ -390,7 +520,6 @@ int idxGrep_base(int index, char *data, int flags, int mode)
   #ifdef  QA_CHECKS
     if (cur.regm.rm_so == cur.regm.rm_eo)
     {
-      regfree(rp);
       Assert(NO, "start/end offsets are identical in idxGrep(%d)",
           index);
     }
@@ -451,7 +580,6 @@ int idxGrep_base(int index, char *data, int flags, int mode)
     CALL_IF_DEBUG_MODE(printf("Bye!\n");)
  }
 
-  if (!ltp->plain ) regfree(rp);
 return (1);
 }
 
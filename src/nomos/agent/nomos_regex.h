@@ -23,15 +23,30 @@
 #include <ctype.h>
 #include "nomos.h"
 #include "util.h"
+#include "nomos_prefilter.h"
 #include "_autodefs.h"
 
-regex_t regc[NFOOTPRINTS];
+/**
+ * Regex compile and match statistics
+ */
+typedef struct {
+  unsigned long compiled; ///< Number of regcomp() calls
+  unsigned long matched;  ///< Number of regexec() calls
+  unsigned long skipped;  ///< Searches answered by the prefilter
+  double compileTime;     ///< Seconds spent in regcomp()
+  double matchTime;       ///< Seconds spent in regexec()
+} regexStats_t;
 
 void regexError(int ret, regex_t *regc, char *regex);
 int endsIn(char *s, char *suffix);
 int lineInFile(char *pathname, char *regex);
 int textInFile(char *pathname, char *regex, int flags);
 int strGrep(char *regex, char *data, int flags);
+regex_t* getCompiledRegex(int index, int flags);
+void regexCacheFree();
+regexStats_t* getRegexStats();
+void resetRegexStats();
+void logRegexStats(char *label);
 int idxGrep(int index, char *data, int flags);
 int idxGrep_recordPosition(int index, char *data, int flags);
 int idxGrep_recordPositionDoctored(int index, char *data, int flags);
@@ -529,6 +529,7 @@ FUNCTION void Usage(char *Name)
   printf("  -V   :: print the version info, then exit.\n");
   printf("  -d   :: specify a directory to scan.\n");
   printf("  -n   :: spaw n - 1 child processes to run, there will be n running processes(the parent and n - 1 children). \n the default n is 2(when n is less than 2 or not setting, will be changed to 2) when -d is specified.\n");
+  printf(" when run by the scheduler, the files of an upload are scanned by n processes, the default n is 1.\n");
 } /* Usage() */
 
 /**
@@ -556,6 +557,9 @@ FUNCTION void Bail(int exitval)
     fo_dbManager_free(gl.dbManager);
     PQfinish(gl.pgConn);
   }
+  /* the parent of an upload worker keeps talking to the scheduler */
+  if (gl.uploadWorker)
+    _exit(exitval ? 1 : 0);
   fo_scheduler_disconnect(exitval);
   exit(exitval);
 }
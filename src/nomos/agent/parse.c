@@ -448,6 +448,7 @@ char *parseLicenses(char *filetext, int size, scanres_t *scp,
 #ifdef  PRECHECK
   preloadResults(/*PARSE_ARGS*/filetext, ltsr);
 #endif  /* PRECHECK */
+  prefilterScanBuffer(filetext);
 #ifdef  MEMSTATS
   memStats("parseLicenses: BOP");
 #endif  /* MEMSTATS */
@@ -7208,6 +7209,7 @@ char *parseLicenses(char *filetext, int size, scanres_t *scp,
   listDump(&searchList, -1);
   memStats("parseLicenses: pre-Free");
 #endif  /* MEMSTATS */
+  prefilterClear();
   listClear(&searchList, NO);
 #ifdef  MEMSTATS
   memStats("parseLicenses: EOP");
@@ -8635,6 +8637,7 @@ int findPhrase(int index, char *filetext, int size, int isML, int isPS,
     printf(" ... doctoring buffer for \"%s\"\n", sp->str);
 #endif  /* DOCTOR_DEBUG */
     (void) doctorBuffer(sp->buf, isML, isPS, NO);
+    prefilterScanBuffer(sp->buf);
 #ifdef  PARSE_STOPWATCH
     RESET_TIMER;
     (void) sprintf(timerName, "... doctor(%03d): %s (%d)",
@@ -8723,6 +8726,7 @@ int findPhrase(int index, char *filetext, int size, int isML, int isPS,
         cp = sp->buf+seo;
         ptr = sp->buf+sso;
         ltsr[index] = 0;        /* reset search cache */
+        prefilterForgetBuffer(sp->buf);
         while (ptr <= cp) {
           *ptr++ = ',';
         }
@@ -5,6 +5,7 @@
 #include "standalone.h"
 
 int result = 0;
+char* sysconfigdir = NULL;
 
 void  fo_scheduler_heart(int i){}
 void  fo_scheduler_connect(int* argc, char** argv, PGconn** db_conn){}
@@ -27,6 +28,7 @@ int GetUploadPerm(PGconn *pgConn, long UploadPk, int user_pk){return(10);}
 
 fo_dbManager* fo_dbManager_new(PGconn* dbConnection) {return NULL;}
 void fo_dbManager_free(fo_dbManager* dbManager) {}
+void fo_dbManager_finish(fo_dbManager* dbManager) {}
 fo_dbManager_PreparedStatement* fo_dbManager_PrepareStamement_str(fo_dbManager* dbManager, const char* name, const char* query, const char* paramtypes) {return NULL;}
 PGresult* fo_dbManager_ExecPrepared(fo_dbManager_PreparedStatement* preparedStatement, ...) {return NULL;}
 
@@ -62,6 +62,7 @@ extern int   fo_scheduler_userID();
 extern void  fo_scheduler_set_special(int option, int value);
 extern int   fo_scheduler_get_special(int option);
 extern char* fo_sysconfig(const char* sectionname, const char* variablename);
+extern char* sysconfigdir;
 extern int  fo_GetAgentKey   (PGconn *pgConn,const char *agent_name, long unused, const char *cpunused, const char *agent_desc);
 extern int fo_WriteARS(PGconn *pgConn, int ars_pk, int upload_pk, int agent_pk,
                         const char *tableName, const char *ars_status, int ars_success);
@@ -86,6 +87,7 @@ fo_dbManager_PrepareStamement_str(dbManager, \
 
 fo_dbManager* fo_dbManager_new(PGconn* dbConnection);
 void fo_dbManager_free(fo_dbManager* dbManager);
+void fo_dbManager_finish(fo_dbManager* dbManager);
 fo_dbManager_PreparedStatement* fo_dbManager_PrepareStamement_str(fo_dbManager* dbManager, const char* name, const char* query, const char* paramtypes);
 PGresult* fo_dbManager_ExecPrepared(fo_dbManager_PreparedStatement* preparedStatement, ...);
 
@@ -50,6 +50,7 @@ struct curScan cur;
 
 extern CU_TestInfo nomos_gap_testcases[];
 extern CU_TestInfo doctorBuffer_testcases[];
+extern CU_TestInfo nomos_prefilter_testcases[];
 /* ************************************************************************** */
 /* **** create test suite *************************************************** */
 /* ************************************************************************** */
@@ -59,6 +60,7 @@ CU_SuiteInfo suites[] =
 {
     {"Testing process:", NULL, NULL, NULL, NULL, nomos_gap_testcases},
     {"Testing doctor Buffer:", NULL, NULL, NULL, NULL, doctorBuffer_testcases},
+    {"Testing prefilter:", NULL, NULL, NULL, NULL, nomos_prefilter_testcases},
     CU_SUITE_INFO_NULL
 };
 #else
@@ -66,6 +68,7 @@ CU_SuiteInfo suites[] =
 {
     {"Testing process:", NULL, NULL, nomos_gap_testcases},
     {"Testing doctor Buffer:", NULL, NULL, doctorBuffer_testcases},
+    {"Testing prefilter:", NULL, NULL, nomos_prefilter_testcases},
     CU_SUITE_INFO_NULL
 };
 #endif
@@ -0,0 +1,114 @@
+/*
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+/**
+ * \file
+ * \brief Unit test cases for the footprint prefilter
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <CUnit/CUnit.h>
+
+#include "nomos.h"
+#include "licenses.h"
+#include "nomos_regex.h"
+#include "nomos_prefilter.h"
+#include "_autodefs.h"
+
+/**
+ * \brief Test for prefilterRequiredLiterals()
+ * \test
+ * -# Extract the anchors of regexes with groups, quantifiers and alternatives
+ * -# Check that only text required by every match is used
+ */
+void test_prefilterRequiredLiterals()
+{
+  char literals[PREFILTER_MAXBRANCH][PREFILTER_MAXLIT + 1];
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("GNU General", literals), 1);
+  CU_ASSERT_STRING_EQUAL(literals[0], "gnu general");
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("licen[cs]e (is|are) granted", literals), 1);
+  CU_ASSERT_STRING_EQUAL(literals[0], " granted");
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("acknowledge?ment", literals), 1);
+  CU_ASSERT_STRING_EQUAL(literals[0], "acknowledg");
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("apache.{0,60}license|asl v", literals), 2);
+  CU_ASSERT_STRING_EQUAL(literals[0], "license");
+  CU_ASSERT_STRING_EQUAL(literals[1], "asl v");
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("permission is hereby granted", literals), 1);
+  CU_ASSERT_STRING_EQUAL(literals[0], "permission i");
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("http://isc\\?.org", literals), 1);
+  CU_ASSERT_STRING_EQUAL(literals[0], "http://is");
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("http://isc\\?.org/copyright", literals), 1);
+  CU_ASSERT_STRING_EQUAL(literals[0], "org/copyrigh");
+
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("bsd|mit", literals), 2);
+  CU_ASSERT_STRING_EQUAL(literals[0], "bsd");
+  CU_ASSERT_STRING_EQUAL(literals[1], "mit");
+
+  /* no usable anchor */
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("(gpl|lgpl)", literals), 0);
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("bsd|mi", literals), 0);
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("\\(c\\) [0-9]+", literals), 0);
+  CU_ASSERT_EQUAL(prefilterRequiredLiterals("unbalanced (group", literals), 0);
+}
+
+/**
+ * \brief Test for prefilterScanBuffer() and idxGrep()
+ * \test
+ * -# Scan a buffer with the prefilter
+ * -# Check that footprints found by idxGrep() on a copy of the buffer, which
+ *    is not prefiltered, are candidates for the scanned buffer
+ * -# Check that a footprint whose anchor is missing is skipped
+ */
+void test_prefilterScanBuffer()
+{
+  char *buf;
+  char *copy;
+  int i;
+
+  licenseInit();
+  buf = g_strdup("This file is licensed under the Apache License, Version 2.0");
+  copy = g_strdup(buf);
+  prefilterScanBuffer(buf);
+
+  for (i = 0; i < NFOOTPRINTS; i++)
+  {
+    if (idxGrep(i, copy, REG_ICASE | REG_EXTENDED) > 0)
+    {
+      CU_ASSERT_TRUE(prefilterMayMatch(i, buf));
+    }
+  }
+  g_free(copy);
+  CU_ASSERT_FALSE(prefilterMayMatch(_TITLE_ZLIB, buf));
+  CU_ASSERT_TRUE(prefilterMayMatch(_TITLE_ZLIB, buf + 1));
+
+  prefilterClear();
+  CU_ASSERT_TRUE(prefilterMayMatch(_TITLE_ZLIB, buf));
+  g_free(buf);
+}
+
+CU_TestInfo nomos_prefilter_testcases[] = {
+  {"Testing required literals:", test_prefilterRequiredLiterals},
+  {"Testing buffer scan:", test_prefilterScanBuffer},
+  CU_TEST_INFO_NULL
+};
@@ -19,25 +19,12 @@
 
 using namespace std;
 
-/**
- * Default constructor for OjoAgent.
- *
- * Also initializes the regex.
- */
-OjoAgent::OjoAgent() :
-    regLicenseList(
-        boost::regex(SPDX_LICENSE_LIST, boost::regex_constants::icase)),
-    regLicenseName(
-        boost::regex(SPDX_LICENSE_NAMES, boost::regex_constants::icase))
-{
-}
-
 /**
  * Scan a single file (when running from scheduler).
  * @param filePath        The file to be scanned.
  * @param databaseHandler Database handler to be used.
  * @return List of matches found.
- * @sa OjoAgent::scanString()
+ * @sa findSpdxLicenses()
  * @sa OjoAgent::filterMatches()
  * @sa OjoAgent::findLicenseId()
  * @throws std::runtime_error() Throws runtime error if the file can not be
@@ -46,23 +33,14 @@ OjoAgent::OjoAgent() :
 vector<ojomatch> OjoAgent::processFile(const string &filePath,
   OjosDatabaseHandler &databaseHandler)
 {
-  ifstream stream(filePath);
-  std::stringstream sstr;
-  sstr << stream.rdbuf();
-  if (stream.fail())
+  fo::FileView fileContent(filePath, -1);
+  if (!fileContent.isOpen())
   {
     throw std::runtime_error(filePath);
   }
-  stream.close();
-  const string fileContent = sstr.str();
-  vector<ojomatch> licenseList;
   vector<ojomatch> licenseNames;
 
-  scanString(fileContent, regLicenseList, licenseList, 0);
-  for (auto m : licenseList)
-  {
-    scanString(m.content, regLicenseName, licenseNames, m.start);
-  }
+  findSpdxLicenses(fileContent.begin(), fileContent.end(), licenseNames);
 
   findLicenseId(licenseNames, databaseHandler);
   filterMatches(licenseNames);
@@ -79,63 +57,18 @@ vector<ojomatch> OjoAgent::processFile(const string &filePath,
  */
 vector<ojomatch> OjoAgent::processFile(const string &filePath)
 {
-  ifstream stream(filePath);
-  std::stringstream sstr;
-  sstr << stream.rdbuf();
-  if (stream.fail())
+  fo::FileView fileContent(filePath, -1);
+  if (!fileContent.isOpen())
   {
     throw std::runtime_error(filePath);
   }
-  stream.close();
-  const string fileContent = sstr.str();
-  vector<ojomatch> licenseList;
   vector<ojomatch> licenseNames;
 
-  scanString(fileContent, regLicenseList, licenseList, 0);
-  for (auto m : licenseList)
-  {
-    scanString(m.content, regLicenseName, licenseNames, m.start);
-  }
+  findSpdxLicenses(fileContent.begin(), fileContent.end(), licenseNames);
 
   return licenseNames;
 }
 
-/**
- * Scan a string based using a regex and create matches.
- * @param text        String to be scanned
- * @param reg         Regex to be used
- * @param[out] result The match list.
- * @param offset      The offset to be added for each match
- */
-void OjoAgent::scanString(const string &text, boost::regex reg,
-    vector<ojomatch> &result, unsigned int offset)
-{
-  string::const_iterator end = text.end();
-  string::const_iterator pos = text.begin();
-
-  while (pos != end)
-  {
-    // Find next match
-    boost::smatch res;
-    if (boost::regex_search(pos, end, res, reg))
-    {
-      // Found match
-      result.push_back(
-        ojomatch(offset + res.position(1),
-          offset + res.position(1) + res.length(1),
-          res.length(1),
-          res[1].str()));
-      pos = res[0].second;
-      offset += res.position() + res.length();
-    }
-    else
-    {
-      // No match found
-      break;
-    }
-  }
-}
-
 /**
  * Filter the matches list and remove entries with license id less than 1.
  * @param[in,out] matches List of matches to be filtered
@@ -16,17 +16,20 @@
  */
 /**
  * @file
- * OjoAgent - the regex runner
+ * OjoAgent - the SPDX-License-Identifier scanner
  */
 #ifndef SRC_OJO_AGENT_OJOAGENT_HPP_
 #define SRC_OJO_AGENT_OJOAGENT_HPP_
 
-#include <boost/regex.hpp>
+#include <algorithm>
 #include <fstream>
+#include <vector>
+
+#include "files.hpp"
 
 #include "OjosDatabaseHandler.hpp"
 #include "ojomatch.hpp"
-#include "ojoregex.hpp"
+#include "spdxexpression.hpp"
 
 /**
  * @class OjoAgent
@@ -35,20 +38,10 @@
 class OjoAgent
 {
   public:
-    OjoAgent();
     std::vector<ojomatch> processFile(const std::string &filePath,
       OjosDatabaseHandler &databaseHandler);
     std::vector<ojomatch> processFile(const std::string &filePath);
   private:
-    /**
-     * @var boost::regex regLicenseList
-     * Regex to find the list of licenses
-     * @var boost::regex regLicenseName
-     * Regex to find the license names from the license lists
-     */
-    const boost::regex regLicenseList, regLicenseName;
-    void scanString(const std::string &text, boost::regex reg,
-        std::vector<ojomatch> &result, unsigned int offset);
     void filterMatches(std::vector<ojomatch> &matches);
     void findLicenseId(std::vector<ojomatch> &matches,
       OjosDatabaseHandler &databaseHandler);
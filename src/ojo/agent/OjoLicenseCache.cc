@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+/**
+ * @file
+ * @brief License id cache shared by all the threads of OJO
+ */
+
+#include "OjoLicenseCache.hpp"
+
+using namespace std;
+
+/**
+ * Convert a string to lower case, like LOWER() in the database does for
+ * ASCII.
+ * @param text String to convert
+ * @return Lower case string
+ */
+static string toLowerCase(string text)
+{
+  for (string::iterator it = text.begin(); it != text.end(); ++it)
+  {
+    if (*it >= 'A' && *it <= 'Z')
+      *it += 'a' - 'A';
+  }
+  return text;
+}
+
+/**
+ * Create an empty cache.
+ */
+OjoLicenseCache::OjoLicenseCache() :
+  licenseRefs(make_shared<LicenseMap>()), names(), namesMutex(), writeMutex()
+{
+}
+
+/**
+ * @brief Load the short names of the licenses in the database.
+ *
+ * When several licenses have the same short name ignoring the case, the one
+ * with the lowest id is kept, as the queries of the database handler do.
+ * @param licenseRefs Short names with their license id
+ */
+void OjoLicenseCache::preload(
+  const vector<pair<string, unsigned long>> &licenseRefs)
+{
+  shared_ptr<LicenseMap> loaded = make_shared<LicenseMap>();
+  loaded->reserve(licenseRefs.size());
+  for (size_t i = 0; i < licenseRefs.size(); ++i)
+  {
+    pair<LicenseMap::iterator, bool> inserted = loaded->insert(
+      make_pair(toLowerCase(licenseRefs[i].first), licenseRefs[i].second));
+    if (!inserted.second && licenseRefs[i].second < inserted.first->second)
+    {
+      inserted.first->second = licenseRefs[i].second;
+    }
+  }
+
+  // The threads still reading the previous licenses keep them until done
+  atomic_store(&this->licenseRefs, shared_ptr<const LicenseMap>(loaded));
+}
+
+/**
+ * @brief Get the license id for a short name from the cache.
+ *
+ * The name is first matched against the preloaded licenses as
+ * OjosDatabaseHandler::selectOrInsertLicenseIdForName() does in the
+ * database, then searched in the names already resolved.
+ * @param rfShortName Short name of the license
+ * @return License id, 0 if the name is not in the cache
+ */
+unsigned long OjoLicenseCache::find(const string &rfShortName) const
+{
+  unsigned long licenseId = findLicenseRef(rfShortName);
+  if (licenseId > 0)
+  {
+    return licenseId;
+  }
+
+  lock_guard<mutex> lock(namesMutex);
+  LicenseMap::const_iterator found = names.find(rfShortName);
+  return (found != names.end()) ? found->second : 0;
+}
+
+/**
+ * @brief Get the license id for a short name from the preloaded licenses.
+ * @param rfShortName Short name of the license
+ * @return License id, 0 if no preloaded license matches the name
+ */
+unsigned long OjoLicenseCache::findLicenseRef(const string &rfShortName) const
+{
+  shared_ptr<const LicenseMap> licenseRefs = atomic_load(&this->licenseRefs);
+  if (licenseRefs->empty())
+  {
+    return 0;
+  }
+  string first, second;
+  getNameCandidates(rfShortName, first, second);
+  unsigned long licenseId = 0;
+  LicenseMap::const_iterator found = licenseRefs->find(first);
+  if (found != licenseRefs->end())
+  {
+    licenseId = found->second;
+  }
+  found = licenseRefs->find(second);
+  if (found != licenseRefs->end() && (licenseId == 0 || found->second < licenseId))
+  {
+    licenseId = found->second;
+  }
+  return licenseId;
+}
+
+/**
+ * Add a name resolved through the database to the cache.
+ * @param rfShortName Short name of the license
+ * @param licenseId   License id of the name
+ */
+void OjoLicenseCache::addName(const string &rfShortName,
+  unsigned long licenseId)
+{
+  lock_guard<mutex> lock(namesMutex);
+  names.insert(make_pair(rfShortName, licenseId));
+}
+
+/**
+ * @brief Get the lower case short names matching a license name.
+ *
+ * The following rules are applied:
+ * -# `GPL-2.0` and `GPL-2.0-only` are treated as same
+ * -# `GPL-2.0+` and `GPL-2.0-or-later` are treated as same
+ * @param rfShortName Short name found
+ * @param[out] first  First matching short name
+ * @param[out] second Second matching short name
+ */
+void OjoLicenseCache::getNameCandidates(const string &rfShortName,
+  string &first, string &second)
+{
+  string tempShortName = toLowerCase(rfShortName);
+  /* Check if the name ends with +, -or-later, -only */
+  if ((rfShortName.length() >= 1
+      && rfShortName.compare(rfShortName.length() - 1, 1, "+") == 0)
+    || (rfShortName.length() >= 9
+      && rfShortName.compare(rfShortName.length() - 9, 9, "-or-later") == 0))
+  {
+    string plus("+");
+    string orLater("-or-later");
+
+    unsigned long int plusLast = tempShortName.rfind(plus);
+    unsigned long int orLaterLast = tempShortName.rfind(orLater);
+
+    /* Remove last occurrence of + and -or-later (if found) */
+    if (plusLast != string::npos)
+    {
+      tempShortName.replace(plusLast, plus.length(), "");
+    }
+    if (orLaterLast != string::npos)
+    {
+      tempShortName.replace(orLaterLast, orLater.length(), "");
+    }
+
+    first = tempShortName + plus;
+    second = tempShortName + orLater;
+  }
+  else
+  {
+    string only("-only");
+
+    unsigned long int onlyLast = tempShortName.rfind(only);
+
+    /* Remove last occurrence of -only (if found) */
+    if (onlyLast != string::npos)
+    {
+      tempShortName.replace(onlyLast, only.length(), "");
+    }
+
+    first = tempShortName;
+    second = tempShortName + only;
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+/**
+ * @file
+ * @brief License id cache shared by all the threads of OJO
+ */
+
+#ifndef OJOS_AGENT_LICENSE_CACHE_HPP
+#define OJOS_AGENT_LICENSE_CACHE_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @class OjoLicenseCache
+ * @brief Cache of the license ids for the short names found by OJO
+ *
+ * The cache is preloaded with the short names of all the licenses in the
+ * database. The names which can not be resolved from them are resolved once
+ * through the database and added to the cache.
+ *
+ * The preloaded licenses are an immutable map replaced as a whole when they
+ * are loaded again, so finding a preloaded name never locks. The names
+ * resolved through the database are kept in a separate map protected by a
+ * mutex. Resolving names is serialized: a thread resolving a name missing
+ * from the cache waits for the other thread resolving it and uses its result.
+ */
+class OjoLicenseCache
+{
+  public:
+    OjoLicenseCache();
+
+    void preload(
+      const std::vector<std::pair<std::string, unsigned long>> &licenseRefs);
+    unsigned long find(const std::string &rfShortName) const;
+    template <typename Resolver>
+    unsigned long resolve(const std::string &rfShortName, Resolver resolver);
+
+    static void getNameCandidates(const std::string &rfShortName,
+      std::string &first, std::string &second);
+
+  private:
+    OjoLicenseCache(const OjoLicenseCache&) = delete;
+    OjoLicenseCache& operator=(const OjoLicenseCache&) = delete;
+
+    /**
+     * Map from names to license ids
+     */
+    typedef std::unordered_map<std::string, unsigned long> LicenseMap;
+
+    unsigned long findLicenseRef(const std::string &rfShortName) const;
+    void addName(const std::string &rfShortName, unsigned long licenseId);
+
+    /**
+     * @var std::shared_ptr<const LicenseMap> licenseRefs
+     * Lower case short names of the preloaded licenses, only accessed with
+     * std::atomic_load() and std::atomic_store()
+     * @var LicenseMap names
+     * Names resolved through the database
+     * @var std::mutex namesMutex
+     * Protects names
+     * @var std::mutex writeMutex
+     * Serializes the resolution of the names
+     */
+    std::shared_ptr<const LicenseMap> licenseRefs;
+    LicenseMap names;
+    mutable std::mutex namesMutex;
+    std::mutex writeMutex;
+};
+
+/**
+ * @brief Get the license id for a short name, resolving it if needed.
+ *
+ * If the name is not in the cache, the resolver is called with the cache
+ * locked, so only one thread resolves a new name. A license id greater than
+ * 0 returned by the resolver is added to the cache.
+ * @param rfShortName Short name of the license
+ * @param resolver    Function returning the license id for the name
+ * @return License id, 0 if the name could not be resolved
+ */
+template <typename Resolver>
+unsigned long OjoLicenseCache::resolve(const std::string &rfShortName,
+  Resolver resolver)
+{
+  unsigned long licenseId = find(rfShortName);
+  if (licenseId > 0)
+  {
+    return licenseId;
+  }
+
+  std::lock_guard<std::mutex> lock(writeMutex);
+  // Another thread may have added the name while waiting for the lock
+  licenseId = find(rfShortName);
+  if (licenseId == 0)
+  {
+    licenseId = resolver();
+    if (licenseId > 0)
+    {
+      addName(rfShortName, licenseId);
+    }
+  }
+  return licenseId;
+}
+
+#endif // OJOS_AGENT_LICENSE_CACHE_HPP
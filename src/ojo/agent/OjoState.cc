@@ -23,7 +23,7 @@
  * @param cliOptions CLI options passed
  */
 OjoState::OjoState(const int agentId, const OjoCliOptions &cliOptions) :
-  agentId(agentId), cliOptions(cliOptions)
+  agentId(agentId), cliOptions(cliOptions), ojoAgent()
 {
 }
 
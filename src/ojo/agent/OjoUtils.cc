@@ -112,7 +112,7 @@ void bail(int exitval)
 bool processUploadId(const OjoState &state, int uploadId,
     OjosDatabaseHandler &databaseHandler)
 {
-  vector<unsigned long> fileIds = databaseHandler.queryFileIdsForScan(
+  StreamedQueryResult fileIds = databaseHandler.streamFileIdsForScan(
       uploadId, state.getAgentId());
   char const *repoArea = "files";
 
@@ -121,57 +121,55 @@ bool processUploadId(const OjoState &state, int uploadId,
   {
     OjosDatabaseHandler threadLocalDatabaseHandler(databaseHandler.spawn());
 
-    size_t pFileCount = fileIds.size();
     OjoAgent agentObj = state.getOjoAgent();
-#pragma omp for
-    for (size_t it = 0; it < pFileCount; ++it)
+    vector<unsigned long> batch;
+    while (!errors && fileIds.getNextUnsignedLongs(0, FILE_ID_BATCH_SIZE, batch) > 0)
     {
-      if (errors)
-        continue;
-
-      unsigned long pFileId = fileIds[it];
-
-      if (pFileId == 0)
-        continue;
-
-      char *fileName = threadLocalDatabaseHandler.getPFileNameForFileId(
-        pFileId);
-      char *filePath = NULL;
-#pragma omp critical (repo_mk_path)
-      filePath = fo_RepMkPath(repoArea, fileName);
-
-      if (!filePath)
+      for (size_t it = 0; it < batch.size() && !errors; ++it)
       {
-        LOG_FATAL(
-          AGENT_NAME" was unable to derive a file path for pfile %ld.  Check your HOSTS configuration.",
-          pFileId);
-        errors = true;
-      }
+        unsigned long pFileId = batch[it];
 
-      vector<ojomatch> identified;
-      try
-      {
-        identified = agentObj.processFile(filePath, threadLocalDatabaseHandler);
-      }
-      catch (std::runtime_error &e)
-      {
-        LOG_FATAL("Unable to read %s.", e.what());
-        continue;
-      }
+        if (pFileId == 0)
+          continue;
 
-      if (!storeResultInDb(identified, threadLocalDatabaseHandler,
-          state.getAgentId(), pFileId))
-      {
-        LOG_FATAL("Unable to store results in database for pfile %ld.",
+        char *fileName = threadLocalDatabaseHandler.getPFileNameForFileId(
           pFileId);
-        bail(-20);
+        char *filePath = fo_RepMkPath(repoArea, fileName);
+
+        if (!filePath)
+        {
+          LOG_FATAL(
+            AGENT_NAME" was unable to derive a file path for pfile %ld.  Check your HOSTS configuration.",
+            pFileId);
+          errors = true;
+        }
+
+        vector<ojomatch> identified;
+        try
+        {
+          identified = agentObj.processFile(filePath, threadLocalDatabaseHandler);
+        }
+        catch (std::runtime_error &e)
+        {
+          LOG_FATAL("Unable to read %s.", e.what());
+          continue;
+        }
+
+        if (!storeResultInDb(identified, threadLocalDatabaseHandler,
+            state.getAgentId(), pFileId))
+        {
+          LOG_FATAL("Unable to store results in database for pfile %ld.",
+            pFileId);
+          bail(-20);
+        }
+
+        fo_scheduler_heart(1);
       }
-
-      fo_scheduler_heart(1);
+      batch.clear();
     }
   }
 
-  return !errors;
+  return !errors && !fileIds.isFailed();
 }
 
 /**
@@ -21,6 +21,11 @@
 #define AGENT_NAME "ojo"
 #define AGENT_DESC "ojo agent"
 #define AGENT_ARS  "ojo_ars"
+/**
+ * The results of the ojo versions with the same fingerprint are reused,
+ * change it when the findings of the scanner change
+ */
+#define AGENT_FINGERPRINT "ojo-spdx-1"
 
 #include <vector>
 #include <utility>
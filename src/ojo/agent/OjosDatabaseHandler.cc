@@ -29,7 +29,19 @@ using namespace std;
  * @param dbManager DBManager to be used
  */
 OjosDatabaseHandler::OjosDatabaseHandler(DbManager dbManager) :
-    fo::AgentDatabaseHandler(dbManager)
+    fo::AgentDatabaseHandler(dbManager),
+    licenseCache(std::make_shared<OjoLicenseCache>())
+{
+}
+
+/**
+ * Constructor for OjosDatabaseHandler sharing a license cache
+ * @param dbManager    DBManager to be used
+ * @param licenseCache License cache to be used
+ */
+OjosDatabaseHandler::OjosDatabaseHandler(DbManager dbManager,
+    std::shared_ptr<OjoLicenseCache> licenseCache) :
+    fo::AgentDatabaseHandler(dbManager), licenseCache(licenseCache)
 {
 }
 
@@ -44,16 +56,17 @@ vector<unsigned long> OjosDatabaseHandler::queryFileIdsForUpload(int uploadId)
 }
 
 /**
- * Get a vector of all file id for a given upload id which are not scanned by the given agentId.
+ * Get all file ids for a given upload id which are not scanned by the given
+ * agentId, while the query returns them.
  * @param uploadId Upload ID to be queried
  * @param agentId  ID of the agent
- * @return List of all pfiles for the given upload
+ * @return Streamed pfile ids for the given upload
  */
-vector<unsigned long> OjosDatabaseHandler::queryFileIdsForScan(int uploadId, int agentId)
+fo::StreamedQueryResult OjosDatabaseHandler::streamFileIdsForScan(int uploadId, int agentId)
 {
   string uploadtreeTableName = queryUploadTreeTableName(uploadId);
 
-  QueryResult queryResult = dbManager.execPrepared(
+  return dbManager.streamPrepared(
     fo_dbManager_PrepareStamement(dbManager.getStruct_dbManager(),
       ("pfileForUploadFilterAgent" + uploadtreeTableName).c_str(),
       ("SELECT distinct(ut.pfile_fk) FROM " + uploadtreeTableName + " AS ut "
@@ -62,20 +75,19 @@ vector<unsigned long> OjosDatabaseHandler::queryFileIdsForScan(int uploadId, int
       "AND ut.upload_fk = $1 AND (ut.ufile_mode&x'3C000000'::int)=0;").c_str(),
       int, int),
     uploadId, agentId);
-
-  return queryResult.getSimpleResults(0, fo::stringToUnsignedLong);
 }
 
 /**
  * Spawn a new DbManager object.
  *
- * Used to create new objects for threads.
+ * Used to create new objects for threads. The license cache is shared with
+ * the new object.
  * @return DbManager object for threads.
  */
 OjosDatabaseHandler OjosDatabaseHandler::spawn() const
 {
   DbManager spawnedDbMan(dbManager.spawn());
-  return OjosDatabaseHandler(spawnedDbMan);
+  return OjosDatabaseHandler(spawnedDbMan, licenseCache);
 }
 
 /**
@@ -150,34 +162,12 @@ bool OjosDatabaseHandler::insertNoResultInDatabase(
     entry.agent_fk, entry.pfile_fk);
 }
 
-/**
- * Helper function to check if a string ends with other string.
- * @param firstString The string to be checked
- * @param ending      The ending string
- * @return True if first string has the ending string at end, false otherwise.
- */
-bool hasEnding(string const &firstString, string const &ending)
-{
-  if (firstString.length() >= ending.length())
-  {
-    return (0
-      == firstString.compare(firstString.length() - ending.length(),
-        ending.length(), ending));
-  }
-  else
-  {
-    return false;
-  }
-}
-
 /**
  * Get the license id for a given short name or create a new entry.
  *
  * @note
- * The following rules are also applied on name matching:
- * -# All matches are case in-sensitive.
- * -# `GPL-2.0 and GPL-2.0-only` are treated as same
- * -# `GPL-2.0+ and GPL-2.0-or-later` are treated as same
+ * All matches are case in-sensitive and follow the rules of
+ * OjoLicenseCache::getNameCandidates().
  *
  * @param rfShortName Short name to be searched.
  * @returns License id, 0 on failure
@@ -198,62 +188,16 @@ unsigned long OjosDatabaseHandler::selectOrInsertLicenseIdForName(
       char*, char*);
 
   /* First check similar matches */
-  /* Check if the name ends with +, -or-later, -only */
-  if (hasEnding(rfShortName, "+") || hasEnding(rfShortName, "-or-later"))
-  {
-    string tempShortName(rfShortName);
-    /* Convert shortname to lower-case */
-    std::transform(tempShortName.begin(), tempShortName.end(), tempShortName.begin(),
-      ::tolower);
-    string plus("+");
-    string orLater("-or-later");
-
-    unsigned long int plusLast = tempShortName.rfind(plus);
-    unsigned long int orLaterLast = tempShortName.rfind(orLater);
-
-    /* Remove last occurrence of + and -or-later (if found) */
-    if (plusLast != string::npos)
-    {
-      tempShortName.replace(plusLast, plus.length(), "");
-    }
-    if (orLaterLast != string::npos)
-    {
-      tempShortName.replace(orLaterLast, orLater.length(), "");
-    }
+  string first, second;
+  OjoLicenseCache::getNameCandidates(rfShortName, first, second);
 
-    QueryResult queryResult = dbManager.execPrepared(searchWithOr,
-        (tempShortName + plus).c_str(), (tempShortName + orLater).c_str());
+  QueryResult queryResult = dbManager.execPrepared(searchWithOr,
+      first.c_str(), second.c_str());
 
-    success = queryResult && queryResult.getRowCount() > 0;
-    if (success)
-    {
-      result = queryResult.getSimpleResults<unsigned long>(0, fo::stringToUnsignedLong)[0];
-    }
-  }
-  else
+  success = queryResult && queryResult.getRowCount() > 0;
+  if (success)
   {
-    string tempShortName(rfShortName);
-    /* Convert shortname to lower-case */
-    std::transform(tempShortName.begin(), tempShortName.end(), tempShortName.begin(),
-      ::tolower);
-    string only("-only");
-
-    unsigned long int onlyLast = tempShortName.rfind(only);
-
-    /* Remove last occurrence of -only (if found) */
-    if (onlyLast != string::npos)
-    {
-      tempShortName.replace(onlyLast, only.length(), "");
-    }
-
-    QueryResult queryResult = dbManager.execPrepared(searchWithOr,
-        tempShortName.c_str(), (tempShortName + only).c_str());
-
-    success = queryResult && queryResult.getRowCount() > 0;
-    if (success)
-    {
-      result = queryResult.getSimpleResults<unsigned long>(0, fo::stringToUnsignedLong)[0];
-    }
+    result = queryResult.getSimpleResults<unsigned long>(0, fo::stringToUnsignedLong)[0];
   }
 
   if (result > 0)
@@ -313,42 +257,48 @@ unsigned long OjosDatabaseHandler::selectOrInsertLicenseIdForName(
 }
 
 /**
- * @brief Get the license id for a given short name.
+ * @brief Get the short names of all the licenses.
  *
- * The function first checks if the license exists in the cache list. If the
- * license is not cached, it checks in DB and store in the cache.
- * @param rfShortName Short name to be searched
- * @returns License ID if found, 0 otherwise
- * @sa OjosDatabaseHandler::getCachedLicenseIdForName()
+ * Fills the license cache shared with the spawned handlers, so that the
+ * known names are resolved without querying the database.
+ * @return True on success, false otherwise
  */
-unsigned long OjosDatabaseHandler::getLicenseIdForName(
-    string const &rfShortName)
+bool OjosDatabaseHandler::preloadLicenseCache()
 {
-  unsigned long licenseId = getCachedLicenseIdForName(rfShortName);
-  if (licenseId == 0)
+  QueryResult queryResult = dbManager.queryPrintf(
+    "SELECT rf_pk, rf_shortname FROM ONLY license_ref");
+  if (!queryResult)
   {
-    licenseId = selectOrInsertLicenseIdForName(rfShortName);
-    licenseRefCache.insert(std::make_pair(rfShortName, licenseId));
+    return false;
+  }
+
+  vector<pair<string, unsigned long>> licenseRefs;
+  int rowCount = queryResult.getRowCount();
+  licenseRefs.reserve(rowCount);
+  for (int i = 0; i < rowCount; i++)
+  {
+    vector<string> row = queryResult.getRow(i);
+    licenseRefs.push_back(make_pair(row[1], fo::stringToUnsignedLong(row[0].c_str())));
   }
-  return licenseId;
+  licenseCache->preload(licenseRefs);
+  return true;
 }
 
 /**
- * Get the license id from the cached license list.
- * @param rfShortName Name of the license
- * @returns License id if found, 0 otherwise
+ * @brief Get the license id for a given short name.
+ *
+ * The function first checks if the license exists in the license cache. If
+ * the license is not cached, it checks in DB and store in the cache. The
+ * cache is shared by all the threads, only one of them queries the DB for a
+ * given name.
+ * @param rfShortName Short name to be searched
+ * @returns License ID if found, 0 otherwise
+ * @sa OjoLicenseCache::resolve()
  */
-unsigned long OjosDatabaseHandler::getCachedLicenseIdForName(
-    string const &rfShortName) const
+unsigned long OjosDatabaseHandler::getLicenseIdForName(
+    string const &rfShortName)
 {
-  std::unordered_map<string, long>::const_iterator findIterator =
-    licenseRefCache.find(rfShortName);
-  if (findIterator != licenseRefCache.end())
-  {
-    return findIterator->second;
-  }
-  else
-  {
-    return 0;
-  }
+  return licenseCache->resolve(rfShortName, [this, &rfShortName]() {
+    return selectOrInsertLicenseIdForName(rfShortName);
+  });
 }
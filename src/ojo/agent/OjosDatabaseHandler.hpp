@@ -22,7 +22,7 @@
 #ifndef OJOS_AGENT_DATABASE_HANDLER_HPP
 #define OJOS_AGENT_DATABASE_HANDLER_HPP
 
-#include <unordered_map>
+#include <memory>
 #include <algorithm>
 #include <string>
 #include <iostream>
@@ -31,6 +31,7 @@
 #include "libfossAgentDatabaseHandler.hpp"
 #include "libfossdbmanagerclass.hpp"
 #include "ojomatch.hpp"
+#include "OjoLicenseCache.hpp"
 
 extern "C" {
 #include "libfossology.h"
@@ -73,29 +74,31 @@ class OjosDatabaseHandler: public fo::AgentDatabaseHandler
   public:
     OjosDatabaseHandler(fo::DbManager dbManager);
     OjosDatabaseHandler(OjosDatabaseHandler &&other) :
-      fo::AgentDatabaseHandler(std::move(other))
+      fo::AgentDatabaseHandler(std::move(other)),
+      licenseCache(std::move(other.licenseCache))
     {
     }
     ;
     OjosDatabaseHandler spawn() const;
 
     std::vector<unsigned long> queryFileIdsForUpload(int uploadId);
-    std::vector<unsigned long> queryFileIdsForScan(int uploadId, int agentId);
+    fo::StreamedQueryResult streamFileIdsForScan(int uploadId, int agentId);
     unsigned long saveLicenseToDatabase(OjoDatabaseEntry &entry) const;
     bool insertNoResultInDatabase(OjoDatabaseEntry &entry) const;
     bool saveHighlightToDatabase(const ojomatch &match,
       const unsigned long fl_fk) const;
 
+    bool preloadLicenseCache();
     unsigned long getLicenseIdForName(std::string const &rfShortName);
 
   private:
-    unsigned long getCachedLicenseIdForName(
-      std::string const &rfShortName) const;
+    OjosDatabaseHandler(fo::DbManager dbManager,
+      std::shared_ptr<OjoLicenseCache> licenseCache);
     unsigned long selectOrInsertLicenseIdForName(std::string rfShortname);
     /**
-     * Cached license pairs
+     * License ids cache, shared with the spawned handlers
      */
-    std::unordered_map<std::string, long> licenseRefCache;
+    std::shared_ptr<OjoLicenseCache> licenseCache;
 };
 
 #endif // OJOS_AGENT_DATABASE_HANDLER_HPP
@@ -16,9 +16,10 @@
  */
 /**
  * @file
- * The list of regex used in the agent.
+ * The list of regex describing the licenses found by the agent.
  *
- * Each regex is stored as a macro.
+ * Each regex is stored as a macro. The agent does not run them but finds the
+ * same licenses with findSpdxLicenses().
  */
 #ifndef SRC_OJO_AGENT_OJOREGEX_HPP_
 #define SRC_OJO_AGENT_OJOREGEX_HPP_
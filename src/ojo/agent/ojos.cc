@@ -50,6 +50,8 @@
  *   - @link src/ojo/ui @endlink
  */
 
+#include <omp.h>
+
 #include "ojos.hpp"
 
 using namespace fo;
@@ -131,10 +133,22 @@ int main(int argc, char **argv)
   else
   {
     DbManager dbManager(&argc, argv);
+    // keep the connection of every thread for the next uploads
+    dbManager.setPoolSize(omp_get_max_threads());
     OjosDatabaseHandler databaseHandler(dbManager);
 
     state.setAgentId(queryAgentId(dbManager));
 
+    if (!databaseHandler.preloadLicenseCache())
+    {
+      LOG_WARNING(AGENT_NAME" was unable to preload the licenses, they will be queried one by one.");
+    }
+
+    // results of other ojo versions are copied instead of scanning again
+    bool reuseResults = fo_ResultReuseEnabled() &&
+      fo_SetAgentFingerprint(dbManager.getStruct_dbManager(),
+        state.getAgentId(), AGENT_FINGERPRINT);
+
     while (fo_scheduler_next() != NULL)
     {
       int uploadId = atoi(fo_scheduler_current());
@@ -147,6 +161,14 @@ int main(int argc, char **argv)
       if (arsId <= 0)
         bail(5);
 
+      if (reuseResults)
+      {
+        long copied = fo_CopyLicenseFileResults(dbManager.getStruct_dbManager(),
+          uploadId, state.getAgentId(), AGENT_FINGERPRINT);
+        if (copied > 0)
+          fo_scheduler_heart(copied);
+      }
+
       if (!processUploadId(state, uploadId, databaseHandler))
         bail(2);
 
@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+/**
+ * @file
+ * Scanner for SPDX-License-Identifier expressions
+ *
+ * The scanner finds the same licenses at the same positions as the regex
+ * SPDX_LICENSE_LIST followed by SPDX_LICENSE_NAMES (see ojoregex.hpp) but
+ * looks at every character of the text only once:
+ * -# The tags are found by searching for the `-` of `spdx-licen` with
+ * memchr() and comparing the surrounding characters.
+ * -# The license list after a tag is split in at most 5 elements, each an
+ * optional operator, an optional `(`, an identifier of at most 37 characters
+ * and an optional `)`.
+ * -# The elements are parsed as an expression by recursive descent.
+ */
+
+#include <cstring>
+
+#include "spdxexpression.hpp"
+
+using namespace std;
+
+/**
+ * Maximum number of licenses in an expression, as in SPDX_LICENSE_LIST
+ */
+#define SPDX_MAX_LICENSES 5
+/**
+ * Maximum length of a license identifier, as in SPDX_LICENSE_LIST
+ */
+#define SPDX_MAX_LICENSE_LENGTH 37
+
+/**
+ * @struct spdxtoken
+ * @brief Token of a license expression
+ */
+struct spdxtoken
+{
+  /**
+   * Type of the token
+   */
+  enum tokentype
+  {
+    LICENSE,  ///< License or exception identifier
+    AND,      ///< `AND` operator
+    OR,       ///< `OR` operator
+    WITH,     ///< `WITH` operator
+    OPEN,     ///< Opening parenthesis
+    CLOSE     ///< Closing parenthesis
+  };
+  /**
+   * @var tokentype type
+   * Type of the token
+   * @var long int license
+   * Index of the license in the matches, for license tokens
+   */
+  tokentype type;
+  long int license;
+
+  spdxtoken(tokentype t, long int l = -1) : type(t), license(l)
+  {
+  }
+};
+
+/**
+ * Check if a character can be part of a license identifier, like
+ * `[\w\d\.\+\-]` in the C locale.
+ * @param c Character to check
+ * @return True if the character is a letter, a digit or one of `_.+-`
+ */
+static inline bool isLicenseChar(unsigned char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+    || (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '+' || c == '-';
+}
+
+/**
+ * Match a word at the beginning of a text, ignoring the case of letters.
+ * @param pos  Beginning of the text
+ * @param end  End of the text
+ * @param word Word to match, in lower case
+ * @return End of the word in the text, NULL if the text does not start with
+ * the word
+ */
+static const char* matchIgnoreCase(const char *pos, const char *end,
+  const char *word)
+{
+  for (; *word; ++word, ++pos)
+  {
+    if (pos == end)
+      return NULL;
+    char c = *word >= 'a' && *word <= 'z' ? *pos | 0x20 : *pos;
+    if (c != *word)
+      return NULL;
+  }
+  return pos;
+}
+
+/**
+ * Match an SPDX-License-Identifier tag followed by `: `.
+ *
+ * Accepts `spdx-licen[cs]e(?:id|[- ]identifier): ` ignoring the case.
+ * @param pos Beginning of the tag
+ * @param end End of the text
+ * @return Beginning of the license list, NULL if there is no tag
+ */
+static const char* matchTag(const char *pos, const char *end)
+{
+  pos = matchIgnoreCase(pos, end, "spdx-licen");
+  if (!pos || pos == end || ((*pos | 0x20) != 'c' && (*pos | 0x20) != 's'))
+    return NULL;
+  pos = matchIgnoreCase(pos + 1, end, "e");
+  if (!pos || pos == end)
+    return NULL;
+  if (*pos == '-' || *pos == ' ')
+    pos = matchIgnoreCase(pos + 1, end, "identifier: ");
+  else
+    pos = matchIgnoreCase(pos, end, "id: ");
+  return pos;
+}
+
+/**
+ * Match an operator with the spaces around it.
+ * @param pos      Beginning of the operator
+ * @param end      End of the text
+ * @param[out] op  Type of the operator
+ * @return End of the operator, NULL if there is no operator
+ */
+static const char* matchOperator(const char *pos, const char *end,
+  spdxtoken::tokentype &op)
+{
+  const char *next;
+  if ((next = matchIgnoreCase(pos, end, " and ")))
+    op = spdxtoken::AND;
+  else if ((next = matchIgnoreCase(pos, end, " or ")))
+    op = spdxtoken::OR;
+  else if ((next = matchIgnoreCase(pos, end, " with ")))
+    op = spdxtoken::WITH;
+  return next;
+}
+
+/**
+ * @class spdxparser
+ * @brief Recursive descent parser of the tokens of an expression
+ *
+ * Parses the grammar
+ * ~~~
+ * or      := and ("OR" and)*
+ * and     := with ("AND" with)*
+ * with    := license ("WITH" license)? | "(" or ")"
+ * ~~~
+ */
+class spdxparser
+{
+  public:
+    spdxparser(const vector<spdxtoken> &tokens, vector<spdxnode> &nodes) :
+      tokens(tokens), nodes(nodes), next(0)
+    {
+    }
+
+    /**
+     * Parse all the tokens.
+     * @return Index of the root node, -1 if the tokens are not a valid
+     * expression
+     */
+    int parse()
+    {
+      int root = parseOr();
+      return next == tokens.size() ? root : -1;
+    }
+
+  private:
+    const vector<spdxtoken> &tokens;  ///< Tokens to parse
+    vector<spdxnode> &nodes;          ///< Nodes of the expression
+    size_t next;                      ///< Index of the next token
+
+    bool accept(spdxtoken::tokentype type)
+    {
+      if (next == tokens.size() || tokens[next].type != type)
+        return false;
+      ++next;
+      return true;
+    }
+
+    int addNode(spdxnode::nodetype type, int left, int right,
+      long int license)
+    {
+      spdxnode node;
+      node.type = type;
+      node.left = left;
+      node.right = right;
+      node.license = license;
+      nodes.push_back(node);
+      return nodes.size() - 1;
+    }
+
+    int parseOr()
+    {
+      int left = parseAnd();
+      while (left >= 0 && accept(spdxtoken::OR))
+      {
+        int right = parseAnd();
+        left = right < 0 ? -1 : addNode(spdxnode::OR, left, right, -1);
+      }
+      return left;
+    }
+
+    int parseAnd()
+    {
+      int left = parseWith();
+      while (left >= 0 && accept(spdxtoken::AND))
+      {
+        int right = parseWith();
+        left = right < 0 ? -1 : addNode(spdxnode::AND, left, right, -1);
+      }
+      return left;
+    }
+
+    int parseWith()
+    {
+      if (accept(spdxtoken::OPEN))
+      {
+        int inner = parseOr();
+        return inner >= 0 && accept(spdxtoken::CLOSE) ? inner : -1;
+      }
+      int license = parseLicense();
+      if (license >= 0 && accept(spdxtoken::WITH))
+      {
+        int exception = parseLicense();
+        license = exception < 0 ? -1
+          : addNode(spdxnode::WITH, license, exception, -1);
+      }
+      return license;
+    }
+
+    int parseLicense()
+    {
+      if (next == tokens.size() || tokens[next].type != spdxtoken::LICENSE)
+        return -1;
+      return addNode(spdxnode::LICENSE, -1, -1, tokens[next++].license);
+    }
+};
+
+/**
+ * Find the licenses of the SPDX-License-Identifier tags in a text.
+ * @param begin            Beginning of the text
+ * @param end              End of the text
+ * @param[out] licenses    Licenses found, with their position in the text
+ * @param[out] expressions Expressions found, NULL if not needed
+ */
+static void scanText(const char *begin, const char *end,
+  vector<ojomatch> &licenses, vector<spdxexpression> *expressions)
+{
+  vector<spdxtoken> tokens;
+  // The tag is searched from the `-` in `spdx-licen`
+  const char *dash = begin + 4;
+  while (dash < end
+    && (dash = static_cast<const char*>(memchr(dash, '-', end - dash))))
+  {
+    const char *listBegin = matchTag(dash - 4, end);
+    if (!listBegin)
+    {
+      ++dash;
+      continue;
+    }
+
+    const size_t firstLicense = licenses.size();
+    tokens.clear();
+    const char *listEnd = listBegin;
+    for (int count = 0; count < SPDX_MAX_LICENSES; ++count)
+    {
+      const char *next = listEnd;
+      spdxtoken::tokentype op = spdxtoken::LICENSE;
+      if (next != end && *next == ' ')
+      {
+        next = matchOperator(next, end, op);
+        if (!next)
+          break;
+      }
+      const bool open = next != end && *next == '(';
+      if (open)
+        ++next;
+      const char *name = next;
+      while (next != end && next - name < SPDX_MAX_LICENSE_LENGTH
+        && isLicenseChar(*next))
+        ++next;
+      if (next == name)
+        break;
+      const bool close = next != end && *next == ')';
+
+      licenses.push_back(ojomatch(name - begin, next - begin, next - name,
+        string(name, next)));
+      if (op != spdxtoken::LICENSE)
+        tokens.push_back(spdxtoken(op));
+      if (open)
+        tokens.push_back(spdxtoken(spdxtoken::OPEN));
+      tokens.push_back(spdxtoken(spdxtoken::LICENSE, licenses.size() - 1));
+      if (close)
+      {
+        tokens.push_back(spdxtoken(spdxtoken::CLOSE));
+        ++next;
+      }
+      listEnd = next;
+    }
+
+    if (licenses.size() == firstLicense)
+    {
+      ++dash;
+      continue;
+    }
+
+    if (expressions)
+    {
+      spdxexpression expression;
+      expression.start = listBegin - begin;
+      expression.end = listEnd - begin;
+      expression.root = spdxparser(tokens, expression.nodes).parse();
+      if (expression.root < 0)
+        expression.nodes.clear();
+      expressions->push_back(expression);
+    }
+    // Continue after the license list, no tag can start inside it
+    dash = listEnd + 4;
+  }
+}
+
+/**
+ * Find the licenses of the SPDX-License-Identifier tags in a text.
+ * @param begin         Beginning of the text
+ * @param end           End of the text
+ * @param[out] licenses Licenses found, with their position in the text
+ */
+void findSpdxLicenses(const char *begin, const char *end,
+  vector<ojomatch> &licenses)
+{
+  scanText(begin, end, licenses, NULL);
+}
+
+/**
+ * Find the licenses of the SPDX-License-Identifier tags in a text and the
+ * structure of their expressions.
+ * @param begin            Beginning of the text
+ * @param end              End of the text
+ * @param[out] licenses    Licenses found, with their position in the text
+ * @param[out] expressions Expressions found, in the order of the text
+ */
+void findSpdxLicenses(const char *begin, const char *end,
+  vector<ojomatch> &licenses, vector<spdxexpression> &expressions)
+{
+  scanText(begin, end, licenses, &expressions);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+/**
+ * @file
+ * Scanner for SPDX-License-Identifier expressions
+ */
+#ifndef SRC_OJO_AGENT_SPDXEXPRESSION_HPP_
+#define SRC_OJO_AGENT_SPDXEXPRESSION_HPP_
+
+#include <vector>
+
+#include "ojomatch.hpp"
+
+/**
+ * @struct spdxnode
+ * @brief Node of the tree of an SPDX license expression
+ */
+struct spdxnode
+{
+  /**
+   * Type of the node
+   */
+  enum nodetype
+  {
+    LICENSE,  ///< License or exception identifier
+    AND,      ///< Conjunction of the left and right operands
+    OR,       ///< Disjunction of the left and right operands
+    WITH      ///< License on the left with the exception on the right
+  };
+  /**
+   * @var nodetype type
+   * Type of the node
+   * @var int left
+   * Index of the left operand in the nodes of the expression, -1 for licenses
+   * @var int right
+   * Index of the right operand in the nodes of the expression, -1 for licenses
+   * @var long int license
+   * Index of the license in the matches of the scan, -1 for operators
+   */
+  nodetype type;
+  int left, right;
+  long int license;
+};
+
+/**
+ * @struct spdxexpression
+ * @brief License expression following an SPDX-License-Identifier tag
+ */
+struct spdxexpression
+{
+  /**
+   * @var long int start
+   * Start position of the expression
+   * @var long int end
+   * End position of the expression
+   * @var int root
+   * Index of the root of the expression in nodes, -1 if the licenses do not
+   * form a valid expression
+   */
+  long int start, end;
+  int root;
+  /**
+   * @var
+   * Nodes of the expression tree, operands come before their operators
+   */
+  std::vector<spdxnode> nodes;
+};
+
+void findSpdxLicenses(const char *begin, const char *end,
+  std::vector<ojomatch> &licenses);
+void findSpdxLicenses(const char *begin, const char *end,
+  std::vector<ojomatch> &licenses, std::vector<spdxexpression> &expressions);
+
+#endif /* SRC_OJO_AGENT_SPDXEXPRESSION_HPP_ */
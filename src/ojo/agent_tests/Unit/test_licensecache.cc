@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/**
+ * \file test_licensecache.cc
+ * \brief Test the license id cache shared by the threads
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <thread>
+
+#include "OjoLicenseCache.hpp"
+
+using namespace std;
+
+/**
+ * \class licenseCacheTestSuite
+ * \brief Test OjoLicenseCache
+ */
+class licenseCacheTestSuite : public CPPUNIT_NS :: TestFixture {
+  CPPUNIT_TEST_SUITE (licenseCacheTestSuite);
+  CPPUNIT_TEST (preloadTest);
+  CPPUNIT_TEST (resolveTest);
+  CPPUNIT_TEST (concurrentResolveTest);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+private:
+  /**
+   * \brief Licenses as in the license_ref table
+   */
+  vector<pair<string, unsigned long>> licenseRefs()
+  {
+    return {
+      {"GPL-2.0", 12}, {"GPL-2.0-only", 10}, {"GPL-2.0+", 11},
+      {"GPL-2.0-or-later", 13}, {"MIT", 20}, {"mit", 3},
+      {"Apache-2.0", 30}, {"LGPL-2.1-or-later", 40},
+    };
+  }
+
+protected:
+  /**
+   * \brief Test the names found in the preloaded licenses
+   * \test
+   * -# Preload the licenses
+   * -# Check that the names are found ignoring the case, with the lowest id
+   * -# Check that `-only` and `-or-later` are the same as no suffix and `+`
+   * -# Check that other names are not found
+   */
+  void preloadTest () {
+    OjoLicenseCache cache;
+    CPPUNIT_ASSERT_EQUAL(0UL, cache.find("MIT"));
+
+    cache.preload(licenseRefs());
+    CPPUNIT_ASSERT_EQUAL(3UL, cache.find("MIT"));
+    CPPUNIT_ASSERT_EQUAL(30UL, cache.find("apache-2.0"));
+    CPPUNIT_ASSERT_EQUAL(10UL, cache.find("GPL-2.0"));
+    CPPUNIT_ASSERT_EQUAL(10UL, cache.find("gpl-2.0-only"));
+    CPPUNIT_ASSERT_EQUAL(11UL, cache.find("GPL-2.0+"));
+    CPPUNIT_ASSERT_EQUAL(11UL, cache.find("GPL-2.0-or-later"));
+    CPPUNIT_ASSERT_EQUAL(40UL, cache.find("LGPL-2.1+"));
+    CPPUNIT_ASSERT_EQUAL(0UL, cache.find("LGPL-2.1"));
+    CPPUNIT_ASSERT_EQUAL(0UL, cache.find("BSD-3-Clause"));
+  }
+
+  /**
+   * \brief Test the names resolved with a resolver
+   * \test
+   * -# Resolve preloaded and new names
+   * -# Check that the resolver is only called for new names
+   * -# Check that failures are not cached
+   */
+  void resolveTest () {
+    OjoLicenseCache cache;
+    cache.preload(licenseRefs());
+    int calls = 0;
+
+    CPPUNIT_ASSERT_EQUAL(3UL, cache.resolve("MIT", [&]() { calls++; return 99UL; }));
+    CPPUNIT_ASSERT_EQUAL(0, calls);
+
+    CPPUNIT_ASSERT_EQUAL(50UL, cache.resolve("BSD-3-Clause", [&]() { calls++; return 50UL; }));
+    CPPUNIT_ASSERT_EQUAL(50UL, cache.resolve("BSD-3-Clause", [&]() { calls++; return 51UL; }));
+    CPPUNIT_ASSERT_EQUAL(50UL, cache.find("BSD-3-Clause"));
+    CPPUNIT_ASSERT_EQUAL(1, calls);
+
+    CPPUNIT_ASSERT_EQUAL(0UL, cache.resolve("Broken", [&]() { calls++; return 0UL; }));
+    CPPUNIT_ASSERT_EQUAL(60UL, cache.resolve("Broken", [&]() { calls++; return 60UL; }));
+    CPPUNIT_ASSERT_EQUAL(3, calls);
+
+    // Preloading again keeps the resolved names
+    cache.preload(licenseRefs());
+    CPPUNIT_ASSERT_EQUAL(50UL, cache.find("BSD-3-Clause"));
+  }
+
+  /**
+   * \brief Test that threads resolving the same names share the results
+   * \test
+   * -# Resolve the same new names from several threads
+   * -# Check that every name is resolved once and all threads get its id
+   */
+  void concurrentResolveTest () {
+    OjoLicenseCache cache;
+    cache.preload(licenseRefs());
+    const int nameCount = 200;
+    vector<int> calls(nameCount, 0);
+    vector<int> wrongIds(8, 0);
+
+    vector<thread> threads;
+    for (int t = 0; t < 8; t++)
+    {
+      threads.push_back(thread([&, t]() {
+        for (int i = 0; i < nameCount; i++)
+        {
+          int n = (i + t * 25) % nameCount;
+          unsigned long id = cache.resolve("License-" + to_string(n), [&, n]() {
+            calls[n]++;
+            this_thread::yield();
+            return (unsigned long) 1000 + n;
+          });
+          if (id != (unsigned long) 1000 + n)
+            wrongIds[t]++;
+        }
+      }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+      threads[t].join();
+
+    for (int t = 0; t < 8; t++)
+      CPPUNIT_ASSERT_EQUAL(0, wrongIds[t]);
+    for (int n = 0; n < nameCount; n++)
+      CPPUNIT_ASSERT_EQUAL(1, calls[n]);
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( licenseCacheTestSuite );
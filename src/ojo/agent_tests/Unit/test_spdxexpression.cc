@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026, Siemens AG
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+/**
+ * \file test_spdxexpression.cc
+ * \brief Test the SPDX expression scanner against the regex
+ */
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <boost/regex.hpp>
+
+#include "ojoregex.hpp"
+#include "spdxexpression.hpp"
+
+using namespace std;
+
+/**
+ * \brief Reference scan of a text with the regex used before
+ */
+static void regexScan(const string &text, const boost::regex &reg,
+  vector<ojomatch> &result, unsigned int offset)
+{
+  string::const_iterator end = text.end();
+  string::const_iterator pos = text.begin();
+
+  while (pos != end)
+  {
+    boost::smatch res;
+    if (!boost::regex_search(pos, end, res, reg))
+      break;
+    result.push_back(ojomatch(offset + res.position(1),
+      offset + res.position(1) + res.length(1), res.length(1),
+      res[1].str()));
+    pos = res[0].second;
+    offset += res.position() + res.length();
+  }
+}
+
+/**
+ * \brief Licenses found in a text by the regexes used before
+ */
+static vector<ojomatch> regexLicenses(const string &text)
+{
+  static const boost::regex listRegex(SPDX_LICENSE_LIST,
+    boost::regex_constants::icase);
+  static const boost::regex nameRegex(SPDX_LICENSE_NAMES,
+    boost::regex_constants::icase);
+  vector<ojomatch> licenseList;
+  vector<ojomatch> licenseNames;
+  regexScan(text, listRegex, licenseList, 0);
+  for (auto m : licenseList)
+    regexScan(m.content, nameRegex, licenseNames, m.start);
+  return licenseNames;
+}
+
+/**
+ * \brief Write a node of an expression with parenthesis around operations
+ */
+static string nodeToString(const spdxexpression &expression, int node,
+  const vector<ojomatch> &licenses)
+{
+  const spdxnode &n = expression.nodes[node];
+  switch (n.type)
+  {
+    case spdxnode::LICENSE:
+      return licenses[n.license].content;
+    case spdxnode::AND:
+      return "(" + nodeToString(expression, n.left, licenses) + " AND "
+        + nodeToString(expression, n.right, licenses) + ")";
+    case spdxnode::OR:
+      return "(" + nodeToString(expression, n.left, licenses) + " OR "
+        + nodeToString(expression, n.right, licenses) + ")";
+    case spdxnode::WITH:
+      return "(" + nodeToString(expression, n.left, licenses) + " WITH "
+        + nodeToString(expression, n.right, licenses) + ")";
+  }
+  return "";
+}
+
+/**
+ * \class spdxExpressionTestSuite
+ * \brief Test findSpdxLicenses()
+ */
+class spdxExpressionTestSuite : public CPPUNIT_NS :: TestFixture {
+  CPPUNIT_TEST_SUITE (spdxExpressionTestSuite);
+  CPPUNIT_TEST (expressionTest);
+  CPPUNIT_TEST (invalidExpressionTest);
+  CPPUNIT_TEST (sameAsRegexTest);
+
+  CPPUNIT_TEST_SUITE_END ();
+
+private:
+  /**
+   * \brief Scan a text and write its expressions, "invalid" for the ones
+   * which can not be parsed
+   */
+  vector<string> scanExpressions(const string &text)
+  {
+    vector<ojomatch> licenses;
+    vector<spdxexpression> expressions;
+    findSpdxLicenses(text.data(), text.data() + text.length(), licenses,
+      expressions);
+    vector<string> result;
+    for (auto e : expressions)
+      result.push_back(e.root < 0 ? "invalid"
+        : nodeToString(e, e.root, licenses));
+    return result;
+  }
+
+  /**
+   * \brief Check that the scanner finds the same licenses as the regexes
+   */
+  void assertSameAsRegex(const string &text)
+  {
+    vector<ojomatch> expected = regexLicenses(text);
+    vector<ojomatch> actual;
+    findSpdxLicenses(text.data(), text.data() + text.length(), actual);
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(text, expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(text, expected[i].start, actual[i].start);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(text, expected[i].end, actual[i].end);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(text, expected[i].len, actual[i].len);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(text, expected[i].content,
+        actual[i].content);
+    }
+  }
+
+protected:
+  /**
+   * \brief Test the structure of valid expressions
+   * \test
+   * -# Scan texts with one or more tags
+   * -# Check that AND binds before OR, WITH before AND, and that
+   *    parenthesis group the licenses
+   */
+  void expressionTest () {
+    CPPUNIT_ASSERT(scanExpressions("SPDX-License-Identifier: MIT")
+      == vector<string>({"MIT"}));
+    CPPUNIT_ASSERT(scanExpressions(
+      "SPDX-License-Identifier: GPL-2.0 AND LGPL-2.1+ WITH Classpath-exception-2.0")
+      == vector<string>({"(GPL-2.0 AND (LGPL-2.1+ WITH Classpath-exception-2.0))"}));
+    CPPUNIT_ASSERT(scanExpressions(
+      "// spdx-license-identifier: MIT or Apache-2.0 and BSD-3-Clause\n"
+      "# SPDX-LicenseId: (MIT OR Apache-2.0) AND BSD-3-Clause\n")
+      == vector<string>({"(MIT OR (Apache-2.0 AND BSD-3-Clause))",
+        "((MIT OR Apache-2.0) AND BSD-3-Clause)"}));
+  }
+
+  /**
+   * \brief Test license lists which are not valid expressions
+   * \test
+   * -# Scan texts with unbalanced parenthesis, missing operators and
+   *    misplaced WITH
+   * -# Check that the expressions are invalid
+   * -# Check that the licenses are still found
+   */
+  void invalidExpressionTest () {
+    CPPUNIT_ASSERT(scanExpressions("SPDX-License-Identifier: (MIT OR GPL-2.0")
+      == vector<string>({"invalid"}));
+    CPPUNIT_ASSERT(scanExpressions("SPDX-License-Identifier: MIT) OR GPL-2.0")
+      == vector<string>({"invalid"}));
+    CPPUNIT_ASSERT(scanExpressions("SPDX-License-Identifier: (MIT)GPL-2.0")
+      == vector<string>({"invalid"}));
+    CPPUNIT_ASSERT(scanExpressions(
+      "SPDX-License-Identifier: (MIT OR GPL-2.0) WITH Classpath-exception-2.0")
+      == vector<string>({"invalid"}));
+
+    vector<ojomatch> licenses;
+    vector<spdxexpression> expressions;
+    const string text = "x SPDX-License-Identifier: MIT) OR GPL-2.0";
+    findSpdxLicenses(text.data(), text.data() + text.length(), licenses,
+      expressions);
+    CPPUNIT_ASSERT_EQUAL((size_t) 2, licenses.size());
+    CPPUNIT_ASSERT_EQUAL(string("GPL-2.0"), licenses[1].content);
+    CPPUNIT_ASSERT_EQUAL((size_t) 1, expressions.size());
+    CPPUNIT_ASSERT_EQUAL(27L, expressions[0].start);
+    CPPUNIT_ASSERT_EQUAL((long) text.length(), expressions[0].end);
+    CPPUNIT_ASSERT(expressions[0].nodes.empty());
+  }
+
+  /**
+   * \brief Test that the licenses are the ones found by the regexes
+   * \test
+   * -# Scan typical tags, long identifiers and more than 5 licenses
+   * -# Scan pseudo random texts made of tags, operators, identifiers and
+   *    other characters
+   * -# Compare the positions and names with the ones found by the regexes
+   */
+  void sameAsRegexTest () {
+    assertSameAsRegex("");
+    assertSameAsRegex("SPDX-License-Identifier: ");
+    assertSameAsRegex("SPDX-License-Identifier: GPL-2.0 AND LGPL-2.1+");
+    assertSameAsRegex("SPDX-License-Identifier: "
+      "A-very-long-license-identifier-of-more-than-37-characters-and-more");
+    assertSameAsRegex("SPDX-License-Identifier: A or B or C or D or E or F");
+    assertSameAsRegex("SPDX-License-Identifier: SPDX-License-Identifier: MIT");
+    assertSameAsRegex("SPDX-License-Identifier:  and MIT");
+
+    const char *fragments[] = {
+      "SPDX-License-Identifier: ", "spdx-licenseid: ", "SpDx-LiCeNcE identifier: ",
+      "spdx-licence-identifier: ", "spdx-licen", "SPDX-", "-identifier: ",
+      " AND ", " or ", " With ", " and", "(", ")", "MIT", "GPL-2.0+",
+      "Classpath-exception-2.0", "a_very.long+identifier-with-40-characters",
+      " ", "  ", ":", "-", "\n", "x", "\xe9", "\t",
+    };
+    const size_t fragmentCount = sizeof(fragments) / sizeof(fragments[0]);
+    unsigned seed = 4321;
+    for (int n = 0; n < 20000; n++)
+    {
+      seed = seed * 1103515245 + 12345;
+      size_t length = (seed >> 16) % 30;
+      string text;
+      for (size_t i = 0; i < length; i++)
+      {
+        seed = seed * 1103515245 + 12345;
+        text += fragments[(seed >> 16) % fragmentCount];
+      }
+      assertSameAsRegex(text);
+    }
+  }
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( spdxExpressionTestSuite );
@@ -30,6 +30,7 @@
 #include <host.h>
 #include <job.h>
 #include <logging.h>
+#include <metrics.h>
 #include <scheduler.h>
 
 /* library includes */
@@ -42,6 +43,8 @@
 /* unix library includes */
 #include <fcntl.h>
 #include <limits.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -122,6 +125,20 @@ const char* agent_status_strings[] =
 { AGENT_STATUS_TYPES(SELECT_STRING) };
 #undef SELECT_STRING
 
+/**
+ * Lock held while the messages of an agent are handled, so that an agent isn't
+ * removed while the communication thread uses it.
+ */
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+static GMutex io_mutex;
+#define io_lock()   g_mutex_lock(&io_mutex)
+#define io_unlock() g_mutex_unlock(&io_mutex)
+#else
+static GStaticMutex io_mutex = G_STATIC_MUTEX_INIT;
+#define io_lock()   g_static_mutex_lock(&io_mutex)
+#define io_unlock() g_static_mutex_unlock(&io_mutex)
+#endif
+
 /* ************************************************************************** */
 /* **** Local Functions ***************************************************** */
 /* ************************************************************************** */
@@ -144,12 +161,42 @@ static int agent_close_fd(int* pid_ptr, agent_t* agent, agent_t* excepted)
   {
     close(agent->from_child);
     close(agent->to_child);
-    fclose(agent->read);
     fclose(agent->write);
   }
   return 0;
 }
 
+/**
+ * @brief Takes an agent out of the pool of its meta agent and closes it.
+ *
+ * The agent is still owned by its last job, it will leave it and the system
+ * once it sends "BYE".
+ *
+ * @param agent  the agent in the pool
+ */
+static void agent_unpool(agent_t* agent)
+{
+  agent->type->pool = g_list_remove(agent->type->pool, agent);
+  agent->pooled = 0;
+  aprintf(agent, "CLOSE\n");
+}
+
+/**
+ * @brief GTraverseFunction that closes all of the agents in the pool of a meta
+ * agent.
+ *
+ * @param name    the name of the meta agent
+ * @param ma      the meta agent
+ * @param unused
+ * @return always returns 0 to indicate that the traversal should continue
+ */
+static int agent_pool_clear(char* name, meta_agent_t* ma, gpointer unused)
+{
+  while (ma->pool != NULL)
+    agent_unpool(ma->pool->data);
+  return 0;
+}
+
 /**
  * Check the status and check in time of an agent.
  *   - If we haven't gotten a recent communication, close it
@@ -165,6 +212,13 @@ static int update(int* pid_ptr, agent_t* agent, gpointer unused)
   TEST_NULL(agent, 0);
   int nokill = is_agent_special(agent, SAG_NOKILL) || is_meta_special(agent->type, SAG_NOKILL);
 
+  if (agent->pooled && time(NULL) - agent->pooled > CONF_agent_pool_timeout)
+  {
+    AGENT_SEQUENTIAL_PRINT("no new job for %d seconds, closing\n", (time(NULL) - agent->pooled));
+    agent_unpool(agent);
+    return 0;
+  }
+
   if (agent->status == AG_SPAWNED || agent->status == AG_RUNNING || agent->status == AG_PAUSED)
   {
     /* check last checkin time */
@@ -266,52 +320,29 @@ static int agent_test(const gchar* name, meta_agent_t* ma, scheduler_t* schedule
 }
 
 /**
- * Main function used for agent communication. This is where the communication
- * thread will spend the majority of its time.
+ * @brief Checks the version information sent by an agent.
+ *
+ * The first message of an agent should be "VERSION: <string>" where the string
+ * is the version information. There are five things that can happen here.
+ *   -# the agent sends correct version information   => continue
+ *   -# this is the first agent to send version info  => save version and continue
+ *   -# the agent sends incorrect version information => invalidate the agent
+ *   -# the agent doesn't send version information    => invalidate the agent
+ *   -# the agent crashed before sending information  => stop listening
  *
- * @param scheduler Pointer to scheduler interface
- * @param agent a the agent that will be listened on
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the agent that sent the message
+ * @param buffer     the first message of the agent
+ * @return 1 if the agent should still be listened to, 0 otherwise
  */
-static void agent_listen(scheduler_t* scheduler, agent_t* agent)
+static int agent_version(scheduler_t* scheduler, agent_t* agent, char* buffer)
 {
-  /* static locals */
-#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
-  static GMutex version_lock;
-#else
-  static GStaticMutex version_lock = G_STATIC_MUTEX_INIT;
-#endif
-
-  /* locals */
-  char buffer[1024]; // buffer to store c strings read from agent
-  GMatchInfo* match; // regex match information
-  char* arg;         // used during regex retrievals
-  int relevant;      // used during special retrievals
-
-  TEST_NULV(agent);
-
-  /**
-   * Start by getting the version information from the agent. The agent should
-   * send "VERSION: <string>" where the string is the version information. there
-   * are five things that can happen here.
-   *   -# the agent sends correct version information   => continue
-   *   -# this is the first agent to send version info  => save version and continue
-   *   -# the agent sends incorrect version information => invalidate the agent
-   *   -# the agent doesn't send version information    => invalidate the agent
-   *   -# the agent crashed before sending information  => close the thread
-   */
-  if (fgets(buffer, sizeof(buffer), agent->read) == NULL)
-  {
-    AGENT_CONCURRENT_PRINT("pipe from child closed: %s\n", strerror(errno));
-    g_thread_exit(NULL);
-  }
-
   /* check to make sure "VERSION" was sent */
-  buffer[strlen(buffer) - 1] = '\0';
   if (strncmp(buffer, "VERSION: ", 9) != 0)
   {
     if (strncmp(buffer, "@@@1", 4) == 0)
     {
-      THREAD_FATAL(job_log(agent->owner), "agent crashed before sending version information");
+      AGENT_CONCURRENT_PRINT("agent crashed before sending version information\n");
     }
     else
     {
@@ -321,17 +352,12 @@ static void agent_listen(scheduler_t* scheduler, agent_t* agent)
       con_printf(main_log, "ERROR %s.%d: agent %s.%s has been invalidated, removing from agents\n", __FILE__, __LINE__,
           agent->host->name, agent->type->name);
       AGENT_CONCURRENT_PRINT("agent didn't send version information: \"%s\"\n", buffer);
-      return;
     }
+    return 0;
   }
 
   /* check that the VERSION information is correct */
-#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
-  g_mutex_lock(&version_lock);
-#else
-  g_static_mutex_lock(&version_lock);
-#endif
-  strcpy(buffer, &buffer[9]);
+  buffer += 9;
   if (agent->type->version == NULL && agent->type->valid)
   {
     agent->type->version_source = agent->host->name;
@@ -348,203 +374,340 @@ static void agent_listen(scheduler_t* scheduler, agent_t* agent)
         agent->type->version_source, agent->type->version, agent->host->name, buffer);
     agent->type->valid = 0;
     agent_kill(agent);
-#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
-    g_mutex_unlock(&version_lock);
-#else
-    g_static_mutex_unlock(&version_lock);
-#endif
-    return;
+    return 0;
   }
-#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
-  g_mutex_unlock(&version_lock);
-#else
-  g_static_mutex_unlock(&version_lock);
-#endif
 
-  /*!
-   * If we reach here the agent has correctly sent VERION information to the
-   * scheduler. The agent now enters a listening loop. The communication thread
-   * will wait for input from the agent, and act according to the agents current
-   * state and what was sent
+  agent->versioned = TRUE;
+  metrics_agent_startup(agent->type->name, g_get_monotonic_time() - agent->spawned);
+  return 1;
+}
+
+/**
+ * @brief Acts on a message sent by an agent once it has sent its version.
+ *
+ * The communication thread reads the messages of every agent, and acts
+ * according to the agents current state and what was sent.
+ *
+ * \note any command prepended by "@@@" is a message from the scheduler to the
+ *       communication thread, not from the agent.
+ *
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the agent that sent the message
+ * @param buffer     the message without its new line
+ * @return 1 if the agent should still be listened to, 0 otherwise
+ */
+static int agent_message(scheduler_t* scheduler, agent_t* agent, char* buffer)
+{
+  GMatchInfo* match; // regex match information
+  char* arg;         // used during regex retrievals
+  int relevant;      // used during special retrievals
+  uint64_t analyzed; // the items the agent has analyzed, from a HEART
+  gint64 now;        // time of a HEART
+
+  if (strlen(buffer) == 0)
+    return 1;
+
+  if (TVERB_AGENT && (TVERB_SPECIAL || strncmp(buffer, "SPECIAL", 7) != 0))
+    AGENT_CONCURRENT_PRINT("received: \"%s\"\n", buffer);
+
+  /*! - \b command: "BYE"
    *
-   * \note any command prepended by "@@@" is a message from the scheduler to the
-   *       communication thread, not from the agent.
+   *    The agent has finished processing all of the data from the relevant job.
+   *    This command is follow by a return code. 0 indicates that it completed
+   *    correctly, anything else can be used as an error code. Regardless of
+   *    whether the agent completed, the agent will not be listened to anymore.
    */
-  while (1)
+  if (strncmp(buffer, "BYE", 3) == 0)
   {
-    /* get message from agent */
-    if (fgets(buffer, sizeof(buffer), agent->read) == NULL)
-      g_thread_exit(NULL);
+    if ((agent->return_code = atoi(&(buffer[4]))) != 0)
+    {
+      AGENT_CONCURRENT_PRINT("agent failed with error code %d\n", agent->return_code);
+      event_signal(agent_fail_event, agent);
+    }
+    return 0;
+  }
 
-    buffer[strlen(buffer) - 1] = '\0';
+  /*! - \b command "@@@1"
+   *
+   *    The scheduler needs the communication thread to stop listening to the
+   *    agent. This will normally only happen if the agent crashes and the
+   *    scheduler receives a SIGCHLD for it before it sends "BYE #".
+   */
+  if (strncmp(buffer, "@@@1", 4) == 0)
+    return 0;
 
-    if (strlen(buffer) == 0)
-      continue;
+  /*! - \b command "@@@0"
+   *
+   *    The scheduler has updated the data that the agent should be processing.
+   *    This is sent after an agent sends the "OK" command, and the scheduler has
+   *    processed the resulting agent_ready_event().
+   */
+  if (strncmp(buffer, "@@@0", 4) == 0 && agent->updated)
+  {
+    aprintf(agent, "%s\n", agent->data);
+    aprintf(agent, "END\n");
+    fflush(agent->write);
+    agent->updated = 0;
+    return 1;
+  }
 
-    if (TVERB_AGENT && (TVERB_SPECIAL || strncmp(buffer, "SPECIAL", 7) != 0))
-      AGENT_CONCURRENT_PRINT("received: \"%s\"\n", buffer);
-
-    /*! - \b command: "BYE"
-     *
-     *    The agent has finished processing all of the data from the relevant job.
-     *    This command is follow by a return code. 0 indicates that it completed
-     *    correctly, anything else can be used as an error code. Regardless of
-     *    whether the agent completed, the communication thread will shutdown.
-     */
-    if (strncmp(buffer, "BYE", 3) == 0)
-    {
-      if ((agent->return_code = atoi(&(buffer[4]))) != 0)
-      {
-        AGENT_CONCURRENT_PRINT("agent failed with error code %d\n", agent->return_code);
-        event_signal(agent_fail_event, agent);
-      }
-      break;
-    }
+  /* agent just checked in */
+  agent->check_in = time(NULL);
 
-    /*! - \b command "@@@1"
-     *
-     *    The scheduler needs the communication thread to shutdown. This will
-     *    normally only happen if the agent crashes and the scheduler receives a
-     *    SIGCHLD for it before it sends "BYE #".
-     */
-    if (strncmp(buffer, "@@@1", 4) == 0)
-      break;
+  /*! - \b command: "OK"
+   *
+   *    The agent is ready for data. This is sent it 2 situations:
+   *        -# the agent has completed startup and is ready for the first part of
+   *           the data that needs to be analyzed for the job
+   *        -# the agent has finished the last piece of the job it was working on
+   *           and is ready for the next piece or to be shutdown
+   */
+  if (strncmp(buffer, "OK", 2) == 0)
+  {
+    if (agent->status != AG_PAUSED)
+      event_signal(agent_ready_event, agent);
+  }
 
-    /*! - \b command "@@@0"
-     *
-     *    The scheduler has updated the data that the agent should be processing.
-     *    This is sent after an agent sends the "OK" command, and the scheduler has
-     *    processed the resulting agent_ready_event().
-     */
-    if (strncmp(buffer, "@@@0", 4) == 0 && agent->updated)
+  /*! - \b command: "HEART"
+   *
+   *    Given the size of jobs that can be processed by FOSSology, agents can
+   *    take an extremely long period of time to finish. To make sure that an
+   *    agent is still working it must periodically update the scheduler with
+   *    how much of the job it has processed. The time between two HEART
+   *    messages and the items processed in between are kept in the metrics.
+   */
+  else if (strncmp(buffer, "HEART", 5) == 0)
+  {
+    g_regex_match(scheduler->parse_agent_msg, buffer, 0, &match);
+
+    arg = g_match_info_fetch(match, 3);
+    analyzed = atoi(arg);
+    g_free(arg);
+
+    now = g_get_monotonic_time();
+    metrics_agent_heart(agent->type->name, now - agent->heart,
+        analyzed > agent->total_analyzed ? analyzed - agent->total_analyzed : 0);
+    agent->total_analyzed = analyzed;
+    agent->heart = now;
+
+    arg = g_match_info_fetch(match, 6);
+    agent->alive = (arg[0] == '1' || agent->alive);
+    g_free(arg);
+
+    g_match_info_free(match);
+    match = NULL;
+
+    database_job_processed(agent->owner->id, agent->total_analyzed);
+  }
+
+  /*! - \b command: "EMAIL"
+   *
+   *    Agents have the ability to set the message that will be sent with the
+   *    notification email. This grabs the message and sets inside the job that
+   *    the agent is running under.
+   */
+  else if (strncmp(buffer, "EMAIL", 5) == 0)
+  {
+    agent->owner->message = g_strdup(buffer + 6);
+  }
+
+  /*! - \b command: "SPECIAL"
+   *
+   *    Agents can set special attributes that change how it is treated during
+   *    execution. This grabs the command and whether it is being set to true
+   *    or false. Agents use this by calling fo_scheduler_set_special() in the
+   *    agent api.
+   */
+  else if (strncmp(buffer, "SPECIAL", 7) == 0)
+  {
+    relevant = INT_MAX;
+
+    g_regex_match(scheduler->parse_agent_msg, buffer, 0, &match);
+
+    arg = g_match_info_fetch(match, 3);
+    relevant &= atoi(arg);
+    g_free(arg);
+
+    arg = g_match_info_fetch(match, 6);
+    if (atoi(arg))
     {
-      aprintf(agent, "%s\n", agent->data);
-      aprintf(agent, "END\n");
-      fflush(agent->write);
-      agent->updated = 0;
-      continue;
+      if (agent->special & relevant)
+        relevant = 0;
     }
-
-    /* agent just checked in */
-    agent->check_in = time(NULL);
-
-    /*! - \b command: "OK"
-     *
-     *    The agent is ready for data. This is sent it 2 situations:
-     *        -# the agent has completed startup and is ready for the first part of
-     *           the data that needs to be analyzed for the job
-     *        -# the agent has finished the last piece of the job it was working on
-     *           and is ready for the next piece or to be shutdown
-     */
-    if (strncmp(buffer, "OK", 2) == 0)
+    else
     {
-      if (agent->status != AG_PAUSED)
-        event_signal(agent_ready_event, agent);
+      if (!(agent->special & relevant))
+        relevant = 0;
     }
+    g_free(arg);
 
-    /*! - \b command: "HEART"
-     *
-     *    Given the size of jobs that can be processed by FOSSology, agents can
-     *    take an extremely long period of time to finish. To make sure that an
-     *    agent is still working it must periodically update the scheduler with
-     *    how much of the job it has processed.
-     */
-    else if (strncmp(buffer, "HEART", 5) == 0)
-    {
-      g_regex_match(scheduler->parse_agent_msg, buffer, 0, &match);
+    g_match_info_free(match);
 
-      arg = g_match_info_fetch(match, 3);
-      agent->total_analyzed = atoi(arg);
-      g_free(arg);
+    agent->special ^= relevant;
+  }
 
-      arg = g_match_info_fetch(match, 6);
-      agent->alive = (arg[0] == '1' || agent->alive);
-      g_free(arg);
+  /*! - \b command: GETSPECIAL
+   *
+   *    The agent has requested the value of a special attribute. The scheduler
+   *    will respond with the value of the special attribute.
+   */
+  else if (strncmp(buffer, "GETSPECIAL", 10) == 0)
+  {
+    g_regex_match(scheduler->parse_agent_msg, buffer, 0, &match);
 
-      g_match_info_free(match);
-      match = NULL;
+    arg = g_match_info_fetch(match, 3);
+    relevant = atoi(arg);
+    g_free(arg);
 
-      database_job_processed(agent->owner->id, agent->total_analyzed);
-    }
+    if (agent->special & relevant)
+      aprintf(agent, "VALUE: 1\n");
+    else
+      aprintf(agent, "VALUE: 0\n");
 
-    /*! - \b command: "EMAIL"
-     *
-     *    Agents have the ability to set the message that will be sent with the
-     *    notification email. This grabs the message and sets inside the job that
-     *    the agent is running under.
-     */
-    else if (strncmp(buffer, "EMAIL", 5) == 0)
-    {
-      agent->owner->message = g_strdup(buffer + 6);
-    }
+    g_match_info_free(match);
+  }
 
-    /*! - \b command: "SPECIAL"
-     *
-     *    Agents can set special attributes that change how it is treated during
-     *    execution. This grabs the command and whether it is being set to true
-     *    or false. Agents use this by calling fo_scheduler_set_special() in the
-     *    agent api.
-     */
-    else if (strncmp(buffer, "SPECIAL", 7) == 0)
-    {
-      relevant = INT_MAX;
+  /*! - \b command: unknown
+   *
+   *    The agent didn't use a legal command. This will simply put what the agent
+   *    printed into the log and move on.
+   */
+  else if (!(TVERB_AGENT))
+    AGENT_CONCURRENT_PRINT("\"%s\"\n", buffer);
 
-      g_regex_match(scheduler->parse_agent_msg, buffer, 0, &match);
+  return 1;
+}
 
-      arg = g_match_info_fetch(match, 3);
-      relevant &= atoi(arg);
-      g_free(arg);
+/**
+ * @brief Tests if the communication thread is listening to an agent.
+ *
+ * @note The io lock must be held.
+ *
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the agent to test
+ * @return true if the messages of the agent are read
+ */
+static gboolean agent_io_listening(scheduler_t* scheduler, agent_t* agent)
+{
+  return scheduler->io_agents != NULL &&
+      g_hash_table_lookup(scheduler->io_agents, GINT_TO_POINTER(agent->from_child)) == agent;
+}
 
-      arg = g_match_info_fetch(match, 6);
-      if (atoi(arg))
-      {
-        if (agent->special & relevant)
-          relevant = 0;
-      }
-      else
-      {
-        if (!(agent->special & relevant))
-          relevant = 0;
-      }
-      g_free(arg);
+/**
+ * @brief Stops listening to an agent, the messages it still sends are ignored.
+ *
+ * @note The io lock must be held.
+ *
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the agent to stop listening to
+ */
+static void agent_io_forget(scheduler_t* scheduler, agent_t* agent)
+{
+  epoll_ctl(scheduler->io_epoll, EPOLL_CTL_DEL, agent->from_child, NULL);
+  g_hash_table_remove(scheduler->io_agents, GINT_TO_POINTER(agent->from_child));
 
-      g_match_info_free(match);
+  if (TVERB_AGENT)
+    AGENT_CONCURRENT_PRINT("communication closing\n");
+}
 
-      agent->special ^= relevant;
-    }
+/**
+ * @brief Reads what an agent sent and acts on every complete message.
+ *
+ * The pipe of the agent is non-blocking, so this only reads what is already
+ * available. The part of a message that hasn't been received yet is kept in
+ * the buffer of the agent. A message that doesn't fit in the buffer is cut in
+ * several messages.
+ *
+ * @note The io lock must be held.
+ *
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the agent to read from
+ * @return FALSE if nothing could be read, TRUE otherwise
+ */
+static gboolean agent_io_read(scheduler_t* scheduler, agent_t* agent)
+{
+  ssize_t len;
+  char* end;
+  uint32_t start = 0;
+  int listening = 1;
+
+  len = read(agent->from_child, agent->msg + agent->msg_len, MAX_MSG - agent->msg_len);
+  if (len < 0 && (errno == EAGAIN || errno == EINTR))
+    return FALSE;
+  if (len <= 0)
+  {
+    AGENT_CONCURRENT_PRINT("pipe from child closed: %s\n", strerror(errno));
+    agent_io_forget(scheduler, agent);
+    return FALSE;
+  }
 
-    /*! - \b command: GETSPECIAL
-     *
-     *    The agent has requested the value of a special attribute. The scheduler
-     *    will respond with the value of the special attribute.
-     */
-    else if (strncmp(buffer, "GETSPECIAL", 10) == 0)
+  agent->msg_len += len;
+  while (listening && start < agent->msg_len)
+  {
+    if ((end = memchr(agent->msg + start, '\n', agent->msg_len - start)) == NULL)
     {
-      g_regex_match(scheduler->parse_agent_msg, buffer, 0, &match);
+      if (start != 0 || agent->msg_len < MAX_MSG)
+        break;
+      end = agent->msg + agent->msg_len;
+    }
 
-      arg = g_match_info_fetch(match, 3);
-      relevant = atoi(arg);
-      g_free(arg);
+    *end = '\0';
+    if (agent->versioned)
+      listening = agent_message(scheduler, agent, agent->msg + start);
+    else
+      listening = agent_version(scheduler, agent, agent->msg + start);
+    start = end - agent->msg + 1;
+  }
 
-      if (agent->special & relevant)
-        aprintf(agent, "VALUE: 1\n");
-      else
-        aprintf(agent, "VALUE: 0\n");
+  if (!listening)
+  {
+    agent->msg_len = 0;
+    agent_io_forget(scheduler, agent);
+  }
+  else if (start >= agent->msg_len)
+  {
+    agent->msg_len = 0;
+  }
+  else if (start != 0)
+  {
+    agent->msg_len -= start;
+    memmove(agent->msg, agent->msg + start, agent->msg_len);
+  }
 
-      g_match_info_free(match);
-    }
+  return TRUE;
+}
 
-    /*! - \b command: unknown
-     *
-     *    The agent didn't use a legal command. This will simply put what the agent
-     *    printed into the log and move on.
-     */
-    else if (!(TVERB_AGENT))
-      AGENT_CONCURRENT_PRINT("\"%s\"\n", buffer);
+/**
+ * Main function used for agent communication. This is where the communication
+ * thread will spend the majority of its time. A single thread waits for the
+ * messages of all of the agents, and reads from every agent that sent
+ * something.
+ *
+ * @param scheduler  the scheduler holding the agents to listen to
+ * @return always NULL
+ */
+static void* agent_io_thread(scheduler_t* scheduler)
+{
+  struct epoll_event events[AGENT_IO_EVENTS];
+  agent_t* agent;
+  int n, i;
+
+  while (!scheduler->io_terminate)
+  {
+    if ((n = epoll_wait(scheduler->io_epoll, events, AGENT_IO_EVENTS, AGENT_IO_TIMEOUT)) <= 0)
+      continue;
+
+    io_lock();
+    for (i = 0; i < n; i++)
+    {
+      agent = g_hash_table_lookup(scheduler->io_agents, GINT_TO_POINTER(events[i].data.fd));
+      if (agent != NULL)
+        agent_io_read(scheduler, agent);
+    }
+    io_unlock();
   }
 
-  if (TVERB_AGENT)
-    AGENT_CONCURRENT_PRINT("communication thread closing\n");
+  return NULL;
 }
 
 /**
@@ -609,15 +772,6 @@ static void shell_parse(char* confdir, int user_id, int group_id, char* input, c
   (*argc) = idx;
 }
 
-/**
- * For the agent_spawn() function.
- */
-typedef struct
-{
-  scheduler_t* scheduler; ///< Reference to current scheduler state
-  agent_t* agent;         ///< Reference to current agent state
-} agent_spawn_args;
-
 /**
  * @brief Spawns a new agent using the command passed in using the meta agent.
  *
@@ -631,17 +785,15 @@ typedef struct
  *   agent. It will then call exec to start the new agent process
  *
  * @b parent:
- *   This will enter the listen function, and wait for information from the
- *   child, either as a failure or as an update for the information being
- *   analyzed
+ *   The communication thread starts listening to the child, for information
+ *   either as a failure or as an update for the information being analyzed
  *
- * @param pass  a pointer to scheduler_t and the new agent_t
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the new agent
  */
-static void* agent_spawn(agent_spawn_args* pass)
+static void agent_spawn(scheduler_t* scheduler, agent_t* agent)
 {
   /* locals */
-  scheduler_t* scheduler = pass->scheduler;
-  agent_t* agent = pass->agent;
   gchar* tmp;                 // pointer to temporary string
   gchar** args;               // the arguments that will be passed to the child
   int argc;                   // the number of arguments parsed
@@ -649,6 +801,8 @@ static void* agent_spawn(agent_spawn_args* pass)
   char buffer[2048];          // character buffer
 
   /* spawn the new process */
+  agent->spawned = g_get_monotonic_time();
+  agent->heart = agent->spawned;
   while ((agent->pid = fork()) < 0)
     sleep(rand() % CONF_fork_backoff_time);
 
@@ -721,15 +875,14 @@ static void* agent_spawn(agent_spawn_args* pass)
     /* If we reach here, the exec call has failed */
     log_printf("ERROR %s.%d: JOB[%d.%s]: exec failed: pid = %d, errno = \"%s\"", __FILE__, __LINE__, agent->owner->id,
         agent->owner->agent_type, getpid(), strerror(errno));
+    exit(5);
   }
   /* we are in the parent */
   else
   {
     event_signal(agent_create_event, agent);
-    agent_listen(scheduler, agent);
+    agent_io_add(scheduler, agent);
   }
-
-  return NULL;
 }
 
 /* ************************************************************************** */
@@ -795,6 +948,7 @@ meta_agent_t* meta_agent_init(char* name, char* cmd, int max, int spc)
 void meta_agent_destroy(meta_agent_t* ma)
 {
   TEST_NULV(ma);
+  agent_pool_clear(ma->name, ma, NULL);
   g_free(ma->version);
   g_free(ma);
 }
@@ -816,7 +970,6 @@ agent_t* agent_init(scheduler_t* scheduler, host_t* host, job_t* job)
   agent_t* agent;
   int child_to_parent[2];
   int parent_to_child[2];
-  agent_spawn_args* pass;
 
   /* check job input */
   if (!job)
@@ -856,6 +1009,13 @@ agent_t* agent_init(scheduler_t* scheduler, host_t* host, job_t* job)
     return NULL;
   }
 
+  /* start the communication thread with the first agent */
+  if (scheduler->io_thread == NULL && !agent_io_init(scheduler))
+  {
+    g_free(agent);
+    return NULL;
+  }
+
   /* create the pipes between the child and the parent */
   if (pipe(parent_to_child) != 0)
   {
@@ -885,14 +1045,11 @@ agent_t* agent_init(scheduler_t* scheduler, host_t* host, job_t* job)
   agent->return_code = -1;
   agent->total_analyzed = 0;
   agent->special = 0;
+  agent->pooled = 0;
+  agent->msg_len = 0;
+  agent->versioned = FALSE;
 
   /* open the relevant file pointers */
-  if ((agent->read = fdopen(agent->from_child, "r")) == NULL)
-  {
-    ERROR("JOB[%d.%s] failed to initialize read file", job->id, job->agent_type);
-    g_free(agent);
-    return NULL;
-  }
   if ((agent->write = fdopen(agent->to_child, "w")) == NULL)
   {
     ERROR("JOB[%d.%s] failed to initialize write file", job->id, job->agent_type);
@@ -907,17 +1064,7 @@ agent_t* agent_init(scheduler_t* scheduler, host_t* host, job_t* job)
     meta_agent_increase_count(agent->type);
   }
 
-  /* spawn the listen thread */
-  pass = g_new0(agent_spawn_args, 1);
-  pass->scheduler = scheduler;
-  pass->agent = agent;
-
-#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
-  agent->thread = g_thread_new(agent->type->name, (GThreadFunc) agent_spawn, pass);
-#else
-  agent->thread = g_thread_create((GThreadFunc)agent_spawn, pass, 1, NULL);
-#endif
-
+  agent_spawn(scheduler, agent);
   return agent;
 }
 
@@ -942,12 +1089,121 @@ void agent_destroy(agent_t* agent)
   close(agent->from_parent);
   close(agent->to_parent);
   fclose(agent->write);
-  fclose(agent->read);
 
   /* release the child process */
   g_free(agent);
 }
 
+/* ************************************************************************** */
+/* **** Communication thread ************************************************ */
+/* ************************************************************************** */
+
+/**
+ * @brief Starts the communication thread.
+ *
+ * @param scheduler  the scheduler that will hold the agents
+ * @return TRUE if the communication thread is running
+ */
+gboolean agent_io_init(scheduler_t* scheduler)
+{
+  if ((scheduler->io_epoll = epoll_create1(EPOLL_CLOEXEC)) < 0)
+  {
+    ERROR("unable to create the agent communication: %s", strerror(errno));
+    return FALSE;
+  }
+
+  scheduler->io_agents = g_hash_table_new(g_direct_hash, g_direct_equal);
+  scheduler->io_terminate = FALSE;
+
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+  scheduler->io_thread = g_thread_new("agents", (GThreadFunc) agent_io_thread, scheduler);
+#else
+  scheduler->io_thread = g_thread_create((GThreadFunc) agent_io_thread, scheduler, TRUE, NULL);
+#endif
+
+  return TRUE;
+}
+
+/**
+ * @brief Starts listening to the messages of a new agent.
+ *
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the agent to listen to
+ */
+void agent_io_add(scheduler_t* scheduler, agent_t* agent)
+{
+  struct epoll_event event;
+
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN;
+  event.data.fd = agent->from_child;
+
+  fcntl(agent->from_child, F_SETFL, fcntl(agent->from_child, F_GETFL) | O_NONBLOCK);
+
+  io_lock();
+  g_hash_table_insert(scheduler->io_agents, GINT_TO_POINTER(agent->from_child), agent);
+  if (epoll_ctl(scheduler->io_epoll, EPOLL_CTL_ADD, agent->from_child, &event) != 0)
+  {
+    AGENT_ERROR("unable to listen to the agent: %s", strerror(errno));
+    g_hash_table_remove(scheduler->io_agents, GINT_TO_POINTER(agent->from_child));
+  }
+  io_unlock();
+}
+
+/**
+ * @brief Stops listening to an agent once every message it sent was handled.
+ *
+ * The agent is sent "@@@1" through its own pipe, so the messages before it are
+ * still handled, in particular the "BYE" of an agent that closed normally.
+ * When this returns, the communication thread doesn't use the agent anymore.
+ *
+ * @param scheduler  the scheduler the agent belongs to
+ * @param agent      the agent to stop listening to
+ */
+void agent_io_remove(scheduler_t* scheduler, agent_t* agent)
+{
+  io_lock();
+  if (agent_io_listening(scheduler, agent))
+  {
+    if (write(agent->to_parent, "@@@1\n", 5) != 5)
+    {
+      AGENT_SEQUENTIAL_PRINT("write to agent unsuccessful: %s\n", strerror(errno));
+      agent_io_forget(scheduler, agent);
+    }
+
+    while (agent_io_listening(scheduler, agent))
+      if (!agent_io_read(scheduler, agent))
+        agent_io_forget(scheduler, agent);
+  }
+  io_unlock();
+}
+
+/**
+ * @brief Stops the communication thread.
+ *
+ * @note If agent_io_destroy() is called before any agent was created, it will
+ *       be a no-op.
+ *
+ * @param scheduler  the scheduler holding the communication thread
+ */
+void agent_io_destroy(scheduler_t* scheduler)
+{
+  if (scheduler->io_thread)
+  {
+    scheduler->io_terminate = TRUE;
+    g_thread_join(scheduler->io_thread);
+    scheduler->io_thread = NULL;
+  }
+
+  if (scheduler->io_epoll >= 0)
+    close(scheduler->io_epoll);
+  if (scheduler->io_agents)
+    g_hash_table_destroy(scheduler->io_agents);
+
+  scheduler->io_epoll = -1;
+  scheduler->io_agents = NULL;
+}
+
 /* ************************************************************************** */
 /* **** Events ************************************************************** */
 /* ************************************************************************** */
@@ -974,11 +1230,16 @@ void agent_death_event(scheduler_t* scheduler, pid_t* pid)
   if (agent->owner->id >= 0)
     event_signal(database_update_event, NULL);
 
-  if (write(agent->to_parent, "@@@1\n", 5) != 5)
-    AGENT_SEQUENTIAL_PRINT("write to agent unsuccessful: %s\n", strerror(errno));
-  g_thread_join(agent->thread);
+  agent_io_remove(scheduler, agent);
 
-  if (agent->return_code != 0)
+  /* an agent in the pool has no job left to fail */
+  if (agent->pooled)
+  {
+    AGENT_SEQUENTIAL_PRINT("agent closed while waiting for a new job\n");
+    agent->type->pool = g_list_remove(agent->type->pool, agent);
+    agent->pooled = 0;
+  }
+  else if (agent->return_code != 0)
   {
     if (WIFEXITED(status))
     {
@@ -1385,3 +1646,99 @@ void meta_agent_decrease_count(meta_agent_t* ma)
   ma->run_count--;
   V_AGENT("AGENT[%s] run decreased to %d\n", ma->name, ma->run_count);
 }
+
+/**
+ * @brief Keeps a finished agent to run the next job of its type.
+ *
+ * Instead of closing an agent when its job is complete, the agent is kept in
+ * the pool of its meta agent. This is only done for the meta agents that are
+ * REUSABLE, when CONF_agent_pool_size is set and the pool isn't full. The
+ * agent stays in the finished agents of its job until agent_pool_take() gives
+ * it a new job.
+ *
+ * @param agent  the agent that finished its job
+ * @return 1 if the agent was kept, 0 if it should be closed
+ */
+int agent_pool_add(agent_t* agent)
+{
+  meta_agent_t* ma = agent->type;
+
+  if (closing || agent->owner->id <= 0 || agent->owner->jq_cmd_args != NULL || !ma->valid
+      || !is_meta_special(ma, SAG_REUSABLE) || g_list_length(ma->pool) >= CONF_agent_pool_size)
+    return 0;
+
+  AGENT_SEQUENTIAL_PRINT("agent waiting for a new job\n");
+  agent->pooled = time(NULL);
+  ma->pool = g_list_append(ma->pool, agent);
+  return 1;
+}
+
+/**
+ * @brief Starts a job with an agent from the pool instead of spawning one.
+ *
+ * The agent leaves its last job, possibly removing it from the system, and
+ * receives "RESET" with the job id, user id and group id of the new job. The
+ * agent answers with "OK", after which it is treated like a freshly spawned
+ * agent of the new job.
+ *
+ * @param scheduler  the scheduler holding the jobs and meta agents
+ * @param host       the host the job must run on
+ * @param job        the job to start
+ * @return the agent now running the job, NULL if none was waiting on the host
+ */
+agent_t* agent_pool_take(scheduler_t* scheduler, host_t* host, job_t* job)
+{
+  meta_agent_t* ma = g_tree_lookup(scheduler->meta_agents, job->agent_type);
+  agent_t* agent = NULL;
+  GList* iter;
+
+  if (ma == NULL || !ma->valid || job->jq_cmd_args != NULL)
+    return NULL;
+
+  for (iter = ma->pool; iter != NULL; iter = iter->next)
+  {
+    if (((agent_t*) iter->data)->host == host)
+    {
+      agent = iter->data;
+      break;
+    }
+  }
+
+  if (agent == NULL)
+    return NULL;
+
+  ma->pool = g_list_delete_link(ma->pool, iter);
+  agent->pooled = 0;
+  job_remove_agent(agent->owner, scheduler->job_list, agent);
+
+  agent->owner = job;
+  agent->updated = 0;
+  agent->data = NULL;
+  agent->n_updates = 0;
+  agent->total_analyzed = 0;
+  agent->check_in = time(NULL);
+  agent->heart = g_get_monotonic_time();
+
+  job_add_agent(job, agent);
+  agent_transition(agent, AG_SPAWNED);
+
+  /* a spawned agent would have been niced to the priority of the job */
+  if (strcmp(agent->host->address, LOCAL_HOST) == 0
+      && setpriority(PRIO_PROCESS, agent->pid, job->priority) != 0)
+    AGENT_SEQUENTIAL_PRINT("unable to set the priority of the agent: %s\n", strerror(errno));
+
+  AGENT_SEQUENTIAL_PRINT("agent reused from the pool\n");
+  aprintf(agent, "VERBOSE %d\n", job->verbose);
+  aprintf(agent, "RESET %d %d %d\n", job->parent_id, job->user_id, job->group_id);
+  return agent;
+}
+
+/**
+ * @brief Closes every agent waiting in the pools of the meta agents.
+ *
+ * @param scheduler  the scheduler holding the meta agents
+ */
+void agent_pool_close(scheduler_t* scheduler)
+{
+  g_tree_foreach(scheduler->meta_agents, (GTraverseFunc) agent_pool_clear, NULL);
+}
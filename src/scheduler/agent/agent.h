@@ -37,14 +37,19 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #define MAX_CMD     1023 ///< the size of the agent's command buffer (arbitrary)
 #define MAX_NAME    255  ///< the size of the agent's name buffer    (arbitrary)
 #define MAX_ARGS    32   ///< the size of the argument buffer        (arbitrary)
+#define MAX_MSG     1023 ///< the size of the agent's message buffer (arbitrary)
 #define DEFAULT_RET -1   ///< default return code                    (arbitrary)
 
 #define LOCAL_HOST "localhost"
 
+#define AGENT_IO_EVENTS  64   ///< the number of agents read at once by the communication thread
+#define AGENT_IO_TIMEOUT 1000 ///< the ms the communication thread waits before checking if it must stop
+
 #define SAG_NOKILL     (1 << 0) ///< This agent should not be killed when updating the agent
 #define SAG_EXCLUSIVE  (1 << 1) ///< This agent must not run at the same time as any other agent
 #define SAG_NOEMAIL    (1 << 2) ///< This agent should not send notification emails
 #define SAG_LOCAL      (1 << 3) ///< This agent should only run on localhost
+#define SAG_REUSABLE   (1 << 4) ///< This agent can run the next job of its type
 
 /**
  * \file
@@ -99,6 +104,7 @@ typedef struct
     char* version;              ///< the version of the agent that is running on all hosts
     int valid;                  ///< flag indicating if the meta_agent is valid
     int run_count;              ///< the count of agents in running state
+    GList* pool;                ///< the finished agents waiting for a new job
 } meta_agent_t;
 
 /**
@@ -115,19 +121,25 @@ typedef struct
 
     /* thread management */
     agent_status status;    ///< the state of execution the agent is currently in
-    GThread*     thread;    ///< the thread that communicates with this agent
     time_t       check_in;  ///< the time that the agent last generated anything
     uint8_t      n_updates; ///< keeps track of the number of times the agent has updated
     pid_t        pid;       ///< the pid of the process this agent is running in
+    time_t       pooled;    ///< the time the agent entered the pool, 0 if not in it
 
     /* pipes connecting to the child */
     int from_parent;  ///< file identifier to read from the parent (child stdin)
     int to_child;     ///< file identifier to print to the child
     int from_child;   ///< file identifier to read from child
     int to_parent;    ///< file identifier to print to the parent  (child stdout)
-    FILE* read;       ///< FILE* that abstracts the use of the from_child socket
     FILE* write;      ///< FILE* that abstracts the use of the to_child socket
 
+    /* messages received from the child */
+    char     msg[MAX_MSG + 1]; ///< the messages read from the child that weren't handled yet
+    uint32_t msg_len;          ///< the length of the messages in msg
+    gboolean versioned;        ///< has the child sent its version information
+    gint64   spawned;          ///< monotonic time the child was forked
+    gint64   heart;            ///< monotonic time of the last HEART, or of the start of the job
+
     /* data management */
     job_t*   owner;           ///< the job that this agent is assigned to
     gchar*   data;            ///< the data that has been sent to the agent for analysis
@@ -150,10 +162,17 @@ void meta_agent_destroy(meta_agent_t* meta_agent);
 agent_t* agent_init(scheduler_t* scheduler, host_t* host, job_t* owner);
 void agent_destroy(agent_t* agent);
 
+/* communication thread */
+gboolean agent_io_init(scheduler_t* scheduler);
+void agent_io_destroy(scheduler_t* scheduler);
+
 /* ************************************************************************** */
 /* **** Modifier Functions and events *************************************** */
 /* ************************************************************************** */
 
+void agent_io_add(scheduler_t* scheduler, agent_t* agent);
+void agent_io_remove(scheduler_t* scheduler, agent_t* agent);
+
 void agent_death_event(scheduler_t* scheduler, pid_t* pids);
 void agent_create_event(scheduler_t* scheduler, agent_t* agent);
 void agent_ready_event(scheduler_t* scheduler, agent_t* agent);
@@ -178,6 +197,10 @@ int  add_meta_agent(GTree* meta_agents, char* name, char* cmd, int max, int spc)
 
 void kill_agents(scheduler_t* scheduler);
 
+int      agent_pool_add(agent_t* agent);
+agent_t* agent_pool_take(scheduler_t* scheduler, host_t* host, job_t* job);
+void     agent_pool_close(scheduler_t* scheduler);
+
 int  is_meta_special(meta_agent_t* ma, int special_type);
 int  is_agent_special(agent_t* agent, int special_type);
 
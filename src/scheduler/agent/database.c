@@ -28,6 +28,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 /* other library includes */
 #include <libfossdb.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 
@@ -773,6 +774,159 @@ static PGconn* database_connect(gchar* configdir)
   return ret;
 }
 
+/**
+ * @brief Creates the trigger notifying the scheduler of new jobs and listens to
+ *        its notifications.
+ *
+ * @param conn  the connection that will receive the notifications
+ * @return TRUE if the connection is listening, FALSE otherwise
+ */
+static gboolean database_listen(PGconn* conn)
+{
+  PGresult* db_result;
+  gboolean ret = TRUE;
+
+  db_result = PQexec(conn, jobqueue_notify_function);
+  if(PQresultStatus(db_result) != PGRES_COMMAND_OK)
+  {
+    PQ_ERROR(db_result, "unable to create the job queue notification function");
+    return FALSE;
+  }
+  SafePQclear(db_result);
+
+  db_result = PQexec(conn, jobqueue_notify_check);
+  if(PQresultStatus(db_result) != PGRES_TUPLES_OK)
+  {
+    PQ_ERROR(db_result, "unable to check the job queue notification trigger");
+    return FALSE;
+  }
+  if(PQntuples(db_result) == 0)
+  {
+    SafePQclear(db_result);
+    db_result = PQexec(conn, jobqueue_notify_trigger);
+    if(PQresultStatus(db_result) != PGRES_COMMAND_OK)
+    {
+      PQ_ERROR(db_result, "unable to create the job queue notification trigger");
+      return FALSE;
+    }
+  }
+  SafePQclear(db_result);
+
+  db_result = PQexec(conn, jobqueue_listen);
+  if(PQresultStatus(db_result) != PGRES_COMMAND_OK)
+  {
+    PQ_ERROR(db_result, "unable to listen to the job queue notifications");
+    ret = FALSE;
+  }
+  SafePQclear(db_result);
+
+  return ret;
+}
+
+/**
+ * @brief Waits for the notifications of new jobs in the job queue.
+ *
+ * Every batch of notifications signals a single database_update_event(), the
+ * notifications received before the event is processed are merged into it.
+ * If the connection is lost, it is reset and the job queue is checked since
+ * the notifications sent in the mean time are lost. The periodic checks of
+ * the job queue are used until the connection is listening again.
+ *
+ * @param scheduler  the scheduler_t* that holds the notification connection
+ * @return NULL, always
+ */
+static void* database_listen_thread(scheduler_t* scheduler)
+{
+  PGconn* conn = scheduler->n_conn;
+  PGnotify* notify;
+  struct pollfd pfd;
+  int received;
+
+  while(!scheduler->n_terminate)
+  {
+    if(!g_atomic_int_get(&scheduler->n_listening))
+    {
+      PQreset(conn);
+      if(PQstatus(conn) != CONNECTION_OK || !database_listen(conn))
+      {
+        g_usleep(NOTIFY_TIMEOUT * 1000);
+        continue;
+      }
+
+      V_DATABASE("DB: listening to the job queue notifications again\n");
+      g_atomic_int_set(&scheduler->n_listening, 1);
+      if(g_atomic_int_compare_and_exchange(&scheduler->n_pending, 0, 1))
+        event_signal(database_update_event, NULL);
+    }
+
+    pfd.fd = PQsocket(conn);
+    pfd.events = POLLIN;
+    if(poll(&pfd, 1, NOTIFY_TIMEOUT) <= 0)
+      continue;
+
+    if(!PQconsumeInput(conn) || PQstatus(conn) != CONNECTION_OK)
+    {
+      WARNING("lost the job queue notification connection: %s",
+          PQerrorMessage(conn));
+      g_atomic_int_set(&scheduler->n_listening, 0);
+      continue;
+    }
+
+    for(received = 0; (notify = PQnotifies(conn)) != NULL; received++)
+      PQfreemem(notify);
+
+    if(received)
+    {
+      V_DATABASE("DB: received %d job queue notifications\n", received);
+      if(g_atomic_int_compare_and_exchange(&scheduler->n_pending, 0, 1))
+        event_signal(database_update_event, NULL);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Starts the thread waiting for the job queue notifications.
+ *
+ * A connection separated from the one of the scheduler is used, so that the
+ * notifications are received while the event loop is busy. If the connection
+ * can't be created, the job queue is polled as usual.
+ *
+ * @param scheduler  the scheduler_t* that holds the notification connection
+ */
+static void database_listen_init(scheduler_t* scheduler)
+{
+  gchar* dbconf = NULL;
+  char* error = NULL;
+
+  dbconf = g_strdup_printf("%s/Db.conf", scheduler->sysconfigdir);
+  scheduler->n_conn = fo_dbconnect(dbconf, &error);
+  g_free(dbconf);
+
+  if(error || PQstatus(scheduler->n_conn) != CONNECTION_OK
+      || !database_listen(scheduler->n_conn))
+  {
+    WARNING("Unable to listen to the job queue notifications, polling it: \"%s\"",
+        error ? error : PQerrorMessage(scheduler->n_conn));
+    free(error);
+    database_listen_destroy(scheduler);
+    return;
+  }
+
+  scheduler->n_terminate = 0;
+  g_atomic_int_set(&scheduler->n_pending, 0);
+  g_atomic_int_set(&scheduler->n_listening, 1);
+
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+  scheduler->n_thread = g_thread_new("notify",
+      (GThreadFunc)database_listen_thread, scheduler);
+#else
+  scheduler->n_thread = g_thread_create((GThreadFunc)database_listen_thread,
+      scheduler, TRUE, NULL);
+#endif
+}
+
 /**
  * Initializes any one-time attributes relating to the database. Currently this
  * includes creating the db connection and checking the URL of the FOSSology
@@ -793,6 +947,35 @@ void database_init(scheduler_t* scheduler)
 
   /* check that relevant database fields exist */
   check_tables(scheduler);
+
+  if(CONF_job_notify)
+    database_listen_init(scheduler);
+}
+
+/**
+ * @brief Stops the thread waiting for the job queue notifications.
+ *
+ * @note If database_listen_destroy() is called while the notifications are
+ *       not used, it will be a no-op.
+ *
+ * @param scheduler  the scheduler_t* that holds the notification connection
+ */
+void database_listen_destroy(scheduler_t* scheduler)
+{
+  if(scheduler->n_thread)
+  {
+    scheduler->n_terminate = 1;
+    g_thread_join(scheduler->n_thread);
+    scheduler->n_thread = NULL;
+  }
+
+  if(scheduler->n_conn)
+  {
+    PQfinish(scheduler->n_conn);
+    scheduler->n_conn = NULL;
+  }
+
+  g_atomic_int_set(&scheduler->n_listening, 0);
 }
 
 /* ************************************************************************** */
@@ -846,6 +1029,9 @@ void database_exec_event(scheduler_t* scheduler, char* sql)
 /**
  * @brief Checks the job queue for any new entries.
  *
+ * If the job queue has more ready jobs than can be checked out at once, it
+ * keeps being polled even if the notifications are received.
+ *
  * @param scheduler The scheduler_t* that holds the connection
  * @param unused
  */
@@ -853,12 +1039,13 @@ void database_update_event(scheduler_t* scheduler, void* unused)
 {
   /* locals */
   PGresult* db_result;
-  PGresult* pri_result;
   int i, j_id;
-  char sql[512];
-  char* value, * type, * host, * pfile, * parent, *jq_cmd_args;
+  char* value, * type, * host, * pfile, * parent, *jq_cmd_args, * user;
   job_t* job;
 
+  /* notifications received from now on need an other check */
+  g_atomic_int_set(&scheduler->n_pending, 0);
+
   if(closing)
   {
     WARNING("scheduler is closing, will not check the job queue");
@@ -889,6 +1076,7 @@ void database_update_event(scheduler_t* scheduler, void* unused)
     pfile  =      PQget(db_result, i, "jq_runonpfile");
     value  =      PQget(db_result, i, "jq_args");
     jq_cmd_args  =PQget(db_result, i, "jq_cmd_args");
+    user   =      PQget(db_result, i, "user_pk");
 
     if(host != NULL)
       host = (strlen(host) == 0) ? NULL : host;
@@ -907,32 +1095,40 @@ void database_update_event(scheduler_t* scheduler, void* unused)
       continue;
     }
 
-    sprintf(sql, jobsql_information, parent);
-    pri_result = database_exec(scheduler, sql);
-    if(PQresultStatus(pri_result) != PGRES_TUPLES_OK)
-    {
-      PQ_ERROR(pri_result, "database update failed on call to PQexec");
-      continue;
-    }
-    if(PQntuples(pri_result)==0)
+    if(PQgetisnull(db_result, i, PQfnumber(db_result, "user_pk")))
     {
       WARNING("can not find the user information of job_pk %s\n", parent);
-      SafePQclear(pri_result);
       continue;
     }
     job = job_init(scheduler->job_list, scheduler->job_queue, type, host, j_id,
         atoi(parent),
-        atoi(PQget(pri_result, 0, "user_pk")),
-        atoi(PQget(pri_result, 0, "group_pk")),
-        atoi(PQget(pri_result, 0, "job_priority")), jq_cmd_args);
+        atoi(user),
+        atoi(PQget(db_result, i, "group_pk")),
+        atoi(PQget(db_result, i, "job_priority")), jq_cmd_args);
     job_set_data(scheduler, job,  value, (pfile && pfile[0] != '\0'));
-
-    SafePQclear(pri_result);
   }
 
+  /* the jobs left in the job queue are not notified again */
+  scheduler->n_backlog = (PQntuples(db_result) == CHECKOUT_LIMIT);
+
   SafePQclear(db_result);
 }
 
+/**
+ * @brief Checks if the job queue notifications are received.
+ *
+ * While they are and the last check took every ready job, the job queue
+ * doesn't need to be polled.
+ *
+ * @param scheduler  the scheduler_t* that holds the notification connection
+ * @return TRUE if the job queue doesn't need to be polled, FALSE otherwise
+ */
+gboolean database_listening(scheduler_t* scheduler)
+{
+  return scheduler->n_thread != NULL && !scheduler->n_backlog
+      && g_atomic_int_get(&scheduler->n_listening);
+}
+
 /**
  * @brief Resets any jobs in the job queue that are not completed.
  *
@@ -29,6 +29,10 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #define PQget(db_result, row, col) \
   PQgetvalue(db_result, row, PQfnumber(db_result, col))
 
+#define CHECKOUT_LIMIT   10          ///< Max number of jobs taken from the job queue at once
+#define JOBQUEUE_CHANNEL "jobqueue"  ///< Channel notified of the new jobs
+#define NOTIFY_TIMEOUT   1000        ///< Time (ms) between checks of the notification thread
+
 extern const char* jobsql_failed;
 
 /* ************************************************************************** */
@@ -37,6 +41,7 @@ extern const char* jobsql_failed;
 
 void database_init(scheduler_t* scheduler);
 void email_init(scheduler_t* scheduler);
+void database_listen_destroy(scheduler_t* scheduler);
 
 /* ************************************************************************** */
 /* **** event and functions ************************************************* */
@@ -45,6 +50,7 @@ void email_init(scheduler_t* scheduler);
 PGresult* database_exec(scheduler_t* scheduler, const char* sql);
 void database_exec_event(scheduler_t* scheduler, char* sql);
 void database_update_event(scheduler_t* scheduler, void* unused);
+gboolean database_listening(scheduler_t* scheduler);
 
 void database_reset_queue(scheduler_t* scheduler);
 void database_update_job(scheduler_t* db_conn, job_t* j, job_status status);
@@ -22,6 +22,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 /* local includes */
 #include <event.h>
 #include <logging.h>
+#include <metrics.h>
 #include <scheduler.h>
 
 /* std libaray includes */
@@ -159,6 +160,7 @@ event_t* event_init(void(*func)(scheduler_t*, void*), void* arg, char* name, cha
   e->name = name;
   e->source_name = source_name;
   e->source_line = source_line;
+  e->queued = g_get_monotonic_time();
 
   return e;
 }
@@ -255,6 +257,8 @@ int event_loop_enter(scheduler_t* scheduler,
     if(e == NULL)
       continue;
 
+    metrics_event(e->queued);
+
     if(TVERB_EVENT && strcmp(e->name, "log_event") != 0)
       log_printf("EVENT: calling %s, source[%s.%d] \n", e->name, e->source_name, e->source_line);
     e->func(scheduler, e->argument);
@@ -38,6 +38,7 @@ typedef struct {
   char* name;                       ///< Name of the event, used for debugging
   char*    source_name;             ///< Name of the source file creating the event
   uint16_t source_line;             ///< Line in the source file creating the event
+  gint64   queued;                  ///< Monotonic time the event was created
 } event_t;
 
 /** internal structure for the event loop */
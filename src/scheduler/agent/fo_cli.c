@@ -113,19 +113,20 @@ int socket_connect(char* host, char* port)
 uint8_t receive(int s, char* buffer, size_t max, uint8_t end)
 {
   size_t bytes = 0;
+  size_t keep = 0;
   uint8_t closing = 0;
   char* poss;
 
   do
   {
-    /* start by clearing the buffer */
-    memset(buffer, '\0', max);
-    bytes = 0;
+    /* start by clearing the buffer, a line that wasn't complete is kept */
+    memset(buffer + keep, '\0', max - keep);
+    bytes = keep;
 
     /* read from the socket */
     do
     {
-      bytes = read(s, buffer + bytes, max - bytes);
+      bytes = read(s, buffer + bytes, max - bytes - 1);
 
       if(bytes == 0)
       {
@@ -134,7 +135,15 @@ uint8_t receive(int s, char* buffer, size_t max, uint8_t end)
       }
 
       bytes = strlen(buffer);
-    } while(!closing && buffer[bytes - 1] != '\n');
+    } while(!closing && buffer[bytes - 1] != '\n' && bytes < max - 1);
+
+    /* the buffer is full, keep the last line until the rest of it is read */
+    keep = 0;
+    if(!closing && buffer[bytes - 1] != '\n' && (poss = strrchr(buffer, '\n')) != NULL)
+    {
+      *poss = '\0';
+      keep = bytes - (poss - buffer + 1);
+    }
 
     /* interpret the results */
     for(poss = strtok(buffer, "\n"); !closing && poss != NULL;
@@ -160,7 +169,8 @@ uint8_t receive(int s, char* buffer, size_t max, uint8_t end)
     }
 
     fflush(stdout);
-  } while(end);
+    memmove(buffer, buffer + bytes - keep, keep);
+  } while(end || keep);
 
   return closing;
 }
@@ -190,6 +200,7 @@ void interface_usage()
   printf("|%*s:   query/change the scheduler/job verbosity      |\n", P_WIDTH, "verbose [jq_pk] [level]");
   printf("|%*s:   change priority for job that this jq_pk is in |\n", P_WIDTH, "priority <jq_pk> <level>");
   printf("|%*s:   causes the scheduler to check the job queue   |\n", P_WIDTH, "database");
+  printf("|%*s:   prints the scheduler counters and histograms  |\n", P_WIDTH, "metrics");
   printf("+-----------------------------------------------------------------------------+\n");
   fflush(stdout);
 }
@@ -222,6 +233,7 @@ int main(int argc, char** argv)
   uint8_t c_restart  = 0;
   uint8_t c_verbose  = 0;
   uint8_t c_database = 0;
+  uint8_t c_metrics  = 0;
 
   /* initialize memory */
   host = NULL;
@@ -261,6 +273,8 @@ int main(int argc, char** argv)
           "CLI will change the scheduler's verbose level", "integer"},
       {"database", 'd', 0, G_OPTION_ARG_NONE,   &c_database,
           "CLI will send a database command to scheduler", NULL},
+      {"metrics",  'm', 0, G_OPTION_ARG_NONE,   &c_metrics,
+          "CLI will send a metrics command and close", NULL},
       {NULL}
   };
 
@@ -304,7 +318,7 @@ int main(int argc, char** argv)
 
   /* check specific command instructions */
   if(c_die || c_stop || c_load || c_pause || c_reload || c_status || c_agents
-      || c_restart || c_verbose || c_database)
+      || c_restart || c_verbose || c_database || c_metrics)
   {
     response = 0;
 
@@ -356,6 +370,12 @@ int main(int argc, char** argv)
       receive(s, buffer, sizeof(buffer), TRUE);
     }
 
+    if(c_metrics)
+    {
+      bytes = write(s, "metrics", 7);
+      receive(s, buffer, sizeof(buffer), TRUE);
+    }
+
     return 0;
   }
 
@@ -389,6 +409,7 @@ int main(int argc, char** argv)
 
       response = (strncmp(buffer, "agents",  6) == 0 ||
                   strncmp(buffer, "status",  6) == 0 ||
+                  strcmp (buffer, "metrics\n" ) == 0 ||
                   strcmp (buffer, "verbose\n" ) == 0 ||
                   strcmp (buffer, "load\n"    ) == 0) ?
                       FALSE : TRUE;
@@ -146,33 +146,55 @@ void host_print(host_t* host, GOutputStream* ostr)
 }
 
 /**
- * Gets a host for which there are at least num agents available to start
- * new agents on.
+ * @brief Gets the least loaded host for which there are at least num agents
+ *        available to start new agents on.
+ *
+ * The load of a host is its number of running agents relative to its max. If
+ * several hosts have the same load, the first one in the queue is chosen, so
+ * that idle hosts are used in turn.
  *
  * @param queue GList of available hosts
  * @param num the number of agents to start on the host
  * @return the host with that number of available slots, NULL if none exist
  */
-host_t* get_host(GList** queue, uint8_t num)
+host_t* peek_host(GList* queue, uint8_t num)
 {
-  GList*  host_queue = *queue;
-  GList*  curr       = NULL;
-  host_t* ret        = NULL;
+  GList*  curr = NULL;
+  host_t* host = NULL;
+  host_t* ret  = NULL;
 
-  for(curr = host_queue; curr != NULL; curr = curr->next)
+  for(curr = queue; curr != NULL; curr = curr->next)
   {
-    ret = curr->data;
-    if(ret->max - ret->running >= num)
-      break;
+    host = curr->data;
+    if(host->max - host->running < num)
+      continue;
+
+    if(ret == NULL || (int64_t)host->running * ret->max < (int64_t)ret->running * host->max)
+      ret = host;
   }
 
-  if(curr == NULL)
+  return ret;
+}
+
+/**
+ * Gets the least loaded host for which there are at least num agents available
+ * to start new agents on, and moves it to the end of the queue.
+ *
+ * @param queue GList of available hosts
+ * @param num the number of agents to start on the host
+ * @return the host with that number of available slots, NULL if none exist
+ * @sa peek_host()
+ */
+host_t* get_host(GList** queue, uint8_t num)
+{
+  host_t* ret = peek_host(*queue, num);
+
+  if(ret == NULL)
     return NULL;
 
-  host_queue = g_list_remove(host_queue, ret);
-  host_queue = g_list_append(host_queue, ret);
+  *queue = g_list_remove(*queue, ret);
+  *queue = g_list_append(*queue, ret);
 
-  *queue = host_queue;
   return ret;
 }
 
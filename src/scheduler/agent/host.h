@@ -59,6 +59,7 @@ void host_increase_load(host_t* host);
 void host_decrease_load(host_t* host);
 void host_print(host_t* host, GOutputStream* ostr);
 
+host_t* peek_host(GList* queue, uint8_t num);
 host_t* get_host(GList** queue, uint8_t num);
 void    print_host_load(GTree* host_list, GOutputStream* ostr);
 
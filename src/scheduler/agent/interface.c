@@ -26,6 +26,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <interface.h>
 #include <job.h>
 #include <logging.h>
+#include <metrics.h>
 #include <scheduler.h>
 
 /* std library includes */
@@ -129,6 +130,7 @@ static void interface_conn_destroy(interface_connection* inter)
  * |  verbose | Change verbose level for scheduler or job |
  * | priority | Change the priority of job |
  * | database | Check the database job queue |
+ * |  metrics | Get the counters and latency histograms |
  *
  * @param  conn      Pointer to the interface_connection structure
  * @param  scheduler Pointer to the relevant scheduler structure
@@ -471,6 +473,18 @@ void interface_thread(interface_connection* conn, scheduler_t* scheduler)
       event_signal(database_update_event, NULL);
     }
 
+    /* command: "metrics"
+     *
+     * The interface has requested the counters and latency histograms of the
+     * scheduler, printed in the text format of Prometheus. These are printed
+     * directly by this thread so that they can be read even if the event loop
+     * is blocked.
+     */
+    else if(strcmp(cmd, "metrics") == 0)
+    {
+      metrics_print(conn->ostr);
+    }
+
     /* command: unknown
      *
      * The command sent does not match any of the known commands, log an error
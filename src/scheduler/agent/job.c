@@ -25,6 +25,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <agent.h>
 #include <database.h>
 #include <job.h>
+#include <metrics.h>
 #include <scheduler.h>
 
 /* std library includes */
@@ -75,6 +76,67 @@ static int is_active(int* job_id, job_t* job, int* counter)
   return 0;
 }
 
+/**
+ * @brief Adds to the number of running agents of a group.
+ *
+ * @param usage     The running agents of every group
+ * @param group_id  The group to add the agents to
+ * @param n         The number of agents to add
+ */
+static void group_usage_add(GTree* usage, int32_t group_id, gint n)
+{
+  gint* key = g_new(gint, 1);
+
+  *key = group_id;
+  g_tree_insert(usage, key,
+      GINT_TO_POINTER(GPOINTER_TO_INT(g_tree_lookup(usage, key)) + n));
+}
+
+/**
+ * @brief Counts an agent as running for the group of its job.
+ *
+ * This will be called from within a g_tree_foreach() on the running agents.
+ *
+ * @param pid    The pid of the agent, used as the key in the GTree
+ * @param agent  The agent that is counted
+ * @param usage  The running agents of every group
+ * @return always returns 0
+ */
+static int group_usage_count(int* pid, agent_t* agent, GTree* usage)
+{
+  if(agent->owner && agent->owner->id > 0
+      && (agent->status == AG_SPAWNED || agent->status == AG_RUNNING))
+    group_usage_add(usage, agent->owner->group_id, 1);
+  return 0;
+}
+
+/**
+ * @brief Tests if the group of a job uses less of its share of the agents
+ *        than the group of an other job.
+ *
+ * The share of a group is its number of running agents relative to its
+ * weight. Groups without a weight have a weight of 1.
+ *
+ * @param scheduler  The scheduler holding the weights of the groups
+ * @param usage      The running agents of every group
+ * @param a          The first job
+ * @param b          The second job
+ * @return TRUE if the group of a uses less of its share than the one of b
+ */
+static gboolean group_share_less(scheduler_t* scheduler, GTree* usage,
+    job_t* a, job_t* b)
+{
+  int64_t used_a   = GPOINTER_TO_INT(g_tree_lookup(usage, &a->group_id));
+  int64_t used_b   = GPOINTER_TO_INT(g_tree_lookup(usage, &b->group_id));
+  int64_t weight_a = GPOINTER_TO_INT(g_tree_lookup(scheduler->group_weights, &a->group_id));
+  int64_t weight_b = GPOINTER_TO_INT(g_tree_lookup(scheduler->group_weights, &b->group_id));
+
+  if(weight_a <= 0) weight_a = 1;
+  if(weight_b <= 0) weight_b = 1;
+
+  return used_a * weight_b < used_b * weight_a;
+}
+
 /**
  * @brief Prints the jobs status to the output stream.
  *
@@ -128,15 +190,34 @@ static void job_transition(scheduler_t* scheduler, job_t* job, job_status new_st
   job->status = new_status;
 
   /* only update database for real jobs */
-  if(job->id >= 0)
-    database_update_job(scheduler, job, new_status);
+  if(job->id < 0)
+    return;
+
+  database_update_job(scheduler, job, new_status);
+
+  /* the jobs depending on this one can now be checked out, the agents of the */
+  /* job don't always die to signal it when they are kept in a pool          */
+  if(new_status == JB_COMPLETE || new_status == JB_FAILED)
+    event_signal(database_update_event, NULL);
+
+  if(new_status == JB_STARTED && job->started == 0)
+  {
+    job->started = g_get_monotonic_time();
+    metrics_job_wait(job->agent_type, job->started - job->queued);
+  }
+  else if((new_status == JB_COMPLETE || new_status == JB_FAILED) && job->started != 0)
+  {
+    metrics_job_run(job->agent_type, g_get_monotonic_time() - job->started,
+        new_status == JB_FAILED);
+  }
 }
 
 /**
  * @brief Used to compare two different jobs in the priority queue.
  *
- * This simply compares their priorities so that jobs with a high priority are
- * scheduler before low priority jobs.
+ * This compares their priorities so that jobs with a high priority are
+ * scheduler before low priority jobs, then their position in the job queue so
+ * that jobs with the same priority keep their order across the agent types.
  *
  * @param a       The first job
  * @param b       The second job
@@ -145,7 +226,161 @@ static void job_transition(scheduler_t* scheduler, job_t* job, job_status new_st
  */
 static gint job_compare(gconstpointer a, gconstpointer b, gpointer user_data)
 {
-  return ((job_t*)a)->priority - ((job_t*)b)->priority;
+  const job_t* job_a = a;
+  const job_t* job_b = b;
+
+  if(job_a->priority != job_b->priority)
+    return job_a->priority - job_b->priority;
+  return (job_a->queue_pos > job_b->queue_pos) - (job_a->queue_pos < job_b->queue_pos);
+}
+
+/**
+ * @brief Finds the first job of the job queue.
+ *
+ * Called from within a g_tree_foreach() on the job queue, this keeps the head
+ * of the queue of every agent type that comes first.
+ *
+ * @param type   The agent type of the queue
+ * @param queue  The queue of jobs of that agent type
+ * @param first  Set to the first job found so far
+ * @return always returns 0
+ */
+static int job_queue_first(gchar* type, GSequence* queue, GSequenceIter** first)
+{
+  GSequenceIter* beg = g_sequence_get_begin_iter(queue);
+
+  if(!g_sequence_iter_is_end(beg) && (*first == NULL ||
+      job_compare(g_sequence_get(beg), g_sequence_get(*first), NULL) < 0))
+    *first = beg;
+
+  return 0;
+}
+
+/**
+ * @brief Counts the jobs waiting in the job queue.
+ *
+ * @param type   The agent type of the queue
+ * @param queue  The queue of jobs of that agent type
+ * @param count  The number of jobs counted so far
+ * @return always returns 0
+ */
+static int job_queue_count(gchar* type, GSequence* queue, uint32_t* count)
+{
+  *count += g_sequence_get_length(queue);
+  return 0;
+}
+
+/**
+ * @brief The job chosen by next_ready_job() while going through the queues
+ */
+typedef struct
+{
+    scheduler_t*   scheduler;  ///< The scheduler holding the agents and hosts
+    GTree*         usage;      ///< The running agents of every group
+    GSequenceIter* best;       ///< The best job that can start, NULL for none
+    host_t*        host;       ///< The host the best job must start on, NULL for any
+} ready_job_t;
+
+/**
+ * @brief Finds the best job that can start in the queue of an agent type.
+ *
+ * Called from within a g_tree_foreach() on the job queue. A type that reached
+ * its max number of agents, or that must run on a full localhost, is skipped
+ * without looking at its jobs. Otherwise only the jobs with the best priority
+ * of the queue are looked at.
+ *
+ * @param type   The agent type of the queue
+ * @param queue  The queue of jobs of that agent type
+ * @param ready  The best job found in the previous queues, updated
+ * @return always returns 0
+ */
+static int job_queue_ready(gchar* type, GSequence* queue, ready_job_t* ready)
+{
+  scheduler_t* scheduler = ready->scheduler;
+  GSequenceIter* iter;
+  GSequenceIter* curr;
+  GSequenceIter* best = NULL;
+  meta_agent_t* meta;
+  host_t* local = NULL;
+  host_t* job_host;
+  host_t* best_host = NULL;
+  job_t* job;
+  job_t* ret = NULL;
+  job_t* prev = ready->best ? g_sequence_get(ready->best) : NULL;
+
+  if(g_sequence_get_length(queue) == 0)
+    return 0;
+
+  // Check the max limit of running agents
+  meta = g_tree_lookup(scheduler->meta_agents, type);
+  if(meta != NULL && meta->max_run <= meta->run_count)
+  {
+    V_SCHED("JOB_INIT: Unable to run agent %s due to max_run limit.\n", type);
+    return 0;
+  }
+
+  // check if the agent is required to run on local host
+  if(is_meta_special(meta, SAG_LOCAL))
+  {
+    local = g_tree_lookup(scheduler->host_list, LOCAL_HOST);
+    if(local == NULL || !(local->running < local->max))
+      return 0;
+  }
+
+  iter = g_sequence_get_begin_iter(queue);
+  while(!g_sequence_iter_is_end(iter))
+  {
+    curr = iter;
+    iter = g_sequence_iter_next(iter);
+    job  = g_sequence_get(curr);
+
+    /* lower priorities wait for the jobs that can start */
+    if(ret != NULL && job->priority != ret->priority)
+      break;
+    if(prev != NULL && job->priority > prev->priority)
+      break;
+
+    if(local != NULL)
+      job_host = local;
+    // check if the job is required to run on a specific machine
+    else if(job->required_host != NULL)
+    {
+      job_host = g_tree_lookup(scheduler->host_list, job->required_host);
+      if(job_host == NULL)
+      {
+        g_sequence_remove(curr);
+        job->message = "ERROR: jq_host not in the agent list!";
+        job_fail_event(scheduler, job);
+        continue;
+      }
+      if(!(job_host->running < job_host->max))
+        continue;
+    }
+    // the generic case, this can run anywhere
+    else
+      job_host = NULL;
+
+    if(ret == NULL || group_share_less(scheduler, ready->usage, job, ret))
+    {
+      best      = curr;
+      best_host = job_host;
+      ret       = job;
+    }
+  }
+
+  if(ret == NULL)
+    return 0;
+
+  if(prev == NULL || ret->priority < prev->priority ||
+      group_share_less(scheduler, ready->usage, ret, prev) ||
+      (!group_share_less(scheduler, ready->usage, prev, ret) &&
+       ret->queue_pos < prev->queue_pos))
+  {
+    ready->best = best;
+    ready->host = best_host;
+  }
+
+  return 0;
 }
 
 /* ************************************************************************** */
@@ -162,6 +397,7 @@ static gint job_compare(gconstpointer a, gconstpointer b, gpointer user_data)
  *
  * @param job_list   The list of all jobs, the job will be added to this list
  * @param job_queue  The job queue, the job must be added to this for scheduling
+ *                   if its id isn't negative
  * @param type       The type of agent that will be created for this job
  * @param host       The name of the host that this job will execute on
  * @param id         The id number for the job in the database
@@ -172,7 +408,7 @@ static gint job_compare(gconstpointer a, gconstpointer b, gpointer user_data)
  * @param jq_cmd_args Command line arguments
  * @return the new job
  */
-job_t* job_init(GTree* job_list, GSequence* job_queue,
+job_t* job_init(GTree* job_list, GTree* job_queue,
     char* type, char* host, int id, int parent_id, int user_id, int group_id, int priority, char *jq_cmd_args)
 {
   job_t* job = g_new0(job_t, 1);
@@ -196,9 +432,11 @@ job_t* job_init(GTree* job_list, GSequence* job_queue,
   job->user_id         = user_id;
   job->group_id        = group_id;
   job->jq_cmd_args     = g_strdup(jq_cmd_args);
+  job->queued          = g_get_monotonic_time();
+  job->started         = 0;
 
   g_tree_insert(job_list, &job->id, job);
-  if(id >= 0) g_sequence_insert_sorted(job_queue, job, job_compare, NULL);
+  if(id >= 0) job_queue_insert(job_queue, job);
   return job;
 }
 
@@ -557,7 +795,8 @@ void job_update(scheduler_t* scheduler, job_t* job)
       job_transition(scheduler, job, JB_COMPLETE);
       for(iter = job->finished_agents; iter != NULL; iter = iter->next)
       {
-        aprintf(iter->data, "CLOSE\n");
+        if(!agent_pool_add(iter->data))
+          aprintf(iter->data, "CLOSE\n");
       }
     }
     /* this indicates a failed agent */
@@ -681,6 +920,43 @@ log_t* job_log(job_t* job)
 /* **** Job list Functions ************************************************** */
 /* ************************************************************************** */
 
+/**
+ * @brief Creates a new job queue.
+ *
+ * The job queue keeps a queue of jobs sorted by priority for every agent type,
+ * so that an agent type that can't start is skipped as a whole.
+ *
+ * @return the job queue, must be freed with g_tree_destroy()
+ */
+GTree* job_queue_new()
+{
+  return g_tree_new_full(string_compare, NULL, g_free,
+      (GDestroyNotify)g_sequence_free);
+}
+
+/**
+ * @brief Adds a job to the job queue.
+ *
+ * The job is put behind the jobs of the same priority already in the queue.
+ *
+ * @param job_queue The queue to add the job to
+ * @param job       The job to add
+ */
+void job_queue_insert(GTree* job_queue, job_t* job)
+{
+  static uint64_t queue_pos = 0;
+  GSequence* queue;
+
+  if((queue = g_tree_lookup(job_queue, job->agent_type)) == NULL)
+  {
+    queue = g_sequence_new(NULL);
+    g_tree_insert(job_queue, g_strdup(job->agent_type), queue);
+  }
+
+  job->queue_pos = queue_pos++;
+  g_sequence_insert_sorted(queue, job, job_compare, NULL);
+}
+
 /**
  * @brief Gets the next job from the job queue.
  *
@@ -689,15 +965,16 @@ log_t* job_log(job_t* job)
  * @param job_queue The queue to get job from
  * @return the job or NULL
  */
-job_t* next_job(GSequence* job_queue)
+job_t* next_job(GTree* job_queue)
 {
   job_t* retval = NULL;
-  GSequenceIter* beg = g_sequence_get_begin_iter(job_queue);
+  GSequenceIter* first = NULL;
 
-  if(g_sequence_get_length(job_queue) != 0)
+  g_tree_foreach(job_queue, (GTraverseFunc)job_queue_first, &first);
+  if(first != NULL)
   {
-    retval = g_sequence_get(beg);
-    g_sequence_remove(beg);
+    retval = g_sequence_get(first);
+    g_sequence_remove(first);
   }
 
   return retval;
@@ -709,17 +986,30 @@ job_t* next_job(GSequence* job_queue)
  * @param job_queue The queue to get job from
  * @return the job at the top of the job queue, NULL if queue is empty
  */
-job_t* peek_job(GSequence* job_queue)
+job_t* peek_job(GTree* job_queue)
 {
-  GSequenceIter* beg;
+  GSequenceIter* first = NULL;
 
-  if(g_sequence_get_length(job_queue) == 0)
+  g_tree_foreach(job_queue, (GTraverseFunc)job_queue_first, &first);
+  if(first == NULL)
   {
     return NULL;
   }
 
-  beg = g_sequence_get_begin_iter(job_queue);
-  return g_sequence_get(beg);
+  return g_sequence_get(first);
+}
+
+/**
+ * @brief Gets the number of jobs waiting in the job queue
+ *
+ * @param job_queue The queue to check
+ * @return number of queued jobs
+ */
+uint32_t queued_jobs(GTree* job_queue)
+{
+  uint32_t count = 0;
+  g_tree_foreach(job_queue, (GTraverseFunc)job_queue_count, &count);
+  return count;
 }
 
 /**
@@ -735,3 +1025,60 @@ uint32_t active_jobs(GTree* job_list)
   return count;
 }
 
+
+/**
+ * @brief Counts the running agents of every group.
+ *
+ * @param scheduler  The scheduler holding the running agents
+ * @return a new GTree mapping the group ids to their number of running agents,
+ *         it is used by next_ready_job() and must be freed with g_tree_unref()
+ */
+GTree* group_usage(scheduler_t* scheduler)
+{
+  GTree* usage = g_tree_new_full(int_compare, NULL, g_free, NULL);
+
+  g_tree_foreach(scheduler->agents, (GTraverseFunc)group_usage_count, usage);
+  return usage;
+}
+
+/**
+ * @brief Takes the next job that can start from the job queue.
+ *
+ * Nothing is looked at while every host is full. Otherwise the queue of every
+ * agent type is looked at, skipping a type that reached its max, or that must
+ * run on a full localhost, as a whole, so that a job waiting for its agent
+ * type or for a host doesn't block the jobs of the other types.
+ *
+ * Among the jobs that can start with the best priority, the one whose group
+ * uses the least of its share of the agents is taken, then the first one in
+ * the job queue. Jobs that don't require a host run on the least loaded host.
+ *
+ * Jobs requiring a host that doesn't exist are removed from the job queue and
+ * failed.
+ *
+ * @param scheduler  The scheduler holding the job queue, agents and hosts
+ * @param usage      The running agents of every group, from group_usage(). The
+ *                   group of the returned job is counted with one more agent.
+ * @param host       Set to the host the returned job must start on
+ * @return the job removed from the job queue, NULL if no job can start
+ */
+job_t* next_ready_job(scheduler_t* scheduler, GTree* usage, host_t** host)
+{
+  ready_job_t ready = { scheduler, usage, NULL, NULL };
+  job_t* ret;
+
+  /* every host is in the host queue, a required host is full as well */
+  if(peek_host(scheduler->host_queue, 1) == NULL)
+    return NULL;
+
+  g_tree_foreach(scheduler->job_queue, (GTraverseFunc)job_queue_ready, &ready);
+  if(ready.best == NULL)
+    return NULL;
+
+  ret = g_sequence_get(ready.best);
+  g_sequence_remove(ready.best);
+  group_usage_add(usage, ret->group_id, 1);
+
+  *host = (ready.host != NULL) ? ready.host : get_host(&scheduler->host_queue, 1);
+  return ret;
+}
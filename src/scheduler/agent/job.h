@@ -20,6 +20,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #define JOB_H_INCLUDE
 
 /* local includes */
+#include <host.h>
 #include <logging.h>
 
 /* std library includes */
@@ -84,13 +85,18 @@ typedef struct
     int32_t  id;        ///< The identifier for this job
     int32_t  user_id;   ///< The id of the user that created the job
     int32_t  group_id;  ///< The id of the group that created the job
+    uint64_t queue_pos; ///< The position of the job in the job queue
+
+    /* information for the metrics */
+    gint64 queued;   ///< Monotonic time the job was read from the job queue
+    gint64 started;  ///< Monotonic time the job was started, 0 before
 } job_t;
 
 /* ************************************************************************** */
 /* **** Constructor Destructor ********************************************** */
 /* ************************************************************************** */
 
-job_t* job_init(GTree* job_list, GSequence* job_queue, char* type, char* host,
+job_t* job_init(GTree* job_list, GTree* job_queue, char* type, char* host,
     int id, int parent_id, int user_id, int group_id, int priority, char *jq_cmd_args);
 void   job_destroy(job_t* job);
 
@@ -120,8 +126,13 @@ log_t*    job_log(job_t* job);
 /* **** Job list Functions ************************************************** */
 /* ************************************************************************** */
 
-job_t*   next_job(GSequence* job_queue);
-job_t*   peek_job(GSequence* job_queue);
+GTree*   job_queue_new();
+void     job_queue_insert(GTree* job_queue, job_t* job);
+job_t*   next_job(GTree* job_queue);
+job_t*   peek_job(GTree* job_queue);
+uint32_t queued_jobs(GTree* job_queue);
 uint32_t active_jobs(GTree* job_list);
+GTree*   group_usage(scheduler_t* scheduler);
+job_t*   next_ready_job(scheduler_t* scheduler, GTree* usage, host_t** host);
 
 #endif /* JOB_H_INCLUDE */
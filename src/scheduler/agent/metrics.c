@@ -0,0 +1,374 @@
+/* **************************************************************
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+************************************************************** */
+/**
+ * \file
+ * \brief Counters and latency histograms of the scheduler
+ *
+ * The scheduler keeps counters and histograms about the event loop, the jobs
+ * and the agents. They are written by the event loop and by the communication
+ * thread and are read by the interface threads when the "metrics" command is
+ * received. They are printed in the text format of Prometheus, so they can be
+ * compared between runs without attaching a debugger to the scheduler.
+ *
+ * The job and agent metrics are kept for every agent type. The throughput of
+ * the agents is measured from the HEART messages the agents send with
+ * fo_scheduler_heart().
+ */
+
+/* local includes */
+#include <metrics.h>
+#include <scheduler.h>
+
+/* std library includes */
+#include <string.h>
+
+/* ************************************************************************** */
+/* **** Locals ************************************************************** */
+/* ************************************************************************** */
+
+/**
+ * Upper bounds of the buckets of every histogram in seconds. They go from the
+ * time an event waits in the event loop up to the run time of a large job.
+ */
+static const gdouble metrics_bounds[METRICS_BUCKETS] =
+    { 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 5, 10, 30, 60, 300, 900, 3600, 14400 };
+
+/** Metrics of the jobs and agents of one agent type */
+typedef struct {
+  histogram_t job_wait;        ///< Time between reading a job and starting it
+  histogram_t job_run;         ///< Time between starting a job and its end
+  histogram_t startup;         ///< Time between the fork and the VERSION message
+  histogram_t heart_gap;       ///< Time between two HEART messages of an agent
+  guint64     jobs_completed;  ///< Number of jobs that completed
+  guint64     jobs_failed;     ///< Number of jobs that failed
+  guint64     hearts;          ///< Number of HEART messages received
+  guint64     items;           ///< Number of items the agents reported as processed
+} type_metrics_t;
+
+/** A metric that is kept for every agent type */
+typedef struct {
+  const char* name;  ///< Name of the metric
+  const char* help;  ///< Description printed with the metric
+  glong offset;      ///< Offset of the metric in type_metrics_t
+} family_t;
+
+/** Histograms that are kept for every agent type */
+static const family_t metrics_histograms[] =
+{
+    {"fossology_scheduler_job_wait_seconds",
+        "Time between reading a job from the job queue and starting it",
+        G_STRUCT_OFFSET(type_metrics_t, job_wait)},
+    {"fossology_scheduler_job_run_seconds",
+        "Time between starting a job and its completion or failure",
+        G_STRUCT_OFFSET(type_metrics_t, job_run)},
+    {"fossology_scheduler_agent_startup_seconds",
+        "Time between forking an agent and receiving its VERSION",
+        G_STRUCT_OFFSET(type_metrics_t, startup)},
+    {"fossology_scheduler_agent_heartbeat_gap_seconds",
+        "Time between two HEART messages of the same agent",
+        G_STRUCT_OFFSET(type_metrics_t, heart_gap)}
+};
+
+/** Counters that are kept for every agent type */
+static const family_t metrics_counters[] =
+{
+    {"fossology_scheduler_jobs_completed_total",
+        "Number of jobs that completed",
+        G_STRUCT_OFFSET(type_metrics_t, jobs_completed)},
+    {"fossology_scheduler_jobs_failed_total",
+        "Number of jobs that failed",
+        G_STRUCT_OFFSET(type_metrics_t, jobs_failed)},
+    {"fossology_scheduler_agent_heartbeats_total",
+        "Number of HEART messages received from the agents",
+        G_STRUCT_OFFSET(type_metrics_t, hearts)},
+    {"fossology_scheduler_agent_items_total",
+        "Number of items the agents reported as processed",
+        G_STRUCT_OFFSET(type_metrics_t, items)}
+};
+
+/** Time the events wait in the event loop before they are called */
+static histogram_t event_latency;
+
+/** The type_metrics_t of every agent type, by the name of the type */
+static GTree* type_metrics = NULL;
+
+/**
+ * The metrics are changed by the event loop and by the communication thread
+ * and are printed by the interface threads.
+ */
+#if GLIB_MAJOR_VERSION >= 2 && GLIB_MINOR_VERSION >= 32
+static GMutex metrics_mutex;
+#define metrics_lock()   g_mutex_lock(&metrics_mutex)
+#define metrics_unlock() g_mutex_unlock(&metrics_mutex)
+#else
+static GStaticMutex metrics_mutex = G_STATIC_MUTEX_INIT;
+#define metrics_lock()   g_static_mutex_lock(&metrics_mutex)
+#define metrics_unlock() g_static_mutex_unlock(&metrics_mutex)
+#endif
+
+/**
+ * @brief Get the metrics of an agent type, creating them on first use.
+ *
+ * The metrics lock must be held by the caller.
+ *
+ * @param agent_type  the name of the agent type
+ * @return the metrics of the agent type
+ */
+static type_metrics_t* metrics_type(const char* agent_type)
+{
+  type_metrics_t* metrics;
+
+  if (type_metrics == NULL)
+    type_metrics = g_tree_new_full(string_compare, NULL, g_free, g_free);
+
+  if ((metrics = g_tree_lookup(type_metrics, agent_type)) == NULL)
+  {
+    metrics = g_new0(type_metrics_t, 1);
+    g_tree_insert(type_metrics, g_strdup(agent_type), metrics);
+  }
+
+  return metrics;
+}
+
+/**
+ * @brief GTraverseFunc that collects the names of the agent types.
+ *
+ * @param name   the name of the agent type
+ * @param value  unused
+ * @param names  the GPtrArray the name is added to
+ * @return always 0 to continue the traversal
+ */
+static gboolean metrics_names(gpointer name, gpointer value, gpointer names)
+{
+  g_ptr_array_add(names, name);
+  return 0;
+}
+
+/**
+ * @brief Print one histogram in the text format of Prometheus.
+ *
+ * @param out        the string the histogram is appended to
+ * @param name       the name of the histogram
+ * @param label      the agent type of the histogram, NULL for none
+ * @param histogram  the histogram to print
+ */
+static void histogram_print(GString* out, const char* name, const char* label,
+    histogram_t* histogram)
+{
+  gchar* labels;
+  guint64 total = 0;
+  int i;
+
+  labels = label == NULL ? g_strdup("") : g_strdup_printf("agent_type=\"%s\",", label);
+
+  for (i = 0; i < METRICS_BUCKETS; i++)
+  {
+    total += histogram->buckets[i];
+    g_string_append_printf(out, "%s_bucket{%sle=\"%g\"} %" G_GUINT64_FORMAT "\n",
+        name, labels, metrics_bounds[i], total);
+  }
+  g_string_append_printf(out, "%s_bucket{%sle=\"+Inf\"} %" G_GUINT64_FORMAT "\n",
+      name, labels, histogram->count);
+
+  g_free(labels);
+
+  /* the sum and count only have the agent type as label */
+  labels = label == NULL ? g_strdup("") : g_strdup_printf("{agent_type=\"%s\"}", label);
+  g_string_append_printf(out, "%s_sum%s %.6f\n", name, labels, histogram->sum);
+  g_string_append_printf(out, "%s_count%s %" G_GUINT64_FORMAT "\n",
+      name, labels, histogram->count);
+
+  g_free(labels);
+}
+
+/* ************************************************************************** */
+/* **** Functions *********************************************************** */
+/* ************************************************************************** */
+
+/**
+ * @brief Add an observation to a histogram.
+ *
+ * The histogram is not locked, this should be used on histograms that are
+ * protected by the caller.
+ *
+ * @param histogram  the histogram to change
+ * @param usec       the observation in microseconds
+ */
+void metrics_histogram_observe(histogram_t* histogram, gint64 usec)
+{
+  gdouble seconds = MAX(usec, 0) / (gdouble)G_USEC_PER_SEC;
+  int i;
+
+  for (i = 0; i < METRICS_BUCKETS && seconds > metrics_bounds[i]; i++);
+
+  histogram->buckets[i]++;
+  histogram->count++;
+  histogram->sum += seconds;
+}
+
+/**
+ * @brief Record the time an event waited in the event loop.
+ *
+ * @param queued  the monotonic time the event was put into the event loop
+ */
+void metrics_event(gint64 queued)
+{
+  metrics_lock();
+  metrics_histogram_observe(&event_latency, g_get_monotonic_time() - queued);
+  metrics_unlock();
+}
+
+/**
+ * @brief Record the time a job waited before it was started.
+ *
+ * @param agent_type  the agent type of the job
+ * @param usec        the waiting time in microseconds
+ */
+void metrics_job_wait(const char* agent_type, gint64 usec)
+{
+  metrics_lock();
+  metrics_histogram_observe(&metrics_type(agent_type)->job_wait, usec);
+  metrics_unlock();
+}
+
+/**
+ * @brief Record the end of a job.
+ *
+ * @param agent_type  the agent type of the job
+ * @param usec        the time the job ran in microseconds
+ * @param failed      if the job failed instead of completing
+ */
+void metrics_job_run(const char* agent_type, gint64 usec, int failed)
+{
+  type_metrics_t* metrics;
+
+  metrics_lock();
+  metrics = metrics_type(agent_type);
+  metrics_histogram_observe(&metrics->job_run, usec);
+  if (failed)
+    metrics->jobs_failed++;
+  else
+    metrics->jobs_completed++;
+  metrics_unlock();
+}
+
+/**
+ * @brief Record the time an agent took to send its VERSION after the fork.
+ *
+ * @param agent_type  the agent type of the agent
+ * @param usec        the startup time in microseconds
+ */
+void metrics_agent_startup(const char* agent_type, gint64 usec)
+{
+  metrics_lock();
+  metrics_histogram_observe(&metrics_type(agent_type)->startup, usec);
+  metrics_unlock();
+}
+
+/**
+ * @brief Record a HEART message of an agent.
+ *
+ * @param agent_type  the agent type of the agent
+ * @param gap         the time since the previous HEART of the agent in microseconds
+ * @param items       the number of items processed since the previous HEART
+ */
+void metrics_agent_heart(const char* agent_type, gint64 gap, uint32_t items)
+{
+  type_metrics_t* metrics;
+
+  metrics_lock();
+  metrics = metrics_type(agent_type);
+  metrics_histogram_observe(&metrics->heart_gap, gap);
+  metrics->hearts++;
+  metrics->items += items;
+  metrics_unlock();
+}
+
+/**
+ * @brief Print every metric in the text format of Prometheus.
+ *
+ * This does not use the event loop, so the metrics can still be read when the
+ * event loop is too busy to answer the other commands. Like the other answers
+ * of the interface, the metrics are followed by an "end" line.
+ *
+ * @param ostr  the output stream to print the metrics to
+ */
+void metrics_print(GOutputStream* ostr)
+{
+  GString* out = g_string_new("");
+  GPtrArray* names = g_ptr_array_new();
+  type_metrics_t* metrics;
+  guint64 value;
+  int i, j;
+
+  metrics_lock();
+
+  g_string_append(out, "# HELP fossology_scheduler_event_latency_seconds "
+      "Time events wait in the event loop before they are called\n");
+  g_string_append(out, "# TYPE fossology_scheduler_event_latency_seconds histogram\n");
+  histogram_print(out, "fossology_scheduler_event_latency_seconds", NULL, &event_latency);
+
+  if (type_metrics != NULL)
+    g_tree_foreach(type_metrics, metrics_names, names);
+
+  for (i = 0; i < G_N_ELEMENTS(metrics_histograms); i++)
+  {
+    g_string_append_printf(out, "# HELP %s %s\n# TYPE %s histogram\n",
+        metrics_histograms[i].name, metrics_histograms[i].help, metrics_histograms[i].name);
+    for (j = 0; j < names->len; j++)
+    {
+      metrics = g_tree_lookup(type_metrics, g_ptr_array_index(names, j));
+      histogram_print(out, metrics_histograms[i].name, g_ptr_array_index(names, j),
+          G_STRUCT_MEMBER_P(metrics, metrics_histograms[i].offset));
+    }
+  }
+
+  for (i = 0; i < G_N_ELEMENTS(metrics_counters); i++)
+  {
+    g_string_append_printf(out, "# HELP %s %s\n# TYPE %s counter\n",
+        metrics_counters[i].name, metrics_counters[i].help, metrics_counters[i].name);
+    for (j = 0; j < names->len; j++)
+    {
+      metrics = g_tree_lookup(type_metrics, g_ptr_array_index(names, j));
+      value = G_STRUCT_MEMBER(guint64, metrics, metrics_counters[i].offset);
+      g_string_append_printf(out, "%s{agent_type=\"%s\"} %" G_GUINT64_FORMAT "\n",
+          metrics_counters[i].name, (char*)g_ptr_array_index(names, j), value);
+    }
+  }
+
+  metrics_unlock();
+
+  g_string_append(out, "end\n");
+  g_output_stream_write(ostr, out->str, out->len, NULL, NULL);
+
+  g_ptr_array_free(names, TRUE);
+  g_string_free(out, TRUE);
+}
+
+/**
+ * @brief Clear every metric and free the metrics of the agent types.
+ */
+void metrics_reset()
+{
+  metrics_lock();
+  memset(&event_latency, 0, sizeof(event_latency));
+  if (type_metrics != NULL)
+    g_tree_destroy(type_metrics);
+  type_metrics = NULL;
+  metrics_unlock();
+}
@@ -0,0 +1,64 @@
+/* **************************************************************
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+************************************************************** */
+/**
+ * \file
+ * \brief Counters and latency histograms of the scheduler
+ */
+
+#ifndef METRICS_H_INCLUDE
+#define METRICS_H_INCLUDE
+
+/* std includes */
+#include <stdint.h>
+
+/* other library includes */
+#include <gio/gio.h>
+#include <glib.h>
+
+/* ************************************************************************** */
+/* **** Data Types ********************************************************** */
+/* ************************************************************************** */
+
+/** Number of finite buckets of every histogram, see metrics_bounds */
+#define METRICS_BUCKETS 15
+
+/**
+ * A latency histogram. Every bucket only counts its own observations, they
+ * are accumulated when the histogram is printed.
+ */
+typedef struct {
+  guint64 buckets[METRICS_BUCKETS + 1]; ///< Observations per bucket, the last one is +Inf
+  guint64 count;                        ///< The number of observations
+  gdouble sum;                          ///< The sum of the observations in seconds
+} histogram_t;
+
+/* ************************************************************************** */
+/* **** Functions *********************************************************** */
+/* ************************************************************************** */
+
+void metrics_event(gint64 queued);
+void metrics_job_wait(const char* agent_type, gint64 usec);
+void metrics_job_run(const char* agent_type, gint64 usec, int failed);
+void metrics_agent_startup(const char* agent_type, gint64 usec);
+void metrics_agent_heart(const char* agent_type, gint64 gap, uint32_t items);
+
+void metrics_histogram_observe(histogram_t* histogram, gint64 usec);
+void metrics_print(GOutputStream* ostr);
+void metrics_reset();
+
+#endif /* METRICS_H_INCLUDE */
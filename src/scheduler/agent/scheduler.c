@@ -26,6 +26,7 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 #include <event.h>
 #include <host.h>
 #include <interface.h>
+#include <metrics.h>
 #include <scheduler.h>
 #include <fossconfig.h>
 
@@ -232,13 +233,15 @@ void scheduler_signal(scheduler_t* scheduler)
    * Every CONF_agent_update_interval, the agents and database should be
    * updated. The agents need to be updated to check for dead and unresponsive
    * agents. The database is updated to make sure that a new job hasn't been
-   * scheduled without the scheduler being informed.
+   * scheduled without the scheduler being informed, unless the database
+   * notifies the scheduler of the new jobs.
    */
   if((time(NULL) - last_update) > CONF_agent_update_interval )
   {
     V_SPECIAL("SIGNALS: Performing agent and database update\n");
     event_signal(agent_update_event, NULL);
-    event_signal(database_update_event, NULL);
+    if(!database_listening(scheduler))
+      event_signal(database_update_event, NULL);
     last_update = time(NULL);
   }
 }
@@ -274,6 +277,11 @@ scheduler_t* scheduler_init(gchar* sysconfigdir, log_t* log)
   ret->main_log      = log;
   ret->host_queue    = NULL;
 
+  ret->io_epoll      = -1;
+  ret->io_thread     = NULL;
+  ret->io_agents     = NULL;
+  ret->io_terminate  = FALSE;
+
   ret->i_created     = FALSE;
   ret->i_terminate   = FALSE;
   ret->i_port        = 0;
@@ -281,7 +289,8 @@ scheduler_t* scheduler_init(gchar* sysconfigdir, log_t* log)
   ret->workers       = NULL;
   ret->cancel        = NULL;
 
-  ret->job_queue     = g_sequence_new(NULL);
+  ret->job_queue     = job_queue_new();
+  ret->group_weights = g_tree_new_full(int_compare, NULL, g_free, NULL);
 
   ret->db_conn       = NULL;
   ret->host_url      = NULL;
@@ -289,6 +298,12 @@ scheduler_t* scheduler_init(gchar* sysconfigdir, log_t* log)
   ret->email_header  = NULL;
   ret->email_footer  = NULL;
   ret->email_command = NULL;
+  ret->n_conn        = NULL;
+  ret->n_thread      = NULL;
+  ret->n_terminate   = FALSE;
+  ret->n_listening   = 0;
+  ret->n_pending     = 0;
+  ret->n_backlog     = FALSE;
 
   /* This regex should find:
    *   1. One or more capital letters followed by a ':' followed by white space,
@@ -372,8 +387,12 @@ scheduler_t* scheduler_init(gchar* sysconfigdir, log_t* log)
  */
 void scheduler_destroy(scheduler_t* scheduler)
 {
+  /* the notification and communication threads signal events and log */
+  database_listen_destroy(scheduler);
+  agent_io_destroy(scheduler);
 
   event_loop_destroy();
+  metrics_reset();
 
   if(scheduler->main_log)
   {
@@ -390,7 +409,7 @@ void scheduler_destroy(scheduler_t* scheduler)
   if(scheduler->email_subject) g_free(scheduler->email_subject);
   if(scheduler->email_command) g_free(scheduler->email_command);
 
-  g_sequence_free(scheduler->job_queue);
+  g_tree_destroy(scheduler->job_queue);
 
   g_regex_unref(scheduler->parse_agent_msg);
   g_regex_unref(scheduler->parse_db_email);
@@ -400,32 +419,13 @@ void scheduler_destroy(scheduler_t* scheduler)
   g_tree_unref(scheduler->agents);
   g_tree_unref(scheduler->host_list);
   g_tree_unref(scheduler->job_list);
+  g_tree_unref(scheduler->group_weights);
 
   if (scheduler->db_conn) PQfinish(scheduler->db_conn);
 
   g_free(scheduler);
 }
 
-/**
- * @brief Check if the current agent's max limit is respected.
- *
- * Compare the number of running agents and run limit of the agent.
- * @param agent     Agent which has to be scheduled.
- * @return True if the agent can be scheduled (no. of running agents < max run
- *         limit of the agent), false otherwise.
- */
-static gboolean isMaxLimitReached(meta_agent_t* agent)
-{
-  if (agent->max_run <= agent->run_count)
-  {
-    return TRUE;
-  }
-  else
-  {
-    return FALSE;
-  }
-}
-
 /**
  * @brief Update function called after every event
  *
@@ -434,6 +434,10 @@ static gboolean isMaxLimitReached(meta_agent_t* agent)
  * is executed. Therefore the code should be light weight since it will be run
  * very frequently.
  *
+ * The jobs are started in the order given by next_ready_job(), until no job
+ * of the job queue can start. The running agents of every group are only
+ * counted when a host is free to start a job.
+ *
  * @todo Currently this will only grab a job and create a single agent to execute
  *   the job.
  *
@@ -449,8 +453,17 @@ void scheduler_update(scheduler_t* scheduler)
   static int lockout = 0;
 
   /* locals */
-  int n_agents = g_tree_nnodes(scheduler->agents);
-  int n_jobs   = active_jobs(scheduler->job_list);
+  int n_agents;
+  int n_jobs;
+  GTree* usage;
+
+  /* the agents waiting for a new job must not hold up a shutdown, the */
+  /* startup tests or an exclusive job                                 */
+  if(closing || scheduler->s_startup || job != NULL || lockout)
+    agent_pool_close(scheduler);
+
+  n_agents = g_tree_nnodes(scheduler->agents);
+  n_jobs   = active_jobs(scheduler->job_list);
 
   /* check to see if we are in and can exit the startup state */
   if(scheduler->s_startup && n_agents == 0)
@@ -469,58 +482,12 @@ void scheduler_update(scheduler_t* scheduler)
   if(lockout && n_agents == 0 && n_jobs == 0)
     lockout = 0;
 
-  if(job == NULL && !lockout)
+  if(job == NULL && !lockout && queued_jobs(scheduler->job_queue) != 0 &&
+      peek_host(scheduler->host_queue, 1) != NULL)
   {
-    while((job = peek_job(scheduler->job_queue)) != NULL)
+    usage = group_usage(scheduler);
+    while((job = next_ready_job(scheduler, usage, &host)) != NULL)
     {
-      // Check the max limit of running agents
-      if (isMaxLimitReached(
-          g_tree_lookup(scheduler->meta_agents, job->agent_type)))
-      {
-        V_SCHED("JOB_INIT: Unable to run agent %s due to max_run limit.\n",
-            job->agent_type);
-        job = NULL;
-        break;
-      }
-      // check if the agent is required to run on local host
-      if(is_meta_special(
-          g_tree_lookup(scheduler->meta_agents, job->agent_type), SAG_LOCAL))
-      {
-        host = g_tree_lookup(scheduler->host_list, LOCAL_HOST);
-        if(!(host->running < host->max))
-        {
-          job = NULL;
-          break;
-        }
-      }
-      // check if the job is required to run on a specific machine
-      else if((job->required_host != NULL))
-      {
-        host = g_tree_lookup(scheduler->host_list, job->required_host);
-        if(host != NULL)
-        {
-          if(!(host->running < host->max))
-          {
-          job = NULL;
-          break;
-        }
-       } else {
-         //log_printf("ERROR %s.%d: jq_pk %d jq_host '%s' not in the agent list!\n",
-         //  __FILE__, __LINE__, job->id, job->required_host);
-         job->message = "ERROR: jq_host not in the agent list!";
-         job_fail_event(scheduler, job);
-         job = NULL;
-         break;
-       }
-      }
-      // the generic case, this can run anywhere, find a place
-      else if((host = get_host(&(scheduler->host_queue), 1)) == NULL)
-      {
-        job = NULL;
-        break;
-      }
-
-      next_job(scheduler->job_queue);
       if(is_meta_special(
           g_tree_lookup(scheduler->meta_agents, job->agent_type), SAG_EXCLUSIVE))
       {
@@ -529,9 +496,11 @@ void scheduler_update(scheduler_t* scheduler)
       }
 
       V_SCHED("Starting JOB[%d].%s\n", job->id, job->agent_type);
-      agent_init(scheduler, host, job);
+      if(agent_pool_take(scheduler, host, job) == NULL)
+        agent_init(scheduler, host, job);
       job = NULL;
     }
+    g_tree_unref(usage);
   }
 
   if(job != NULL && n_agents == 0 && n_jobs == 0)
@@ -683,6 +652,7 @@ void scheduler_clear_config(scheduler_t* scheduler)
 {
   g_tree_clear(scheduler->meta_agents);
   g_tree_clear(scheduler->host_list);
+  g_tree_clear(scheduler->group_weights);
 
   g_list_free(scheduler->host_queue);
   scheduler->host_queue = NULL;
@@ -690,6 +660,7 @@ void scheduler_clear_config(scheduler_t* scheduler)
   g_free(scheduler->host_url);
   g_free(scheduler->email_subject);
   g_free(scheduler->email_command);
+  database_listen_destroy(scheduler);
   PQfinish(scheduler->db_conn);
   scheduler->db_conn       = NULL;
   scheduler->host_url      = NULL;
@@ -817,6 +788,8 @@ void scheduler_agent_config(scheduler_t* scheduler)
             special |= SAG_NOKILL;
           else if(strncmp(cmd, "LOCAL", 6) == 0)
             special |= SAG_LOCAL;
+          else if(strncmp(cmd, "REUSABLE", 8) == 0)
+            special |= SAG_REUSABLE;
           else if(strlen(cmd) != 0)
             WARNING("%s: Invalid special type for agent %s: %s",
                 dirname, name, cmd);
@@ -872,6 +845,7 @@ void scheduler_foss_config(scheduler_t* scheduler)
   GError*  error = NULL;          // error return location
   int32_t  i;                     // indexing variable
   host_t*  host;                  // new hosts will be created in the loop
+  gint*    group;                 // id of a group with a weight
   fo_conf* version;               // information loaded from the version file
 
   if(scheduler->sysconfig != NULL)
@@ -930,6 +904,24 @@ void scheduler_foss_config(scheduler_t* scheduler)
     }
   }
 
+  /* load the weights of the groups sharing the agents */
+  keys = fo_config_key_set(scheduler->sysconfig, "SHARES", &special);
+  for(i = 0; i < special; i++)
+  {
+    max = atoi(fo_config_get(scheduler->sysconfig, "SHARES", keys[i], NULL));
+    if(!string_is_num(keys[i]) || max <= 0)
+    {
+      WARNING("invalid weight for group %s: \"%s\"\n", keys[i],
+          fo_config_get(scheduler->sysconfig, "SHARES", keys[i], NULL));
+      continue;
+    }
+
+    group = g_new(gint, 1);
+    *group = atoi(keys[i]);
+    g_tree_insert(scheduler->group_weights, group, GINT_TO_POINTER(max));
+    V_SCHED("CONFIG: group %d has a weight of %d\n", *group, max);
+  }
+
   if((tmp = fo_RepValidate(scheduler->sysconfig)) != NULL)
   {
     ERROR("configuration file failed repository validation");
@@ -42,9 +42,10 @@ with this program; if not, write to the Free Software Foundation, Inc.,
  *     agent. A job is a scheduler construct used to run an agent process.
  * \section schedulerarchitecture Scheduler Architecture
  * Scheduler use a classic client server communication style for both the agent
- * communication and the UI communication. Every time a new communication
- * channel is needed, the scheduler will create a new thread to manage the
- * communications with that channel. This makes the communication logic much simpler.
+ * communication and the UI communication. Every UI connection gets a thread to
+ * manage the communications with that channel. A single communication thread
+ * waits for the messages of all of the agents using epoll, so that a large
+ * number of agents doesn't need as many threads.
  *
  * If the communication thread receives anything that would involve changing a
  * data structure internal to the scheduler, it passes the information off to
@@ -64,15 +65,15 @@ with this program; if not, write to the Free Software Foundation, Inc.,
  * that it is waiting. The main thread will then take a chunk of data from the
  * job that the agent belongs to and allocate it to the agent. The communication
  * thread will then be responsible for sending the data to the corresponding
- * process. It is important to note that the communication threads are using
- * blocking IO on the pipe from the corresponding process. As a result, any
- * string that starts with "@" is reserved as a communication from the scheduler
- * instead of the corresponding process. Writing anything that starts with "@"
+ * process. It is important to note that the communication thread reads the
+ * messages of the scheduler on the same pipe as the ones of the process. As a
+ * result, any string that starts with "@" is reserved as a communication from
+ * the scheduler instead of the corresponding process. Writing anything that starts with "@"
  * to stdout within an agent will result in undefined behavior.
  *
  * Here are some other properties of the scheduler:
  * - Scheduler can take advantage of multiple processors on whatever machine it is running on.
- * - Simplified code for communicating with agents since all IO would be blocking instead of non-blocking.
+ * - Reading from the agents is non-blocking, every agent has a bounded buffer for the messages it sent.
  * - Master thread can not get swamped with communications between the agents and can concentrate on managing new jobs.
  * - Uses GLib
  * - Job queue is implemented in db tables:
@@ -164,8 +165,12 @@ typedef struct
     log_t*   main_log;      ///< The main log file for the scheduler
 
     /* used exclusively in agent.c */
-    GTree*  meta_agents;    ///< List of all meta agents available to the scheduler
-    GTree*  agents;         ///< List of any currently running agents
+    GTree*      meta_agents;  ///< List of all meta agents available to the scheduler
+    GTree*      agents;       ///< List of any currently running agents
+    int         io_epoll;     ///< Waits for the messages of all of the agents
+    GThread*    io_thread;    ///< Thread reading the messages of all of the agents
+    GHashTable* io_agents;    ///< The agents that are listened to, by their pipe
+    gboolean    io_terminate; ///< Has the communication thread been terminated
 
     /* used exclusively in host.c */
     GTree* host_list;       ///< List of all hosts available to the scheduler
@@ -181,7 +186,8 @@ typedef struct
 
     /* used exclusively in job.c */
     GTree*     job_list;    ///< List of jobs that have been created
-    GSequence* job_queue;   ///< heap of jobs that still need to be started
+    GTree*     job_queue;   ///< jobs that still need to be started, a queue for every agent type
+    GTree*     group_weights; ///< Weight of the groups when sharing the agents
 
     /* used exclusively in database.c */
     PGconn*  db_conn;         ///< The database connection
@@ -192,6 +198,12 @@ typedef struct
     gchar*   email_command;   ///< The command that will sends emails, usually mailx
     gboolean default_header;  ///< Is the header the default header
     gboolean default_footer;  ///< Is the footer the default footer
+    PGconn*  n_conn;          ///< The connection listening to the job queue notifications
+    GThread* n_thread;        ///< Thread waiting for the job queue notifications
+    gboolean n_terminate;     ///< Has the notification thread been terminated
+    gint     n_listening;     ///< Is the notification connection listening
+    gint     n_pending;       ///< Has a job queue check been signalled
+    gboolean n_backlog;       ///< Were ready jobs left in the job queue by the last check
 
     /* regular expressions */
     GRegex* parse_agent_msg;     ///< Parses messages coming from the agents
@@ -240,6 +252,12 @@ extern GThread* main_thread;
  *   agent_update_interval => The time between each SIGALRM for the scheduler
  *   agent_update_number   => The number of updates before killing an agent
  *   interface_nthreads    => The number of threads available to the interface
+ *   job_notify            => Wait for the notifications of the database for new
+ *                            jobs instead of polling the job queue
+ *   agent_pool_size       => The number of finished agents of each type kept to
+ *                            run the next jobs of that type, 0 to disable
+ *   agent_pool_timeout    => The time a kept agent waits for a new job before
+ *                            it is closed
  *
  * For the operation that will be taken when a variable is loaded from the
  * configuration file. You should provide a function or macro that takes a
@@ -258,7 +276,10 @@ extern GThread* main_thread;
   apply(uint32_t, agent_death_timer,     atoi, %d, 180)           \
   apply(uint32_t, agent_update_interval, atoi, %d, 120)           \
   apply(uint32_t, agent_update_number,   atoi, %d, 5)             \
-  apply(gint,     interface_nthreads,    atoi, %d, 10)
+  apply(gint,     interface_nthreads,    atoi, %d, 10)            \
+  apply(uint32_t, job_notify,            atoi, %d, 0)             \
+  apply(uint32_t, agent_pool_size,       atoi, %d, 0)             \
+  apply(uint32_t, agent_pool_timeout,    atoi, %d, 300)
 
 /** The extern declaractions of configuration varaibles */
 #define SELECT_DECLS(type, name, l_op, w_op, val) extern type CONF_##name;
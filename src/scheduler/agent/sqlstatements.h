@@ -115,25 +115,52 @@ const char* jobsql_email_job =
 
 /* job queue related sql */
 /**
- * Get the jobs which are not yet queued by the scheduler
+ * Get the jobs which are not yet queued by the scheduler, along with the user,
+ * group and priority of the job they belong to
  */
 const char* basic_checkout =
-    " SELECT jobqueue.* FROM jobqueue INNER JOIN job ON job_pk = jq_job_fk "
+    " SELECT jobqueue.*, user_pk, job_priority, job_group_fk AS group_pk "
+    "   FROM jobqueue INNER JOIN job ON job_pk = jq_job_fk "
+    "   LEFT JOIN users ON user_pk = job_user_fk "
     " WHERE jq_starttime IS NULL AND jq_end_bits < 2 "
     "   AND NOT EXISTS(SELECT * FROM jobdepends, jobqueue jdep "
     "     WHERE jdep_jq_fk=jobqueue.jq_pk "
     "       AND jdep_jq_depends_fk=jdep.jq_pk"
     "       AND NOT(jdep.jq_endtime IS NOT NULL AND jdep.jq_end_bits < 2)) "
     " ORDER BY job_priority DESC "
-    "   LIMIT 10;";
+    "   LIMIT " G_STRINGIFY(CHECKOUT_LIMIT) ";";
 
 /**
- * For a given job id, get the job information
+ * Create the function that notifies the scheduler of new jobs
  */
-const char* jobsql_information =
-    " SELECT user_pk, job_priority, job_group_fk as group_pk FROM users "
-    "   LEFT JOIN job ON job_user_fk = user_pk "
-    "   WHERE job_pk = '%s';";
+const char* jobqueue_notify_function =
+    " CREATE OR REPLACE FUNCTION jobqueue_notify() RETURNS trigger AS $$ "
+    "   BEGIN "
+    "     PERFORM pg_notify('" JOBQUEUE_CHANNEL "', ''); "
+    "     RETURN NULL; "
+    "   END; "
+    " $$ LANGUAGE plpgsql;";
+
+/**
+ * Check if the job queue notification trigger exists
+ */
+const char* jobqueue_notify_check =
+    " SELECT tgname FROM pg_trigger "
+    "   WHERE tgname = 'jobqueue_notify' "
+    "     AND tgrelid = 'jobqueue'::regclass;";
+
+/**
+ * Notify the scheduler once for every statement inserting in the job queue
+ */
+const char* jobqueue_notify_trigger =
+    " CREATE TRIGGER jobqueue_notify AFTER INSERT ON jobqueue "
+    "   FOR EACH STATEMENT EXECUTE PROCEDURE jobqueue_notify();";
+
+/**
+ * Listen to the job queue notifications
+ */
+const char* jobqueue_listen =
+    " LISTEN " JOBQUEUE_CHANNEL ";";
 
 /**
  * Mark the given job id as started
@@ -30,6 +30,9 @@ with this program; if not, write to the Free Software Foundation, Inc.,
 /* ************************************************************************** */
 /* **** local declarations ************************************************** */
 /* ************************************************************************** */
+
+extern event_loop_t* event_loop_get();
+
 /*
 int agent_init_suite(void)
 {
@@ -349,6 +352,245 @@ void test_agent_init()
   scheduler_destroy(scheduler);
   // TODO finish
 }
+/**
+ * \brief Test for agent_pool_add() and agent_pool_take()
+ * \test
+ * -# Create a REUSABLE meta agent and an agent that finished its job
+ * -# Check that the agent is only kept when the pool is enabled
+ * -# Take the agent for a new job of the same type
+ * -# Check that the agent left its last job and received the new job context
+ */
+void test_agent_pool()
+{
+  scheduler_t* scheduler;
+  meta_agent_t* ma;
+  host_t* host;
+  agent_t fagent;
+  job_t* fjob;
+  job_t* njob;
+  FILE* from_scheduler;
+  char buffer[256];
+  int job_id = 1;
+
+  scheduler = scheduler_init(testdb, NULL);
+  scheduler_foss_config(scheduler);
+
+  add_meta_agent(scheduler->meta_agents, "sample", "sample", 1, SAG_REUSABLE);
+  ma = g_tree_lookup(scheduler->meta_agents, "sample");
+  host = host_init("remote", "remote.example", "/tmp", 2);
+
+  fjob = job_init(scheduler->job_list, scheduler->job_queue, "sample", NULL,
+      job_id, 1, 2, 3, 0, NULL);
+  next_job(scheduler->job_queue);
+
+  memset(&fagent, 0, sizeof(agent_t));
+  fagent.type   = ma;
+  fagent.host   = host;
+  fagent.owner  = fjob;
+  fagent.pid    = 10;
+  fagent.status = AG_PAUSED;
+  create_pipe(&fagent.from_child, &fagent.to_child, &from_scheduler, &fagent.write);
+
+  fjob->status = JB_COMPLETE;
+  fjob->finished_agents = g_list_append(fjob->finished_agents, &fagent);
+
+  /* the scheduler is not shutting down after the previous tests */
+  closing = 0;
+
+  /* the pool is disabled by default */
+  CONF_agent_pool_size = 0;
+  FO_ASSERT_FALSE(agent_pool_add(&fagent));
+  FO_ASSERT_PTR_NULL(ma->pool);
+
+  CONF_agent_pool_size = 1;
+  FO_ASSERT_TRUE(agent_pool_add(&fagent));
+  FO_ASSERT_PTR_EQUAL(ma->pool->data, &fagent);
+  FO_ASSERT_TRUE(fagent.pooled);
+
+  /* the agent runs the next job of its type */
+  njob = job_init(scheduler->job_list, scheduler->job_queue, "sample", NULL,
+      2, 2, 4, 5, 0, NULL);
+  next_job(scheduler->job_queue);
+
+  FO_ASSERT_PTR_EQUAL(agent_pool_take(scheduler, host, njob), &fagent);
+  FO_ASSERT_PTR_NULL(ma->pool);
+  FO_ASSERT_FALSE(fagent.pooled);
+  FO_ASSERT_PTR_EQUAL(fagent.owner, njob);
+  FO_ASSERT_EQUAL(fagent.status, AG_SPAWNED);
+  FO_ASSERT_PTR_NOT_NULL(g_list_find(njob->running_agents, &fagent));
+  FO_ASSERT_PTR_NULL(g_tree_lookup(scheduler->job_list, &job_id));
+
+  FO_ASSERT_STRING_EQUAL(fgets(buffer, sizeof(buffer), from_scheduler), "VERBOSE 0\n");
+  FO_ASSERT_STRING_EQUAL(fgets(buffer, sizeof(buffer), from_scheduler), "RESET 2 4 5\n");
+
+  /* there is no agent left to take */
+  FO_ASSERT_PTR_NULL(agent_pool_take(scheduler, host, njob));
+
+  CONF_agent_pool_size = 0;
+  fclose(from_scheduler);
+  fclose(fagent.write);
+  host_destroy(host);
+  scheduler_destroy(scheduler);
+}
+
+/**
+ * \brief Test for the jobs depending on a job run by a pooled agent
+ * \test
+ * -# Queue a job and a job depending on it in the database
+ * -# Check out the jobs, only the first one is ready
+ * -# Complete the first job with an agent that is kept in the pool
+ * -# Check that a database update is signaled and checks out the dependent job
+ */
+void test_agent_pool_depends()
+{
+  scheduler_t* scheduler;
+  meta_agent_t* ma;
+  host_t* host;
+  agent_t fagent;
+  job_t* fjob;
+  event_t* event;
+  FILE* from_scheduler;
+  PGresult* db_result;
+  int job_id = 20;
+  int dep_id = 21;
+  int updated = 0;
+
+  scheduler = scheduler_init(testdb, NULL);
+  database_init(scheduler);
+  FO_ASSERT_PTR_NOT_NULL_FATAL(scheduler->db_conn);
+
+  add_meta_agent(scheduler->meta_agents, "sample", "sample", 1, SAG_REUSABLE);
+  ma = g_tree_lookup(scheduler->meta_agents, "sample");
+  host = host_init("remote", "remote.example", "/tmp", 2);
+
+  db_result = database_exec(scheduler,
+      "INSERT INTO job (job_pk,job_user_fk,job_queued,job_priority,job_name) "
+      "VALUES (20,'1',now(),'0','testing pool');"
+      "INSERT INTO jobqueue "
+      "(jq_pk,jq_job_fk,jq_type,jq_args,jq_runonpfile,jq_starttime,jq_endtime,jq_end_bits,jq_host) "
+      "VALUES (20,20,'sample','1',NULL,NULL,NULL,0,NULL),"
+      "       (21,20,'sample','2',NULL,NULL,NULL,0,NULL);"
+      "INSERT INTO jobdepends (jdep_jq_fk,jdep_jq_depends_fk) VALUES (21,20);");
+  PQclear(db_result);
+
+  database_update_event(scheduler, NULL);
+  fjob = g_tree_lookup(scheduler->job_list, &job_id);
+  FO_ASSERT_PTR_NOT_NULL_FATAL(fjob);
+  FO_ASSERT_PTR_NULL(g_tree_lookup(scheduler->job_list, &dep_id));
+
+  memset(&fagent, 0, sizeof(agent_t));
+  fagent.type   = ma;
+  fagent.host   = host;
+  fagent.owner  = fjob;
+  fagent.pid    = 10;
+  fagent.status = AG_PAUSED;
+  create_pipe(&fagent.from_child, &fagent.to_child, &from_scheduler, &fagent.write);
+  fjob->finished_agents = g_list_append(fjob->finished_agents, &fagent);
+
+  /* the agent of the job is kept instead of dying */
+  closing = 0;
+  CONF_agent_pool_size = 1;
+  while((event = g_async_queue_try_pop(event_loop_get()->queue)) != NULL)
+    g_free(event);
+
+  job_update(scheduler, fjob);
+  FO_ASSERT_EQUAL(fjob->status, JB_COMPLETE);
+  FO_ASSERT_TRUE(fagent.pooled);
+
+  while((event = g_async_queue_try_pop(event_loop_get()->queue)) != NULL)
+  {
+    if(event->func == (event_function)database_update_event)
+      updated = 1;
+    g_free(event);
+  }
+  FO_ASSERT_TRUE(updated);
+
+  database_update_event(scheduler, NULL);
+  FO_ASSERT_PTR_NOT_NULL(g_tree_lookup(scheduler->job_list, &dep_id));
+
+  ma->pool = g_list_remove(ma->pool, &fagent);
+  CONF_agent_pool_size = 0;
+  fclose(from_scheduler);
+  fclose(fagent.write);
+  host_destroy(host);
+  scheduler_destroy(scheduler);
+}
+
+/**
+ * \brief Test for the communication thread
+ * \test
+ * -# Listen to an agent with agent_io_add()
+ * -# Send its version, a message in two parts and a message longer than the
+ *    buffer of the agent
+ * -# Call agent_io_remove(), which handles what is left in the pipe
+ * -# Check that every message was handled and the buffer was emptied
+ */
+void test_agent_io()
+{
+  scheduler_t* scheduler;
+  meta_agent_t* ma;
+  host_t* host;
+  agent_t fagent;
+  job_t* fjob;
+  char* msg;
+  int n;
+
+  scheduler = scheduler_init(testdb, NULL);
+  scheduler_foss_config(scheduler);
+
+  add_meta_agent(scheduler->meta_agents, "sample", "sample", 1, 0);
+  ma = g_tree_lookup(scheduler->meta_agents, "sample");
+  host = host_init("remote", "remote.example", "/tmp", 2);
+
+  fjob = job_init(scheduler->job_list, scheduler->job_queue, "sample", NULL,
+      1, 1, 2, 3, 0, NULL);
+  next_job(scheduler->job_queue);
+
+  memset(&fagent, 0, sizeof(agent_t));
+  fagent.type   = ma;
+  fagent.host   = host;
+  fagent.owner  = fjob;
+  fagent.pid    = 10;
+  fagent.status = AG_RUNNING;
+  create_pipe(&fagent.from_child, &fagent.to_parent, NULL, NULL);
+  create_pipe(&fagent.from_parent, &fagent.to_child, NULL, &fagent.write);
+
+  FO_ASSERT_TRUE_FATAL(agent_io_init(scheduler));
+  agent_io_add(scheduler, &fagent);
+
+  msg = "VERSION: 1.0\nHEART: 5 1\nSPECIAL: 1 1\n";
+  FO_ASSERT_EQUAL(write(fagent.to_parent, msg, strlen(msg)), strlen(msg));
+
+  /* a message longer than the buffer is cut */
+  for(n = 0; n < MAX_MSG + 100; n++)
+    FO_ASSERT_EQUAL(write(fagent.to_parent, "x", 1), 1);
+
+  /* a message can arrive in several parts */
+  FO_ASSERT_EQUAL(write(fagent.to_parent, "\nEMA", 5), 5);
+  usleep(1000);
+  FO_ASSERT_EQUAL(write(fagent.to_parent, "IL done\n", 8), 8);
+
+  agent_io_remove(scheduler, &fagent);
+
+  FO_ASSERT_TRUE(fagent.versioned);
+  FO_ASSERT_STRING_EQUAL(ma->version, "1.0");
+  FO_ASSERT_EQUAL(fagent.total_analyzed, 5);
+  FO_ASSERT_TRUE(fagent.alive);
+  FO_ASSERT_EQUAL(fagent.special, 1);
+  FO_ASSERT_PTR_NOT_NULL_FATAL(fjob->message);
+  FO_ASSERT_STRING_EQUAL(fjob->message, "done");
+  FO_ASSERT_EQUAL(fagent.msg_len, 0);
+  FO_ASSERT_PTR_NULL(g_hash_table_lookup(scheduler->io_agents,
+      GINT_TO_POINTER(fagent.from_child)));
+
+  close(fagent.from_child);
+  close(fagent.to_parent);
+  close(fagent.from_parent);
+  fclose(fagent.write);
+  host_destroy(host);
+  scheduler_destroy(scheduler);
+}
+
 /* ************************************************************************** */
 /* **** suite declaration *************************************************** */
 /* ************************************************************************** */
@@ -366,6 +608,9 @@ CU_TestInfo tests_agent[] =
     {"Test agent_init",  test_agent_init  },
     //{"Test agent_death_event", test_agent_death_event },
     {"Test agent_create_event", test_agent_create_event },
+    {"Test agent_pool", test_agent_pool },
+    {"Test agent_pool_depends", test_agent_pool_depends },
+    {"Test agent_io", test_agent_io },
     CU_TEST_INFO_NULL
 };
 
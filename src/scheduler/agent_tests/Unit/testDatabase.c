@@ -140,6 +140,44 @@ void test_database_update_event()
   scheduler_destroy(scheduler);
 }
 
+/**
+ * \brief Test for the job queue notifications
+ * \test
+ * -# Initialize test database with the notifications enabled
+ * -# Check that the notification thread is listening
+ * -# Insert in the job queue from a connection also listening to it
+ * -# Check that the insertion is notified
+ */
+void test_database_listen()
+{
+  scheduler_t* scheduler;
+  PGresult* db_result;
+  PGnotify* notify;
+
+  scheduler = scheduler_init(testdb, NULL);
+
+  CONF_job_notify = 1;
+  database_init(scheduler);
+  CONF_job_notify = 0;
+  FO_ASSERT_PTR_NOT_NULL(scheduler->n_conn);
+  FO_ASSERT_TRUE(database_listening(scheduler));
+
+  db_result = database_exec(scheduler, "LISTEN " JOBQUEUE_CHANNEL ";");
+  PQclear(db_result);
+
+  /* the trigger is notified for every statement, even without any row */
+  db_result = database_exec(scheduler, "INSERT INTO jobqueue SELECT * FROM jobqueue WHERE false;");
+  PQclear(db_result);
+
+  PQconsumeInput(scheduler->db_conn);
+  notify = PQnotifies(scheduler->db_conn);
+  FO_ASSERT_PTR_NOT_NULL_FATAL(notify);
+  FO_ASSERT_STRING_EQUAL(notify->relname, JOBQUEUE_CHANNEL);
+  PQfreemem(notify);
+
+  scheduler_destroy(scheduler);
+}
+
 /**
  * \brief Test for database_update_job()
  * \test
@@ -276,6 +314,7 @@ CU_TestInfo tests_database[] =
     {"Test database_init",          test_database_init        },
     {"Test database_exec_event",    test_database_exec_event  },
     {"Test database_update_event",  test_database_update_event},
+    {"Test database_listen",        test_database_listen      },
     {"Test database_update_job",    test_database_update_job  },
     {"Test database_job",           test_database_job         },
     CU_TEST_INFO_NULL
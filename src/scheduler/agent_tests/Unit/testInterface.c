@@ -560,6 +560,48 @@ void test_sending_agents()
   scheduler_destroy(scheduler);
 }
 
+/**
+ * \brief Test for metrics message on interface
+ * \test
+ * -# Initialize scheduler and interface
+ * -# Create a socket connection to scheduler
+ * -# Send \b metrics message on the interface
+ * -# Check for the result on socket which should contain\n
+ * `received` followed by the metrics, without using the event loop
+ */
+void test_sending_metrics()
+{
+  char buffer[1024];
+  int soc;
+  ssize_t result;
+
+  // create data structures
+  CREATE_INTERFACE(scheduler);
+
+  // create the connection
+  snprintf(buffer, sizeof(buffer), "%d", scheduler->i_port);
+  soc = socket_connect("localhost", buffer);
+  FO_ASSERT_TRUE_FATAL(soc);
+
+  snprintf(buffer, sizeof(buffer), "metrics");
+  result = write(soc, buffer, strlen(buffer));
+  FO_ASSERT_EQUAL((int)result, (int)strlen(buffer));
+  sleep(1);
+  memset(buffer, '\0', sizeof(buffer));
+  result = read(soc, buffer, sizeof(buffer) - 1);
+  FO_ASSERT_TRUE(result > 0);
+  FO_ASSERT_TRUE(g_str_has_prefix(buffer,
+      "received\n"
+      "# HELP fossology_scheduler_event_latency_seconds "));
+
+  result = g_async_queue_length(event_loop_get()->queue);
+  FO_ASSERT_EQUAL((int)result, 0);
+
+  close(soc);
+  interface_destroy(scheduler);
+  scheduler_destroy(scheduler);
+}
+
 /* ************************************************************************** */
 /* **** suite declaration *************************************************** */
 /* ************************************************************************** */
@@ -580,6 +622,7 @@ CU_TestInfo tests_interface_thread[] =
     {"Test sending \"kill\"",   test_sending_kill   },
     {"Test sending \"pause\"",  test_sending_pause  },
     {"Test sending \"status\"", test_sending_reload },
+    {"Test sending \"metrics\"", test_sending_metrics },
     CU_TEST_INFO_NULL
 };
 
@@ -144,6 +144,43 @@ void test_job_fun()
   scheduler_destroy(scheduler);
 }
 
+/**
+ * \brief Test for the job queue of every agent type
+ * \test
+ * -# Queue jobs of two agent types with different priorities
+ * -# Check that queued_jobs() counts the jobs of every type
+ * -# Check that next_job() takes the jobs by priority, then in the order they
+ *    were queued, across the agent types
+ */
+void test_job_queue()
+{
+  GTree* job_list = g_tree_new_full(int_compare, NULL, NULL, NULL);
+  GTree* job_queue = job_queue_new();
+  job_t* jobs[4];
+  int i;
+
+  jobs[0] = job_init(job_list, job_queue, "nomos",     NULL, 1, 0, 0, 0, 0, NULL);
+  jobs[1] = job_init(job_list, job_queue, "copyright", NULL, 2, 0, 0, 0, 0, NULL);
+  jobs[2] = job_init(job_list, job_queue, "nomos",     NULL, 3, 0, 0, 0, -1, NULL);
+  jobs[3] = job_init(job_list, job_queue, "copyright", NULL, 4, 0, 0, 0, 0, NULL);
+
+  FO_ASSERT_EQUAL(queued_jobs(job_queue), 4);
+  FO_ASSERT_EQUAL(g_tree_nnodes(job_queue), 2);
+  FO_ASSERT_PTR_EQUAL(peek_job(job_queue), jobs[2]);
+
+  FO_ASSERT_PTR_EQUAL(next_job(job_queue), jobs[2]);
+  FO_ASSERT_PTR_EQUAL(next_job(job_queue), jobs[0]);
+  FO_ASSERT_PTR_EQUAL(next_job(job_queue), jobs[1]);
+  FO_ASSERT_PTR_EQUAL(next_job(job_queue), jobs[3]);
+  FO_ASSERT_PTR_NULL(next_job(job_queue));
+  FO_ASSERT_EQUAL(queued_jobs(job_queue), 0);
+
+  g_tree_destroy(job_queue);
+  for(i = 0; i < 4; i++)
+    job_destroy(jobs[i]);
+  g_tree_destroy(job_list);
+}
+
 /* ************************************************************************** */
 /* **** suite declaration *************************************************** */
 /* ************************************************************************** */
@@ -152,5 +189,6 @@ CU_TestInfo tests_job[] =
 {
     {"Test job_event", test_job_event },
     {"Test job_fun",   test_job_fun   },
+    {"Test job_queue", test_job_queue },
     CU_TEST_INFO_NULL
 };
@@ -0,0 +1,164 @@
+/*********************************************************************
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*********************************************************************/
+/**
+ * \file
+ * \brief Unit test for the scheduler metrics
+ */
+
+/* include functions to test */
+#include <testRun.h>
+#include <metrics.h>
+
+/* library includes */
+#include <gio/gio.h>
+#include <glib.h>
+
+/* ************************************************************************** */
+/* **** local declarations ************************************************** */
+/* ************************************************************************** */
+
+/**
+ * @brief Print the metrics into a string.
+ *
+ * @return the metrics, must be freed with g_free()
+ */
+static gchar* metrics_string()
+{
+  GOutputStream* ostr;
+  gchar* ret;
+
+  ostr = g_memory_output_stream_new(NULL, 0, g_realloc, g_free);
+  metrics_print(ostr);
+  g_output_stream_write(ostr, "", 1, NULL, NULL);
+  g_output_stream_close(ostr, NULL, NULL);
+
+  ret = g_memory_output_stream_steal_data(G_MEMORY_OUTPUT_STREAM(ostr));
+  g_object_unref(ostr);
+  return ret;
+}
+
+/* ************************************************************************** */
+/* **** metrics function tests ********************************************** */
+/* ************************************************************************** */
+
+/**
+ * \brief Test for metrics_histogram_observe()
+ * \test
+ * -# Observe values below the first bound, on a bound, between two bounds and
+ *    above the last bound
+ * -# Check the bucket of every value, the count and the sum
+ */
+void test_metrics_histogram_observe()
+{
+  histogram_t histogram;
+
+  memset(&histogram, 0, sizeof(histogram));
+
+  metrics_histogram_observe(&histogram, 0);
+  metrics_histogram_observe(&histogram, -10);
+  metrics_histogram_observe(&histogram, 1000);
+  metrics_histogram_observe(&histogram, 2 * G_USEC_PER_SEC);
+  metrics_histogram_observe(&histogram, (gint64)20000 * G_USEC_PER_SEC);
+
+  FO_ASSERT_EQUAL((int)histogram.buckets[0], 3);
+  FO_ASSERT_EQUAL((int)histogram.buckets[1], 0);
+  FO_ASSERT_EQUAL((int)histogram.buckets[7], 1);
+  FO_ASSERT_EQUAL((int)histogram.buckets[METRICS_BUCKETS], 1);
+  FO_ASSERT_EQUAL((int)histogram.count, 5);
+  FO_ASSERT_DOUBLE_EQUAL(histogram.sum, 20002.001, 0.000001);
+}
+
+/**
+ * \brief Test for metrics_print()
+ * \test
+ * -# Print the metrics without any observation and check the empty event loop
+ *    latency
+ * -# Record the metrics of a job and of its agents
+ * -# Check that the histograms are cumulative, that the counters are kept by
+ *    agent type and that the output ends like the other interface answers
+ * -# Check that metrics_reset() clears the metrics
+ */
+void test_metrics_print()
+{
+  gchar* metrics;
+
+  metrics_reset();
+  metrics = metrics_string();
+  FO_ASSERT_TRUE(g_str_has_prefix(metrics,
+      "# HELP fossology_scheduler_event_latency_seconds "));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_event_latency_seconds_bucket{le=\"+Inf\"} 0\n"
+      "fossology_scheduler_event_latency_seconds_sum 0.000000\n"
+      "fossology_scheduler_event_latency_seconds_count 0\n"));
+  FO_ASSERT_PTR_NULL(strstr(metrics, "agent_type"));
+  FO_ASSERT_TRUE(g_str_has_suffix(metrics, "\nend\n"));
+  g_free(metrics);
+
+  metrics_event(g_get_monotonic_time());
+  metrics_job_wait("copyright", 2 * G_USEC_PER_SEC);
+  metrics_job_run("copyright", 20 * G_USEC_PER_SEC, 0);
+  metrics_job_run("nomos", 20 * G_USEC_PER_SEC, 1);
+  metrics_agent_startup("copyright", 50000);
+  metrics_agent_heart("copyright", 30 * G_USEC_PER_SEC, 10);
+  metrics_agent_heart("copyright", 30 * G_USEC_PER_SEC, 5);
+
+  metrics = metrics_string();
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_event_latency_seconds_count 1\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_job_wait_seconds_bucket{agent_type=\"copyright\",le=\"1\"} 0\n"
+      "fossology_scheduler_job_wait_seconds_bucket{agent_type=\"copyright\",le=\"5\"} 1\n"
+      "fossology_scheduler_job_wait_seconds_bucket{agent_type=\"copyright\",le=\"10\"} 1\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_job_wait_seconds_sum{agent_type=\"copyright\"} 2.000000\n"
+      "fossology_scheduler_job_wait_seconds_count{agent_type=\"copyright\"} 1\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_agent_startup_seconds_bucket{agent_type=\"copyright\",le=\"0.05\"} 1\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_agent_heartbeat_gap_seconds_count{agent_type=\"copyright\"} 2\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_jobs_completed_total{agent_type=\"copyright\"} 1\n"
+      "fossology_scheduler_jobs_completed_total{agent_type=\"nomos\"} 0\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_jobs_failed_total{agent_type=\"copyright\"} 0\n"
+      "fossology_scheduler_jobs_failed_total{agent_type=\"nomos\"} 1\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_agent_heartbeats_total{agent_type=\"copyright\"} 2\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_agent_items_total{agent_type=\"copyright\"} 15\n"));
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "# TYPE fossology_scheduler_agent_items_total counter\n"));
+  g_free(metrics);
+
+  metrics_reset();
+  metrics = metrics_string();
+  FO_ASSERT_PTR_NOT_NULL(strstr(metrics,
+      "fossology_scheduler_event_latency_seconds_count 0\n"));
+  FO_ASSERT_PTR_NULL(strstr(metrics, "agent_type"));
+  g_free(metrics);
+}
+
+/* ************************************************************************** */
+/* **** suite declaration *************************************************** */
+/* ************************************************************************** */
+
+CU_TestInfo tests_metrics[] =
+{
+    {"Test metrics_histogram_observe", test_metrics_histogram_observe },
+    {"Test metrics_print",             test_metrics_print             },
+    CU_TEST_INFO_NULL
+};
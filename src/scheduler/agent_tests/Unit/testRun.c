@@ -98,9 +98,11 @@ CU_SuiteInfo suites[] =
     {"Email",           NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_email },
   //  {"Job"  NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_job },
     {"Scheduler",       NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_scheduler },
+    {"Simulation",      NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_simulation },
     {"MetaAgent",       NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_meta_agent },
     {"Agent",           NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_agent },
     {"Event",           NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_event },
+    {"Metrics",         NULL, NULL, (CU_SetUpFunc)init_suite, (CU_TearDownFunc)clean_suite, tests_metrics },
     CU_SUITE_INFO_NULL
 };
 #else
@@ -113,9 +115,11 @@ CU_SuiteInfo suites[] =
     {"Email",init_suite,clean_suite, tests_email },
   //  {"Job",init_suite,clean_suite, tests_job },
     {"Scheduler", init_suite,clean_suite, tests_scheduler },
+    {"Simulation", init_suite, clean_suite, tests_simulation },
     {"MetaAgent", init_suite, clean_suite, tests_meta_agent },
     {"Agent", init_suite, clean_suite, tests_agent },
     {"Event",init_suite,clean_suite, tests_event },
+    {"Metrics", init_suite, clean_suite, tests_metrics },
     CU_SUITE_INFO_NULL
 };
 #endif
@@ -57,5 +57,8 @@ extern CU_TestInfo tests_email[];
 extern CU_TestInfo tests_job[];
 
 extern CU_TestInfo tests_scheduler[];
+extern CU_TestInfo tests_simulation[];
+
+extern CU_TestInfo tests_metrics[];
 /* scheduler private declarations */
 event_loop_t* event_loop_get();
@@ -0,0 +1,403 @@
+/*********************************************************************
+Copyright (C) 2026, Siemens AG
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+version 2 as published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along
+with this program; if not, write to the Free Software Foundation, Inc.,
+51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*********************************************************************/
+/**
+ * \file
+ * \brief Simulation of the scheduling of job traces
+ *
+ * A trace is replayed against next_ready_job() without starting any agent:
+ * every job keeps a slot of its host and of its agent type for its duration.
+ * The trace files have one entry per line, '#' starts a comment:
+ *
+ *     host  <name> <max>
+ *     agent <name> <max_run> [local]
+ *     share <group id> <weight>
+ *     job   <arrival> <duration> <agent> <group id> <priority> [host]
+ *
+ * The jobs must be sorted by arrival. A trace can be recorded from the job
+ * queue of a FOSSology instance with:
+ *
+ *     SELECT 'job', extract(epoch FROM job_queued - min(job_queued) OVER ()),
+ *            extract(epoch FROM jq_endtime - jq_starttime),
+ *            jq_type, job_group_fk, job_priority
+ *       FROM jobqueue INNER JOIN job ON job_pk = jq_job_fk
+ *      WHERE jq_endtime IS NOT NULL ORDER BY 2;
+ *
+ * and replayed by setting SCHEDULER_TRACE to its path when running the tests.
+ */
+
+/* include functions to test */
+#include <testRun.h>
+
+/* scheduler includes */
+#include <agent.h>
+#include <host.h>
+#include <job.h>
+#include <scheduler.h>
+
+/* library includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ************************************************************************** */
+/* **** simulation ********************************************************** */
+/* ************************************************************************** */
+
+/**
+ * A job of a replayed trace
+ */
+typedef struct
+{
+    double   arrival;   ///< Time the job is added to the job queue
+    double   duration;  ///< Time the agent of the job runs
+    double   start;     ///< Time the job started, negative until it starts
+    job_t*   job;       ///< The job in the scheduler
+    host_t*  host;      ///< The host the job runs on
+} sim_job_t;
+
+/**
+ * Results of the replay of a trace
+ */
+typedef struct
+{
+    uint32_t jobs;        ///< Number of jobs that finished
+    double   makespan;    ///< Time the last job finished
+    double   throughput;  ///< Number of jobs finished by unit of time
+    double   wait_mean;   ///< Mean time between the arrival and the start of the jobs
+    double   wait_max;    ///< Max time between the arrival and the start of the jobs
+    GTree*   group_wait;  ///< Mean wait of the jobs of every group
+} sim_report_t;
+
+/**
+ * @brief Loads a trace in a scheduler.
+ *
+ * @param scheduler  The scheduler to add the hosts, agents and weights to
+ * @param path       The path of the trace file
+ * @return the jobs of the trace
+ */
+static GArray* sim_load(scheduler_t* scheduler, const char* path)
+{
+  GArray* jobs = g_array_new(FALSE, TRUE, sizeof(sim_job_t));
+  GTree* arrivals = job_queue_new();
+  gchar* content = NULL;
+  gchar** lines;
+  gchar** line;
+  char name[256], special[256], host[256];
+  int max, group, priority, n;
+  gint* key;
+  sim_job_t sim;
+
+  FO_ASSERT_TRUE_FATAL(g_file_get_contents(path, &content, NULL, NULL));
+
+  lines = g_strsplit(content, "\n", -1);
+  for(line = lines; *line != NULL; line++)
+  {
+    g_strstrip(*line);
+    if((*line)[0] == '\0' || (*line)[0] == '#')
+      continue;
+
+    special[0] = '\0';
+    host[0] = '\0';
+    if(sscanf(*line, "host %255s %d", name, &max) == 2)
+    {
+      host_insert(host_init(name, "localhost", "directory", max), scheduler);
+    }
+    else if(sscanf(*line, "agent %255s %d %255s", name, &max, special) >= 2)
+    {
+      add_meta_agent(scheduler->meta_agents, name, "simulation", max,
+          strcmp(special, "local") == 0 ? SAG_LOCAL : 0);
+    }
+    else if(sscanf(*line, "share %d %d", &group, &max) == 2)
+    {
+      key = g_new(gint, 1);
+      *key = group;
+      g_tree_insert(scheduler->group_weights, key, GINT_TO_POINTER(max));
+    }
+    else if((n = sscanf(*line, "job %lf %lf %255s %d %d %255s", &sim.arrival,
+        &sim.duration, name, &group, &priority, host)) >= 5)
+    {
+      sim.start = -1;
+      sim.host  = NULL;
+      /* the job is only queued once it arrives */
+      sim.job   = job_init(scheduler->job_list, arrivals, name,
+          n == 6 ? host : NULL, jobs->len + 1, jobs->len + 1, group, group,
+          priority, NULL);
+      g_array_append_val(jobs, sim);
+    }
+    else
+    {
+      FO_FAIL_FATAL("invalid trace line");
+    }
+  }
+
+  g_tree_destroy(arrivals);
+  g_strfreev(lines);
+  g_free(content);
+  return jobs;
+}
+
+/**
+ * @brief Replays a trace and reports the throughput and wait times.
+ *
+ * @param path    The path of the trace file
+ * @param report  The report of the replay, its group_wait must be freed
+ */
+static void sim_replay(const char* path, sim_report_t* report)
+{
+  scheduler_t* scheduler;
+  GArray* jobs;
+  GTree* usage;
+  GTree* group_jobs;
+  sim_job_t* sim;
+  meta_agent_t* meta;
+  job_t* job;
+  host_t* host;
+  gint* key;
+  double now = 0, next, wait;
+  uint32_t arrived = 0, i;
+  int running = 0;
+
+  scheduler = scheduler_init(testdb, NULL);
+  jobs = sim_load(scheduler, path);
+
+  memset(report, 0, sizeof(sim_report_t));
+  report->group_wait = g_tree_new_full(int_compare, NULL, g_free, g_free);
+  group_jobs = g_tree_new_full(int_compare, NULL, g_free, NULL);
+
+  while(report->jobs < jobs->len)
+  {
+    /* finish the jobs that are done and queue the ones that arrive */
+    for(i = 0; i < jobs->len; i++)
+    {
+      sim = &g_array_index(jobs, sim_job_t, i);
+      if(sim->host != NULL && sim->start + sim->duration <= now)
+      {
+        meta = g_tree_lookup(scheduler->meta_agents, sim->job->agent_type);
+        host_decrease_load(sim->host);
+        meta_agent_decrease_count(meta);
+        sim->host = NULL;
+        running--;
+        report->jobs++;
+        report->makespan = now;
+      }
+    }
+    for(; arrived < jobs->len; arrived++)
+    {
+      sim = &g_array_index(jobs, sim_job_t, arrived);
+      if(sim->arrival > now)
+        break;
+      job_queue_insert(scheduler->job_queue, sim->job);
+    }
+
+    /* start the jobs like scheduler_update() */
+    usage = g_tree_new_full(int_compare, NULL, g_free, NULL);
+    for(i = 0; i < jobs->len; i++)
+    {
+      sim = &g_array_index(jobs, sim_job_t, i);
+      if(sim->host != NULL)
+      {
+        key = g_new(gint, 1);
+        *key = sim->job->group_id;
+        g_tree_insert(usage, key,
+            GINT_TO_POINTER(GPOINTER_TO_INT(g_tree_lookup(usage, key)) + 1));
+      }
+    }
+    while((job = next_ready_job(scheduler, usage, &host)) != NULL)
+    {
+      sim = &g_array_index(jobs, sim_job_t, job->id - 1);
+      meta = g_tree_lookup(scheduler->meta_agents, job->agent_type);
+      host_increase_load(host);
+      meta_agent_increase_count(meta);
+      sim->host  = host;
+      sim->start = now;
+      running++;
+    }
+    g_tree_unref(usage);
+
+    /* move to the next arrival or end of a job */
+    next = -1;
+    if(arrived < jobs->len)
+      next = g_array_index(jobs, sim_job_t, arrived).arrival;
+    for(i = 0; i < jobs->len; i++)
+    {
+      sim = &g_array_index(jobs, sim_job_t, i);
+      if(sim->host != NULL && (next < 0 || sim->start + sim->duration < next))
+        next = sim->start + sim->duration;
+    }
+    FO_ASSERT_FATAL(next >= 0 || running > 0 || report->jobs == jobs->len);
+    if(next < 0)
+      break;
+    now = next;
+  }
+
+  /* compute the wait times */
+  for(i = 0; i < jobs->len; i++)
+  {
+    sim = &g_array_index(jobs, sim_job_t, i);
+    wait = sim->start - sim->arrival;
+    report->wait_mean += wait / jobs->len;
+    if(wait > report->wait_max)
+      report->wait_max = wait;
+
+    key = g_new(gint, 1);
+    *key = sim->job->group_id;
+    g_tree_insert(group_jobs, key,
+        GINT_TO_POINTER(GPOINTER_TO_INT(g_tree_lookup(group_jobs, key)) + 1));
+  }
+  for(i = 0; i < jobs->len; i++)
+  {
+    double* mean;
+
+    sim = &g_array_index(jobs, sim_job_t, i);
+    if((mean = g_tree_lookup(report->group_wait, &sim->job->group_id)) == NULL)
+    {
+      key = g_new(gint, 1);
+      *key = sim->job->group_id;
+      mean = g_new0(double, 1);
+      g_tree_insert(report->group_wait, key, mean);
+    }
+    *mean += (sim->start - sim->arrival)
+        / GPOINTER_TO_INT(g_tree_lookup(group_jobs, &sim->job->group_id));
+  }
+  if(report->makespan > 0)
+    report->throughput = report->jobs / report->makespan;
+
+  printf("\n%s: %u jobs in %.1f, throughput %.3f jobs/s, wait mean %.1f max %.1f\n",
+      path, report->jobs, report->makespan, report->throughput,
+      report->wait_mean, report->wait_max);
+
+  g_tree_unref(group_jobs);
+  g_array_free(jobs, TRUE);
+  scheduler_destroy(scheduler);
+}
+
+/**
+ * @brief Gets the mean wait of the jobs of a group.
+ *
+ * @param report  The report of the replay
+ * @param group   The id of the group
+ * @return the mean wait of the group
+ */
+static double sim_group_wait(sim_report_t* report, int group)
+{
+  double* mean = g_tree_lookup(report->group_wait, &group);
+
+  FO_ASSERT_PTR_NOT_NULL_FATAL(mean);
+  return *mean;
+}
+
+/* ************************************************************************** */
+/* **** simulation tests **************************************************** */
+/* ************************************************************************** */
+
+/**
+ * \brief Test that a blocked agent type doesn't block the other jobs
+ * \test
+ * -# Replay jobs of an agent type limited to one agent, followed by jobs of
+ *    an other agent type
+ * -# Check that the jobs of the other agent type don't wait
+ * -# Check that every job finished in the expected time
+ */
+void test_simulation_blocking()
+{
+  sim_report_t report;
+
+  sim_replay("traces/blocking.trace", &report);
+
+  FO_ASSERT_EQUAL(report.jobs, 6);
+  FO_ASSERT_EQUAL((int)report.makespan, 30);
+  FO_ASSERT_EQUAL((int)sim_group_wait(&report, 2), 0);
+
+  g_tree_unref(report.group_wait);
+}
+
+/**
+ * \brief Test that the agents are shared between the groups
+ * \test
+ * -# Replay the jobs of a group, followed by the jobs of an other group
+ * -# Check that the second group gets the first free agent
+ * -# Replay the same jobs with a weight for the second group
+ * -# Check that the second group waits less
+ */
+void test_simulation_shares()
+{
+  sim_report_t report;
+  double wait;
+
+  sim_replay("traces/fairness.trace", &report);
+
+  FO_ASSERT_EQUAL(report.jobs, 6);
+  FO_ASSERT_EQUAL((int)sim_group_wait(&report, 2), 14);
+  g_tree_unref(report.group_wait);
+
+  sim_replay("traces/shares.trace", &report);
+  wait = sim_group_wait(&report, 2);
+  g_tree_unref(report.group_wait);
+
+  sim_replay("traces/weighted_shares.trace", &report);
+  FO_ASSERT_TRUE(sim_group_wait(&report, 2) < wait);
+  g_tree_unref(report.group_wait);
+}
+
+/**
+ * \brief Test that the higher priorities are started first
+ * \test
+ * -# Replay jobs of several priorities on a single slot
+ * -# Check that the jobs of the lowest priority value are started first
+ */
+void test_simulation_priority()
+{
+  sim_report_t report;
+
+  sim_replay("traces/priority.trace", &report);
+
+  FO_ASSERT_EQUAL(report.jobs, 3);
+  FO_ASSERT_EQUAL((int)sim_group_wait(&report, 1), 20);
+  FO_ASSERT_EQUAL((int)sim_group_wait(&report, 3), 0);
+
+  g_tree_unref(report.group_wait);
+}
+
+/**
+ * \brief Replays the trace given by SCHEDULER_TRACE, if any
+ * \test
+ * -# Replay the trace and report its throughput and wait times
+ */
+void test_simulation_replay()
+{
+  sim_report_t report;
+  char* path = getenv("SCHEDULER_TRACE");
+
+  if(path == NULL)
+    return;
+
+  sim_replay(path, &report);
+  g_tree_unref(report.group_wait);
+}
+
+/* ************************************************************************** */
+/* **** suite declaration *************************************************** */
+/* ************************************************************************** */
+
+CU_TestInfo tests_simulation[] =
+{
+    {"Test simulation_blocking", test_simulation_blocking },
+    {"Test simulation_shares",   test_simulation_shares   },
+    {"Test simulation_priority", test_simulation_priority },
+    {"Test simulation_replay",   test_simulation_replay   },
+    CU_TEST_INFO_NULL
+};